@@ -19,10 +19,14 @@
 
 #include "cJSON.h"
 #include "cJSON_os.h"
+#if defined(CONFIG_TINYCBOR)
+#include <tinycbor/cbor.h>
+#endif
 #include "cloud_codec.h"
 
 #include "service_info.h"
 #include "env_sensors.h"
+#include "json_writer.h"
 
 #include <logging/log.h>
 LOG_MODULE_REGISTER(cloud_codec, CONFIG_ASSET_TRACKER_LOG_LEVEL);
@@ -283,56 +287,164 @@ static int json_add_obj(cJSON *parent, const char *str, cJSON *item)
 	return 0;
 }
 
-static int json_add_str(cJSON *parent, const char *str, const char *item)
+static cJSON *json_object_decode(cJSON *obj, const char *str)
 {
-	cJSON *json_str;
+	return obj ? cJSON_GetObjectItem(obj, str) : NULL;
+}
 
-	json_str = cJSON_CreateString(item);
-	if (json_str == NULL) {
-		return -ENOMEM;
+static bool json_value_string_compare(cJSON *obj, const char *const str)
+{
+	char *json_str = cJSON_GetStringValue(obj);
+
+	if ((json_str == NULL) || (str == NULL)) {
+		return false;
 	}
 
-	return json_add_obj(parent, str, json_str);
+	return (strcmp(json_str, str) == 0);
 }
 
-static int json_add_number(cJSON *parent, const char *str, double item)
+/* Sensor data message, the members are encoded in this order */
+struct data_msg {
+	const char *app_id;
+	const char *data;
+	const char *msg_type;
+	int64_t ts;
+};
+
+JSON_SCHEMA_DEFINE(data_msg_schema,
+	JSON_FIELD_STR(struct data_msg, app_id, CMD_CHAN_KEY_STR),
+	JSON_FIELD_STR(struct data_msg, data, CMD_DATA_TYPE_KEY_STR),
+	JSON_FIELD_STR(struct data_msg, msg_type, CMD_GROUP_KEY_STR),
+	JSON_FIELD_INT64(struct data_msg, ts, DATA_TS)
+);
+
+static int data_msg_prepare(const struct cloud_channel_data *channel,
+			    const enum cloud_cmd_group group,
+			    struct data_msg *msg)
 {
-	cJSON *json_num;
+	int ret;
 
-	json_num = cJSON_CreateNumber(item);
-	if (json_num == NULL) {
-		return -ENOMEM;
+	if (channel == NULL || channel->data.buf == NULL ||
+	    channel->data.len == 0 || group >= CLOUD_CMD_GROUP__TOTAL) {
+		return -EINVAL;
 	}
 
-	return json_add_obj(parent, str, json_num);
+	msg->app_id = channel_type_str[channel->type];
+	msg->data = channel->data.buf;
+	msg->msg_type = cmd_group_str[group];
+	msg->ts = channel->ts;
+
+	/** Convert sample uptime to unix time ms. If this function fails the
+	 *  uptime is cleared and an empty timestamp value is encoded.
+	 */
+	ret = date_time_uptime_to_unix_time_ms(&msg->ts);
+	if (ret) {
+		LOG_WRN("date_time_uptime_to_unix_time_ms, error: %d", ret);
+		LOG_WRN("Clearing timestamp");
+		date_time_timestamp_clear(&msg->ts);
+	}
+
+	return 0;
 }
 
-static int json_add_bool(cJSON *parent, const char *str, const bool value)
+int cloud_encode_data_to_buf(const struct cloud_channel_data *channel,
+			     const enum cloud_cmd_group group,
+			     char *buf, size_t size)
 {
-	cJSON *json_bool;
+	int ret;
+	struct data_msg msg;
 
-	json_bool = cJSON_CreateBool(value);
-	if (json_bool == NULL) {
-		return -ENOMEM;
+	ret = data_msg_prepare(channel, group, &msg);
+	if (ret) {
+		return ret;
 	}
 
-	return json_add_obj(parent, str, json_bool);
+	return json_schema_encode(&data_msg_schema, &msg, buf, size);
 }
 
-static cJSON *json_object_decode(cJSON *obj, const char *str)
+static int batch_json_encode(const struct cloud_channel_data *samples,
+			     size_t count, char *buf, size_t size)
 {
-	return obj ? cJSON_GetObjectItem(obj, str) : NULL;
+	int ret;
+	struct json_writer writer;
+	struct data_msg msg;
+
+	json_writer_init(&writer, buf, size);
+	json_writer_arr_begin(&writer, NULL);
+	for (size_t i = 0; i < count; i++) {
+		ret = data_msg_prepare(&samples[i], CLOUD_CMD_GROUP_DATA, &msg);
+		if (ret) {
+			return ret;
+		}
+		json_writer_schema(&writer, NULL, &data_msg_schema, &msg);
+	}
+	json_writer_arr_end(&writer);
+
+	return json_writer_finish(&writer);
 }
 
-static bool json_value_string_compare(cJSON *obj, const char *const str)
+#if defined(CONFIG_TINYCBOR)
+/* [base ts, [appId, data, ts - base ts], ...], messageType is DATA */
+static int batch_cbor_encode(const struct cloud_channel_data *samples,
+			     size_t count, uint8_t *buf, size_t size)
 {
-	char *json_str = cJSON_GetStringValue(obj);
+	CborEncoder encoder;
+	CborEncoder batch;
+	CborEncoder sample;
+	CborError err;
+	struct data_msg msg;
+	int64_t base_ts = 0;
+	int ret;
 
-	if ((json_str == NULL) || (str == NULL)) {
-		return false;
+	cbor_encoder_init(&encoder, buf, size, 0);
+	err = cbor_encoder_create_array(&encoder, &batch, count + 1);
+
+	for (size_t i = 0; i < count; i++) {
+		ret = data_msg_prepare(&samples[i], CLOUD_CMD_GROUP_DATA, &msg);
+		if (ret) {
+			return ret;
+		}
+		if (i == 0) {
+			base_ts = msg.ts;
+			err |= cbor_encode_int(&batch, base_ts);
+		}
+
+		err |= cbor_encoder_create_array(&batch, &sample, 3);
+		err |= cbor_encode_text_stringz(&sample, msg.app_id);
+		err |= cbor_encode_text_stringz(&sample, msg.data);
+		err |= cbor_encode_int(&sample, msg.ts - base_ts);
+		err |= cbor_encoder_close_container(&batch, &sample);
 	}
 
-	return (strcmp(json_str, str) == 0);
+	err |= cbor_encoder_close_container(&encoder, &batch);
+	if (err & CborErrorOutOfMemory) {
+		return -ENOMEM;
+	} else if (err) {
+		return -EINVAL;
+	}
+
+	return cbor_encoder_get_buffer_size(&encoder, buf);
+}
+#endif /* CONFIG_TINYCBOR */
+
+int cloud_encode_batch_to_buf(const struct cloud_channel_data *samples,
+			      size_t count, enum cloud_batch_format format,
+			      uint8_t *buf, size_t size)
+{
+	if (samples == NULL || count == 0 || buf == NULL) {
+		return -EINVAL;
+	}
+
+	switch (format) {
+	case CLOUD_BATCH_FORMAT_JSON:
+		return batch_json_encode(samples, count, (char *)buf, size);
+#if defined(CONFIG_TINYCBOR)
+	case CLOUD_BATCH_FORMAT_CBOR:
+		return batch_cbor_encode(samples, count, buf, size);
+#endif
+	default:
+		return -ENOTSUP;
+	}
 }
 
 int cloud_encode_data(const struct cloud_channel_data *channel,
@@ -340,116 +452,135 @@ int cloud_encode_data(const struct cloud_channel_data *channel,
 		      struct cloud_msg *output)
 {
 	int ret;
-	int64_t data_ts = channel->ts;
+	int len;
+	char *buffer;
+	struct data_msg msg;
 
-	if (channel == NULL || channel->data.buf == NULL ||
-	    channel->data.len == 0 || output == NULL ||
-	    group >= CLOUD_CMD_GROUP__TOTAL) {
+	if (output == NULL) {
 		return -EINVAL;
 	}
 
-	cJSON *root_obj = cJSON_CreateObject();
-	if (root_obj == NULL) {
-		cJSON_Delete(root_obj);
-		return -ENOMEM;
-	}
-
-	/** Convert sample uptime to unix time ms. If this function fails the
-	 *  uptime is cleared and an empty timestamp value is encoded.
-	 */
-	ret = date_time_uptime_to_unix_time_ms(&data_ts);
+	ret = data_msg_prepare(channel, group, &msg);
 	if (ret) {
-		LOG_WRN("date_time_uptime_to_unix_time_ms, error: %d", ret);
-		LOG_WRN("Clearing timestamp");
-		date_time_timestamp_clear(&data_ts);
+		return ret;
 	}
 
-	ret = json_add_str(root_obj, CMD_CHAN_KEY_STR,
-			   channel_type_str[channel->type]);
-	ret += json_add_str(root_obj, CMD_DATA_TYPE_KEY_STR, channel->data.buf);
-	ret += json_add_str(root_obj, CMD_GROUP_KEY_STR, cmd_group_str[group]);
-	ret += json_add_number(root_obj, DATA_TS, data_ts);
-	if (ret != 0) {
-		cJSON_Delete(root_obj);
+	/* One allocation of the exact size, released by cloud_release_data */
+	len = json_schema_encode(&data_msg_schema, &msg, NULL, 0);
+	buffer = k_malloc(len + 1);
+	if (buffer == NULL) {
 		return -ENOMEM;
 	}
 
-	char *buffer;
-
-	buffer = cJSON_PrintUnformatted(root_obj);
-	cJSON_Delete(root_obj);
-
+	output->len = json_schema_encode(&data_msg_schema, &msg, buffer,
+					 len + 1);
 	output->buf = buffer;
-	output->len = strlen(buffer);
 
 	return 0;
 }
 
-int cloud_encode_env_sensors_data(const env_sensor_data_t *sensor_data,
-				  struct cloud_msg *output)
+int cloud_env_sensors_channel_data_get(const env_sensor_data_t *sensor_data,
+				       struct cloud_channel_data *channel,
+				       char *buf, size_t size)
 {
 	__ASSERT_NO_MSG(sensor_data != NULL);
-	__ASSERT_NO_MSG(output != NULL);
+	__ASSERT_NO_MSG(channel != NULL);
 
-	char buf[6];
-	uint8_t len;
-	struct cloud_channel_data cloud_sensor = { .ts = sensor_data->ts };
+	int len;
+
+	channel->ts = sensor_data->ts;
 
 	switch (sensor_data->type) {
 	case ENV_SENSOR_TEMPERATURE:
-		cloud_sensor.type = CLOUD_CHANNEL_TEMP;
+		channel->type = CLOUD_CHANNEL_TEMP;
 		break;
 
 	case ENV_SENSOR_HUMIDITY:
-		cloud_sensor.type = CLOUD_CHANNEL_HUMID;
+		channel->type = CLOUD_CHANNEL_HUMID;
 		break;
 
 	case ENV_SENSOR_AIR_PRESSURE:
-		cloud_sensor.type = CLOUD_CHANNEL_AIR_PRESS;
+		channel->type = CLOUD_CHANNEL_AIR_PRESS;
 		break;
 
 	case ENV_SENSOR_AIR_QUALITY:
-		cloud_sensor.type = CLOUD_CHANNEL_AIR_QUAL;
+		channel->type = CLOUD_CHANNEL_AIR_QUAL;
 		break;
 
 	default:
 		return -1;
 	}
 
-	len = snprintf(buf, sizeof(buf), "%.1f",
-		sensor_data->value);
-	cloud_sensor.data.buf = buf;
-	cloud_sensor.data.len = len;
+	len = snprintf(buf, size, "%.1f", sensor_data->value);
+	if (len < 0 || len >= size) {
+		return -ENOMEM;
+	}
 
-	return cloud_encode_data(&cloud_sensor, CLOUD_CMD_GROUP_DATA, output);
+	channel->data.buf = buf;
+	channel->data.len = len;
+
+	return 0;
 }
 
-int cloud_encode_motion_data(const motion_data_t *motion_data,
+int cloud_encode_env_sensors_data(const env_sensor_data_t *sensor_data,
 				  struct cloud_msg *output)
 {
-	__ASSERT_NO_MSG(motion_data != NULL);
+	__ASSERT_NO_MSG(sensor_data != NULL);
 	__ASSERT_NO_MSG(output != NULL);
 
-	struct cloud_channel_data cloud_sensor = {
-		.type = CLOUD_CHANNEL_FLIP,
-		.ts = motion_data->ts
-	};
+	char buf[8];
+	struct cloud_channel_data cloud_sensor;
+	int err;
+
+	err = cloud_env_sensors_channel_data_get(sensor_data, &cloud_sensor,
+						 buf, sizeof(buf));
+	if (err) {
+		return err;
+	}
+
+	return cloud_encode_data(&cloud_sensor, CLOUD_CMD_GROUP_DATA, output);
+}
+
+int cloud_motion_channel_data_get(const motion_data_t *motion_data,
+				  struct cloud_channel_data *channel)
+{
+	__ASSERT_NO_MSG(motion_data != NULL);
+	__ASSERT_NO_MSG(channel != NULL);
+
+	channel->type = CLOUD_CHANNEL_FLIP;
+	channel->ts = motion_data->ts;
 
 	switch (motion_data->orientation) {
 	case MOTION_ORIENTATION_NORMAL:
-		cloud_sensor.data.buf = "NORMAL";
+		channel->data.buf = "NORMAL";
 		break;
 	case MOTION_ORIENTATION_UPSIDE_DOWN:
-		cloud_sensor.data.buf = "UPSIDE_DOWN";
+		channel->data.buf = "UPSIDE_DOWN";
 		break;
 	default:
 		return -1;
 	}
 
-	cloud_sensor.data.len = sizeof(cloud_sensor.data.buf) - 1;
+	channel->data.len = strlen(channel->data.buf);
 
-	return cloud_encode_data(&cloud_sensor, CLOUD_CMD_GROUP_DATA, output);
+	return 0;
+}
 
+int cloud_encode_motion_data(const motion_data_t *motion_data,
+				  struct cloud_msg *output)
+{
+	__ASSERT_NO_MSG(motion_data != NULL);
+	__ASSERT_NO_MSG(output != NULL);
+
+	struct cloud_channel_data cloud_sensor;
+	int err;
+
+	err = cloud_motion_channel_data_get(motion_data, &cloud_sensor);
+	if (err) {
+		return err;
+	}
+
+	return cloud_encode_data(&cloud_sensor, CLOUD_CMD_GROUP_DATA, output);
 }
 
 #if CONFIG_LIGHT_SENSOR
@@ -503,24 +634,33 @@ int cloud_encode_light_sensor_data(const struct light_sensor_data *sensor_data,
 }
 #endif /* CONFIG_LIGHT_SENSOR */
 
+static int config_msg_write(struct json_writer *writer, bool gps_enable)
+{
+	json_writer_obj_begin(writer, NULL);
+	json_writer_obj_begin(writer, "state");
+	json_writer_obj_begin(writer, "reported");
+	json_writer_obj_begin(writer, "config");
+	json_writer_obj_begin(writer, channel_type_str[CLOUD_CHANNEL_GPS]);
+	json_writer_bool(writer, cmd_type_str[CLOUD_CMD_ENABLE], gps_enable);
+	json_writer_obj_end(writer);
+	json_writer_obj_end(writer);
+	json_writer_obj_end(writer);
+	json_writer_obj_end(writer);
+	json_writer_obj_end(writer);
+
+	return json_writer_finish(writer);
+}
+
 int cloud_encode_config_data(struct cloud_msg *output)
 {
 	__ASSERT_NO_MSG(output != NULL);
 
-	cJSON *chan_obj = cJSON_CreateObject();
-	cJSON *state_obj = cJSON_CreateObject();
-	cJSON *reported_obj = cJSON_CreateObject();
-	cJSON *config_obj = cJSON_CreateObject();
-	cJSON *root_obj = cJSON_CreateObject();
-	int ret = 0;
+	struct json_writer writer;
 	char *buffer;
+	int len;
 
-	if (chan_obj == NULL || state_obj == NULL ||
-	    reported_obj == NULL || config_obj == NULL ||
-		root_obj == NULL) {
-		ret = -ENOMEM;
-		goto cleanup;
-	}
+	output->buf = NULL;
+	output->len = 0;
 
 	/* Currently, the only value that can be changed from
 	 * the device is GPS enable, so it is the only
@@ -529,45 +669,27 @@ int cloud_encode_config_data(struct cloud_msg *output)
 	enum cloud_cmd_state gps_state =
 		cloud_get_channel_enable_state(CLOUD_CHANNEL_GPS);
 
-	if (gps_state != CLOUD_CMD_STATE_UNDEFINED) {
-		ret = json_add_bool(chan_obj, cmd_type_str[CLOUD_CMD_ENABLE],
-				gps_state == CLOUD_CMD_STATE_TRUE);
-		if (ret != 0) {
-			ret = -ENOMEM;
-			goto cleanup;
-		}
-	}
-
-	/* No items in chan_obj is not an error, there
+	/* No items to report is not an error, there
 	 * is just nothing to report
 	 */
-	if (cJSON_GetArraySize(chan_obj) == 0) {
-		goto cleanup;
+	if (gps_state == CLOUD_CMD_STATE_UNDEFINED) {
+		return 0;
 	}
 
-	cJSON_AddItemToObject(config_obj, channel_type_str[CLOUD_CHANNEL_GPS],
-			      chan_obj);
-	cJSON_AddItemToObject(reported_obj, "config", config_obj);
-	cJSON_AddItemToObject(state_obj, "reported", reported_obj);
-	cJSON_AddItemToObject(root_obj, "state", state_obj);
+	json_writer_init(&writer, NULL, 0);
+	len = config_msg_write(&writer, gps_state == CLOUD_CMD_STATE_TRUE);
 
-	buffer = cJSON_PrintUnformatted(root_obj);
-	cJSON_Delete(root_obj);
+	buffer = k_malloc(len + 1);
+	if (buffer == NULL) {
+		return -ENOMEM;
+	}
+
+	json_writer_init(&writer, buffer, len + 1);
+	output->len = config_msg_write(&writer,
+				       gps_state == CLOUD_CMD_STATE_TRUE);
 	output->buf = buffer;
-	output->len = strlen(buffer);
 
 	return 0;
-
-cleanup:
-	output->buf = NULL;
-	output->len = 0;
-	cJSON_Delete(chan_obj);
-	cJSON_Delete(state_obj);
-	cJSON_Delete(reported_obj);
-	cJSON_Delete(config_obj);
-	cJSON_Delete(root_obj);
-
-	return ret;
 }
 
 int cloud_encode_device_status_data(
@@ -205,6 +205,52 @@ typedef void (*cloud_cmd_cb_t)(struct cloud_command *cmd);
 int cloud_encode_data(const struct cloud_channel_data *channel,
 	const enum cloud_cmd_group group, struct cloud_msg *output);
 
+/**
+ * @brief Encode cloud data into a caller-provided buffer.
+ *
+ * Produces the same output as @ref cloud_encode_data without allocating
+ * memory. The output must not be released with @ref cloud_release_data.
+ *
+ * @param channel The cloud channel type.
+ * @param group The channel data's group.
+ * @param buf Output buffer, can be NULL to only compute the length.
+ * @param size Size of the output buffer.
+ *
+ * @return Length of the encoded data without the terminating null
+ *         character, -ENOMEM if it does not fit in the buffer, otherwise
+ *         a (negative) error code.
+ */
+int cloud_encode_data_to_buf(const struct cloud_channel_data *channel,
+			     const enum cloud_cmd_group group,
+			     char *buf, size_t size);
+
+/** @brief Encoding of a batch of samples. */
+enum cloud_batch_format {
+	/** JSON array of data messages, as encoded by cloud_encode_data. */
+	CLOUD_BATCH_FORMAT_JSON,
+	/** CBOR array with the timestamp of the first sample, followed by
+	 *  [appId, data, timestamp offset] for each sample.
+	 */
+	CLOUD_BATCH_FORMAT_CBOR,
+};
+
+/**
+ * @brief Encode a batch of data samples into a caller-provided buffer.
+ *
+ * @param samples Samples to encode, in the order they are sent.
+ * @param count Number of samples.
+ * @param format Encoding of the batch.
+ * @param buf Output buffer.
+ * @param size Size of the output buffer.
+ *
+ * @return Length of the encoded batch, -ENOMEM if it does not fit in the
+ *         buffer, -ENOTSUP if the format is not enabled, otherwise a
+ *         (negative) error code.
+ */
+int cloud_encode_batch_to_buf(const struct cloud_channel_data *samples,
+			      size_t count, enum cloud_batch_format format,
+			      uint8_t *buf, size_t size);
+
 /**
  * @brief Decode cloud data.
  *
@@ -275,6 +321,31 @@ int cloud_encode_env_sensors_data(const env_sensor_data_t *sensor_data,
 int cloud_encode_motion_data(const motion_data_t *motion_data,
 			     struct cloud_msg *output);
 
+/**
+ * @brief Convert an environment sensor sample to cloud channel data.
+ *
+ * @param sensor_data Sensor sample.
+ * @param channel Channel data, the data points to buf.
+ * @param buf Buffer for the formatted value.
+ * @param size Size of the buffer.
+ *
+ * @return 0 if the operation was successful, otherwise a (negative) error code.
+ */
+int cloud_env_sensors_channel_data_get(const env_sensor_data_t *sensor_data,
+				       struct cloud_channel_data *channel,
+				       char *buf, size_t size);
+
+/**
+ * @brief Convert a motion sample to cloud channel data.
+ *
+ * @param motion_data Motion sample.
+ * @param channel Channel data.
+ *
+ * @return 0 if the operation was successful, otherwise a (negative) error code.
+ */
+int cloud_motion_channel_data_get(const motion_data_t *motion_data,
+				  struct cloud_channel_data *channel);
+
 #if CONFIG_LIGHT_SENSOR
 int cloud_encode_light_sensor_data(const struct light_sensor_data *sensor_data,
 				   struct cloud_msg *output);
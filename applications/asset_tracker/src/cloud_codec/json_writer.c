@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr.h>
+
+#include "json_writer.h"
+
+/* Integers up to this magnitude are printed by cJSON ("%1.15g") with all
+ * their digits, so they can be written without floating point formatting.
+ */
+#define INT64_EXACT_MAX 999999999999999LL
+
+static void put(struct json_writer *writer, const char *data, size_t len)
+{
+	if (writer->len < writer->size) {
+		memcpy(writer->buf + writer->len, data,
+		       MIN(len, writer->size - writer->len));
+	}
+	writer->len += len;
+}
+
+static void put_char(struct json_writer *writer, char c)
+{
+	if (writer->len < writer->size) {
+		writer->buf[writer->len] = c;
+	}
+	writer->len++;
+}
+
+/* Same escaping as cJSON: the characters that JSON requires to be escaped,
+ * everything else including UTF-8 is copied as is.
+ */
+static void put_string(struct json_writer *writer, const char *str)
+{
+	const char *run = str;
+	char esc[7];
+
+	put_char(writer, '"');
+	for (; *str; str++) {
+		unsigned char c = *str;
+
+		if (c >= 32 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		put(writer, run, str - run);
+		run = str + 1;
+
+		switch (c) {
+		case '"':
+			put(writer, "\\\"", 2);
+			break;
+		case '\\':
+			put(writer, "\\\\", 2);
+			break;
+		case '\b':
+			put(writer, "\\b", 2);
+			break;
+		case '\f':
+			put(writer, "\\f", 2);
+			break;
+		case '\n':
+			put(writer, "\\n", 2);
+			break;
+		case '\r':
+			put(writer, "\\r", 2);
+			break;
+		case '\t':
+			put(writer, "\\t", 2);
+			break;
+		default:
+			snprintf(esc, sizeof(esc), "\\u%04x", c);
+			put(writer, esc, 6);
+			break;
+		}
+	}
+	put(writer, run, str - run);
+	put_char(writer, '"');
+}
+
+static void member_begin(struct json_writer *writer, const char *key)
+{
+	if (!writer->first) {
+		put_char(writer, ',');
+	}
+	writer->first = false;
+
+	if (key) {
+		put_string(writer, key);
+		put_char(writer, ':');
+	}
+}
+
+void json_writer_init(struct json_writer *writer, char *buf, size_t size)
+{
+	writer->buf = buf;
+	writer->size = buf ? size : 0;
+	writer->len = 0;
+	writer->first = true;
+}
+
+void json_writer_obj_begin(struct json_writer *writer, const char *key)
+{
+	member_begin(writer, key);
+	put_char(writer, '{');
+	writer->first = true;
+}
+
+void json_writer_obj_end(struct json_writer *writer)
+{
+	put_char(writer, '}');
+	writer->first = false;
+}
+
+void json_writer_arr_begin(struct json_writer *writer, const char *key)
+{
+	member_begin(writer, key);
+	put_char(writer, '[');
+	writer->first = true;
+}
+
+void json_writer_arr_end(struct json_writer *writer)
+{
+	put_char(writer, ']');
+	writer->first = false;
+}
+
+void json_writer_str(struct json_writer *writer, const char *key,
+		     const char *value)
+{
+	member_begin(writer, key);
+	if (value == NULL) {
+		put(writer, "null", 4);
+		return;
+	}
+	put_string(writer, value);
+}
+
+void json_writer_int64(struct json_writer *writer, const char *key,
+		       int64_t value)
+{
+	char digits[20];
+	size_t i = sizeof(digits);
+	uint64_t magnitude;
+
+	if (value > INT64_EXACT_MAX || value < -INT64_EXACT_MAX) {
+		/* cJSON stores numbers as double */
+		json_writer_number(writer, key, (double)value);
+		return;
+	}
+
+	member_begin(writer, key);
+	magnitude = (value < 0) ? -value : value;
+	do {
+		digits[--i] = '0' + (magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+
+	if (value < 0) {
+		put_char(writer, '-');
+	}
+	put(writer, &digits[i], sizeof(digits) - i);
+}
+
+void json_writer_number(struct json_writer *writer, const char *key,
+			double value)
+{
+	char num[26];
+	int len;
+
+	member_begin(writer, key);
+
+	/* NaN and infinity */
+	if ((value * 0) != 0) {
+		put(writer, "null", 4);
+		return;
+	}
+
+	/* Shortest form that reads back as the same value, like cJSON */
+	len = snprintf(num, sizeof(num), "%1.15g", value);
+	if (strtod(num, NULL) != value) {
+		len = snprintf(num, sizeof(num), "%1.17g", value);
+	}
+	put(writer, num, len);
+}
+
+void json_writer_bool(struct json_writer *writer, const char *key,
+		      bool value)
+{
+	member_begin(writer, key);
+	if (value) {
+		put(writer, "true", 4);
+	} else {
+		put(writer, "false", 5);
+	}
+}
+
+int json_writer_finish(struct json_writer *writer)
+{
+	if (writer->buf == NULL) {
+		/* Length computation only */
+		return writer->len;
+	}
+
+	if (writer->len >= writer->size) {
+		if (writer->size > 0) {
+			writer->buf[writer->size - 1] = '\0';
+		}
+		return -ENOMEM;
+	}
+
+	writer->buf[writer->len] = '\0';
+
+	return writer->len;
+}
+
+void json_writer_schema(struct json_writer *writer, const char *key,
+			const struct json_schema *schema, const void *data)
+{
+	json_writer_obj_begin(writer, key);
+
+	for (size_t i = 0; i < schema->count; i++) {
+		const struct json_field *field = &schema->fields[i];
+		const void *value = (const uint8_t *)data + field->offset;
+
+		switch (field->type) {
+		case JSON_FIELD_STR:
+			json_writer_str(writer, field->key,
+					*(const char *const *)value);
+			break;
+		case JSON_FIELD_INT64:
+			json_writer_int64(writer, field->key,
+					  *(const int64_t *)value);
+			break;
+		case JSON_FIELD_NUMBER:
+			json_writer_number(writer, field->key,
+					   *(const double *)value);
+			break;
+		case JSON_FIELD_BOOL:
+			json_writer_bool(writer, field->key,
+					 *(const bool *)value);
+			break;
+		case JSON_FIELD_OBJ:
+			json_writer_schema(writer, field->key, field->obj,
+					   value);
+			break;
+		}
+	}
+
+	json_writer_obj_end(writer);
+}
+
+int json_schema_encode(const struct json_schema *schema, const void *data,
+		       char *buf, size_t size)
+{
+	struct json_writer writer;
+
+	if (schema == NULL || data == NULL) {
+		return -EINVAL;
+	}
+
+	json_writer_init(&writer, buf, size);
+	json_writer_schema(&writer, NULL, schema, data);
+
+	return json_writer_finish(&writer);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef JSON_WRITER_H__
+#define JSON_WRITER_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Streaming JSON writer.
+ *
+ * Writes a JSON document directly into a caller-provided buffer without
+ * any heap allocation. The output is identical to the unformatted output
+ * of cJSON for the same document.
+ *
+ * If the buffer is too small, writing continues without storing the data,
+ * so that @ref json_writer_finish returns the size that is needed.
+ */
+struct json_writer {
+	char *buf;
+	size_t size;
+	/* Length of the document, also beyond the buffer size */
+	size_t len;
+	/* Next member is the first of its object or array */
+	bool first;
+};
+
+/** @brief Type of a member described in a @ref json_schema. */
+enum json_field_type {
+	/* const char *, NULL is encoded as null */
+	JSON_FIELD_STR,
+	/* int64_t */
+	JSON_FIELD_INT64,
+	/* double */
+	JSON_FIELD_NUMBER,
+	/* bool */
+	JSON_FIELD_BOOL,
+	/* Nested structure described by another schema */
+	JSON_FIELD_OBJ,
+};
+
+struct json_schema;
+
+/** @brief Description of one member of a JSON object. */
+struct json_field {
+	const char *key;
+	enum json_field_type type;
+	/* Offset of the value in the structure */
+	size_t offset;
+	/* Schema of a JSON_FIELD_OBJ member */
+	const struct json_schema *obj;
+};
+
+/** @brief Compile-time description of a JSON object. */
+struct json_schema {
+	const struct json_field *fields;
+	size_t count;
+};
+
+#define JSON_FIELD(_type, _struct, _member, _key, _obj)			       \
+	{								       \
+		.key = _key,						       \
+		.type = _type,						       \
+		.offset = offsetof(_struct, _member),			       \
+		.obj = _obj,						       \
+	}
+
+#define JSON_FIELD_STR(_struct, _member, _key)				       \
+	JSON_FIELD(JSON_FIELD_STR, _struct, _member, _key, NULL)
+#define JSON_FIELD_INT64(_struct, _member, _key)			       \
+	JSON_FIELD(JSON_FIELD_INT64, _struct, _member, _key, NULL)
+#define JSON_FIELD_NUMBER(_struct, _member, _key)			       \
+	JSON_FIELD(JSON_FIELD_NUMBER, _struct, _member, _key, NULL)
+#define JSON_FIELD_BOOL(_struct, _member, _key)				       \
+	JSON_FIELD(JSON_FIELD_BOOL, _struct, _member, _key, NULL)
+#define JSON_FIELD_OBJ(_struct, _member, _key, _schema)			       \
+	JSON_FIELD(JSON_FIELD_OBJ, _struct, _member, _key, &_schema)
+
+/**
+ * @brief Define a schema from a list of JSON_FIELD_* entries. The members
+ *	  are written in the order of the list.
+ */
+#define JSON_SCHEMA_DEFINE(_name, ...)					       \
+	static const struct json_field _name##_fields[] = { __VA_ARGS__ };    \
+	static const struct json_schema _name = {			       \
+		.fields = _name##_fields,				       \
+		.count = ARRAY_SIZE(_name##_fields),			       \
+	}
+
+/**
+ * @brief Start writing a document.
+ *
+ * @param writer Writer instance.
+ * @param buf Output buffer, can be NULL to only compute the length.
+ * @param size Size of the output buffer.
+ */
+void json_writer_init(struct json_writer *writer, char *buf, size_t size);
+
+/**
+ * @brief Begin an object.
+ *
+ * @param writer Writer instance.
+ * @param key Member name, or NULL for the root object.
+ */
+void json_writer_obj_begin(struct json_writer *writer, const char *key);
+
+/** @brief End the current object. */
+void json_writer_obj_end(struct json_writer *writer);
+
+/**
+ * @brief Begin an array. Elements are written with a NULL key.
+ *
+ * @param writer Writer instance.
+ * @param key Member name, or NULL for the root or an array element.
+ */
+void json_writer_arr_begin(struct json_writer *writer, const char *key);
+
+/** @brief End the current array. */
+void json_writer_arr_end(struct json_writer *writer);
+
+/**
+ * @brief Write a structure described by a schema as an object member.
+ *
+ * @param writer Writer instance.
+ * @param key Member name, or NULL for the root or an array element.
+ * @param schema Description of the structure.
+ * @param data Structure to encode.
+ */
+void json_writer_schema(struct json_writer *writer, const char *key,
+			const struct json_schema *schema, const void *data);
+
+/** @brief Write a string member, NULL is written as null. */
+void json_writer_str(struct json_writer *writer, const char *key,
+		     const char *value);
+
+/** @brief Write an integer member. */
+void json_writer_int64(struct json_writer *writer, const char *key,
+		       int64_t value);
+
+/** @brief Write a number member. */
+void json_writer_number(struct json_writer *writer, const char *key,
+			double value);
+
+/** @brief Write a boolean member. */
+void json_writer_bool(struct json_writer *writer, const char *key,
+		      bool value);
+
+/**
+ * @brief Terminate the document.
+ *
+ * @param writer Writer instance.
+ *
+ * @return Length of the document without the terminating null character,
+ *	   or -ENOMEM if it does not fit in the buffer.
+ */
+int json_writer_finish(struct json_writer *writer);
+
+/**
+ * @brief Encode a structure as a JSON object.
+ *
+ * @param schema Description of the structure.
+ * @param data Structure to encode.
+ * @param buf Output buffer, can be NULL to only compute the length.
+ * @param size Size of the output buffer.
+ *
+ * @return Length of the document without the terminating null character,
+ *	   or -ENOMEM if it does not fit in the buffer.
+ */
+int json_schema_encode(const struct json_schema *schema, const void *data,
+		       char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSON_WRITER_H__ */
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <string.h>
+
+#include "data_batch.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(data_batch, CONFIG_ASSET_TRACKER_LOG_LEVEL);
+
+#if defined(CONFIG_DATA_BATCH_FORMAT_CBOR)
+#define BATCH_FORMAT CLOUD_BATCH_FORMAT_CBOR
+#else
+#define BATCH_FORMAT CLOUD_BATCH_FORMAT_JSON
+#endif
+
+/* Delay before trying again to send a batch that could not be sent */
+#define FLUSH_RETRY_DELAY K_SECONDS(30)
+
+struct batch_sample {
+	/* Uptime, converted to UNIX time when the batch is encoded */
+	int64_t ts;
+	enum cloud_channel type;
+	/* Size of the sample encoded as a separate JSON message */
+	uint16_t msg_len;
+	uint8_t len;
+	char data[CONFIG_DATA_BATCH_SAMPLE_SIZE + 1];
+};
+
+BUILD_ASSERT(CONFIG_DATA_BATCH_SAMPLE_SIZE <= UINT8_MAX,
+	     "Sample size does not fit the length field");
+
+/* Ring of samples, the oldest at head */
+static struct batch_sample samples[CONFIG_DATA_BATCH_SAMPLES_MAX];
+static size_t head;
+static size_t count;
+/* Sum of msg_len of the queued samples */
+static size_t pending_bytes;
+
+static uint8_t batch_buf[CONFIG_DATA_BATCH_BUF_SIZE];
+static K_MUTEX_DEFINE(batch_lock);
+
+static struct k_work_q *batch_work_q;
+static struct k_delayed_work flush_work;
+static data_batch_send_t batch_send;
+static struct data_batch_stats stats;
+
+static struct batch_sample *sample_get(size_t index)
+{
+	return &samples[(head + index) % ARRAY_SIZE(samples)];
+}
+
+static void oldest_drop(void)
+{
+	pending_bytes -= sample_get(0)->msg_len;
+	head = (head + 1) % ARRAY_SIZE(samples);
+	count--;
+	stats.dropped++;
+}
+
+/* An encoded JSON batch is the messages separated by commas, in brackets,
+ * with a terminating null character.
+ */
+static bool batch_fits(size_t msg_len)
+{
+	return (count < ARRAY_SIZE(samples)) &&
+	       (pending_bytes + msg_len + count + 3 <= sizeof(batch_buf));
+}
+
+static int flush_locked(void)
+{
+	struct cloud_channel_data batch[CONFIG_DATA_BATCH_SAMPLES_MAX];
+	struct batch_sample *sample;
+	int len;
+	int err;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		sample = sample_get(i);
+		batch[i].type = sample->type;
+		batch[i].ts = sample->ts;
+		batch[i].data.buf = sample->data;
+		batch[i].data.len = sample->len;
+	}
+
+	len = cloud_encode_batch_to_buf(batch, count, BATCH_FORMAT,
+					batch_buf, sizeof(batch_buf));
+	if (len < 0) {
+		LOG_ERR("Batch encoding failed: %d", len);
+		return len;
+	}
+
+	err = batch_send(batch_buf, len);
+	if (err) {
+		LOG_WRN("Batch not sent (%d), %d samples kept", err, count);
+		return err;
+	}
+
+	stats.samples += count;
+	stats.batches++;
+	stats.unbatched_bytes += pending_bytes;
+	stats.batched_bytes += len;
+
+	LOG_INF("Sent %d samples in %d bytes, %d bytes as separate messages",
+		count, len, pending_bytes);
+
+	head = 0;
+	count = 0;
+	pending_bytes = 0;
+	k_delayed_work_cancel(&flush_work);
+
+	return 0;
+}
+
+static void flush_work_fn(struct k_work *work)
+{
+	int err;
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&batch_lock, K_FOREVER);
+	err = flush_locked();
+	if (err && count > 0) {
+		k_delayed_work_submit_to_queue(batch_work_q, &flush_work,
+					       FLUSH_RETRY_DELAY);
+	}
+	k_mutex_unlock(&batch_lock);
+}
+
+int data_batch_init(struct k_work_q *work_q, data_batch_send_t send)
+{
+	if (work_q == NULL || send == NULL) {
+		return -EINVAL;
+	}
+
+	batch_work_q = work_q;
+	batch_send = send;
+	k_delayed_work_init(&flush_work, flush_work_fn);
+
+	return 0;
+}
+
+int data_batch_add(const struct cloud_channel_data *data)
+{
+	struct batch_sample *sample;
+	int msg_len;
+
+	if (data == NULL || data->data.buf == NULL || data->data.len == 0) {
+		return -EINVAL;
+	}
+
+	if (data->data.len > CONFIG_DATA_BATCH_SAMPLE_SIZE) {
+		return -E2BIG;
+	}
+
+	msg_len = cloud_encode_data_to_buf(data, CLOUD_CMD_GROUP_DATA,
+					   NULL, 0);
+	if (msg_len < 0) {
+		return msg_len;
+	}
+
+	if (msg_len + 3 > sizeof(batch_buf)) {
+		return -E2BIG;
+	}
+
+	k_mutex_lock(&batch_lock, K_FOREVER);
+
+	/* Make room by sending the batch, or drop the oldest samples
+	 * if it cannot be sent.
+	 */
+	if (!batch_fits(msg_len) && flush_locked() != 0) {
+		while (!batch_fits(msg_len)) {
+			oldest_drop();
+		}
+		LOG_WRN("Batch full, %d samples dropped", stats.dropped);
+	}
+
+	sample = sample_get(count);
+	sample->ts = data->ts;
+	sample->type = data->type;
+	sample->msg_len = msg_len;
+	sample->len = data->data.len;
+	memcpy(sample->data, data->data.buf, data->data.len);
+	sample->data[data->data.len] = '\0';
+
+	count++;
+	pending_bytes += msg_len;
+
+	if (count == 1) {
+		k_delayed_work_submit_to_queue(batch_work_q, &flush_work,
+				K_SECONDS(CONFIG_DATA_BATCH_MAX_AGE));
+	}
+
+	if (pending_bytes >= CONFIG_DATA_BATCH_FLUSH_SIZE ||
+	    count == ARRAY_SIZE(samples)) {
+		(void)flush_locked();
+	}
+
+	k_mutex_unlock(&batch_lock);
+
+	return 0;
+}
+
+int data_batch_flush(void)
+{
+	int err;
+
+	k_mutex_lock(&batch_lock, K_FOREVER);
+	err = flush_locked();
+	k_mutex_unlock(&batch_lock);
+
+	return err;
+}
+
+void data_batch_flush_request(void)
+{
+	k_mutex_lock(&batch_lock, K_FOREVER);
+	if (count > 0) {
+		k_delayed_work_submit_to_queue(batch_work_q, &flush_work,
+					       K_NO_WAIT);
+	}
+	k_mutex_unlock(&batch_lock);
+}
+
+void data_batch_stats_get(struct data_batch_stats *stats_out)
+{
+	k_mutex_lock(&batch_lock, K_FOREVER);
+	*stats_out = stats;
+	k_mutex_unlock(&batch_lock);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**@file
+ *
+ * @brief   Sample batching for asset tracker uplinks
+ */
+
+#ifndef DATA_BATCH_H__
+#define DATA_BATCH_H__
+
+#include <zephyr.h>
+#include "cloud_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Send an encoded batch.
+ *
+ * @return 0 if the batch was sent. Otherwise the samples are kept and
+ *	   sent with a later batch.
+ */
+typedef int (*data_batch_send_t)(const uint8_t *buf, size_t len);
+
+/** @brief Batching counters. */
+struct data_batch_stats {
+	/* Samples sent in batches */
+	uint32_t samples;
+	/* Batches sent */
+	uint32_t batches;
+	/* Samples dropped because the batch could not be sent */
+	uint32_t dropped;
+	/* Size of the sent samples if encoded as separate JSON messages */
+	uint32_t unbatched_bytes;
+	/* Size of the sent batches */
+	uint32_t batched_bytes;
+};
+
+/**
+ * @brief Initialize batching.
+ *
+ * @param work_q Work queue that sends the batches.
+ * @param send Function that sends a batch.
+ *
+ * @return 0 if successful, otherwise a negative error code.
+ */
+int data_batch_init(struct k_work_q *work_q, data_batch_send_t send);
+
+/**
+ * @brief Add a sample to the batch. The data is copied.
+ *
+ * The batch is sent when it reaches CONFIG_DATA_BATCH_FLUSH_SIZE or
+ * CONFIG_DATA_BATCH_SAMPLES_MAX, or when the oldest sample is
+ * CONFIG_DATA_BATCH_MAX_AGE seconds old.
+ *
+ * @param data Sample to add, group CLOUD_CMD_GROUP_DATA.
+ *
+ * @return 0 if the sample was added, -E2BIG if it is too long to be batched
+ *	   and must be sent on its own, otherwise a negative error code.
+ */
+int data_batch_add(const struct cloud_channel_data *data);
+
+/**
+ * @brief Send the batch now.
+ *
+ * @return 0 if the batch was sent or empty, otherwise a negative error code.
+ */
+int data_batch_flush(void);
+
+/** @brief Send the batch from the work queue, as soon as possible. */
+void data_batch_flush_request(void);
+
+/**
+ * @brief Get the batching counters.
+ *
+ * @param stats Counters.
+ */
+void data_batch_stats_get(struct data_batch_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATA_BATCH_H__ */
@@ -43,6 +43,9 @@
 #include "watchdog.h"
 #include "gps_controller.h"
 #include <date_time.h>
+#if defined(CONFIG_DATA_BATCH)
+#include "data_batch.h"
+#endif
 
 #include <logging/log.h>
 LOG_MODULE_REGISTER(asset_tracker, CONFIG_ASSET_TRACKER_LOG_LEVEL);
@@ -93,6 +96,11 @@ defined(CONFIG_NRF_CLOUD_PROVISION_CERTIFICATES)
  */
 #define CONN_CYCLE_AFTER_ASSOCIATION_REQ_MS K_MINUTES(5)
 
+/* Size of the stack buffer for encoding sensor data. It fits the keys, the
+ * timestamp and an NMEA sentence.
+ */
+#define SENSOR_DATA_MSG_MAX_LEN 192
+
 struct rsrp_data {
 	uint16_t value;
 	uint16_t offset;
@@ -836,8 +844,21 @@ static void motion_data_send(struct k_work *work)
 {
 	ARG_UNUSED(work);
 
-	if (!flip_mode_enabled || !data_send_enabled() ||
-	    gps_control_is_active()) {
+	if (!flip_mode_enabled || !data_send_enabled()) {
+		return;
+	}
+
+#if defined(CONFIG_DATA_BATCH)
+	struct cloud_channel_data cloud_data;
+
+	if (cloud_motion_channel_data_get(&last_motion_data,
+					  &cloud_data) == 0 &&
+	    data_batch_add(&cloud_data) == 0) {
+		return;
+	}
+#endif
+
+	if (gps_control_is_active()) {
 		return;
 	}
 
@@ -1118,71 +1139,85 @@ static void device_config_send(struct k_work *work)
 	}
 }
 
-/**@brief Get environment data from sensors and send to cloud. */
-static void env_data_send(void)
+/**@brief Send one environment sample to cloud. */
+static int env_sample_send(const env_sensor_data_t *env_data)
 {
 	int err;
-	env_sensor_data_t env_data;
+	char buf[8];
+	struct cloud_channel_data cloud_data;
 	struct cloud_msg msg = {
 		.qos = CLOUD_QOS_AT_MOST_ONCE,
 		.endpoint.type = CLOUD_EP_TOPIC_MSG
 	};
 
+	if (cloud_env_sensors_channel_data_get(env_data, &cloud_data, buf,
+					       sizeof(buf))) {
+		return 0;
+	}
+
+#if defined(CONFIG_DATA_BATCH)
+	if (data_batch_add(&cloud_data) == 0) {
+		return 0;
+	}
+#endif
+
+	if (cloud_encode_data(&cloud_data, CLOUD_CMD_GROUP_DATA, &msg)) {
+		return 0;
+	}
+
+	err = cloud_send(cloud_backend, &msg);
+	cloud_release_data(&msg);
+
+	return err;
+}
+
+/**@brief Get environment data from sensors and send to cloud. */
+static void env_data_send(void)
+{
+	int err;
+	env_sensor_data_t env_data;
+
 	if (!data_send_enabled()) {
 		return;
 	}
 
-	if (gps_control_is_active()) {
+	/* Batched samples are not sent while the GPS is active */
+	if (!IS_ENABLED(CONFIG_DATA_BATCH) && gps_control_is_active()) {
 		env_sensors_set_backoff_enable(true);
 		return;
 	}
 
 	env_sensors_set_backoff_enable(false);
 
-	if (env_sensors_get_temperature(&env_data) == 0) {
-		if (cloud_is_send_allowed(CLOUD_CHANNEL_TEMP, env_data.value) &&
-		    cloud_encode_env_sensors_data(&env_data, &msg) == 0) {
-			err = cloud_send(cloud_backend, &msg);
-			cloud_release_data(&msg);
-			if (err) {
-				goto error;
-			}
+	if (env_sensors_get_temperature(&env_data) == 0 &&
+	    cloud_is_send_allowed(CLOUD_CHANNEL_TEMP, env_data.value)) {
+		err = env_sample_send(&env_data);
+		if (err) {
+			goto error;
 		}
 	}
 
-	if (env_sensors_get_humidity(&env_data) == 0) {
-		if (cloud_is_send_allowed(CLOUD_CHANNEL_HUMID,
-					  env_data.value) &&
-		    cloud_encode_env_sensors_data(&env_data, &msg) == 0) {
-			err = cloud_send(cloud_backend, &msg);
-			cloud_release_data(&msg);
-			if (err) {
-				goto error;
-			}
+	if (env_sensors_get_humidity(&env_data) == 0 &&
+	    cloud_is_send_allowed(CLOUD_CHANNEL_HUMID, env_data.value)) {
+		err = env_sample_send(&env_data);
+		if (err) {
+			goto error;
 		}
 	}
 
-	if (env_sensors_get_pressure(&env_data) == 0) {
-		if (cloud_is_send_allowed(CLOUD_CHANNEL_AIR_PRESS,
-					  env_data.value) &&
-		    cloud_encode_env_sensors_data(&env_data, &msg) == 0) {
-			err = cloud_send(cloud_backend, &msg);
-			cloud_release_data(&msg);
-			if (err) {
-				goto error;
-			}
+	if (env_sensors_get_pressure(&env_data) == 0 &&
+	    cloud_is_send_allowed(CLOUD_CHANNEL_AIR_PRESS, env_data.value)) {
+		err = env_sample_send(&env_data);
+		if (err) {
+			goto error;
 		}
 	}
 
-	if (env_sensors_get_air_quality(&env_data) == 0) {
-		if (cloud_is_send_allowed(CLOUD_CHANNEL_AIR_QUAL,
-					  env_data.value) &&
-		    cloud_encode_env_sensors_data(&env_data, &msg) == 0) {
-			err = cloud_send(cloud_backend, &msg);
-			cloud_release_data(&msg);
-			if (err) {
-				goto error;
-			}
+	if (env_sensors_get_air_quality(&env_data) == 0 &&
+	    cloud_is_send_allowed(CLOUD_CHANNEL_AIR_QUAL, env_data.value)) {
+		err = env_sample_send(&env_data);
+		if (err) {
+			goto error;
 		}
 	}
 
@@ -1236,6 +1271,48 @@ void light_sensor_data_send(void)
 }
 #endif /* CONFIG_LIGHT_SENSOR */
 
+#if defined(CONFIG_DATA_BATCH)
+/**@brief Send a batch of samples to nRF Cloud. */
+static int batch_send(const uint8_t *buf, size_t len)
+{
+	int err;
+	struct cloud_msg msg = {
+		.qos = CLOUD_QOS_AT_MOST_ONCE,
+		.endpoint.type = CLOUD_EP_TOPIC_MSG,
+		.buf = (char *)buf,
+		.len = len
+	};
+
+	/* Keep the samples while sending would disturb the GPS */
+	if (!data_send_enabled() || gps_control_is_active()) {
+		return -EAGAIN;
+	}
+
+	err = cloud_send(cloud_backend, &msg);
+	if (err) {
+		LOG_ERR("Transmission of batch failed: %d", err);
+	}
+
+	return err;
+}
+
+/**@brief Channels that are sent in batches. */
+static bool batch_channel(enum cloud_channel type)
+{
+	switch (type) {
+	case CLOUD_CHANNEL_GPS:
+	case CLOUD_CHANNEL_TEMP:
+	case CLOUD_CHANNEL_HUMID:
+	case CLOUD_CHANNEL_AIR_PRESS:
+	case CLOUD_CHANNEL_AIR_QUAL:
+	case CLOUD_CHANNEL_FLIP:
+		return true;
+	default:
+		return false;
+	}
+}
+#endif /* CONFIG_DATA_BATCH */
+
 /**@brief Send sensor data to nRF Cloud. **/
 static void sensor_data_send(struct cloud_channel_data *data)
 {
@@ -1245,20 +1322,46 @@ static void sensor_data_send(struct cloud_channel_data *data)
 			.endpoint.type = CLOUD_EP_TOPIC_MSG
 		};
 
-	if (!data_send_enabled() || gps_control_is_active()) {
+	char buf[SENSOR_DATA_MSG_MAX_LEN];
+
+	if (!data_send_enabled()) {
 		return;
 	}
 
-	err = cloud_encode_data(data, CLOUD_CMD_GROUP_DATA, &msg);
-	if (err) {
-		LOG_ERR("Unable to encode cloud data: %d", err);
-	} else {
+#if defined(CONFIG_DATA_BATCH)
+	if (batch_channel(data->type) && data_batch_add(data) == 0) {
+		return;
+	}
+#endif
+
+	if (gps_control_is_active()) {
+		return;
+	}
+
+	/* Sensor samples are encoded on the stack, only messages that do
+	 * not fit are allocated.
+	 */
+	err = cloud_encode_data_to_buf(data, CLOUD_CMD_GROUP_DATA, buf,
+				       sizeof(buf));
+	if (err >= 0) {
+		msg.buf = buf;
+		msg.len = err;
 		err = cloud_send(cloud_backend, &msg);
-		cloud_release_data(&msg);
+	} else if (err == -ENOMEM) {
+		err = cloud_encode_data(data, CLOUD_CMD_GROUP_DATA, &msg);
 		if (err) {
-			LOG_ERR("%s failed, data was not sent: %d", __func__,
-			err);
+			LOG_ERR("Unable to encode cloud data: %d", err);
+			return;
 		}
+		err = cloud_send(cloud_backend, &msg);
+		cloud_release_data(&msg);
+	} else {
+		LOG_ERR("Unable to encode cloud data: %d", err);
+		return;
+	}
+
+	if (err) {
+		LOG_ERR("%s failed, data was not sent: %d", __func__, err);
 	}
 }
 
@@ -1397,21 +1500,29 @@ void cloud_event_handler(const struct cloud_backend *const backend,
 		int err;
 
 		LOG_INF("CLOUD_EVT_DATA_RECEIVED");
-		err = cloud_decode_command(evt->data.msg.buf);
-		if (err == 0) {
-			/* Cloud decoder has handled the data */
-			return;
+		/* Only A-GPS data is large enough to be fragmented */
+		if (evt->data.msg.offset == 0) {
+			err = cloud_decode_command(evt->data.msg.buf);
+			if (err == 0) {
+				/* Cloud decoder has handled the data */
+				return;
+			}
 		}
 
 #if defined(CONFIG_AGPS)
-		err = gps_process_agps_data(evt->data.msg.buf,
-					    evt->data.msg.len);
+		err = gps_process_agps_fragment(evt->data.msg.buf,
+						evt->data.msg.len,
+						evt->data.msg.offset,
+						evt->data.msg.total_len);
 		if (err) {
 			LOG_WRN("Data was not valid A-GPS data, err: %d", err);
 			break;
 		}
 
-		LOG_INF("A-GPS data processed");
+		if (evt->data.msg.offset + evt->data.msg.len >=
+		    evt->data.msg.total_len) {
+			LOG_INF("A-GPS data processed");
+		}
 #endif /* defined(CONFIG_AGPS) */
 		break;
 	}
@@ -1574,6 +1685,9 @@ static void work_init(void)
 #if CONFIG_MODEM_INFO
 	k_delayed_work_init(&rsrp_work, modem_rsrp_data_send);
 #endif /* CONFIG_MODEM_INFO */
+#if defined(CONFIG_DATA_BATCH)
+	data_batch_init(&application_work_q, batch_send);
+#endif
 }
 
 static void cloud_api_init(void)
@@ -1833,6 +1947,12 @@ static void lte_handler(const struct lte_lc_evt *const evt)
 		LOG_INF("RRC mode: %s",
 			evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED ?
 			"Connected" : "Idle");
+#if defined(CONFIG_DATA_BATCH_FLUSH_ON_RRC_CONNECTED)
+		/* The radio is on anyway, send the batch along */
+		if (evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED) {
+			data_batch_flush_request();
+		}
+#endif
 		break;
 	case LTE_LC_EVT_CELL_UPDATE:
 		LOG_INF("LTE cell changed: Cell ID: %d, Tracking area: %d",
@@ -474,17 +474,25 @@ static void motion_thread_fn(void)
 
 	while (!err) {
 		bool send_event;
+		bool skip_read;
 		uint32_t option_bm;
 
 		k_sem_take(&sem, K_FOREVER);
 
 		k_spinlock_key_t key = k_spin_lock(&state.lock);
 		send_event = (state.state == STATE_FETCHING) && state.sample;
+		/* While fetching, the sensor accumulates motion until the next
+		 * HID report slot. A wake up for other reasons must not read
+		 * it, as the motion would be lost.
+		 */
+		skip_read = (state.state == STATE_FETCHING) && !state.sample;
 		state.sample = false;
 		option_bm = state.option_mask;
 		k_spin_unlock(&state.lock, key);
 
-		err = motion_read(send_event);
+		if (!skip_read) {
+			err = motion_read(send_event);
+		}
 
 		bool no_motion = (err == -ENODATA);
 		if (unlikely(no_motion)) {
@@ -260,31 +260,7 @@ static int handle_at_fota(enum at_cmd_type cmd_type)
 	return err;
 }
 
-/**@brief API to handle FOTA AT commands
- */
-int slm_at_fota_parse(const char *at_cmd)
-{
-	int ret = -ENOENT;
-
-	if (slm_util_cmd_casecmp(at_cmd, AT_FOTA)) {
-		ret = at_parser_params_from_str(at_cmd, NULL, &at_param_list);
-		if (ret < 0) {
-			LOG_ERR("Failed to parse AT command %d", ret);
-			return -EINVAL;
-		}
-		ret = handle_at_fota(at_parser_cmd_type_get(at_cmd));
-	}
-
-	return ret;
-}
-
-/**@brief API to list FOTA AT commands
- */
-void slm_at_fota_clac(void)
-{
-	sprintf(rsp_buf, "%s\r\n", AT_FOTA);
-	rsp_send(rsp_buf, strlen(rsp_buf));
-}
+SLM_AT_CMD_DEFINE(fota, AT_FOTA, handle_at_fota);
 
 /**@brief API to initialize FOTA AT commands handler
  */
@@ -99,6 +99,11 @@ static ftp_op_list_t ftp_op_list[FTP_OP_MAX] = {
 
 RING_BUF_DECLARE(ftp_data_buf, CONFIG_AT_CMD_RESPONSE_MAX_LEN / 2);
 
+/* Data is passed as is, with its length first */
+static bool ftp_data_raw;
+/* File for the raw data following AT#XFTP="put" */
+static char ftp_put_file[FTP_MAX_FILEPATH];
+
 /* global functions defined in different files */
 void rsp_send(const uint8_t *str, size_t len);
 
@@ -126,6 +131,13 @@ static int ftp_data_send(void)
 	uint32_t sz_send = 0;
 
 	if (ring_buf_is_empty(&ftp_data_buf) == 0) {
+		if (ftp_data_raw) {
+			char header[32];
+
+			sprintf(header, "#XFTP: %d, %d\r\n", DATATYPE_RAW,
+				ring_buf_size_get(&ftp_data_buf));
+			rsp_send(header, strlen(header));
+		}
 		sz_send = ring_buf_get(&ftp_data_buf, rsp_buf, sizeof(rsp_buf));
 		rsp_send(rsp_buf, sz_send);
 		rsp_send("\r\n", 2);
@@ -136,7 +148,11 @@ static int ftp_data_send(void)
 
 void ftp_data_callback(const uint8_t *msg, uint16_t len)
 {
-	if (slm_util_hex_check((uint8_t *)msg, len)) {
+	if (ftp_data_raw) {
+		if (ftp_data_save((uint8_t *)msg, len) < 0) {
+			LOG_WRN("FTP data overrun");
+		}
+	} else if (slm_util_hex_check((uint8_t *)msg, len)) {
 		int ret;
 		int size = len * 2;
 
@@ -423,7 +439,7 @@ static int do_ftp_delete(void)
 	return (ret == FTP_CODE_250) ? 0 : -1;
 }
 
-/* AT#XFTP="get",<file> */
+/* AT#XFTP="get",<file>[,<datatype>] */
 static int do_ftp_get(void)
 {
 	int ret;
@@ -441,18 +457,38 @@ static int do_ftp_get(void)
 		return ret;
 	}
 	file[sz_file] = '\0';
+	if (param_count > 3) {
+		uint16_t type;
+
+		ret = at_params_short_get(&at_param_list, 3, &type);
+		if (ret) {
+			return ret;
+		}
+		ftp_data_raw = (type == DATATYPE_RAW);
+	}
 
 	ring_buf_reset(&ftp_data_buf);
 	ret = ftp_get(file);
 	if (ret == FTP_CODE_226) {
 		ftp_data_send();
-		return 0;
+		ret = 0;
 	} else {
-		return -1;
+		ret = -1;
 	}
+	ftp_data_raw = false;
+
+	return ret;
+}
+
+static int ftp_put_raw(const uint8_t *data, int datalen)
+{
+	int ret = ftp_put(ftp_put_file, data, datalen);
+
+	return (ret == FTP_CODE_226) ? 0 : -1;
 }
 
 /* AT#XFTP="put",<file>[<datatype>,<data>] */
+/* AT#XFTP="put",<file>,<datatype>,<length> for raw data */
 static int do_ftp_put(void)
 {
 	int ret;
@@ -480,6 +516,16 @@ static int do_ftp_put(void)
 		if (ret) {
 			return ret;
 		}
+		if (type == DATATYPE_RAW) {
+			uint16_t length;
+
+			ret = at_params_short_get(&at_param_list, 4, &length);
+			if (ret) {
+				return ret;
+			}
+			strcpy(ftp_put_file, file);
+			return slm_at_host_raw_recv(length, ftp_put_raw);
+		}
 		size = NET_IPV4_MTU;
 		ret = at_params_string_get(&at_param_list, 4, data, &size);
 		if (ret) {
@@ -502,51 +548,36 @@ static int do_ftp_put(void)
 	return (ret == FTP_CODE_226) ? 0 : -1;
 }
 
-/**@brief API to handle FTP AT command
- */
-int slm_at_ftp_parse(const char *at_cmd)
+/* AT#XFTP=<cmd>[,<arg>...] */
+static int handle_at_ftp(enum at_cmd_type cmd_type)
 {
-	int ret = -ENOENT;
+	int ret;
 	char op_str[16];
 	int size = 16;
 
-	if (slm_util_cmd_casecmp(at_cmd, AT_FTP_STR)) {
-		ret = at_parser_params_from_str(at_cmd, NULL, &at_param_list);
-		if (ret) {
-			LOG_ERR("Failed to parse AT command %d", ret);
-			return -EINVAL;
-		}
-		if (at_parser_cmd_type_get(at_cmd) != AT_CMD_TYPE_SET_COMMAND) {
-			return -EINVAL;
-		}
-		if (at_params_valid_count_get(&at_param_list) < 2) {
-			return -EINVAL;
-		}
-		ret = at_params_string_get(&at_param_list, 1, op_str, &size);
-		if (ret) {
-			return ret;
-		}
-		op_str[size] = '\0';
-		ret = -EINVAL;
-		for (int i = 0; i < FTP_OP_MAX; i++) {
-			if (slm_util_casecmp(op_str,
-				ftp_op_list[i].op_str)) {
-				ret = ftp_op_list[i].handler();
-				break;
-			}
+	if (cmd_type != AT_CMD_TYPE_SET_COMMAND) {
+		return -EINVAL;
+	}
+	if (at_params_valid_count_get(&at_param_list) < 2) {
+		return -EINVAL;
+	}
+	ret = at_params_string_get(&at_param_list, 1, op_str, &size);
+	if (ret) {
+		return ret;
+	}
+	op_str[size] = '\0';
+	ret = -EINVAL;
+	for (int i = 0; i < FTP_OP_MAX; i++) {
+		if (slm_util_casecmp(op_str, ftp_op_list[i].op_str)) {
+			ret = ftp_op_list[i].handler();
+			break;
 		}
 	}
 
 	return ret;
 }
 
-/**@brief API to list FTP AT commands
- */
-void slm_at_ftp_clac(void)
-{
-	sprintf(rsp_buf, "%s\r\n", AT_FTP_STR);
-	rsp_send(rsp_buf, strlen(rsp_buf));
-}
+SLM_AT_CMD_DEFINE(ftp, AT_FTP_STR, handle_at_ftp);
 
 /**@brief API to initialize FTP AT commands handler
  */
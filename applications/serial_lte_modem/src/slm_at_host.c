@@ -38,24 +38,22 @@ LOG_MODULE_REGISTER(at_host, CONFIG_SLM_LOG_LEVEL);
 
 #define OK_STR		"OK\r\n"
 #define ERROR_STR	"ERROR\r\n"
-#define FATAL_STR	"FATAL ERROR\r\n"
 #define SLM_SYNC_STR	"Ready\r\n"
 
 #define SLM_VERSION	"#XSLMVER: 1.4\r\n"
-#define AT_CMD_SLMVER	"AT#XSLMVER"
-#define AT_CMD_SLEEP	"AT#XSLEEP"
-#define AT_CMD_RESET	"AT#XRESET"
-#define AT_CMD_CLAC	"AT#XCLAC"
-#define AT_CMD_SLMUART	"AT#XSLMUART"
 
 #define SLM_UART_BAUDRATE                                           \
 	"#XSLMUART: (1200, 2400, 4800, 9600, 14400, 19200, 38400, " \
 	"57600, 115200, 230400, 460800, 921600, 1000000)\r\n"
 
 #define AT_MAX_CMD_LEN	CONFIG_AT_CMD_RESPONSE_MAX_LEN
+#define AT_BUF_NUM	2
 #define UART_RX_BUF_NUM	2
 #define UART_RX_LEN	256
 #define UART_RX_TIMEOUT 1
+#define RAW_PROMPT	"> "
+#define RAW_RX_TIMEOUT	K_SECONDS(10)
+#define AT_CMD_INDEX_SIZE 64 /* Power of two */
 
 /** @brief Termination Modes. */
 enum term_modes {
@@ -75,17 +73,42 @@ enum shutdown_modes {
 
 static enum term_modes term_mode;
 static const struct device *uart_dev;
-static uint8_t at_buf[AT_MAX_CMD_LEN];
-static size_t at_buf_len;
 static struct k_work cmd_send_work;
-static const char termination[3] = { '\0', '\r', '\n' };
+static const char termination[MODE_COUNT] = { '\0', '\r', '\n', '\n' };
+
+/* Commands are framed in place in at_buf while the previous one is being
+ * handled, and handed to cmd_send_work without copying. A buffer is busy
+ * from the time its frame is complete until the frame has been handled.
+ */
+static uint8_t at_buf[AT_BUF_NUM][AT_MAX_CMD_LEN];
+static size_t frame_len[AT_BUF_NUM];
+static bool frame_raw[AT_BUF_NUM];
+static atomic_t frames_busy;
+static uint8_t fill_frame; /* Frame being received, UART ISR only */
+static uint8_t cmd_frame;  /* Next frame to handle, work queue only */
+static size_t fill_len;
+static bool inside_quotes;
+static bool rx_running;
 
 static uint8_t uart_rx_buf[UART_RX_BUF_NUM][UART_RX_LEN];
 static uint8_t *next_buf = uart_rx_buf[1];
 static uint8_t *uart_tx_buf;
 
+static struct {
+	uint32_t rx_bytes; /* Bytes received */
+	uint32_t dropped;  /* Bytes dropped, no room in the frame buffers */
+	uint32_t peak;     /* Peak occupancy of a frame buffer */
+} rx_stats;
+
 static K_SEM_DEFINE(tx_done, 0, 1);
 
+/* Raw data is framed like a command, and passed to raw_handler */
+static bool raw_receiving;
+static bool raw_prompt;
+static slm_raw_handler_t raw_handler;
+static uint16_t raw_len;
+static struct k_delayed_work raw_timeout_work;
+
 /* global functions defined in different files */
 void enter_idle(void);
 void enter_sleep(bool wake_up);
@@ -167,49 +190,121 @@ static void response_handler(void *context, const char *response)
 	}
 }
 
-static void handle_at_clac(void)
+/* Open addressing hash index of the command table, built at init. The size
+ * is a power of two, and at least one slot is always left free.
+ */
+static const struct slm_at_cmd *at_cmd_index[AT_CMD_INDEX_SIZE];
+
+/* FNV-1a hash of the command name, ignoring case */
+static uint32_t cmd_hash(const char *name, size_t len)
 {
-	rsp_send(AT_CMD_SLMVER, sizeof(AT_CMD_SLMVER) - 1);
-	rsp_send("\r\n", 2);
-	rsp_send(AT_CMD_SLMUART, sizeof(AT_CMD_SLMUART) - 1);
-	rsp_send("\r\n", 2);
-	rsp_send(AT_CMD_SLEEP, sizeof(AT_CMD_SLEEP) - 1);
-	rsp_send("\r\n", 2);
-	rsp_send(AT_CMD_RESET, sizeof(AT_CMD_RESET) - 1);
-	rsp_send("\r\n", 2);
-	rsp_send(AT_CMD_CLAC, sizeof(AT_CMD_CLAC) - 1);
-	rsp_send("\r\n", 2);
-#if defined(CONFIG_SLM_TCP_PROXY)
-	slm_at_tcp_proxy_clac();
-#endif
-#if defined(CONFIG_SLM_UDP_PROXY)
-	slm_at_udp_proxy_clac();
-#endif
-	slm_at_tcpip_clac();
-	slm_at_icmp_clac();
-	slm_at_gps_clac();
-	slm_at_mqtt_clac();
-	slm_at_ftp_clac();
-	slm_at_httpc_clac();
-	slm_at_fota_clac();
-#if defined(CONFIG_SLM_NATIVE_TLS)
-	slm_at_cmng_clac();
-#endif
+	uint32_t hash = 2166136261U;
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (uint8_t)toupper((int)name[i]);
+		hash *= 16777619U;
+	}
+
+	return hash;
 }
 
-static int handle_at_sleep(const char *at_cmd, enum shutdown_modes *mode)
+static bool cmd_name_equal(const char *name, size_t len, const char *string)
 {
-	int ret = -EINVAL;
-	enum at_cmd_type type;
-	uint16_t shutdown_mode;
+	if (strlen(string) != len) {
+		return false;
+	}
 
-	ret = at_parser_params_from_str(at_cmd, NULL, &at_param_list);
-	if (ret < 0) {
-		LOG_ERR("Failed to parse AT command %d", ret);
-		return -EINVAL;
+	for (size_t i = 0; i < len; i++) {
+		if (toupper((int)name[i]) != toupper((int)string[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int cmd_index_build(void)
+{
+	size_t count = 0;
+	size_t slot;
+	size_t len;
+
+	memset(at_cmd_index, 0, sizeof(at_cmd_index));
+
+	Z_STRUCT_SECTION_FOREACH(slm_at_cmd, cmd) {
+		if (++count >= AT_CMD_INDEX_SIZE) {
+			LOG_ERR("AT command index full");
+			return -ENOMEM;
+		}
+
+		len = strlen(cmd->string);
+		slot = cmd_hash(cmd->string, len) & (AT_CMD_INDEX_SIZE - 1);
+		while (at_cmd_index[slot] != NULL) {
+			if (cmd_name_equal(cmd->string, len,
+					   at_cmd_index[slot]->string)) {
+				LOG_ERR("Duplicate AT command %s", cmd->string);
+				return -EEXIST;
+			}
+			slot = (slot + 1) & (AT_CMD_INDEX_SIZE - 1);
+		}
+		at_cmd_index[slot] = cmd;
+	}
+
+	LOG_DBG("%d AT commands registered", count);
+	return 0;
+}
+
+static const struct slm_at_cmd *cmd_lookup(const char *at_cmd)
+{
+	/* Command name ends where parameters or "?" start */
+	size_t len = strcspn(at_cmd, "=?");
+	size_t slot = cmd_hash(at_cmd, len) & (AT_CMD_INDEX_SIZE - 1);
+
+	while (at_cmd_index[slot] != NULL) {
+		if (cmd_name_equal(at_cmd, len, at_cmd_index[slot]->string)) {
+			return at_cmd_index[slot];
+		}
+		slot = (slot + 1) & (AT_CMD_INDEX_SIZE - 1);
+	}
+
+	return NULL;
+}
+
+/**@brief handle AT#XSLMVER commands
+ *  AT#XSLMVER
+ */
+static int handle_at_slmver(enum at_cmd_type type)
+{
+	ARG_UNUSED(type);
+
+	rsp_send(SLM_VERSION, sizeof(SLM_VERSION) - 1);
+	return 0;
+}
+
+/**@brief handle AT#XCLAC commands
+ *  AT#XCLAC
+ */
+static int handle_at_clac(enum at_cmd_type type)
+{
+	ARG_UNUSED(type);
+
+	Z_STRUCT_SECTION_FOREACH(slm_at_cmd, cmd) {
+		rsp_send(cmd->string, strlen(cmd->string));
+		rsp_send("\r\n", 2);
 	}
 
-	type = at_parser_cmd_type_get(at_cmd);
+	return 0;
+}
+
+/**@brief handle AT#XSLEEP commands
+ *  AT#XSLEEP[=<shutdown_mode>]
+ *  AT#XSLEEP=?
+ */
+static int handle_at_sleep(enum at_cmd_type type)
+{
+	int ret = -EINVAL;
+	uint16_t shutdown_mode;
+
 	if (type == AT_CMD_TYPE_SET_COMMAND) {
 		shutdown_mode = SHUTDOWN_MODE_IDLE;
 		if (at_params_valid_count_get(&at_param_list) > 1) {
@@ -223,12 +318,11 @@ static int handle_at_sleep(const char *at_cmd, enum shutdown_modes *mode)
 		if (shutdown_mode == SHUTDOWN_MODE_IDLE) {
 			slm_at_host_uninit();
 			enter_idle();
-			*mode = SHUTDOWN_MODE_IDLE;
-			ret = 0; /*Will send no "OK"*/
+			ret = 1; /* Will send no "OK" */
 		} else if (shutdown_mode == SHUTDOWN_MODE_SLEEP) {
 			slm_at_host_uninit();
 			enter_sleep(true);
-			ret = 0; /* Cannot reach here */
+			ret = 1; /* Cannot reach here */
 		} else {
 			LOG_ERR("AT parameter error");
 			ret = -EINVAL;
@@ -247,28 +341,42 @@ static int handle_at_sleep(const char *at_cmd, enum shutdown_modes *mode)
 	return ret;
 }
 
-static int handle_at_slmuart(const char *at_cmd, uint32_t *baudrate)
+/**@brief handle AT#XRESET commands
+ *  AT#XRESET
+ */
+static int handle_at_reset(enum at_cmd_type type)
 {
-	int ret = -EINVAL;
-	enum at_cmd_type type;
+	ARG_UNUSED(type);
 
-	ret = at_parser_params_from_str(at_cmd, NULL, &at_param_list);
-	if (ret < 0) {
-		LOG_ERR("Failed to parse AT command %d", ret);
-		return -EINVAL;
-	}
+	rsp_send(OK_STR, sizeof(OK_STR) - 1);
+	k_sleep(K_MSEC(50));
+	slm_at_host_uninit();
+	enter_sleep(false);
+	sys_reboot(SYS_REBOOT_COLD);
+
+	return 1; /* Cannot reach here */
+}
+
+/**@brief handle AT#XSLMUART commands
+ *  AT#XSLMUART=<baud_rate>
+ *  AT#XSLMUART?
+ *  AT#XSLMUART=?
+ */
+static int handle_at_slmuart(enum at_cmd_type type)
+{
+	int ret = -EINVAL;
+	uint32_t baudrate;
 
-	type = at_parser_cmd_type_get(at_cmd);
 	if (type == AT_CMD_TYPE_SET_COMMAND) {
-		if (at_params_valid_count_get(&at_param_list) > 1) {
-			ret = at_params_int_get(&at_param_list, 1,
-					baudrate);
-			if (ret < 0) {
-				LOG_ERR("AT parameter error");
-				return -EINVAL;
-			}
+		if (at_params_valid_count_get(&at_param_list) < 2) {
+			return -EINVAL;
+		}
+		ret = at_params_int_get(&at_param_list, 1, &baudrate);
+		if (ret < 0) {
+			LOG_ERR("AT parameter error");
+			return -EINVAL;
 		}
-		switch (*baudrate) {
+		switch (baudrate) {
 		case 1200:
 		case 2400:
 		case 4800:
@@ -282,12 +390,16 @@ static int handle_at_slmuart(const char *at_cmd, uint32_t *baudrate)
 		case 460800:
 		case 921600:
 		case 1000000:
-			ret = 0;
 			break;
 		default:
 			LOG_ERR("Invalid uart baud rate provided.");
 			return -EINVAL;
 		}
+		/* OK is sent with the old baud rate */
+		rsp_send(OK_STR, sizeof(OK_STR) - 1);
+		k_sleep(K_MSEC(50));
+		set_uart_baudrate(baudrate);
+		ret = 1;
 	}
 
 	if (type == AT_CMD_TYPE_READ_COMMAND) {
@@ -308,176 +420,76 @@ static int handle_at_slmuart(const char *at_cmd, uint32_t *baudrate)
 	return ret;
 }
 
-static void cmd_send(struct k_work *work)
+/**@brief handle AT#XUARTSTAT commands
+ *  AT#XUARTSTAT
+ */
+static int handle_at_uartstat(enum at_cmd_type type)
 {
-	size_t chars;
-	char str[24];
-	static char buf[AT_MAX_CMD_LEN];
-	enum at_cmd_state state;
-	int err;
+	char buf[64];
+	int len;
 
-	ARG_UNUSED(work);
-
-	/* Make sure the string is 0-terminated */
-	at_buf[MIN(at_buf_len, AT_MAX_CMD_LEN - 1)] = 0;
+	ARG_UNUSED(type);
 
-	LOG_HEXDUMP_DBG(at_buf, at_buf_len, "RX");
-
-	if (slm_util_cmd_casecmp(at_buf, AT_CMD_SLMVER)) {
-		rsp_send(SLM_VERSION, sizeof(SLM_VERSION) - 1);
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	}
+	len = sprintf(buf, "#XUARTSTAT: %d, %d, %d\r\n", rx_stats.rx_bytes,
+		      rx_stats.dropped, rx_stats.peak);
+	rsp_send(buf, len);
 
-	if (slm_util_cmd_casecmp(at_buf, AT_CMD_SLMUART)) {
-		uint32_t baudrate;
+	return 0;
+}
 
-		err = handle_at_slmuart(at_buf, &baudrate);
-		if (err != 0) {
-			rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-			goto done;
-		} else {
-			rsp_send(OK_STR, sizeof(OK_STR) - 1);
-			k_sleep(K_MSEC(50));
-			set_uart_baudrate(baudrate);
-			goto done;
-		}
-	}
+SLM_AT_CMD_DEFINE(slmver, "AT#XSLMVER", handle_at_slmver);
+SLM_AT_CMD_DEFINE(slmuart, "AT#XSLMUART", handle_at_slmuart);
+SLM_AT_CMD_DEFINE(uartstat, "AT#XUARTSTAT", handle_at_uartstat);
+SLM_AT_CMD_DEFINE(sleep, "AT#XSLEEP", handle_at_sleep);
+SLM_AT_CMD_DEFINE(reset, "AT#XRESET", handle_at_reset);
+SLM_AT_CMD_DEFINE(clac, "AT#XCLAC", handle_at_clac);
 
-	if (slm_util_cmd_casecmp(at_buf, AT_CMD_RESET)) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		k_sleep(K_MSEC(50));
-		slm_at_host_uninit();
-		enter_sleep(false);
-		sys_reboot(SYS_REBOOT_COLD);
-	}
-
-	if (slm_util_cmd_casecmp(at_buf, AT_CMD_CLAC)) {
-		handle_at_clac();
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	}
+static void cmd_send(const char *at_cmd, size_t at_cmd_len)
+{
+	size_t chars;
+	char str[24];
+	static char buf[AT_MAX_CMD_LEN];
+	const struct slm_at_cmd *cmd;
+	enum at_cmd_state state;
+	int err;
 
-	if (slm_util_cmd_casecmp(at_buf, AT_CMD_SLEEP)) {
-		enum shutdown_modes mode = SHUTDOWN_MODE_INVALID;
+	LOG_HEXDUMP_DBG(at_cmd, at_cmd_len, "RX");
 
-		err = handle_at_sleep(at_buf, &mode);
+	cmd = cmd_lookup(at_cmd);
+	if (cmd != NULL) {
+		err = at_parser_params_from_str(at_cmd, NULL, &at_param_list);
 		if (err) {
-			rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-			goto done;
+			LOG_ERR("Failed to parse AT command %d", err);
+			err = -EINVAL;
 		} else {
-			if (mode == SHUTDOWN_MODE_INVALID) {
-				/*Test command*/
-				rsp_send(OK_STR, sizeof(OK_STR) - 1);
-				goto done;
-			} else {
-				/*Entered IDLE*/
-				return;
-			}
+			err = cmd->handler(at_parser_cmd_type_get(at_cmd));
 		}
+		goto response;
 	}
 
 #if defined(CONFIG_SLM_TCP_PROXY)
-	err = slm_at_tcp_proxy_parse(at_buf, at_buf_len);
-	if (err > 0) {
-		goto done;
-	} else if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
+	err = slm_at_tcp_proxy_datamode_send((const uint8_t *)at_cmd,
+						 at_cmd_len);
+	if (err != -ENOENT) {
+		goto response;
 	}
 #endif
 
 #if defined(CONFIG_SLM_UDP_PROXY)
-	err = slm_at_udp_proxy_parse(at_buf, at_buf_len);
-	if (err > 0) {
-		goto done;
-	} else if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
+	err = slm_at_udp_proxy_datamode_send((const uint8_t *)at_cmd,
+						 at_cmd_len);
+	if (err != -ENOENT) {
+		goto response;
 	}
 #endif
 
-	err = slm_at_tcpip_parse(at_buf);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-	err = slm_at_icmp_parse(at_buf);
-	if (err == 0) {
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-	err = slm_at_gps_parse(at_buf);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-	err = slm_at_mqtt_parse(at_buf);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-	err = slm_at_ftp_parse(at_buf);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-	err = slm_at_httpc_parse(at_buf, at_buf_len);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-	err = slm_at_fota_parse(at_buf);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
-	}
-
-#if defined(CONFIG_SLM_NATIVE_TLS)
-	err = slm_at_cmng_parse(at_buf);
-	if (err == 0) {
-		rsp_send(OK_STR, sizeof(OK_STR) - 1);
-		goto done;
-	} else if (err != -ENOENT) {
-		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
-		goto done;
+	err = slm_at_httpc_payload_send((const uint8_t *)at_cmd, at_cmd_len);
+	if (err != -ENOENT) {
+		goto response;
 	}
-#endif
 
 	/* Send to modem */
-	err = at_cmd_write(at_buf, buf, AT_MAX_CMD_LEN, &state);
+	err = at_cmd_write(at_cmd, buf, AT_MAX_CMD_LEN, &state);
 	if (err < 0) {
 		LOG_ERR("AT command error: %d", err);
 		state = AT_CMD_ERROR;
@@ -502,91 +514,229 @@ static void cmd_send(struct k_work *work)
 	default:
 		break;
 	}
+	goto done;
+
+response:
+	/* A positive value means the response is sent later, or was sent */
+	if (err == 0) {
+		rsp_send(OK_STR, sizeof(OK_STR) - 1);
+	} else if (err < 0) {
+		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
+	}
 
 done:
-	err = uart_rx_enable(uart_dev, uart_rx_buf[0],
-				sizeof(uart_rx_buf[0]), UART_RX_TIMEOUT);
+	if (raw_prompt) {
+		raw_prompt = false;
+		k_delayed_work_submit(&raw_timeout_work, RAW_RX_TIMEOUT);
+		rsp_send(RAW_PROMPT, sizeof(RAW_PROMPT) - 1);
+	}
+}
+
+static void raw_send(uint8_t *data, size_t len)
+{
+	int err;
+
+	k_delayed_work_cancel(&raw_timeout_work);
+
+	LOG_DBG("Raw data received: %d", len);
+	err = raw_handler(data, len);
 	if (err) {
-		LOG_ERR("UART RX failed: %d", err);
-		rsp_send(FATAL_STR, sizeof(FATAL_STR) - 1);
+		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
+	} else {
+		rsp_send(OK_STR, sizeof(OK_STR) - 1);
+	}
+}
+
+static void frames_send(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	while (atomic_test_bit(&frames_busy, cmd_frame)) {
+		uint8_t *frame = at_buf[cmd_frame];
+
+		if (frame_raw[cmd_frame]) {
+			raw_send(frame, frame_len[cmd_frame]);
+		} else {
+			/* Make sure the string is 0-terminated */
+			frame[frame_len[cmd_frame]] = '\0';
+			cmd_send((char *)frame, frame_len[cmd_frame]);
+		}
+
+		atomic_clear_bit(&frames_busy, cmd_frame);
+		cmd_frame = (cmd_frame + 1) % AT_BUF_NUM;
+	}
+}
+
+int slm_at_host_raw_recv(uint16_t length, slm_raw_handler_t handler)
+{
+	unsigned int key;
+
+	if (length == 0 || length >= AT_MAX_CMD_LEN || handler == NULL) {
+		return -EINVAL;
 	}
+
+	raw_handler = handler;
+	raw_len = length;
+	raw_prompt = true;
+
+	key = irq_lock();
+	raw_receiving = true;
+	irq_unlock(key);
+
+	return 1;
 }
 
-static void uart_rx_handler(uint8_t character)
+static void raw_timeout(struct k_work *work)
 {
-	static bool inside_quotes;
-	static size_t cmd_len;
-	size_t pos;
+	unsigned int key;
+	size_t received = 0;
+	bool timeout = false;
+
+	ARG_UNUSED(work);
 
-	cmd_len += 1;
-	pos = cmd_len - 1;
+	key = irq_lock();
+	if (raw_receiving) {
+		raw_receiving = false;
+		received = fill_len;
+		fill_len = 0;
+		timeout = true;
+	}
+	irq_unlock(key);
 
-	/* Handle special characters. */
+	if (timeout) {
+		LOG_WRN("Raw data timeout, received %d of %d",
+			received, raw_len);
+		rsp_send(ERROR_STR, sizeof(ERROR_STR) - 1);
+	}
+}
+
+/* Copies data to the frame being received, as much as fits. */
+static void frame_put(const uint8_t *data, size_t len)
+{
+	size_t space = AT_MAX_CMD_LEN - 1 - fill_len;
+
+	if (len > space) {
+		rx_stats.dropped += len - space;
+		len = space;
+	}
+
+	memcpy(&at_buf[fill_frame][fill_len], data, len);
+	fill_len += len;
+
+	if (fill_len > rx_stats.peak) {
+		rx_stats.peak = fill_len;
+	}
+}
+
+static void frame_submit(bool raw)
+{
+	frame_len[fill_frame] = fill_len;
+	frame_raw[fill_frame] = raw;
+	atomic_set_bit(&frames_busy, fill_frame);
+	k_work_submit(&cmd_send_work);
+
+	fill_frame = (fill_frame + 1) % AT_BUF_NUM;
+	fill_len = 0;
+	inside_quotes = false;
+}
+
+static inline bool is_special(uint8_t character)
+{
+	return (character == termination[term_mode] || character == '"' ||
+		character == 0x08 || character == 0x7F);
+}
+
+/* Handles a special character, and returns true if it ends the command. */
+static bool special_handle(uint8_t character)
+{
 	switch (character) {
 	case 0x08: /* Backspace. */
 		/* Fall through. */
 	case 0x7F: /* DEL character */
-		pos = pos ? pos - 1 : 0;
-		at_buf[pos] = 0;
-		cmd_len = cmd_len <= 1 ? 0 : cmd_len - 2;
-		break;
+		if (fill_len > 0) {
+			fill_len--;
+		}
+		return false;
 	case '"':
 		inside_quotes = !inside_quotes;
-		 /* Fall through. */
+		frame_put(&character, 1);
+		return false;
 	default:
-		/* Detect AT command buffer overflow or zero length */
-		if (cmd_len > AT_MAX_CMD_LEN) {
-			LOG_ERR("Buffer overflow, dropping '%c'\n", character);
-			cmd_len = AT_MAX_CMD_LEN;
-			return;
-		} else if (cmd_len < 1) {
-			LOG_ERR("Invalid AT command length: %d", cmd_len);
-			cmd_len = 0;
-			return;
-		}
-
-		at_buf[pos] = character;
 		break;
 	}
 
+	/* Line termination */
 	if (inside_quotes) {
-		return;
+		frame_put(&character, 1);
+		return false;
+	}
+	if (term_mode == MODE_CR_LF) {
+		if (fill_len == 0 || at_buf[fill_frame][fill_len - 1] != '\r') {
+			frame_put(&character, 1);
+			return false;
+		}
+		fill_len--;
 	}
 
-	/* Check if the character marks line termination. */
-	switch (term_mode) {
-	case MODE_NULL_TERM:
-		goto send;
-	case MODE_CR:
-		if (character == termination[term_mode]) {
-			cmd_len--;
-			goto send;
+	return true;
+}
+
+/* Frames the received data in place. Runs of ordinary characters are
+ * copied at once, only the special characters are handled one by one.
+ */
+static void uart_rx_handler(const uint8_t *data, size_t len)
+{
+	size_t run;
+
+	rx_stats.rx_bytes += len;
+
+	while (len > 0) {
+		if (atomic_test_bit(&frames_busy, fill_frame)) {
+			/* Previous frames not handled yet */
+			rx_stats.dropped += len;
+			return;
 		}
-		break;
-	case MODE_LF:
-		if ((at_buf[pos - 1]) &&
-			character == termination[term_mode]) {
-			cmd_len--;
-			goto send;
+
+		if (raw_receiving) {
+			run = MIN(len, raw_len - fill_len);
+			frame_put(data, run);
+			data += run;
+			len -= run;
+			if (fill_len == raw_len) {
+				raw_receiving = false;
+				frame_submit(true);
+			}
+			continue;
 		}
-		break;
-	case MODE_CR_LF:
-		if ((at_buf[pos - 1] == '\r') && (character == '\n')) {
-			cmd_len -= 2;
-			goto send;
+
+		for (run = 0; run < len && !is_special(data[run]); run++) {
 		}
-		break;
-	default:
-		LOG_ERR("Invalid termination mode: %d", term_mode);
-		break;
+		frame_put(data, run);
+		data += run;
+		len -= run;
+
+		if (len == 0) {
+			break;
+		}
+
+		if (special_handle(*data) && fill_len > 0) {
+			frame_submit(false);
+		}
+		data++;
+		len--;
 	}
+}
 
-	return;
-send:
-	uart_rx_disable(uart_dev);
-	k_work_submit(&cmd_send_work);
-	at_buf_len = cmd_len;
-	cmd_len = 0;
+static void uart_rx_start(void)
+{
+	int err;
+
+	next_buf = uart_rx_buf[1];
+	err = uart_rx_enable(uart_dev, uart_rx_buf[0],
+			     sizeof(uart_rx_buf[0]), UART_RX_TIMEOUT);
+	if (err) {
+		LOG_ERR("UART RX failed: %d", err);
+	}
 }
 
 static void uart_callback(const struct device *dev, struct uart_event *evt,
@@ -595,7 +745,6 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 	ARG_UNUSED(dev);
 
 	int err;
-	static uint16_t pos;
 
 	ARG_UNUSED(user_data);
 
@@ -610,13 +759,10 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 		LOG_INF("TX_ABORTED");
 		break;
 	case UART_RX_RDY:
-		for (int i = pos; i < (pos + evt->data.rx.len); i++) {
-			uart_rx_handler(evt->data.rx.buf[i]);
-		}
-		pos += evt->data.rx.len;
+		uart_rx_handler(&evt->data.rx.buf[evt->data.rx.offset],
+				evt->data.rx.len);
 		break;
 	case UART_RX_BUF_REQUEST:
-		pos = 0;
 		err = uart_rx_buf_rsp(uart_dev, next_buf,
 					sizeof(uart_rx_buf[0]));
 		if (err) {
@@ -631,6 +777,10 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 		break;
 	case UART_RX_DISABLED:
 		LOG_DBG("RX_DISABLED");
+		/* RX is kept running, restart it after an error */
+		if (rx_running) {
+			uart_rx_start();
+		}
 		break;
 	default:
 		break;
@@ -677,12 +827,25 @@ int slm_at_host_init(void)
 	device_set_power_state(uart_dev, DEVICE_PM_ACTIVE_STATE,
 				NULL, NULL);
 	term_mode = CONFIG_SLM_AT_HOST_TERMINATION;
+	atomic_clear(&frames_busy);
+	fill_frame = 0;
+	cmd_frame = 0;
+	fill_len = 0;
+	inside_quotes = false;
+	raw_receiving = false;
+	next_buf = uart_rx_buf[1];
 	err = uart_rx_enable(uart_dev, uart_rx_buf[0],
 				sizeof(uart_rx_buf[0]), UART_RX_TIMEOUT);
 	if (err) {
 		LOG_ERR("Cannot enable rx: %d", err);
 		return -EFAULT;
 	}
+	rx_running = true;
+
+	err = cmd_index_build();
+	if (err) {
+		return err;
+	}
 
 	err = at_notif_register_handler(NULL, response_handler);
 	if (err) {
@@ -749,7 +912,8 @@ int slm_at_host_init(void)
 	}
 #endif
 
-	k_work_init(&cmd_send_work, cmd_send);
+	k_work_init(&cmd_send_work, frames_send);
+	k_delayed_work_init(&raw_timeout_work, raw_timeout);
 	k_sem_give(&tx_done);
 	rsp_send(SLM_SYNC_STR, sizeof(SLM_SYNC_STR)-1);
 
@@ -813,6 +977,7 @@ void slm_at_host_uninit(void)
 	}
 
 	/* Power off UART module */
+	rx_running = false;
 	uart_rx_disable(uart_dev);
 	k_sleep(K_MSEC(100));
 	err = device_set_power_state(uart_dev, DEVICE_PM_OFF_STATE,
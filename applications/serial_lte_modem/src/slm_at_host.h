@@ -13,6 +13,7 @@
  * @{
  */
 
+#include <zephyr.h>
 #include <zephyr/types.h>
 #include <ctype.h>
 #include <modem/at_cmd_parser.h>
@@ -21,12 +22,29 @@
 /**@brief AT command handler type. */
 typedef int (*slm_at_handler_t) (enum at_cmd_type);
 
-/**@brief AT command list item type. */
-typedef struct slm_at_cmd_list {
-	uint8_t type;
-	char *string;
+/**@brief AT command table entry. */
+struct slm_at_cmd {
+	const char *string;
 	slm_at_handler_t handler;
-} slm_at_cmd_list_t;
+};
+
+/**
+ * @brief Register an AT command with the AT host.
+ *
+ * The command parameters are parsed into at_param_list before the handler
+ * is called. The handler returns 0 to have OK sent, a negative error code
+ * to have ERROR sent, or a positive value if the final response is sent
+ * later or by the handler itself.
+ *
+ * @param _name Unique name of the table entry.
+ * @param _string AT command string, for example "AT#XSOCKET".
+ * @param _handler Command handler.
+ */
+#define SLM_AT_CMD_DEFINE(_name, _string, _handler)                    \
+	const Z_STRUCT_SECTION_ITERABLE(slm_at_cmd, slm_at_cmd_##_name) = { \
+		.string = _string,                                      \
+		.handler = _handler,                                    \
+	}
 
 /**@brief Arbitrary data type over AT channel. */
 enum slm_data_type_t {
@@ -34,9 +52,20 @@ enum slm_data_type_t {
 	DATATYPE_PLAINTEXT,
 	DATATYPE_JSON,
 	DATATYPE_HTML,
-	DATATYPE_OMATLV
+	DATATYPE_OMATLV,
+	DATATYPE_RAW
 };
 
+/**@brief Raw data handler type.
+ *
+ * @param data Raw data received after the AT command.
+ * @param datalen Length of the data.
+ *
+ * @retval 0 If the operation was successful, OK is sent.
+ *           Otherwise ERROR is sent.
+ */
+typedef int (*slm_raw_handler_t)(const uint8_t *data, int datalen);
+
 /**
  * @brief Initialize AT host for serial LTE modem
  *
@@ -45,6 +74,25 @@ enum slm_data_type_t {
  */
 int slm_at_host_init(void);
 
+/**
+ * @brief Receive raw data following an AT command
+ *
+ * After the calling command handler returns, a "> " prompt is sent and the
+ * next @p length bytes received are passed to @p handler as they are,
+ * without hexadecimal encoding or termination processing. The final
+ * OK or ERROR is sent after the handler returns, or ERROR if the data
+ * does not arrive in time.
+ *
+ * The command handler must return the value returned by this function.
+ *
+ * @param length Length of the raw data.
+ * @param handler Handler to call with the data.
+ *
+ * @retval 1 If raw data mode was entered. The final response is deferred.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int slm_at_host_raw_recv(uint16_t length, slm_raw_handler_t handler);
+
 /** @} */
 
 #endif /* SLM_AT_HOST_ */
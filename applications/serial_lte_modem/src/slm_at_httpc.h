@@ -17,16 +17,16 @@
 #include "slm_at_host.h"
 
 /**
- * @brief HTTPC AT command parser.
+ * @brief Send HTTP request payload.
  *
- * @param at_cmd AT command or data string.
- * @param length AT command or data string length.
+ * @param data Payload received from the AT channel.
+ * @param length Length of the payload.
  *
  * @retval 0 If the operation was successful.
- *           Otherwise, negative code means error.
- *           Otherwise, positive code means data is sent in passthrough mode.
+ *           -ENOENT if no payload is expected.
+ *           Otherwise, a (negative) error code is returned.
  */
-int slm_at_httpc_parse(const char *at_cmd, size_t length);
+int slm_at_httpc_payload_send(const uint8_t *data, size_t length);
 
 /**
  * @brief Initialize HTTPC AT command parser.
@@ -44,12 +44,6 @@ int slm_at_httpc_init(void);
  */
 int slm_at_httpc_uninit(void);
 
-/**
- * @brief List HTTPC AT commands.
- *
- */
-void slm_at_httpc_clac(void);
-
 /** @} */
 
 #endif /* SLM_AT_HTTPC_ */
@@ -37,28 +37,18 @@ enum slm_mqttsub_operation {
 	AT_MQTTSUB_SUB
 };
 
-/**@brief List of supported AT commands. */
-enum slm_mqtt_at_cmd_type {
-	AT_MQTT_CONNECT,
-	AT_MQTT_PUBLISH,
-	AT_MQTT_SUBSCRIBE,
-	AT_MQTT_UNSUBSCRIBE,
-	AT_MQTT_MAX
-};
-
 /** forward declaration of cmd handlers **/
 static int handle_at_mqtt_connect(enum at_cmd_type cmd_type);
 static int handle_at_mqtt_publish(enum at_cmd_type cmd_type);
 static int handle_at_mqtt_subscribe(enum at_cmd_type cmd_type);
 static int handle_at_mqtt_unsubscribe(enum at_cmd_type cmd_type);
 
-/**@brief SLM AT Command list type. */
-static slm_at_cmd_list_t mqtt_at_list[AT_MQTT_MAX] = {
-	{AT_MQTT_CONNECT, "AT#XMQTTCON", handle_at_mqtt_connect},
-	{AT_MQTT_PUBLISH, "AT#XMQTTPUB", handle_at_mqtt_publish},
-	{AT_MQTT_SUBSCRIBE, "AT#XMQTTSUB", handle_at_mqtt_subscribe},
-	{AT_MQTT_UNSUBSCRIBE, "AT#XMQTTUNSUB", handle_at_mqtt_unsubscribe},
-};
+/**@brief Supported AT commands. */
+SLM_AT_CMD_DEFINE(mqtt_connect, "AT#XMQTTCON", handle_at_mqtt_connect);
+SLM_AT_CMD_DEFINE(mqtt_publish, "AT#XMQTTPUB", handle_at_mqtt_publish);
+SLM_AT_CMD_DEFINE(mqtt_subscribe, "AT#XMQTTSUB", handle_at_mqtt_subscribe);
+SLM_AT_CMD_DEFINE(mqtt_unsubscribe, "AT#XMQTTUNSUB",
+		  handle_at_mqtt_unsubscribe);
 
 static struct slm_mqtt_ctx {
 	bool connected;
@@ -702,8 +692,24 @@ static int handle_at_mqtt_connect(enum at_cmd_type cmd_type)
 	return err;
 }
 
+/* Publish parameters kept for the raw data following AT#XMQTTPUB */
+static struct {
+	uint8_t topic[MQTT_MAX_TOPIC_LEN];
+	size_t topic_sz;
+	uint16_t qos;
+	uint16_t retain;
+} pub_raw;
+
+static int mqtt_publish_raw(const uint8_t *data, int datalen)
+{
+	return do_mqtt_publish(pub_raw.qos, pub_raw.retain,
+			       pub_raw.topic, pub_raw.topic_sz,
+			       (uint8_t *)data, datalen);
+}
+
 /**@brief handle AT#XMQTTPUB commands
  *  AT#XMQTTPUB=<topic>,<datatype>,<msg>,<qos>,<retain>
+ *  AT#XMQTTPUB=<topic>,<datatype>,<length>,<qos>,<retain> for raw data
  *  AT#XMQTTPUB? READ command not supported
  *  AT#XMQTTPUB=?
  */
@@ -731,19 +737,32 @@ static int handle_at_mqtt_publish(enum at_cmd_type cmd_type)
 		if (err < 0) {
 			return err;
 		}
-		err = at_params_string_get(&at_param_list, 3, msg, &msg_sz);
+		err = at_params_short_get(&at_param_list, 4, &qos);
 		if (err < 0) {
 			return err;
 		}
-		msg[msg_sz] = '\0';
-		err = at_params_short_get(&at_param_list, 4, &qos);
+		err = at_params_short_get(&at_param_list, 5, &retain);
 		if (err < 0) {
 			return err;
 		}
-		err = at_params_short_get(&at_param_list, 5, &retain);
+		if (datatype == DATATYPE_RAW) {
+			uint16_t length;
+
+			err = at_params_short_get(&at_param_list, 3, &length);
+			if (err < 0) {
+				return err;
+			}
+			memcpy(pub_raw.topic, topic, topic_sz);
+			pub_raw.topic_sz = topic_sz;
+			pub_raw.qos = qos;
+			pub_raw.retain = retain;
+			return slm_at_host_raw_recv(length, mqtt_publish_raw);
+		}
+		err = at_params_string_get(&at_param_list, 3, msg, &msg_sz);
 		if (err < 0) {
 			return err;
 		}
+		msg[msg_sz] = '\0';
 		if (datatype == DATATYPE_HEXADECIMAL) {
 			size_t data_len = msg_sz / 2;
 			uint8_t data_hex[data_len];
@@ -766,7 +785,7 @@ static int handle_at_mqtt_publish(enum at_cmd_type cmd_type)
 		break;
 
 	case AT_CMD_TYPE_TEST_COMMAND:
-		sprintf(rsp_buf, "#XMQTTPUB: <topic>, (0, 1), <msg>,"
+		sprintf(rsp_buf, "#XMQTTPUB: <topic>, (0, 1, 5), <msg>,"
 					" (0, 1, 2), (0, 1)\r\n");
 		rsp_send(rsp_buf, strlen(rsp_buf));
 		err = 0;
@@ -864,40 +883,6 @@ static int handle_at_mqtt_unsubscribe(enum at_cmd_type cmd_type)
 	return err;
 }
 
-/**@brief API to handle MQTT AT commands
- */
-int slm_at_mqtt_parse(const char *at_cmd)
-{
-	int ret = -ENOENT;
-	enum at_cmd_type type;
-
-	for (int i = 0; i < AT_MQTT_MAX; i++) {
-		if (slm_util_cmd_casecmp(at_cmd, mqtt_at_list[i].string)) {
-			ret = at_parser_params_from_str(at_cmd, NULL,
-						&at_param_list);
-			if (ret) {
-				LOG_ERR("Failed to parse AT command %d", ret);
-				return -EINVAL;
-			}
-			type = at_parser_cmd_type_get(at_cmd);
-			ret = mqtt_at_list[i].handler(type);
-			break;
-		}
-	}
-
-	return ret;
-}
-
-/**@brief API to list MQTT AT commands
- */
-void slm_at_mqtt_clac(void)
-{
-	for (int i = 0; i < AT_MQTT_MAX; i++) {
-		sprintf(rsp_buf, "%s\r\n", mqtt_at_list[i].string);
-		rsp_send(rsp_buf, strlen(rsp_buf));
-	}
-}
-
 int slm_at_mqtt_init(void)
 {
 	return 0;
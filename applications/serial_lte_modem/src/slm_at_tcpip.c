@@ -20,7 +20,6 @@ LOG_MODULE_REGISTER(tcpip, CONFIG_SLM_LOG_LEVEL);
 
 /*
  * Known limitation in this version
- * - Multiple concurrent sockets
  * - Socket type other than SOCK_STREAM(1) and SOCK_DGRAM(2)
  * - IP Protocol other than TCP(6) and UDP(17)
  * - TCP server accept one connection only
@@ -47,24 +46,9 @@ enum slm_socket_role {
 	AT_SOCKET_ROLE_SERVER
 };
 
-/**@brief List of supported AT commands. */
-enum slm_tcpip_at_cmd_type {
-	AT_SOCKET,
-	AT_SOCKETOPT,
-	AT_BIND,
-	AT_CONNECT,
-	AT_LISTEN,
-	AT_ACCEPT,
-	AT_SEND,
-	AT_RECV,
-	AT_SENDTO,
-	AT_RECVFROM,
-	AT_GETADDRINFO,
-	AT_TCPIP_MAX
-};
-
 /** forward declaration of cmd handlers **/
 static int handle_at_socket(enum at_cmd_type cmd_type);
+static int handle_at_socket_select(enum at_cmd_type cmd_type);
 static int handle_at_socketopt(enum at_cmd_type cmd_type);
 static int handle_at_bind(enum at_cmd_type cmd_type);
 static int handle_at_connect(enum at_cmd_type cmd_type);
@@ -76,20 +60,20 @@ static int handle_at_sendto(enum at_cmd_type cmd_type);
 static int handle_at_recvfrom(enum at_cmd_type cmd_type);
 static int handle_at_getaddrinfo(enum at_cmd_type cmd_type);
 
-/**@brief SLM AT Command list type. */
-static slm_at_cmd_list_t tcpip_at_list[AT_TCPIP_MAX] = {
-	{AT_SOCKET, "AT#XSOCKET", handle_at_socket},
-	{AT_SOCKETOPT, "AT#XSOCKETOPT", handle_at_socketopt},
-	{AT_BIND, "AT#XBIND", handle_at_bind},
-	{AT_CONNECT, "AT#XCONNECT", handle_at_connect},
-	{AT_LISTEN, "AT#XLISTEN", handle_at_listen},
-	{AT_ACCEPT, "AT#XACCEPT", handle_at_accept},
-	{AT_SEND, "AT#XSEND", handle_at_send},
-	{AT_RECV, "AT#XRECV", handle_at_recv},
-	{AT_SENDTO, "AT#XSENDTO", handle_at_sendto},
-	{AT_RECVFROM, "AT#XRECVFROM", handle_at_recvfrom},
-	{AT_GETADDRINFO, "AT#XGETADDRINFO", handle_at_getaddrinfo},
-};
+/**@brief Supported AT commands. */
+SLM_AT_CMD_DEFINE(socket, "AT#XSOCKET", handle_at_socket);
+SLM_AT_CMD_DEFINE(socketselect, "AT#XSOCKETSELECT",
+		  handle_at_socket_select);
+SLM_AT_CMD_DEFINE(socketopt, "AT#XSOCKETOPT", handle_at_socketopt);
+SLM_AT_CMD_DEFINE(bind, "AT#XBIND", handle_at_bind);
+SLM_AT_CMD_DEFINE(connect, "AT#XCONNECT", handle_at_connect);
+SLM_AT_CMD_DEFINE(listen, "AT#XLISTEN", handle_at_listen);
+SLM_AT_CMD_DEFINE(accept, "AT#XACCEPT", handle_at_accept);
+SLM_AT_CMD_DEFINE(send, "AT#XSEND", handle_at_send);
+SLM_AT_CMD_DEFINE(recv, "AT#XRECV", handle_at_recv);
+SLM_AT_CMD_DEFINE(sendto, "AT#XSENDTO", handle_at_sendto);
+SLM_AT_CMD_DEFINE(recvfrom, "AT#XRECVFROM", handle_at_recvfrom);
+SLM_AT_CMD_DEFINE(getaddrinfo, "AT#XGETADDRINFO", handle_at_getaddrinfo);
 
 static struct sockaddr_in remote;
 
@@ -100,7 +84,10 @@ static struct tcpip_client {
 	int sock_peer; /* Socket descriptor for peer. */
 	int ip_proto; /* IP protocol */
 	bool connected; /* TCP connected flag */
-} client;
+} clients[CONFIG_SLM_TCPIP_MAX_SOCKETS];
+
+/* Socket the commands apply to, selected by #XSOCKETSELECT */
+static struct tcpip_client *client = &clients[0];
 
 /* global functions defined in different files */
 void rsp_send(const uint8_t *str, size_t len);
@@ -110,6 +97,27 @@ extern struct at_param_list at_param_list;
 extern struct modem_param_info modem_param;
 extern char rsp_buf[CONFIG_AT_CMD_RESPONSE_MAX_LEN];
 
+static void client_init(struct tcpip_client *c)
+{
+	c->sock = INVALID_SOCKET;
+	c->sec_tag = INVALID_SEC_TAG;
+	c->role = AT_SOCKET_ROLE_CLIENT;
+	c->sock_peer = INVALID_SOCKET;
+	c->connected = false;
+	c->ip_proto = IPPROTO_IP;
+}
+
+static struct tcpip_client *client_find(int sock)
+{
+	for (int i = 0; i < ARRAY_SIZE(clients); i++) {
+		if (clients[i].sock == sock) {
+			return &clients[i];
+		}
+	}
+
+	return NULL;
+}
+
 /**@brief Resolves host IPv4 address and port
  */
 static int parse_host_by_ipv4(const char *ip, uint16_t port)
@@ -170,43 +178,43 @@ static int do_socket_open(uint8_t type, uint8_t role, int sec_tag)
 {
 	int ret = 0;
 
-	client.sec_tag = sec_tag;
+	client->sec_tag = sec_tag;
 	if (type == SOCK_STREAM) {
 		if (sec_tag == INVALID_SEC_TAG) {
-			client.sock = socket(AF_INET, SOCK_STREAM,
+			client->sock = socket(AF_INET, SOCK_STREAM,
 					IPPROTO_TCP);
-			client.ip_proto = IPPROTO_TCP;
+			client->ip_proto = IPPROTO_TCP;
 		} else {
-			client.sock = socket(AF_INET, SOCK_STREAM,
+			client->sock = socket(AF_INET, SOCK_STREAM,
 					IPPROTO_TLS_1_2);
-			client.ip_proto = IPPROTO_TLS_1_2;
+			client->ip_proto = IPPROTO_TLS_1_2;
 		}
 	} else if (type == SOCK_DGRAM) {
 		if (sec_tag == INVALID_SEC_TAG) {
-			client.sock = socket(AF_INET, SOCK_DGRAM,
+			client->sock = socket(AF_INET, SOCK_DGRAM,
 					IPPROTO_UDP);
-			client.ip_proto = IPPROTO_UDP;
+			client->ip_proto = IPPROTO_UDP;
 		} else {
-			client.sock = socket(AF_INET, SOCK_DGRAM,
+			client->sock = socket(AF_INET, SOCK_DGRAM,
 					IPPROTO_DTLS_1_2);
-			client.ip_proto = IPPROTO_DTLS_1_2;
+			client->ip_proto = IPPROTO_DTLS_1_2;
 		}
 	} else {
 		LOG_ERR("socket type %d not supported", type);
 		return -ENOTSUP;
 	}
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("socket() failed: %d", -errno);
 		ret = -errno;
 		goto error_exit;
 	}
 
-	if (client.sec_tag != INVALID_SEC_TAG) {
-		sec_tag_t sec_tag_list[1] = { client.sec_tag };
+	if (client->sec_tag != INVALID_SEC_TAG) {
+		sec_tag_t sec_tag_list[1] = { client->sec_tag };
 #if defined(CONFIG_SLM_NATIVE_TLS)
 		int verify;
 
-		ret = slm_tls_loadcrdl(client.sec_tag);
+		ret = slm_tls_loadcrdl(client->sec_tag);
 		if (ret < 0) {
 			LOG_ERR("Fail to load credential: %d", ret);
 			return ret;
@@ -219,7 +227,7 @@ static int do_socket_open(uint8_t type, uint8_t role, int sec_tag)
 			verify = TLS_PEER_VERIFY_REQUIRED;
 		}
 
-		ret = setsockopt(client.sock, SOL_TLS, TLS_PEER_VERIFY,
+		ret = setsockopt(client->sock, SOL_TLS, TLS_PEER_VERIFY,
 				 &verify, sizeof(verify));
 		if (ret) {
 			printk("Failed to setup peer verification, err %d\n",
@@ -236,7 +244,7 @@ static int do_socket_open(uint8_t type, uint8_t role, int sec_tag)
 		}
 #endif
 
-		ret = setsockopt(client.sock, SOL_TLS, TLS_SEC_TAG_LIST,
+		ret = setsockopt(client->sock, SOL_TLS, TLS_SEC_TAG_LIST,
 				sec_tag_list, sizeof(sec_tag_t));
 		if (ret) {
 			LOG_ERR("set (d)tls tag list failed: %d", -errno);
@@ -245,9 +253,9 @@ static int do_socket_open(uint8_t type, uint8_t role, int sec_tag)
 		}
 	}
 
-	client.role = role;
-	sprintf(rsp_buf, "#XSOCKET: %d, %d, %d, %d\r\n", client.sock,
-		type, role, client.ip_proto);
+	client->role = role;
+	sprintf(rsp_buf, "#XSOCKET: %d, %d, %d, %d\r\n", client->sock,
+		type, role, client->ip_proto);
 	rsp_send(rsp_buf, strlen(rsp_buf));
 
 	LOG_DBG("Socket opened");
@@ -255,10 +263,10 @@ static int do_socket_open(uint8_t type, uint8_t role, int sec_tag)
 
 error_exit:
 	LOG_DBG("Socket not opened");
-	if (client.sock >= 0) {
-		close(client.sock);
+	if (client->sock >= 0) {
+		close(client->sock);
 	}
-	slm_at_tcpip_init();
+	client_init(client);
 	return ret;
 }
 
@@ -266,25 +274,25 @@ static int do_socket_close(int error)
 {
 	int ret = 0;
 
-	if (client.sock > 0) {
+	if (client->sock > 0) {
 #if defined(CONFIG_SLM_NATIVE_TLS)
-		if (client.sec_tag != INVALID_SEC_TAG) {
-			ret = slm_tls_unloadcrdl(client.sec_tag);
+		if (client->sec_tag != INVALID_SEC_TAG) {
+			ret = slm_tls_unloadcrdl(client->sec_tag);
 			if (ret < 0) {
 				LOG_ERR("Fail to load credential: %d", ret);
 				return ret;
 			}
 		}
 #endif
-		ret = close(client.sock);
+		ret = close(client->sock);
 		if (ret < 0) {
 			LOG_WRN("close() failed: %d", -errno);
 			ret = -errno;
 		}
-		if (client.sock_peer > 0) {
-			close(client.sock_peer);
+		if (client->sock_peer > 0) {
+			close(client->sock_peer);
 		}
-		slm_at_tcpip_init();
+		client_init(client);
 		sprintf(rsp_buf, "#XSOCKET: %d, closed\r\n", error);
 		rsp_send(rsp_buf, strlen(rsp_buf));
 		LOG_DBG("Socket closed");
@@ -308,7 +316,7 @@ static int do_socketopt_set(int name, int value)
 	case SO_RCVTIMEO: {
 		struct timeval tmo = { .tv_sec = value };
 
-		ret = setsockopt(client.sock, SOL_SOCKET, SO_RCVTIMEO,
+		ret = setsockopt(client->sock, SOL_SOCKET, SO_RCVTIMEO,
 				&tmo, sizeof(struct timeval));
 		if (ret < 0) {
 			LOG_ERR("setsockopt() error: %d", -errno);
@@ -344,7 +352,7 @@ static int do_socketopt_get(int name)
 		struct timeval tmo;
 		socklen_t len = sizeof(struct timeval);
 
-		ret = getsockopt(client.sock, SOL_SOCKET, SO_RCVTIMEO,
+		ret = getsockopt(client->sock, SOL_SOCKET, SO_RCVTIMEO,
 				&tmo, &len);
 		if (ret) {
 			LOG_ERR("getsockopt() error: %d", -errno);
@@ -401,7 +409,7 @@ static int do_bind(uint16_t port)
 		return -EINVAL;
 	}
 
-	ret = bind(client.sock, (struct sockaddr *)&local,
+	ret = bind(client->sock, (struct sockaddr *)&local,
 		 sizeof(struct sockaddr_in));
 	if (ret) {
 		LOG_ERR("bind() failed: %d", -errno);
@@ -428,8 +436,8 @@ static int do_connect(const char *url, uint16_t port)
 		return ret;
 	}
 
-	if (client.sec_tag != INVALID_SEC_TAG) {
-		ret = setsockopt(client.sock, SOL_TLS,
+	if (client->sec_tag != INVALID_SEC_TAG) {
+		ret = setsockopt(client->sock, SOL_TLS,
 				 TLS_HOSTNAME, url, strlen(url));
 		if (ret < 0) {
 			printk("Failed to set TLS_HOSTNAME\n");
@@ -437,7 +445,7 @@ static int do_connect(const char *url, uint16_t port)
 		}
 	}
 
-	ret = connect(client.sock, (struct sockaddr *)&remote,
+	ret = connect(client->sock, (struct sockaddr *)&remote,
 		sizeof(struct sockaddr_in));
 	if (ret < 0) {
 		LOG_ERR("connect() failed: %d", -errno);
@@ -445,7 +453,7 @@ static int do_connect(const char *url, uint16_t port)
 		return -errno;
 	}
 
-	client.connected = true;
+	client->connected = true;
 	sprintf(rsp_buf, "#XCONNECT: 1\r\n");
 	rsp_send(rsp_buf, strlen(rsp_buf));
 	return 0;
@@ -456,14 +464,14 @@ static int do_listen(void)
 	int ret;
 
 	/* hardcode backlog to be 1 for now */
-	ret = listen(client.sock, 1);
+	ret = listen(client->sock, 1);
 	if (ret < 0) {
 		LOG_ERR("listen() failed: %d", -errno);
 		do_socket_close(-errno);
 		return -errno;
 	}
 
-	client.sock_peer = INVALID_SOCKET;
+	client->sock_peer = INVALID_SOCKET;
 	return 0;
 }
 
@@ -473,7 +481,7 @@ static int do_accept(void)
 	char peer_addr[INET_ADDRSTRLEN];
 	socklen_t len = sizeof(struct sockaddr_in);
 
-	ret = accept(client.sock, (struct sockaddr *)&remote, &len);
+	ret = accept(client->sock, (struct sockaddr *)&remote, &len);
 	if (ret < 0) {
 		LOG_ERR("accept() failed: %d/%d", -errno, ret);
 		do_socket_close(-errno);
@@ -487,10 +495,10 @@ static int do_accept(void)
 	sprintf(rsp_buf, "#XACCEPT: connected with %s\r\n",
 		peer_addr);
 	rsp_send(rsp_buf, strlen(rsp_buf));
-	client.sock_peer = ret;
-	client.connected = true;
+	client->sock_peer = ret;
+	client->connected = true;
 
-	sprintf(rsp_buf, "#XACCEPT: %d\r\n", client.sock_peer);
+	sprintf(rsp_buf, "#XACCEPT: %d\r\n", client->sock_peer);
 	rsp_send(rsp_buf, strlen(rsp_buf));
 
 	return 0;
@@ -500,12 +508,12 @@ static int do_send(const uint8_t *data, int datalen)
 {
 	uint32_t offset = 0;
 	int ret = 0;
-	int sock = client.sock;
+	int sock = client->sock;
 
 	/* For TCP/TLS Server, send to imcoming socket */
-	if (client.role == AT_SOCKET_ROLE_SERVER) {
-		if (client.sock_peer != INVALID_SOCKET) {
-			sock = client.sock_peer;
+	if (client->role == AT_SOCKET_ROLE_SERVER) {
+		if (client->sock_peer != INVALID_SOCKET) {
+			sock = client->sock_peer;
 		} else {
 			LOG_ERR("No remote connection");
 			return -EINVAL;
@@ -539,16 +547,16 @@ static int do_send(const uint8_t *data, int datalen)
 	}
 }
 
-static int do_recv(uint16_t length)
+static int do_recv(uint16_t length, uint16_t datatype)
 {
 	int ret;
 	char data[NET_IPV4_MTU];
-	int sock = client.sock;
+	int sock = client->sock;
 
 	/* For TCP/TLS Server, receive from imcoming socket */
-	if (client.role == AT_SOCKET_ROLE_SERVER) {
-		if (client.sock_peer != INVALID_SOCKET) {
-			sock = client.sock_peer;
+	if (client->role == AT_SOCKET_ROLE_SERVER) {
+		if (client->sock_peer != INVALID_SOCKET) {
+			sock = client->sock_peer;
 		} else {
 			LOG_ERR("No remote connection");
 			return -EINVAL;
@@ -576,7 +584,14 @@ static int do_recv(uint16_t length)
 	if (ret == 0) {
 		LOG_WRN("recv() return 0");
 	}
-	if (slm_util_hex_check(data, ret)) {
+	if (datatype == DATATYPE_RAW) {
+		/* Length first, so that the data needs no encoding */
+		sprintf(rsp_buf, "#XRECV: %d, %d\r\n", DATATYPE_RAW, ret);
+		rsp_send(rsp_buf, strlen(rsp_buf));
+		rsp_send(data, ret);
+		rsp_send("\r\n", 2);
+		ret = 0;
+	} else if (slm_util_hex_check(data, ret)) {
 		char data_hex[ret * 2];
 		int size = ret * 2;
 
@@ -632,7 +647,7 @@ static int do_sendto(const char *url, uint16_t port, const uint8_t *data,
 	}
 
 	while (offset < datalen) {
-		ret = sendto(client.sock, data + offset,
+		ret = sendto(client->sock, data + offset,
 			datalen - offset, 0,
 			(struct sockaddr *)&remote,
 			sizeof(struct sockaddr_in));
@@ -666,7 +681,7 @@ static int do_recvfrom(uint16_t length)
 	int ret;
 	char data[NET_IPV4_MTU];
 
-	ret = recvfrom(client.sock, data, length, 0, NULL, NULL);
+	ret = recvfrom(client->sock, data, length, 0, NULL, NULL);
 	if (ret < 0) {
 		LOG_ERR("recvfrom() error: %d", -errno);
 		if (errno != EAGAIN && errno != ETIMEDOUT) {
@@ -746,14 +761,20 @@ static int handle_at_socket(enum at_cmd_type cmd_type)
 			if (at_params_valid_count_get(&at_param_list) > 4) {
 				at_params_int_get(&at_param_list, 4, &sec_tag);
 			}
-			if (client.sock > 0) {
-				LOG_WRN("Socket is already opened");
-				return -EINVAL;
-			} else {
-				err = do_socket_open(type, role, sec_tag);
+			if (client->sock >= 0) {
+				/* Open in a free slot, and select it */
+				struct tcpip_client *free_client;
+
+				free_client = client_find(INVALID_SOCKET);
+				if (free_client == NULL) {
+					LOG_WRN("No free socket");
+					return -ENOMEM;
+				}
+				client = free_client;
 			}
+			err = do_socket_open(type, role, sec_tag);
 		} else if (op == AT_SOCKET_CLOSE) {
-			if (client.sock < 0) {
+			if (client->sock < 0) {
 				LOG_WRN("Socket is not opened yet");
 				return -EINVAL;
 			} else {
@@ -762,9 +783,9 @@ static int handle_at_socket(enum at_cmd_type cmd_type)
 		} break;
 
 	case AT_CMD_TYPE_READ_COMMAND:
-		if (client.sock != INVALID_SOCKET) {
+		if (client->sock != INVALID_SOCKET) {
 			sprintf(rsp_buf, "#XSOCKET: %d, %d, %d\r\n",
-				client.sock, client.ip_proto, client.role);
+				client->sock, client->ip_proto, client->role);
 		} else {
 			sprintf(rsp_buf, "#XSOCKET: 0\r\n");
 		}
@@ -790,6 +811,61 @@ static int handle_at_socket(enum at_cmd_type cmd_type)
 	return err;
 }
 
+/**@brief handle AT#XSOCKETSELECT commands
+ *  AT#XSOCKETSELECT=<handle>
+ *  AT#XSOCKETSELECT?
+ *  AT#XSOCKETSELECT=? TEST command not supported
+ */
+static int handle_at_socket_select(enum at_cmd_type cmd_type)
+{
+	int err = -EINVAL;
+	int handle;
+	struct tcpip_client *selected;
+
+	switch (cmd_type) {
+	case AT_CMD_TYPE_SET_COMMAND:
+		if (at_params_valid_count_get(&at_param_list) < 2) {
+			return -EINVAL;
+		}
+		err = at_params_int_get(&at_param_list, 1, &handle);
+		if (err) {
+			return err;
+		}
+		if (handle < 0) {
+			return -EINVAL;
+		}
+		selected = client_find(handle);
+		if (selected == NULL) {
+			LOG_ERR("Socket %d not opened", handle);
+			return -EINVAL;
+		}
+		client = selected;
+		sprintf(rsp_buf, "#XSOCKETSELECT: %d\r\n", client->sock);
+		rsp_send(rsp_buf, strlen(rsp_buf));
+		break;
+
+	case AT_CMD_TYPE_READ_COMMAND:
+		for (int i = 0; i < ARRAY_SIZE(clients); i++) {
+			if (clients[i].sock == INVALID_SOCKET) {
+				continue;
+			}
+			sprintf(rsp_buf, "#XSOCKET: %d, %d, %d\r\n",
+				clients[i].sock, clients[i].ip_proto,
+				clients[i].role);
+			rsp_send(rsp_buf, strlen(rsp_buf));
+		}
+		sprintf(rsp_buf, "#XSOCKETSELECT: %d\r\n", client->sock);
+		rsp_send(rsp_buf, strlen(rsp_buf));
+		err = 0;
+		break;
+
+	default:
+		break;
+	}
+
+	return err;
+}
+
 /**@brief handle AT#XSOCKETOPT commands
  *  AT#XSOCKETOPT=<op>,<name>[,<value>]
  *  AT#XSOCKETOPT? READ command not supported
@@ -803,11 +879,11 @@ static int handle_at_socketopt(enum at_cmd_type cmd_type)
 
 	switch (cmd_type) {
 	case AT_CMD_TYPE_SET_COMMAND:
-		if (client.sock < 0) {
+		if (client->sock < 0) {
 			LOG_ERR("Socket not opened yet");
 			return err;
 		}
-		if (client.role != AT_SOCKET_ROLE_CLIENT) {
+		if (client->role != AT_SOCKET_ROLE_CLIENT) {
 			LOG_ERR("Invalid role");
 			return err;
 		}
@@ -861,7 +937,7 @@ static int handle_at_bind(enum at_cmd_type cmd_type)
 	int err = -EINVAL;
 	uint16_t port;
 
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("Socket not opened yet");
 		return err;
 	}
@@ -897,11 +973,11 @@ static int handle_at_connect(enum at_cmd_type cmd_type)
 	int size = TCPIP_MAX_URL;
 	uint16_t port;
 
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("Socket not opened yet");
 		return err;
 	}
-	if (client.role != AT_SOCKET_ROLE_CLIENT) {
+	if (client->role != AT_SOCKET_ROLE_CLIENT) {
 		LOG_ERR("Invalid role");
 		return err;
 	}
@@ -924,7 +1000,7 @@ static int handle_at_connect(enum at_cmd_type cmd_type)
 		break;
 
 	case AT_CMD_TYPE_READ_COMMAND:
-		if (client.connected) {
+		if (client->connected) {
 			sprintf(rsp_buf, "+XCONNECT: 1\r\n");
 		} else {
 			sprintf(rsp_buf, "+XCONNECT: 0\r\n");
@@ -949,16 +1025,16 @@ static int handle_at_listen(enum at_cmd_type cmd_type)
 {
 	int err = -EINVAL;
 
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("Socket not opened yet");
 		return err;
 	}
-	if (client.role != AT_SOCKET_ROLE_SERVER) {
+	if (client->role != AT_SOCKET_ROLE_SERVER) {
 		LOG_ERR("Invalid role");
 		return err;
 	}
-	if (client.ip_proto != IPPROTO_TCP &&
-		client.ip_proto != IPPROTO_TLS_1_2) {
+	if (client->ip_proto != IPPROTO_TCP &&
+		client->ip_proto != IPPROTO_TLS_1_2) {
 		LOG_ERR("Invalid protocol");
 		return err;
 	}
@@ -984,16 +1060,16 @@ static int handle_at_accept(enum at_cmd_type cmd_type)
 {
 	int err = -EINVAL;
 
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("Socket not opened yet");
 		return err;
 	}
-	if (client.role != AT_SOCKET_ROLE_SERVER) {
+	if (client->role != AT_SOCKET_ROLE_SERVER) {
 		LOG_ERR("Invalid role");
 		return err;
 	}
-	if (client.ip_proto != IPPROTO_TCP &&
-		client.ip_proto != IPPROTO_TLS_1_2) {
+	if (client->ip_proto != IPPROTO_TCP &&
+		client->ip_proto != IPPROTO_TLS_1_2) {
 		LOG_ERR("Invalid protocol");
 		return err;
 	}
@@ -1004,9 +1080,9 @@ static int handle_at_accept(enum at_cmd_type cmd_type)
 		break;
 
 	case AT_CMD_TYPE_READ_COMMAND:
-		if (client.sock_peer != INVALID_SOCKET) {
+		if (client->sock_peer != INVALID_SOCKET) {
 			sprintf(rsp_buf, "#XTCPACCEPT: %d\r\n",
-				client.sock_peer);
+				client->sock_peer);
 		} else {
 			sprintf(rsp_buf, "#XTCPACCEPT: 0\r\n");
 		}
@@ -1023,6 +1099,7 @@ static int handle_at_accept(enum at_cmd_type cmd_type)
 
 /**@brief handle AT#XSEND commands
  *  AT#XSEND=<datatype>,<data>
+ *  AT#XSEND=<datatype>,<length> for raw data
  *  AT#XSEND? READ command not supported
  *  AT#XSEND=? TEST command not supported
  */
@@ -1033,7 +1110,7 @@ static int handle_at_send(enum at_cmd_type cmd_type)
 	char data[NET_IPV4_MTU];
 	int size = NET_IPV4_MTU;
 
-	if (!client.connected) {
+	if (!client->connected) {
 		LOG_ERR("Not connected yet");
 		return err;
 	}
@@ -1047,6 +1124,15 @@ static int handle_at_send(enum at_cmd_type cmd_type)
 		if (err) {
 			return err;
 		}
+		if (datatype == DATATYPE_RAW) {
+			uint16_t length;
+
+			err = at_params_short_get(&at_param_list, 2, &length);
+			if (err) {
+				return err;
+			}
+			return slm_at_host_raw_recv(length, do_send);
+		}
 		err = at_params_string_get(&at_param_list, 2, data, &size);
 		if (err) {
 			return err;
@@ -1071,7 +1157,7 @@ static int handle_at_send(enum at_cmd_type cmd_type)
 }
 
 /**@brief handle AT#XRECV commands
- *  AT#XRECV[=<length>]
+ *  AT#XRECV[=<length>[,<datatype>]]
  *  AT#XRECV? READ command not supported
  *  AT#XRECV=? TEST command not supported
  */
@@ -1079,8 +1165,9 @@ static int handle_at_recv(enum at_cmd_type cmd_type)
 {
 	int err = -EINVAL;
 	uint16_t length = NET_IPV4_MTU;
+	uint16_t datatype = DATATYPE_PLAINTEXT;
 
-	if (!client.connected) {
+	if (!client->connected) {
 		LOG_ERR("Not connected yet");
 		return err;
 	}
@@ -1093,7 +1180,16 @@ static int handle_at_recv(enum at_cmd_type cmd_type)
 				return err;
 			}
 		}
-		err = do_recv(length);
+		if (at_params_valid_count_get(&at_param_list) > 2) {
+			err = at_params_short_get(&at_param_list, 2, &datatype);
+			if (err) {
+				return err;
+			}
+		}
+		if (length > NET_IPV4_MTU) {
+			return -EINVAL;
+		}
+		err = do_recv(length, datatype);
 		break;
 
 	default:
@@ -1117,12 +1213,12 @@ static int handle_at_sendto(enum at_cmd_type cmd_type)
 	char data[NET_IPV4_MTU];
 	int size;
 
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("Socket not opened yet");
 		return err;
 	}
-	if (client.ip_proto != IPPROTO_UDP &&
-		client.ip_proto != IPPROTO_DTLS_1_2) {
+	if (client->ip_proto != IPPROTO_UDP &&
+		client->ip_proto != IPPROTO_DTLS_1_2) {
 		LOG_ERR("Invalid protocol");
 		return err;
 	}
@@ -1180,12 +1276,12 @@ static int handle_at_recvfrom(enum at_cmd_type cmd_type)
 	int err = -EINVAL;
 	uint16_t length = NET_IPV4_MTU;
 
-	if (client.sock < 0) {
+	if (client->sock < 0) {
 		LOG_ERR("Socket not opened yet");
 		return err;
 	}
-	if (client.ip_proto != IPPROTO_UDP &&
-		client.ip_proto != IPPROTO_DTLS_1_2) {
+	if (client->ip_proto != IPPROTO_UDP &&
+		client->ip_proto != IPPROTO_DTLS_1_2) {
 		LOG_ERR("Invalid protocol");
 		return err;
 	}
@@ -1267,50 +1363,15 @@ static int handle_at_getaddrinfo(enum at_cmd_type cmd_type)
 	return err;
 }
 
-/**@brief API to handle TCP/IP AT commands
- */
-int slm_at_tcpip_parse(const char *at_cmd)
-{
-	int ret = -ENOENT;
-	enum at_cmd_type type;
-
-	for (int i = 0; i < AT_TCPIP_MAX; i++) {
-		if (slm_util_cmd_casecmp(at_cmd, tcpip_at_list[i].string)) {
-			ret = at_parser_params_from_str(at_cmd, NULL,
-						&at_param_list);
-			if (ret) {
-				LOG_ERR("Failed to parse AT command %d", ret);
-				return -EINVAL;
-			}
-			type = at_parser_cmd_type_get(at_cmd);
-			ret = tcpip_at_list[i].handler(type);
-			break;
-		}
-	}
-
-	return ret;
-}
-
-/**@brief API to list TCP/IP AT commands
- */
-void slm_at_tcpip_clac(void)
-{
-	for (int i = 0; i < AT_TCPIP_MAX; i++) {
-		sprintf(rsp_buf, "%s\r\n", tcpip_at_list[i].string);
-		rsp_send(rsp_buf, strlen(rsp_buf));
-	}
-}
-
 /**@brief API to initialize TCP/IP AT commands handler
  */
 int slm_at_tcpip_init(void)
 {
-	client.sock = INVALID_SOCKET;
-	client.sec_tag = INVALID_SEC_TAG;
-	client.role = AT_SOCKET_ROLE_CLIENT;
-	client.sock_peer = INVALID_SOCKET;
-	client.connected = false;
-	client.ip_proto = IPPROTO_IP;
+	for (int i = 0; i < ARRAY_SIZE(clients); i++) {
+		client_init(&clients[i]);
+	}
+	client = &clients[0];
+
 	return 0;
 }
 
@@ -1318,5 +1379,15 @@ int slm_at_tcpip_init(void)
  */
 int slm_at_tcpip_uninit(void)
 {
-	return do_socket_close(0);
+	int ret = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(clients); i++) {
+		if (clients[i].sock != INVALID_SOCKET) {
+			client = &clients[i];
+			ret = do_socket_close(0);
+		}
+	}
+	client = &clients[0];
+
+	return ret;
 }
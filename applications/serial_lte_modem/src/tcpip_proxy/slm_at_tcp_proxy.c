@@ -37,28 +37,17 @@ enum slm_tcp_proxy_role {
 	AT_TCP_ROLE_SERVER
 };
 
-/**@brief List of supported AT commands. */
-enum slm_tcp_proxy_at_cmd_type {
-	AT_TCP_SERVER,
-	AT_TCP_CLIENT,
-	AT_TCP_SEND,
-	AT_TCP_RECV,
-	AT_TCP_PROXY_MAX
-};
-
 /** forward declaration of cmd handlers **/
 static int handle_at_tcp_server(enum at_cmd_type cmd_type);
 static int handle_at_tcp_client(enum at_cmd_type cmd_type);
 static int handle_at_tcp_send(enum at_cmd_type cmd_type);
 static int handle_at_tcp_recv(enum at_cmd_type cmd_type);
 
-/**@brief SLM AT Command list type. */
-static slm_at_cmd_list_t tcp_proxy_at_list[AT_TCP_PROXY_MAX] = {
-	{AT_TCP_SERVER, "AT#XTCPSVR", handle_at_tcp_server},
-	{AT_TCP_CLIENT, "AT#XTCPCLI", handle_at_tcp_client},
-	{AT_TCP_SEND, "AT#XTCPSEND", handle_at_tcp_send},
-	{AT_TCP_RECV, "AT#XTCPRECV", handle_at_tcp_recv},
-};
+/**@brief Supported AT commands. */
+SLM_AT_CMD_DEFINE(tcp_server, "AT#XTCPSVR", handle_at_tcp_server);
+SLM_AT_CMD_DEFINE(tcp_client, "AT#XTCPCLI", handle_at_tcp_client);
+SLM_AT_CMD_DEFINE(tcp_send, "AT#XTCPSEND", handle_at_tcp_send);
+SLM_AT_CMD_DEFINE(tcp_recv, "AT#XTCPRECV", handle_at_tcp_recv);
 
 RING_BUF_DECLARE(data_buf, CONFIG_AT_CMD_RESPONSE_MAX_LEN / 2);
 static uint8_t data_hex[DATA_HEX_MAX_SIZE];
@@ -801,44 +790,15 @@ static int handle_at_tcp_recv(enum at_cmd_type cmd_type)
 	return err;
 }
 
-/**@brief API to handle TCP proxy AT commands
+/**@brief API to send data in TCP proxy data mode
  */
-int slm_at_tcp_proxy_parse(const char *at_cmd, uint16_t length)
+int slm_at_tcp_proxy_datamode_send(const uint8_t *data, uint16_t length)
 {
-	int ret = -ENOENT;
-	enum at_cmd_type type;
-
-	for (int i = 0; i < AT_TCP_PROXY_MAX; i++) {
-		if (slm_util_cmd_casecmp(at_cmd,
-			tcp_proxy_at_list[i].string)) {
-			ret = at_parser_params_from_str(at_cmd, NULL,
-						&at_param_list);
-			if (ret) {
-				LOG_ERR("Failed to parse AT command %d", ret);
-				return -EINVAL;
-			}
-			type = at_parser_cmd_type_get(at_cmd);
-			ret = tcp_proxy_at_list[i].handler(type);
-			break;
-		}
-	}
-
-	/* handle sending in data mode */
-	if (ret == -ENOENT && proxy.datamode) {
-		ret = do_tcp_send_datamode(at_cmd, length);
+	if (!proxy.datamode) {
+		return -ENOENT;
 	}
 
-	return ret;
-}
-
-/**@brief API to list TCP proxy AT commands
- */
-void slm_at_tcp_proxy_clac(void)
-{
-	for (int i = 0; i < AT_TCP_PROXY_MAX; i++) {
-		sprintf(rsp_buf, "%s\r\n", tcp_proxy_at_list[i].string);
-		rsp_send(rsp_buf, strlen(rsp_buf));
-	}
+	return do_tcp_send_datamode(data, length);
 }
 
 /**@brief API to initialize TCP proxy AT commands handler
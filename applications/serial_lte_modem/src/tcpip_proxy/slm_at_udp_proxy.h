@@ -17,22 +17,16 @@
 #include <modem/at_cmd.h>
 
 /**
- * @brief UDP proxy AT command parser.
+ * @brief Send data in UDP proxy data mode.
  *
- * @param at_cmd AT command or data string.
- * @param length AT command or data string length.
- *
- * @retval 0 If the operation was successful.
- *           Otherwise, negative error code means error.
- *           Otherwise, positive code means data is sent in data mode.
- */
-int slm_at_udp_proxy_parse(const char *at_cmd, uint16_t length);
-
-/**
- * @brief List UDP/IP AT commands.
+ * @param data Data received from the AT channel.
+ * @param length Length of the data.
  *
+ * @retval -ENOENT If data mode is not active.
+ *           Otherwise, a positive value means the data is sent,
+ *           a negative code means error.
  */
-void slm_at_udp_proxy_clac(void);
+int slm_at_udp_proxy_datamode_send(const uint8_t *data, uint16_t length);
 
 /**
  * @brief Initialize UDP proxy AT command parser.
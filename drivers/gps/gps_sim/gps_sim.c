@@ -47,6 +47,209 @@ struct gps_sim_data {
 	struct k_work_q work_q;
 };
 
+static void notify_event(const struct device *dev, struct gps_event *evt)
+{
+	struct gps_sim_data *drv_data = dev->data;
+
+	if (drv_data->handler) {
+		drv_data->handler(dev, evt);
+	}
+}
+
+#if defined(CONFIG_GPS_SIM_TRACE)
+/* Longest trace line, including the terminating null character */
+#define TRACE_LINE_MAX (GPS_NMEA_SENTENCE_MAX_LENGTH + 16)
+/* Number of values in a PVT record */
+#define TRACE_PVT_VALUES 6
+
+static const char trace[] = {
+#include <gps_sim_trace.inc>
+};
+
+struct trace_record {
+	/* Trace time, in milliseconds */
+	uint32_t time;
+	struct gps_event evt;
+};
+
+static struct {
+	/* Offset of the line after the next record */
+	size_t pos;
+	/* Number of times the trace was restarted */
+	uint32_t passes;
+	struct trace_record next;
+	bool next_valid;
+} replay;
+
+/**
+ * @brief Parses a trace line.
+ *
+ * @param line Null-terminated line.
+ * @param rec Pointer to the record to store the parsed line.
+ *
+ * @return true if the line is a valid record.
+ */
+static bool trace_line_parse(const char *line, struct trace_record *rec)
+{
+	double val[TRACE_PVT_VALUES];
+	const char *field;
+	char *end;
+	size_t len;
+
+	rec->time = strtoul(line, &end, 10);
+	if ((end == line) || (*end != ',')) {
+		return false;
+	}
+
+	field = end + 1;
+	len = strcspn(field, "\r");
+
+	if (field[0] == '$') {
+		if (len >= GPS_NMEA_SENTENCE_MAX_LENGTH) {
+			return false;
+		}
+
+		rec->evt.type = GPS_EVT_NMEA_FIX;
+		memcpy(rec->evt.nmea.buf, field, len);
+		rec->evt.nmea.buf[len] = '\0';
+		rec->evt.nmea.len = len;
+
+		return true;
+	}
+
+	if (strncmp(field, "PVT", 3) != 0) {
+		return false;
+	}
+
+	field += 3;
+	for (size_t i = 0; i < ARRAY_SIZE(val); i++) {
+		if (*field != ',') {
+			return false;
+		}
+		field++;
+		val[i] = strtod(field, &end);
+		if (end == field) {
+			return false;
+		}
+		field = end;
+	}
+
+	if ((*field != '\0') && (*field != '\r')) {
+		return false;
+	}
+
+	memset(&rec->evt, 0, sizeof(rec->evt));
+	rec->evt.type = GPS_EVT_PVT_FIX;
+	rec->evt.pvt.latitude = val[0];
+	rec->evt.pvt.longitude = val[1];
+	rec->evt.pvt.altitude = val[2];
+	rec->evt.pvt.accuracy = val[3];
+	rec->evt.pvt.speed = val[4];
+	rec->evt.pvt.heading = val[5];
+
+	return true;
+}
+
+/**
+ * @brief Reads the next valid record from the trace.
+ *
+ * @param rec Pointer to the record to store the data.
+ *
+ * @return true if a record was read, false at the end of the trace.
+ */
+static bool trace_record_read(struct trace_record *rec)
+{
+	char line[TRACE_LINE_MAX];
+
+	while (replay.pos < sizeof(trace)) {
+		const char *start = &trace[replay.pos];
+		size_t left = sizeof(trace) - replay.pos;
+		const char *eol = memchr(start, '\n', left);
+		size_t len = (eol != NULL) ? (size_t)(eol - start) : left;
+
+		replay.pos += len + 1;
+
+		if ((len == 0) || (*start == '#') || (*start == '\r')) {
+			continue;
+		}
+
+		if (len >= sizeof(line)) {
+			if (replay.passes == 0) {
+				LOG_WRN("Trace line too long, skipped");
+			}
+			continue;
+		}
+
+		memcpy(line, start, len);
+		line[len] = '\0';
+
+		if (trace_line_parse(line, rec)) {
+			return true;
+		}
+
+		if (replay.passes == 0) {
+			LOG_WRN("Invalid trace line: %s", log_strdup(line));
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Loads the record after the current one, restarting the trace
+ * at the end if enabled.
+ */
+static void trace_next_load(void)
+{
+	replay.next_valid = trace_record_read(&replay.next);
+	if (replay.next_valid || !IS_ENABLED(CONFIG_GPS_SIM_TRACE_LOOP)) {
+		return;
+	}
+
+	replay.pos = 0;
+	replay.passes++;
+	replay.next_valid = trace_record_read(&replay.next);
+}
+
+/**
+ * @brief Reports the next fix of the trace.
+ *
+ * @param drv_data Pointer to the driver data.
+ *
+ * @return Time until the following fix is due, at least 1 ms so that the
+ *	   work queue is not kept busy.
+ */
+static k_timeout_t trace_fix_notify(struct gps_sim_data *drv_data)
+{
+	uint32_t time = replay.next.time;
+	uint32_t delta;
+
+	notify_event(drv_data->dev, &replay.next.evt);
+	trace_next_load();
+
+	if (!replay.next_valid || (CONFIG_GPS_SIM_TRACE_SPEED == 0)) {
+		return K_MSEC(1);
+	}
+
+	/* The times of a new pass start from the beginning of the trace */
+	delta = (replay.next.time >= time) ?
+		(replay.next.time - time) : replay.next.time;
+
+	return K_MSEC(MAX((int64_t)delta * 100 / CONFIG_GPS_SIM_TRACE_SPEED,
+			  1));
+}
+
+static int trace_init(void)
+{
+	replay.next_valid = trace_record_read(&replay.next);
+	if (!replay.next_valid) {
+		LOG_ERR("No valid records in the GPS trace");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+#else
 /**
  * @brief Calculates NMEA sentence checksum
  *
@@ -188,15 +391,7 @@ static void generate_gps_data(struct gps_nmea *gps_data,
 
 	LOG_DBG("%s (%d bytes)", log_strdup(gps_data->buf), gps_data->len);
 }
-
-static void notify_event(const struct device *dev, struct gps_event *evt)
-{
-	struct gps_sim_data *drv_data = dev->data;
-
-	if (drv_data->handler) {
-		drv_data->handler(dev, evt);
-	}
-}
+#endif /* CONFIG_GPS_SIM_TRACE */
 
 static void start_work_fn(struct k_work *work)
 {
@@ -269,14 +464,26 @@ static void fix_work_fn(struct k_work *work)
 {
 	struct gps_sim_data *drv_data =
 		CONTAINER_OF(work, struct gps_sim_data, fix_work);
-	struct gps_event evt = {
-		.type = GPS_EVT_NMEA_FIX,
-	};
+	k_timeout_t fix_delay;
 
 	if (drv_data->state != GPS_SIM_ACTIVE_SEARCH) {
 		return;
 	}
 
+#if defined(CONFIG_GPS_SIM_TRACE)
+	/* At the end of the trace, let the search time out */
+	if (!replay.next_valid) {
+		return;
+	}
+
+	k_delayed_work_cancel(&drv_data->timeout_work);
+
+	fix_delay = trace_fix_notify(drv_data);
+#else
+	struct gps_event evt = {
+		.type = GPS_EVT_NMEA_FIX,
+	};
+
 	k_delayed_work_cancel(&drv_data->timeout_work);
 
 	generate_gps_data(&drv_data->nmea_sample,
@@ -288,10 +495,13 @@ static void fix_work_fn(struct k_work *work)
 	       drv_data->nmea_sample.len);
 	notify_event(drv_data->dev, &evt);
 
+	fix_delay = K_MSEC(CONFIG_GPS_SIM_FIX_TIME);
+#endif
+
 	if (drv_data->cfg.nav_mode == GPS_NAV_MODE_CONTINUOUS) {
 		k_delayed_work_submit_to_queue(&drv_data->work_q,
 					       &drv_data->fix_work,
-					       K_MSEC(CONFIG_GPS_SIM_FIX_TIME));
+					       fix_delay);
 	} else if (drv_data->cfg.nav_mode == GPS_NAV_MODE_SINGLE_FIX) {
 		drv_data->state = GPS_SIM_IDLE;
 		k_delayed_work_submit_to_queue(&drv_data->work_q,
@@ -376,6 +586,14 @@ static int gps_sim_setup(const struct device *dev)
 {
 	struct gps_sim_data *drv_data = dev->data;
 
+#if defined(CONFIG_GPS_SIM_TRACE)
+	int err = trace_init();
+
+	if (err) {
+		return err;
+	}
+#endif
+
 	drv_data->dev = dev;
 	drv_data->state = GPS_SIM_UNINIT;
 
@@ -7,6 +7,7 @@
 #include <zephyr.h>
 #include <drivers/gpio.h>
 #include <drivers/gps.h>
+#include <drivers/gps/nrf9160_gps.h>
 #include <init.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -44,6 +45,25 @@ LOG_MODULE_REGISTER(nrf9160_gps, CONFIG_NRF9160_GPS_LOG_LEVEL);
 
 #define GPS_BLOCKED_TIMEOUT CONFIG_NRF9160_GPS_PRIORITY_WINDOW_TIMEOUT_SEC
 
+#ifdef CONFIG_NRF9160_GPS_EVT_QUEUE
+#define EVT_QUEUE_LEN CONFIG_NRF9160_GPS_EVT_QUEUE_LENGTH
+
+BUILD_ASSERT((EVT_QUEUE_LEN & (EVT_QUEUE_LEN - 1)) == 0,
+	     "The event queue length must be a power of two");
+
+/* Single-producer, single-consumer ring of PVT and NMEA events. The GPS
+ * thread advances the tail, the event work advances the head. The indices
+ * are free-running and wrap at the ring size when used.
+ */
+struct evt_queue {
+	struct gps_event evts[EVT_QUEUE_LEN];
+	atomic_t head;
+	atomic_t tail;
+	struct k_work work;
+	struct nrf9160_gps_evt_stats stats;
+};
+#endif
+
 struct gps_drv_data {
 	const struct device *dev;
 	gps_event_handler_t handler;
@@ -61,6 +81,9 @@ struct gps_drv_data {
 	struct k_delayed_work stop_work;
 	struct k_delayed_work timeout_work;
 	struct k_delayed_work blocked_work;
+#ifdef CONFIG_NRF9160_GPS_EVT_QUEUE
+	struct evt_queue evt_queue;
+#endif
 };
 
 struct nrf9160_gps_config {
@@ -184,6 +207,111 @@ static void notify_event(const struct device *dev, struct gps_event *evt)
 	}
 }
 
+#ifdef CONFIG_NRF9160_GPS_EVT_QUEUE
+static bool evt_queue_get(struct evt_queue *queue, struct gps_event *evt)
+{
+	atomic_val_t head;
+
+	/* In latest only mode, the GPS thread can overwrite the event while
+	 * it is copied. It then advances the head, and the copy is retried.
+	 */
+	do {
+		head = atomic_get(&queue->head);
+		if (head == atomic_get(&queue->tail)) {
+			return false;
+		}
+
+		*evt = queue->evts[head & (EVT_QUEUE_LEN - 1)];
+	} while (!atomic_cas(&queue->head, head, head + 1));
+
+	return true;
+}
+
+static void evt_work_fn(struct k_work *work)
+{
+	struct evt_queue *queue =
+		CONTAINER_OF(work, struct evt_queue, work);
+	struct gps_drv_data *drv_data =
+		CONTAINER_OF(queue, struct gps_drv_data, evt_queue);
+	struct gps_event evt;
+	uint32_t count = 0;
+
+	while (evt_queue_get(queue, &evt)) {
+		notify_event(drv_data->dev, &evt);
+		count++;
+	}
+
+	if (count == 0) {
+		return;
+	}
+
+	queue->stats.delivered += count;
+	queue->stats.batches++;
+	queue->stats.batch_max = MAX(queue->stats.batch_max, count);
+}
+
+/**@brief Queues a PVT or NMEA event. Called from the GPS thread only. */
+static void evt_queue_put(struct gps_drv_data *drv_data,
+			  const struct gps_event *evt)
+{
+	struct evt_queue *queue = &drv_data->evt_queue;
+	atomic_val_t tail = atomic_get(&queue->tail);
+	atomic_val_t head = atomic_get(&queue->head);
+
+	if ((uint32_t)(tail - head) >= EVT_QUEUE_LEN) {
+		if (!IS_ENABLED(CONFIG_NRF9160_GPS_EVT_QUEUE_LATEST_ONLY)) {
+			LOG_DBG("Event queue full, event dropped");
+			queue->stats.dropped++;
+			return;
+		}
+
+		/* Overwrite the oldest event. If the event work took it
+		 * in the meantime, there is room and nothing is lost.
+		 */
+		if (atomic_cas(&queue->head, head, head + 1)) {
+			queue->stats.dropped++;
+		}
+	}
+
+	queue->evts[tail & (EVT_QUEUE_LEN - 1)] = *evt;
+	atomic_set(&queue->tail, tail + 1);
+	queue->stats.queued++;
+
+	k_work_submit(&queue->work);
+}
+
+int nrf9160_gps_evt_stats_get(const struct device *dev,
+			      struct nrf9160_gps_evt_stats *stats)
+{
+	struct gps_drv_data *drv_data = dev->data;
+
+	if (stats == NULL) {
+		return -EINVAL;
+	}
+
+	*stats = drv_data->evt_queue.stats;
+
+	return 0;
+}
+#else
+int nrf9160_gps_evt_stats_get(const struct device *dev,
+			      struct nrf9160_gps_evt_stats *stats)
+{
+	return -ENOTSUP;
+}
+#endif /* CONFIG_NRF9160_GPS_EVT_QUEUE */
+
+/**@brief Passes a PVT or NMEA event to the event handler. */
+static void notify_data_event(const struct device *dev,
+			      struct gps_event *evt)
+{
+#ifdef CONFIG_NRF9160_GPS_EVT_QUEUE
+	evt_queue_put(dev->data, evt);
+#else
+	notify_event(dev, evt);
+#endif
+}
+
 static int open_socket(struct gps_drv_data *drv_data)
 {
 	drv_data->socket = nrf_socket(NRF_AF_LOCAL, NRF_SOCK_DGRAM,
@@ -387,7 +515,7 @@ wait:
 				evt.type = GPS_EVT_PVT;
 			}
 
-			notify_event(dev, &evt);
+			notify_data_event(dev, &evt);
 			print_satellite_stats(&raw_gps_data);
 
 			break;
@@ -409,7 +537,7 @@ wait:
 				evt.type = GPS_EVT_NMEA;
 			}
 
-			notify_event(dev, &evt);
+			notify_data_event(dev, &evt);
 			break;
 		case NRF_GNSS_AGPS_DATA_ID:
 			LOG_DBG("A-GPS data update needed");
@@ -896,6 +1024,9 @@ static int init(const struct device *dev, gps_event_handler_t handler)
 	k_delayed_work_init(&drv_data->stop_work, stop_work_fn);
 	k_delayed_work_init(&drv_data->timeout_work, timeout_work_fn);
 	k_delayed_work_init(&drv_data->blocked_work, blocked_work_fn);
+#ifdef CONFIG_NRF9160_GPS_EVT_QUEUE
+	k_work_init(&drv_data->evt_queue.work, evt_work_fn);
+#endif
 	k_sem_init(&drv_data->thread_run_sem, 0, 1);
 
 	err = init_thread(dev);
@@ -9,6 +9,7 @@
 #include <drivers/sensor.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <logging/log.h>
 
 #include "sensor_sim.h"
@@ -45,6 +46,308 @@ static void double_to_sensor_value(double val,
 	sense_val->val2 = (val - (int)val) * 1000000;
 }
 
+#if defined(CONFIG_SENSOR_SIM_TRACE)
+/* Longest trace line, including the terminating null character */
+#define TRACE_LINE_MAX 96
+
+static const char trace[] = {
+#include <sensor_sim_trace.inc>
+};
+
+struct trace_record {
+	/* Trace time, in milliseconds */
+	uint32_t time;
+	enum sensor_channel chan;
+	double val[3];
+};
+
+static const struct {
+	const char *name;
+	enum sensor_channel chan;
+	uint8_t count;
+} trace_channels[] = {
+	{ "accel", SENSOR_CHAN_ACCEL_XYZ, 3 },
+	{ "temp", SENSOR_CHAN_AMBIENT_TEMP, 1 },
+	{ "humidity", SENSOR_CHAN_HUMIDITY, 1 },
+	{ "press", SENSOR_CHAN_PRESS, 1 },
+};
+
+static struct {
+	struct k_mutex lock;
+	/* Offset of the line after the next record */
+	size_t pos;
+	/* Uptime at trace time 0 of the current pass */
+	int64_t start;
+	/* Number of times the trace was restarted */
+	uint32_t passes;
+	struct trace_record next;
+	bool next_valid;
+} replay;
+
+/*
+ * @brief Parses a trace line.
+ *
+ * @param line Null-terminated line.
+ * @param rec Pointer to the record to store the parsed line.
+ *
+ * @return true if the line is a valid record.
+ */
+static bool trace_line_parse(const char *line, struct trace_record *rec)
+{
+	const char *field;
+	char *end;
+	size_t i;
+
+	rec->time = strtoul(line, &end, 10);
+	if ((end == line) || (*end != ',')) {
+		return false;
+	}
+
+	field = end + 1;
+	for (i = 0; i < ARRAY_SIZE(trace_channels); i++) {
+		size_t len = strlen(trace_channels[i].name);
+
+		if ((strncmp(field, trace_channels[i].name, len) == 0) &&
+		    (field[len] == ',')) {
+			field += len;
+			break;
+		}
+	}
+
+	if (i == ARRAY_SIZE(trace_channels)) {
+		return false;
+	}
+
+	rec->chan = trace_channels[i].chan;
+	for (uint8_t j = 0; j < trace_channels[i].count; j++) {
+		if (*field != ',') {
+			return false;
+		}
+		field++;
+		rec->val[j] = strtod(field, &end);
+		if (end == field) {
+			return false;
+		}
+		field = end;
+	}
+
+	return (*field == '\0') || (*field == '\r');
+}
+
+/*
+ * @brief Reads the next valid record from the trace.
+ *
+ * @param rec Pointer to the record to store the data.
+ *
+ * @return true if a record was read, false at the end of the trace.
+ */
+static bool trace_record_read(struct trace_record *rec)
+{
+	char line[TRACE_LINE_MAX];
+
+	while (replay.pos < sizeof(trace)) {
+		const char *start = &trace[replay.pos];
+		size_t left = sizeof(trace) - replay.pos;
+		const char *eol = memchr(start, '\n', left);
+		size_t len = (eol != NULL) ? (size_t)(eol - start) : left;
+
+		replay.pos += len + 1;
+
+		if ((len == 0) || (*start == '#') || (*start == '\r')) {
+			continue;
+		}
+
+		if (len >= sizeof(line)) {
+			if (replay.passes == 0) {
+				LOG_WRN("Trace line too long, skipped");
+			}
+			continue;
+		}
+
+		memcpy(line, start, len);
+		line[len] = '\0';
+
+		if (trace_line_parse(line, rec)) {
+			return true;
+		}
+
+		if (replay.passes == 0) {
+			LOG_WRN("Invalid trace line: %s", log_strdup(line));
+		}
+	}
+
+	return false;
+}
+
+/*
+ * @brief Converts trace time to uptime. Not used when stepping through
+ * the records.
+ *
+ * @param time Trace time, in milliseconds.
+ */
+static int64_t trace_uptime_get(uint32_t time)
+{
+	return replay.start +
+	       (int64_t)time * 100 / MAX(CONFIG_SENSOR_SIM_TRACE_SPEED, 1);
+}
+
+/*
+ * @brief Loads the record after the current one, restarting the trace
+ * at the end if enabled.
+ */
+static void trace_next_load(void)
+{
+	uint32_t pass_time = replay.next.time;
+
+	replay.next_valid = trace_record_read(&replay.next);
+	if (replay.next_valid || !IS_ENABLED(CONFIG_SENSOR_SIM_TRACE_LOOP)) {
+		return;
+	}
+
+	replay.pos = 0;
+	replay.passes++;
+	if (CONFIG_SENSOR_SIM_TRACE_SPEED > 0) {
+		/* A pass takes at least 1 ms, also if all records have the
+		 * same time.
+		 */
+		replay.start = MAX(trace_uptime_get(pass_time),
+				   replay.start + 1);
+	}
+
+	replay.next_valid = trace_record_read(&replay.next);
+}
+
+static void trace_record_apply(const struct trace_record *rec)
+{
+	switch (rec->chan) {
+	case SENSOR_CHAN_ACCEL_XYZ:
+		memcpy(accel_samples, rec->val, sizeof(accel_samples));
+		break;
+	case SENSOR_CHAN_AMBIENT_TEMP:
+		temp_sample = rec->val[0];
+		break;
+	case SENSOR_CHAN_HUMIDITY:
+		humidity_sample = rec->val[0];
+		break;
+	case SENSOR_CHAN_PRESS:
+		pressure_sample = rec->val[0];
+		break;
+	default:
+		break;
+	}
+}
+
+static bool trace_chan_match(enum sensor_channel rec_chan,
+			     enum sensor_channel chan)
+{
+	if (rec_chan == SENSOR_CHAN_ACCEL_XYZ) {
+		return (chan == SENSOR_CHAN_ACCEL_X) ||
+		       (chan == SENSOR_CHAN_ACCEL_Y) ||
+		       (chan == SENSOR_CHAN_ACCEL_Z) ||
+		       (chan == SENSOR_CHAN_ACCEL_XYZ);
+	}
+
+	return rec_chan == chan;
+}
+
+/*
+ * @brief Applies the records that are due at the current trace time, up to
+ * the end of the current pass.
+ */
+static void trace_advance(void)
+{
+	int64_t now = k_uptime_get();
+	uint32_t passes;
+
+	k_mutex_lock(&replay.lock, K_FOREVER);
+
+	passes = replay.passes;
+	while (replay.next_valid && (replay.passes == passes) &&
+	       (trace_uptime_get(replay.next.time) <= now)) {
+		trace_record_apply(&replay.next);
+		trace_next_load();
+	}
+
+	k_mutex_unlock(&replay.lock);
+}
+
+/*
+ * @brief Applies the records up to and including the next record
+ * of a channel, or at most one pass of the trace.
+ *
+ * @param chan Channel that is fetched.
+ */
+static void trace_step(enum sensor_channel chan)
+{
+	uint32_t passes;
+
+	k_mutex_lock(&replay.lock, K_FOREVER);
+
+	passes = replay.passes;
+	while (replay.next_valid && (replay.passes - passes) <= 1) {
+		bool match = trace_chan_match(replay.next.chan, chan);
+
+		trace_record_apply(&replay.next);
+		trace_next_load();
+
+		if (match) {
+			break;
+		}
+	}
+
+	k_mutex_unlock(&replay.lock);
+}
+
+#if defined(CONFIG_SENSOR_SIM_TRIGGER_USE_TIMER)
+/*
+ * @brief Gets the time until the next record is due.
+ */
+static k_timeout_t trace_trigger_timeout(void)
+{
+	int64_t due;
+
+	if (CONFIG_SENSOR_SIM_TRACE_SPEED == 0) {
+		return K_MSEC(CONFIG_SENSOR_SIM_TRIGGER_TIMER_MSEC);
+	}
+
+	k_mutex_lock(&replay.lock, K_FOREVER);
+
+	if (!replay.next_valid) {
+		k_mutex_unlock(&replay.lock);
+		return K_FOREVER;
+	}
+
+	due = trace_uptime_get(replay.next.time);
+
+	k_mutex_unlock(&replay.lock);
+
+	return K_MSEC(MAX(due - k_uptime_get(), 1));
+}
+#endif /* CONFIG_SENSOR_SIM_TRIGGER_USE_TIMER */
+
+static int trace_init(void)
+{
+	k_mutex_init(&replay.lock);
+
+	accel_samples[0] = base_accel_samples[0];
+	accel_samples[1] = base_accel_samples[1];
+	accel_samples[2] = base_accel_samples[2];
+	temp_sample = base_temp_sample;
+	humidity_sample = base_humidity_sample;
+	pressure_sample = base_pressure_sample;
+
+	replay.next_valid = trace_record_read(&replay.next);
+	if (!replay.next_valid) {
+		LOG_ERR("No valid records in the sensor trace");
+		return -EINVAL;
+	}
+
+	replay.start = k_uptime_get();
+
+	return 0;
+}
+#endif /* CONFIG_SENSOR_SIM_TRACE */
+
 #if defined(CONFIG_SENSOR_SIM_TRIGGER_USE_BUTTON)
 /*
  * @brief Callback for GPIO when using button as trigger.
@@ -77,11 +380,20 @@ static void sensor_sim_thread(int dev_ptr)
 	struct sensor_sim_data *drv_data = dev->data;
 
 	while (true) {
+#if defined(CONFIG_SENSOR_SIM_TRACE) && \
+	defined(CONFIG_SENSOR_SIM_TRIGGER_USE_TIMER)
+		/* Signal data ready when the next record of the trace is due */
+		k_sleep(trace_trigger_timeout());
+		if (CONFIG_SENSOR_SIM_TRACE_SPEED > 0) {
+			trace_advance();
+		}
+#else
 		if (IS_ENABLED(CONFIG_SENSOR_SIM_TRIGGER_USE_TIMER)) {
 			k_sleep(K_MSEC(CONFIG_SENSOR_SIM_TRIGGER_TIMER_MSEC));
 		} else if (IS_ENABLED(CONFIG_SENSOR_SIM_TRIGGER_USE_BUTTON)) {
 			k_sem_take(&drv_data->gpio_sem, K_FOREVER);
 		}
+#endif
 
 		if (drv_data->drdy_handler != NULL) {
 			drv_data->drdy_handler(dev, &drv_data->drdy_trigger);
@@ -177,6 +489,13 @@ static int sensor_sim_trigger_set(const struct device *dev,
  */
 static int sensor_sim_init(const struct device *dev)
 {
+#if defined(CONFIG_SENSOR_SIM_TRACE)
+	int err = trace_init();
+
+	if (err) {
+		return err;
+	}
+#endif
 #if defined(CONFIG_SENSOR_SIM_TRIGGER)
 #if defined(CONFIG_SENSOR_SIM_TRIGGER_USE_BUTTON)
 	struct sensor_sim_data *drv_data = dev->data;
@@ -194,6 +513,7 @@ static int sensor_sim_init(const struct device *dev)
 	return 0;
 }
 
+#if !defined(CONFIG_SENSOR_SIM_TRACE)
 /**
  * @brief Generates a pseudo-random number between -1 and 1.
  */
@@ -341,6 +661,7 @@ static int sensor_sim_generate_data(enum sensor_channel chan)
 
 	return 0;
 }
+#endif /* !CONFIG_SENSOR_SIM_TRACE */
 
 static int sensor_sim_attr_set(const struct device *dev,
 		enum sensor_channel chan,
@@ -353,7 +674,30 @@ static int sensor_sim_attr_set(const struct device *dev,
 static int sensor_sim_sample_fetch(const struct device *dev,
 				enum sensor_channel chan)
 {
+#if defined(CONFIG_SENSOR_SIM_TRACE)
+	switch (chan) {
+	case SENSOR_CHAN_ACCEL_X:
+	case SENSOR_CHAN_ACCEL_Y:
+	case SENSOR_CHAN_ACCEL_Z:
+	case SENSOR_CHAN_ACCEL_XYZ:
+	case SENSOR_CHAN_AMBIENT_TEMP:
+	case SENSOR_CHAN_HUMIDITY:
+	case SENSOR_CHAN_PRESS:
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (CONFIG_SENSOR_SIM_TRACE_SPEED == 0) {
+		trace_step(chan);
+	} else {
+		trace_advance();
+	}
+
+	return 0;
+#else
 	return sensor_sim_generate_data(chan);
+#endif
 }
 
 static int sensor_sim_channel_get(const struct device *dev,
@@ -11,11 +11,121 @@
 
 static cJSON_Hooks _cjson_hooks;
 
+#if defined(CONFIG_CJSON_ARENA)
+/* cJSON items hold a double */
+#define ARENA_ALIGN 8
+
+static uint8_t arena_buf[CONFIG_CJSON_ARENA_SIZE] __aligned(ARENA_ALIGN);
+static K_MUTEX_DEFINE(arena_lock);
+
+static struct {
+	/* Thread that owns the current scope, NULL outside a scope */
+	k_tid_t owner;
+	int depth;
+	size_t top;
+	/* Most recent allocation, which can be given back when freed */
+	void *last;
+	struct cjson_arena_stats stats;
+} arena;
+
+static void *arena_alloc(size_t sz)
+{
+	size_t len = ROUND_UP(sz, ARENA_ALIGN);
+	void *ptr;
+
+	/* Only the owner changes the arena, other threads use the heap */
+	if (arena.owner != k_current_get()) {
+		return NULL;
+	}
+
+	if (len > sizeof(arena_buf) - arena.top) {
+		arena.stats.fallbacks++;
+		arena.stats.fallback_bytes += sz;
+		return NULL;
+	}
+
+	ptr = &arena_buf[arena.top];
+	arena.top += len;
+	arena.last = ptr;
+	arena.stats.peak = MAX(arena.stats.peak, arena.top);
+
+	return ptr;
+}
+
+static bool arena_free(void *ptr)
+{
+	uint8_t *p = ptr;
+
+	if (p < arena_buf || p >= arena_buf + sizeof(arena_buf)) {
+		return false;
+	}
+
+	/* The rest is released when the scope ends */
+	if (ptr == arena.last) {
+		arena.top = p - arena_buf;
+		arena.last = NULL;
+	}
+
+	return true;
+}
+
+void cJSON_ArenaBegin(void)
+{
+	k_mutex_lock(&arena_lock, K_FOREVER);
+
+	if (arena.depth++ == 0) {
+		arena.owner = k_current_get();
+		arena.top = 0;
+		arena.last = NULL;
+	}
+}
+
+void cJSON_ArenaEnd(void)
+{
+	__ASSERT(arena.depth > 0, "cJSON_ArenaEnd() without cJSON_ArenaBegin()");
+
+	if (--arena.depth == 0) {
+		arena.owner = NULL;
+		arena.top = 0;
+		arena.last = NULL;
+		arena.stats.documents++;
+	}
+
+	k_mutex_unlock(&arena_lock);
+}
+
+void cJSON_ArenaStatsGet(struct cjson_arena_stats *stats)
+{
+	k_mutex_lock(&arena_lock, K_FOREVER);
+	*stats = arena.stats;
+	stats->size = sizeof(arena_buf);
+	k_mutex_unlock(&arena_lock);
+}
+#endif /* CONFIG_CJSON_ARENA */
+
 /**@brief malloc() function definition. */
-static void *malloc_fn_hook(size_t sz) { return k_malloc(sz); }
+static void *malloc_fn_hook(size_t sz)
+{
+#if defined(CONFIG_CJSON_ARENA)
+	void *ptr = arena_alloc(sz);
+
+	if (ptr != NULL) {
+		return ptr;
+	}
+#endif
+	return k_malloc(sz);
+}
 
 /**@brief free() function definition. */
-static void free_fn_hook(void *p_ptr) { k_free(p_ptr); }
+static void free_fn_hook(void *p_ptr)
+{
+#if defined(CONFIG_CJSON_ARENA)
+	if (arena_free(p_ptr)) {
+		return;
+	}
+#endif
+	k_free(p_ptr);
+}
 
 /**@brief Initialize cJSON by assigning function hooks. */
 void cJSON_Init(void)
@@ -8,6 +8,7 @@
 #define cJSON_OS_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * @brief Initialize cJSON with OS hooks.
@@ -21,4 +22,50 @@ void cJSON_Init(void);
  */
 void cJSON_FreeString(char *ptr);
 
+/** @brief cJSON arena usage, for sizing CONFIG_CJSON_ARENA_SIZE. */
+struct cjson_arena_stats {
+	/* Size of the arena */
+	size_t size;
+	/* Highest arena usage */
+	size_t peak;
+	/* Completed arena scopes */
+	uint32_t documents;
+	/* Allocations that did not fit and were taken from the heap */
+	uint32_t fallbacks;
+	size_t fallback_bytes;
+};
+
+#if defined(CONFIG_CJSON_ARENA)
+/**
+ * @brief Begin a document scope.
+ *
+ * Until @ref cJSON_ArenaEnd, cJSON allocations made by the calling thread
+ * come from the arena, and freeing them is a no-op. Other threads wait in
+ * this function until the scope ends. Scopes can be nested in the same
+ * thread.
+ *
+ * Nothing allocated by cJSON in the scope, including printed strings,
+ * may be used after the scope ends.
+ */
+void cJSON_ArenaBegin(void);
+
+/**
+ * @brief End a document scope and release all arena allocations made in it.
+ */
+void cJSON_ArenaEnd(void);
+
+/**
+ * @brief Get the arena usage.
+ * @param stats OUT -- arena usage
+ */
+void cJSON_ArenaStatsGet(struct cjson_arena_stats *stats);
+#else
+static inline void cJSON_ArenaBegin(void) {}
+static inline void cJSON_ArenaEnd(void) {}
+static inline void cJSON_ArenaStatsGet(struct cjson_arena_stats *stats)
+{
+	*stats = (struct cjson_arena_stats){ 0 };
+}
+#endif /* CONFIG_CJSON_ARENA */
+
 #endif /* cJSON_OS_H__ */
@@ -22,6 +22,10 @@ extern "C" {
 
 #define DFU_TARGET_IMAGE_TYPE_MCUBOOT 1
 #define DFU_TARGET_IMAGE_TYPE_MODEM_DELTA 2
+#define DFU_TARGET_IMAGE_TYPE_MCUBOOT_DELTA 3
+
+/** Length of the SHA-256 digest given to dfu_target_hash_set(). */
+#define DFU_TARGET_HASH_LEN 32
 
 enum dfu_target_evt_id {
 	DFU_TARGET_EVT_TIMEOUT,
@@ -62,6 +66,10 @@ int dfu_target_img_type(const void *const buf, size_t len);
  *
  *	  To allow continuation of an aborted DFU procedure, call the
  *	  'dfu_target_offset_get' function after invoking this function.
+ *	  The offset can be non-zero also for a new download, when the target
+ *	  has stored data from an earlier one, like the modem target does.
+ *	  The data before the offset must then not be written again: continue
+ *	  the download from the offset, or skip the data before it.
  *
  * @param[in] img_type Image type identifier.
  * @param[in] file_size Size of the current file being downloaded.
@@ -90,8 +98,15 @@ int dfu_target_offset_get(size_t *offset);
  *		  image.
  * @param[in] len The length of the provided buffer.
  *
- * @return Positive identifier for a supported image type or a negative error
- *	   code identicating reason of failure.
+ * @retval -EAGAIN if the target expects data from another offset, for
+ *		   example after the modem rejected data it had already
+ *		   stored. The data is not written and the target stays
+ *		   initialized. Get the expected offset with
+ *		   dfu_target_offset_get() and write the data from that offset
+ *		   on. A caller that cannot download from that offset must
+ *		   abort with dfu_target_done() or dfu_target_reset().
+ * @return 0 on success or a negative error code identicating reason of
+ *	   failure.
  **/
 int dfu_target_write(const void *const buf, size_t len);
 
@@ -99,14 +114,39 @@ int dfu_target_write(const void *const buf, size_t len);
  * @brief Deinitialize the resources that were needed for the current DFU
  *	  target.
  *
+ *	  If an expected hash was set with dfu_target_hash_set(), it is
+ *	  compared with the hash of the written data before the target is
+ *	  finalized. If they differ, the target is aborted.
+ *
  * @param[in] successful Indicate whether the process completed successfully or
  *			 was aborted.
  *
+ * @retval -EBADMSG if the hash of the written data is not the expected one.
  * @return 0 for an successful deinitialization or a negative error
  *	   code identicating reason of failure.
  **/
 int dfu_target_done(bool successful);
 
+/**
+ * @brief Set the expected SHA-256 digest of the data given to the target.
+ *
+ *	  The data is hashed as it is written, and the hash is verified by
+ *	  dfu_target_done(). Call this function after dfu_target_init() and
+ *	  before the first call to dfu_target_write(). If the target continues
+ *	  from a non-zero offset, the data written before is read back from
+ *	  the target and hashed first. The expectation is cleared by
+ *	  dfu_target_init() and dfu_target_done().
+ *
+ * @param[in] hash DFU_TARGET_HASH_LEN byte digest, or NULL to not verify
+ *		   the data.
+ *
+ * @retval -ENOTSUP if hashing is not enabled, or if the target cannot read
+ *		    back the data written before the current offset. The data
+ *		    is then not verified.
+ * @return 0 on success, otherwise a negative error code.
+ **/
+int dfu_target_hash_set(const uint8_t *hash);
+
 /**
  * @brief Deinitialize the resources that were needed for the current DFU
  *	  target if any and resets the current dfu target.
@@ -398,6 +398,23 @@ int gps_agps_request(struct gps_agps_request request, int socket);
  */
 int gps_process_agps_data(const uint8_t *buf, size_t len);
 
+/**
+ * @brief Processes a fragment of A-GPS data.
+ *
+ * Fragments must be given in order, starting at offset 0. Each A-GPS element
+ * is injected as soon as it has been received, so the whole A-GPS payload
+ * does not need to be buffered.
+ *
+ * @param buf Pointer to the fragment.
+ * @param len Length of the fragment.
+ * @param offset Offset of the fragment in the A-GPS payload.
+ * @param total_len Length of the A-GPS payload.
+ *
+ * @return Zero on success or (negative) error code otherwise.
+ */
+int gps_process_agps_fragment(const uint8_t *buf, size_t len, size_t offset,
+			      size_t total_len);
+
 #ifdef __cplusplus
 }
 #endif
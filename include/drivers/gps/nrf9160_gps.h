@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**
+ * @file nrf9160_gps.h
+ *
+ * @brief nRF9160 GPS driver extensions to the GPS API.
+ */
+
+#ifndef ZEPHYR_INCLUDE_DRIVERS_GPS_NRF9160_GPS_H_
+#define ZEPHYR_INCLUDE_DRIVERS_GPS_NRF9160_GPS_H_
+
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Counters of the PVT and NMEA event queue. */
+struct nrf9160_gps_evt_stats {
+	/** Events added to the queue. */
+	uint32_t queued;
+	/** Events lost because the queue was full. */
+	uint32_t dropped;
+	/** Events passed to the event handler. */
+	uint32_t delivered;
+	/** Number of times the queue was drained. */
+	uint32_t batches;
+	/** Largest number of events delivered in one batch. */
+	uint32_t batch_max;
+};
+
+/**
+ * @brief Get the counters of the PVT and NMEA event queue.
+ *
+ * Requires CONFIG_NRF9160_GPS_EVT_QUEUE.
+ *
+ * @param dev Pointer to the GPS device.
+ * @param stats Pointer to the structure to store the counters.
+ *
+ * @return Zero on success or (negative) error code otherwise.
+ */
+int nrf9160_gps_evt_stats_get(const struct device *dev,
+			      struct nrf9160_gps_evt_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_DRIVERS_GPS_NRF9160_GPS_H_ */
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef JSON_TOK_H__
+#define JSON_TOK_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+/**
+ * @defgroup json_tok JSON tokenizer
+ * @{
+ * @brief In-place JSON tokenizer with path lookups.
+ *
+ * The tokenizer indexes a JSON document in a single pass into a token array
+ * provided by the caller. It does not allocate memory and does not modify
+ * the document, which must be kept until the tokens are no longer used.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Token types. */
+enum json_tok_type {
+	JSON_TOK_OBJECT = 1,
+	JSON_TOK_ARRAY,
+	/** String, including object keys. */
+	JSON_TOK_STRING,
+	/** Number, true, false or null. */
+	JSON_TOK_PRIMITIVE,
+};
+
+/** @brief A JSON value or object key. */
+struct json_tok {
+	/** Offset of the first character, after the quote for strings. */
+	uint16_t start;
+	/** Offset after the last character, at the quote for strings. */
+	uint16_t end;
+	/** Number of members of an object or elements of an array. */
+	uint16_t size;
+	/** Index of the enclosing object or array, -1 for the root. */
+	int16_t parent;
+	/** Token type, @ref json_tok_type. */
+	uint8_t type;
+};
+
+/** @brief A tokenized document. */
+struct json_tok_doc {
+	const char *json;
+	struct json_tok *toks;
+	int count;
+};
+
+/** @brief Maximum length of a document. */
+#define JSON_TOK_DOC_LEN_MAX UINT16_MAX
+
+/**
+ * @brief Tokenize a JSON document.
+ *
+ * Object members are stored as a string token for the key followed by the
+ * tokens of the value. The root value is token 0.
+ *
+ * @param[out] doc Tokenized document.
+ * @param[in] json JSON document. Parsing stops at @p len or at a null
+ *		   character, whichever comes first.
+ * @param[in] len Length of the document.
+ * @param[in] toks Token array.
+ * @param[in] toks_max Number of tokens in @p toks.
+ *
+ * @return Number of tokens if successful.
+ * @return -EINVAL if the document is not valid JSON.
+ * @return -ENOMEM if the document has more than @p toks_max tokens.
+ * @return -E2BIG if the document is longer than @ref JSON_TOK_DOC_LEN_MAX.
+ */
+int json_tok_parse(struct json_tok_doc *doc, const char *json, size_t len,
+		   struct json_tok *toks, size_t toks_max);
+
+/**
+ * @brief Get an object member.
+ *
+ * Keys are compared as they are in the document, without unescaping.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] obj Index of an object token. A negative value is passed
+ *		  through, so that lookups can be chained.
+ * @param[in] key Member name.
+ *
+ * @return Index of the value token if successful.
+ * @return -ENOENT if the member does not exist or @p obj is not an object.
+ */
+int json_tok_obj_get(const struct json_tok_doc *doc, int obj,
+		     const char *key);
+
+/**
+ * @brief Get a value by its path, for example "execution.jobDocument.host".
+ *
+ * Path elements are separated by '.'. An element is an object member name,
+ * or an index when the enclosing value is an array.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] from Index of the token to start from, 0 for the root. A
+ *		   negative value is passed through.
+ * @param[in] path Path to the value.
+ *
+ * @return Index of the value token if successful.
+ * @return -ENOENT if the value does not exist.
+ */
+int json_tok_path(const struct json_tok_doc *doc, int from, const char *path);
+
+/**
+ * @brief Check whether a token is of the given type.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] tok Token index, can be negative.
+ * @param[in] type Token type.
+ *
+ * @return true if the token exists and is of the given type.
+ */
+bool json_tok_is(const struct json_tok_doc *doc, int tok,
+		 enum json_tok_type type);
+
+/**
+ * @brief Compare a string token with a string, without unescaping.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] tok Token index, can be negative.
+ * @param[in] str String to compare with.
+ *
+ * @return true if the token is a string equal to @p str.
+ */
+bool json_tok_str_eq(const struct json_tok_doc *doc, int tok,
+		     const char *str);
+
+/**
+ * @brief Copy a string token, unescaped and null-terminated.
+ *
+ * Like snprintf(), the string is truncated if the buffer is too small and
+ * the return value is the length of the full string.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] tok Token index, can be negative.
+ * @param[out] buf Output buffer.
+ * @param[in] size Size of the output buffer.
+ *
+ * @return Length of the unescaped string if successful.
+ * @return -EINVAL if the token is not a string.
+ */
+int json_tok_str(const struct json_tok_doc *doc, int tok, char *buf,
+		 size_t size);
+
+/**
+ * @brief Get the value of an integer token.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] tok Token index, can be negative.
+ * @param[out] value Value.
+ *
+ * @return 0 if successful.
+ * @return -EINVAL if the token is not an integer that fits in an int.
+ */
+int json_tok_int(const struct json_tok_doc *doc, int tok, int *value);
+
+/**
+ * @brief Get the value of a boolean token.
+ *
+ * @param[in] doc Tokenized document.
+ * @param[in] tok Token index, can be negative.
+ * @param[out] value Value.
+ *
+ * @return 0 if successful.
+ * @return -EINVAL if the token is not true or false.
+ */
+int json_tok_bool(const struct json_tok_doc *doc, int tok, bool *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */
+
+#endif /* JSON_TOK_H__ */
@@ -23,6 +23,9 @@
  */
 
 #include <stdbool.h>
+#include <zephyr/types.h>
+#include <sys/slist.h>
+#include <sys/util.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -107,6 +110,46 @@ struct lte_lc_evt {
 
 typedef void(*lte_lc_evt_handler_t)(const struct lte_lc_evt *const evt);
 
+/** @brief Link state fields, used in bitmasks. */
+#define LTE_LC_STATE_NW_REG_STATUS	BIT(0)
+#define LTE_LC_STATE_RRC_MODE		BIT(1)
+#define LTE_LC_STATE_CELL		BIT(2)
+#define LTE_LC_STATE_PSM_CFG		BIT(3)
+#define LTE_LC_STATE_EDRX_CFG		BIT(4)
+#define LTE_LC_STATE_SYSTEM_MODE	BIT(5)
+#define LTE_LC_STATE_FUNC_MODE		BIT(6)
+#define LTE_LC_STATE_ALL		(BIT(7) - 1)
+
+/** @brief Cached link state. */
+struct lte_lc_state {
+	enum lte_lc_nw_reg_status nw_reg_status;
+	enum lte_lc_rrc_mode rrc_mode;
+	struct lte_lc_cell cell;
+	struct lte_lc_psm_cfg psm_cfg;
+	struct lte_lc_edrx_cfg edrx_cfg;
+	enum lte_lc_system_mode system_mode;
+	enum lte_lc_func_mode func_mode;
+	/** Bitmask of the fields that are known. */
+	uint32_t valid;
+};
+
+/**
+ * @typedef lte_lc_state_handler_t
+ * @brief Callback that is executed when the link state changes.
+ *
+ * @param state Current link state.
+ * @param has_changed Bitmask of the fields that have changed.
+ */
+typedef void (*lte_lc_state_handler_t)(const struct lte_lc_state *state,
+				       uint32_t has_changed);
+
+/** Link state handler list entry. */
+struct lte_lc_state_handler {
+	lte_lc_state_handler_t cb; /**< Callback function. */
+	uint32_t fields; /**< Bitmask of the fields to be notified about. */
+	sys_snode_t node; /**< Linked list node, for internal use. */
+};
+
 /* NOTE: enum order is important and should be preserved. */
 enum lte_lc_pdp_type {
 	LTE_LC_PDP_TYPE_IP = 0,
@@ -233,6 +276,9 @@ int lte_lc_psm_req(bool enable);
  *	  configurations for periodic TAU (Tracking Area Update) and
  *	  active time, both in units of seconds.
  *
+ * The cached value is returned when it is known, see
+ * CONFIG_LTE_LC_STATE_CACHE.
+ *
  * @param tau Pointer to the variable for parsed periodic TAU interval in
  *	      seconds. Positive integer, or -1 if timer is deactivated.
  * @param active_time Pointer to the variable for parsed active time in seconds.
@@ -326,6 +372,9 @@ int lte_lc_pdn_auth_set(enum lte_lc_pdn_auth_type auth_prot,
 			const char *username, const char *password);
 
 /**@brief Get the current network registration status.
+ *
+ * The cached value is returned when it is known, see
+ * CONFIG_LTE_LC_STATE_CACHE.
  *
  * @param status Pointer for network registation status.
  *
@@ -342,6 +391,9 @@ int lte_lc_nw_reg_status_get(enum lte_lc_nw_reg_status *status);
 int lte_lc_system_mode_set(enum lte_lc_system_mode mode);
 
 /**@brief Get the modem's system mode.
+ *
+ * The cached value is returned when it is known, see
+ * CONFIG_LTE_LC_STATE_CACHE.
  *
  * @param mode Pointer to system mode variable.
  *
@@ -350,6 +402,9 @@ int lte_lc_system_mode_set(enum lte_lc_system_mode mode);
 int lte_lc_system_mode_get(enum lte_lc_system_mode *mode);
 
 /**@brief Get the modem's functional mode.
+ *
+ * The cached value is returned when it is known, see
+ * CONFIG_LTE_LC_STATE_CACHE.
  *
  * @param mode Pointer to functional mode variable.
  *
@@ -357,6 +412,50 @@ int lte_lc_system_mode_get(enum lte_lc_system_mode *mode);
  */
 int lte_lc_func_mode_get(enum lte_lc_func_mode *mode);
 
+/**@brief Get the cached link state.
+ *
+ * The link state is updated from network notifications and from the
+ * functional mode and system mode changes made through this library, so
+ * the modem is not queried.
+ *
+ * @param state Pointer to the link state variable. Only the fields set in
+ *		the valid member are known.
+ *
+ * @return Zero on success or (negative) error code otherwise.
+ */
+int lte_lc_state_get(struct lte_lc_state *state);
+
+/**@brief Mark fields of the cached link state as unknown.
+ *
+ * The next getter for an invalidated field queries the modem. Call this
+ * function after changing the functional or system mode with AT commands
+ * sent directly to the modem, as the modem does not notify these changes.
+ *
+ * @param fields Bitmask of the fields to invalidate, for example
+ *		 LTE_LC_STATE_FUNC_MODE.
+ */
+void lte_lc_state_invalidate(uint32_t fields);
+
+/** @brief Add a link state handler.
+ *
+ * The handler is called when one of the fields it is registered for
+ * changes, including when the field becomes known. Handlers are called from
+ * the AT notification context or from the thread changing the functional
+ * or system mode, and must not block or send AT commands.
+ *
+ * @param handler Handler to add. The structure must remain valid until
+ *		  the handler is removed.
+ */
+void lte_lc_state_handler_add(struct lte_lc_state_handler *handler);
+
+/** @brief Remove a link state handler.
+ *
+ * @param handler Handler to remove.
+ *
+ * @return Zero on success, -ENOENT if the handler was not added.
+ */
+int lte_lc_state_handler_remove(struct lte_lc_state_handler *handler);
+
 /** @} */
 
 #ifdef __cplusplus
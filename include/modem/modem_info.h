@@ -37,6 +37,9 @@ extern "C" {
 /** Maximum string size of the network mode string */
 #define MODEM_INFO_NETWORK_MODE_MAX_SIZE 12
 
+/** Maximum number of values read in one snapshot. */
+#define MODEM_INFO_SNAPSHOT_MAX_PARAMS 32
+
 /**@brief RSRP event handler function protoype. */
 typedef void (*rsrp_cb_t)(char rsrp_value);
 
@@ -73,6 +76,7 @@ struct lte_param {
 	char value_string[MODEM_INFO_MAX_RESPONSE_SIZE]; /**< The retrieved value in string format. */
 	char *data_name; /**< The name of the information type. */
 	enum modem_info type; /**< The information type. */
+	int64_t timestamp; /**< Uptime when the value was read, in milliseconds. Zero if not read. */
 };
 
 /**@brief Network parameters. **/
@@ -175,6 +179,31 @@ int modem_info_string_get(enum modem_info info, char *buf,
  */
 int modem_info_short_get(enum modem_info info, uint16_t *buf);
 
+/** @brief Read several modem information values in one pass.
+ *
+ * Values that are read with the same AT command are taken from a single
+ * response, so each AT command is sent at most once. Values read less than
+ * CONFIG_MODEM_INFO_SNAPSHOT_MAX_AGE milliseconds ago are not read again.
+ *
+ * String values are stored in the value_string member and numeric values in
+ * the value member of each parameter.
+ *
+ * The timestamp member tells whether a parameter holds a value from an
+ * earlier call. It must be zero for a parameter that has not been read, so
+ * zero-initialize the parameters before the first call.
+ * @ref modem_info_params_init does this for the parameters of
+ * @ref modem_param_info.
+ *
+ * @param params Parameters to read. The type of each parameter must be set.
+ * @param count  Number of parameters, at most
+ *               MODEM_INFO_SNAPSHOT_MAX_PARAMS.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, the (negative) error code of the first value that
+ *           could not be read is returned. The other values are still read.
+ */
+int modem_info_snapshot_get(struct lte_param *params[], size_t count);
+
 /** @brief Request the name of a modem information data type.
  *
  * @param info The requested information type.
@@ -228,7 +257,9 @@ int modem_info_json_object_encode(struct modem_param_info *modem,
 
 /** @brief Obtain the modem parameters.
  *
- * The data is stored in the provided info structure.
+ * The data is stored in the provided info structure. The parameters are
+ * read with @ref modem_info_snapshot_get, so values that are still within
+ * CONFIG_MODEM_INFO_SNAPSHOT_MAX_AGE are not read from the modem again.
  *
  * @param modem_param Pointer to the storage parameters.
  *
@@ -25,13 +25,28 @@ extern "C" {
 #endif
 
 /** @brief AWS IoT shadow topics, used in messages to specify which shadow
- *         topic that will be published to.
+ *         topic that will be published to, or which shadow topic a received
+ *         message arrived on.
  */
 enum aws_iot_topic_type {
 	AWS_IOT_SHADOW_TOPIC_UNKNOWN = 0x0,
 	AWS_IOT_SHADOW_TOPIC_GET,
 	AWS_IOT_SHADOW_TOPIC_UPDATE,
-	AWS_IOT_SHADOW_TOPIC_DELETE
+	AWS_IOT_SHADOW_TOPIC_DELETE,
+	/** Received on the shadow get accepted topic. */
+	AWS_IOT_SHADOW_TOPIC_GET_ACCEPTED,
+	/** Received on the shadow get rejected topic. */
+	AWS_IOT_SHADOW_TOPIC_GET_REJECTED,
+	/** Received on the shadow update accepted topic. */
+	AWS_IOT_SHADOW_TOPIC_UPDATE_ACCEPTED,
+	/** Received on the shadow update rejected topic. */
+	AWS_IOT_SHADOW_TOPIC_UPDATE_REJECTED,
+	/** Received on the shadow update delta topic. */
+	AWS_IOT_SHADOW_TOPIC_UPDATE_DELTA,
+	/** Received on the shadow delete accepted topic. */
+	AWS_IOT_SHADOW_TOPIC_DELETE_ACCEPTED,
+	/** Received on the shadow delete rejected topic. */
+	AWS_IOT_SHADOW_TOPIC_DELETE_REJECTED
 };
 
 /**@ AWS broker disconnect results. */
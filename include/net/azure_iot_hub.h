@@ -112,6 +112,9 @@ enum azure_iot_hub_topic_type {
  *	  If the value is an empty string (only null-terminator), it's the
  *	  equivalent of "key=". If value is NULL, it's the equivalent of
  *	  "key".
+ *
+ *  @note Property bags of received messages are URL-decoded by the library,
+ *	  while property bags of sent messages must already be URL-encoded.
  */
 struct azure_iot_hub_prop_bag {
 	/** Null-terminated key string. */
@@ -128,9 +131,16 @@ struct azure_iot_hub_topic_data {
 	char *str;
 	/** Length of topic name. */
 	size_t len;
-	/* Array of property bags. */
+	/** Array of property bags. For received devicebound messages, the
+	 *  keys and values are URL-decoded when the message is received,
+	 *  before the event is passed to the application, and are valid
+	 *  until the event handler returns.
+	 */
 	struct azure_iot_hub_prop_bag *prop_bag;
-	/* Number of property bag elements in the prop_bag array. */
+	/** Number of property bag elements in the prop_bag array. Zero for
+	 *  received messages where the property bags do not fit in the
+	 *  library buffer or have an invalid percent-encoding.
+	 */
 	size_t prop_bag_count;
 };
 
@@ -142,6 +152,16 @@ struct azure_iot_hub_data {
 	char *ptr;
 	/** Length of data. */
 	size_t len;
+	/** Offset of the data in the payload of a received message. Only
+	 *  nonzero for fragments of a payload that is larger than
+	 *  @option{CONFIG_AZURE_IOT_HUB_MQTT_PAYLOAD_BUFFER_LEN}, see
+	 *  @option{CONFIG_AZURE_IOT_HUB_PAYLOAD_FRAGMENTS}.
+	 */
+	size_t offset;
+	/** Length of the payload of a received message that the data is part
+	 *  of. The last fragment ends at this length.
+	 */
+	size_t total_len;
 	/** Quality of Service for the message. */
 	enum mqtt_qos qos;
 	/** Message id used for the message, used to match acknowledgments. */
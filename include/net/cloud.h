@@ -120,6 +120,15 @@ struct cloud_msg {
 	size_t len;
 	enum cloud_qos qos;
 	struct cloud_endpoint endpoint;
+	/** Offset of the data in the payload of a received message. Only
+	 *  nonzero for fragments of a payload that the backend delivers in
+	 *  several CLOUD_EVT_DATA_RECEIVED events.
+	 */
+	size_t offset;
+	/** Length of the payload of a received message that the data is part
+	 *  of. The last fragment ends at this length.
+	 */
+	size_t total_len;
 };
 
 /**@brief Cloud event type. */
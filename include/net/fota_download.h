@@ -105,6 +105,32 @@ int fota_download_init(fota_download_callback_t client_callback);
 int fota_download_start(const char *host, const char *file, int sec_tag,
 			const char *apn, size_t fragment_size);
 
+/**@brief Start downloading the given file, and verify its SHA-256 hash.
+ *
+ * Works like @ref fota_download_start. The file is hashed while it is
+ * written to the DFU target, and if the hash differs from @p hash, the upgrade
+ * is not scheduled and a FOTA_DOWNLOAD_EVT_ERROR event with cause
+ * FOTA_DOWNLOAD_ERROR_CAUSE_INVALID_UPDATE is sent instead of
+ * FOTA_DOWNLOAD_EVT_FINISHED.
+ *
+ * Requires @option{CONFIG_DFU_TARGET_HASH_CHECK}.
+ *
+ * @param host Name of host to start downloading from.
+ * @param file Filepath to the file you wish to download.
+ * @param sec_tag Security tag you want to use with HTTPS set to -1 to Disable.
+ * @param apn Access Point Name to use or NULL to use the default APN.
+ * @param fragment_size Fragment size to be used for the download.
+ * @param hash Expected 32 byte SHA-256 digest of the file, or NULL to not
+ *	       verify it.
+ *
+ * @retval 0	     If download has started successfully.
+ * @retval -ENOTSUP  If a hash is given, but hashing is not enabled.
+ *                   Otherwise, a negative value is returned.
+ */
+int fota_download_start_with_hash(const char *host, const char *file,
+				  int sec_tag, const char *apn,
+				  size_t fragment_size, const uint8_t *hash);
+
 #ifdef __cplusplus
 }
 #endif
@@ -211,6 +211,16 @@ enum ftp_trasfer_type {
 	FTP_TYPE_BINARY
 };
 
+/** @brief Statistics of a streamed file transfer. */
+struct ftp_transfer_stats {
+	/** Bytes transferred over the data connection */
+	size_t bytes;
+	/** Time from opening to closing the transfer */
+	uint32_t duration_ms;
+	/** Average throughput in bytes per second */
+	uint32_t throughput;
+};
+
 /**
  * @brief FTP asynchronous callback function.
  *
@@ -352,6 +362,79 @@ int ftp_get(const char *file);
  */
 int ftp_put(const char *file, const uint8_t *data, uint16_t length);
 
+/**@brief Start uploading a file in chunks
+ *
+ * A single data connection is kept open until ftp_put_close().
+ * If offset is not zero, the server is asked to resume the file at
+ * that offset (REST) before storing.
+ *
+ * @param file Target file name
+ * @param offset Offset in the target file to resume at
+ *
+ * @retval Preliminary ftp_return_code (150 or 125) if the transfer is open,
+ *         other ftp_return_code or negative if error
+ */
+int ftp_put_open(const char *file, size_t offset);
+
+/**@brief Send the next chunk of an upload
+ *
+ * @param data Data to be stored
+ * @param length Length of data to be stored
+ *
+ * @retval 0 if successful, negative if error
+ */
+int ftp_put_write(const uint8_t *data, size_t length);
+
+/**@brief Finish an upload
+ *
+ * @param stats Transfer statistics, can be NULL
+ *
+ * @retval ftp_return_code or negative if error
+ */
+int ftp_put_close(struct ftp_transfer_stats *stats);
+
+/**@brief Start downloading a file in chunks
+ *
+ * A single data connection is kept open until ftp_get_close().
+ * If offset is not zero, the server is asked to resume the file at
+ * that offset (REST) before retrieving.
+ *
+ * @param file Target file name
+ * @param offset Offset in the target file to resume at
+ *
+ * @retval Preliminary ftp_return_code (150 or 125) if the transfer is open,
+ *         other ftp_return_code or negative if error
+ */
+int ftp_get_open(const char *file, size_t offset);
+
+/**@brief Read the next chunk of a download
+ *
+ * @param buf Buffer to store the data
+ * @param size Size of the buffer
+ *
+ * @retval Number of bytes read, 0 at the end of the file,
+ *         negative if error
+ */
+int ftp_get_read(uint8_t *buf, size_t size);
+
+/**@brief Finish a download
+ *
+ * @param stats Transfer statistics, can be NULL
+ *
+ * @retval ftp_return_code or negative if error
+ */
+int ftp_get_close(struct ftp_transfer_stats *stats);
+
+/**@brief Get the size of a file
+ *
+ * @param file Target file name
+ * @param size Size of the file in bytes
+ *
+ * @retval ftp_return_code or negative if error,
+ *         -EBADMSG if the reply has no size
+ */
+int ftp_size(const char *file, size_t *size);
+
 
 #ifdef __cplusplus
 }
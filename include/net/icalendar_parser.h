@@ -100,16 +100,50 @@ struct ical_parser_evt {
 typedef int (*icalendar_parser_callback_t)(
 	const struct ical_parser_evt *event);
 
+/** Maximum length of a property name or component name kept by the parser.
+ *  Longer names are never supported ones, and are skipped.
+ */
+#define ICAL_PARSER_NAME_SIZE 15
+
 /**
  * @brief iCalendar parser instance.
+ *
+ * The parser is a state machine that handles each input byte once. Content
+ * lines are unfolded on the fly, and only the values of the supported
+ * properties are stored, directly into @ref ical_parser_evt. Memory use
+ * does not depend on the size of the calendar or its components.
  */
 struct icalendar_parser {
-	/** Internal Buffer for parsing incoming data stream */
-	char buf[CONFIG_ICAL_PARSER_BUFFER_SIZE + 1];
-	/** Offset of unparsed data in buf. */
-	size_t offset;
+	/** Content line parsing state. */
+	uint8_t state;
+	/** Line ended, waiting to see if the next line is folded. */
+	bool line_end;
+	/** Inside a quoted property parameter value. */
+	bool quoted;
 	/** begin of iCalendar object delimiter pair */
 	bool icalobject_begin;
+	/** Component nesting depth inside the iCalendar object. */
+	uint8_t depth;
+	/** Component being parsed is reported to the application. */
+	bool com_report;
+	/** Property of the current content line. */
+	uint8_t prop;
+	/** Property name, or component name for BEGIN and END. */
+	char name[ICAL_PARSER_NAME_SIZE + 1];
+	/** Length of name. */
+	uint8_t name_len;
+	/** Name was too long to be stored. */
+	bool name_overflow;
+	/** Destination of the property value, NULL to skip the value. */
+	char *value;
+	/** Length of the property value stored so far. */
+	size_t value_len;
+	/** Maximum length of the property value. */
+	size_t value_max;
+	/** Property value was too long to be stored. */
+	bool value_overflow;
+	/** Component being parsed. */
+	struct ical_parser_evt evt;
 	/** Event handler. */
 	icalendar_parser_callback_t callback;
 };
@@ -128,11 +162,17 @@ int ical_parser_init(struct icalendar_parser *ical,
 /**
  * @brief Parse the iCalendar data stream. Return the parsed bytes.
  *
+ * The data can be split into chunks at any position. A component event is
+ * sent when the content line following the END of the component starts.
+ * Parsing stops if the callback returns non-zero, and continues from the
+ * same position on the next call.
+ *
  * @param[in,out] ical iCalendar parser instance.
  * @param[in] data Input data to be parsed.
  * @param[in] len  Length of input data stream.
  *
- * @retval size_t  Parsed bytes.
+ * @retval size_t  Parsed bytes. Equal to @p len, unless the callback
+ *                 stopped the parsing.
  */
 size_t ical_parser_parse(struct icalendar_parser *ical,
 			const char *data, size_t len);
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef MQTT_TOPIC_MATCHER_H__
+#define MQTT_TOPIC_MATCHER_H__
+
+#include <zephyr.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file mqtt_topic_matcher.h
+ *
+ * @brief Compiled MQTT topic filter matching.
+ * @defgroup mqtt_topic_matcher MQTT topic matcher
+ * @{
+ */
+
+/** Value used for node indexes that do not refer to a node. */
+#define MQTT_TOPIC_MATCHER_NONE (-1)
+
+/** @brief Type of a topic level in a topic filter. */
+enum mqtt_topic_matcher_level_type {
+	/** Level that must match the topic level exactly. */
+	MQTT_TOPIC_MATCHER_LEVEL_EXACT,
+	/** Single-level wildcard, '+'. */
+	MQTT_TOPIC_MATCHER_LEVEL_SINGLE,
+	/** Multi-level wildcard, '#'. */
+	MQTT_TOPIC_MATCHER_LEVEL_MULTI,
+};
+
+/** @brief Trie node, representing one level of one or more topic filters. */
+struct mqtt_topic_matcher_node {
+	/** Topic level, points into the filter string. Not null-terminated. */
+	const char *level;
+	/** Length of the topic level. */
+	uint16_t level_len;
+	/** Level type, @ref mqtt_topic_matcher_level_type. */
+	uint8_t type;
+	/** Index of the first child node. */
+	int16_t child;
+	/** Index of the next node on the same level. */
+	int16_t sibling;
+	/** Identifier of the filter ending at this node, or
+	 *  MQTT_TOPIC_MATCHER_NONE.
+	 */
+	int16_t id;
+};
+
+/** @brief Topic matcher instance. */
+struct mqtt_topic_matcher {
+	/** Node pool. */
+	struct mqtt_topic_matcher_node *nodes;
+	/** Number of nodes in the pool. */
+	uint16_t node_max;
+	/** Number of nodes in use. */
+	uint16_t node_count;
+	/** Index of the first node on the topmost level. */
+	int16_t root;
+};
+
+/** @brief Statically define a topic matcher with a node pool.
+ *
+ * @param _name Name of the topic matcher instance.
+ * @param _node_max Number of nodes in the pool. Each topic level that is
+ *		    not shared with a previously added filter uses one node.
+ */
+#define MQTT_TOPIC_MATCHER_DEFINE(_name, _node_max)			\
+	static struct mqtt_topic_matcher_node _name##_nodes[_node_max];	\
+	static struct mqtt_topic_matcher _name = {			\
+		.nodes = _name##_nodes,					\
+		.node_max = _node_max,					\
+		.root = MQTT_TOPIC_MATCHER_NONE,			\
+	}
+
+/** @brief Initialize a topic matcher with a node pool.
+ *
+ * @param matcher Topic matcher instance.
+ * @param nodes Node pool.
+ * @param node_max Number of nodes in the pool.
+ */
+void mqtt_topic_matcher_init(struct mqtt_topic_matcher *matcher,
+			     struct mqtt_topic_matcher_node *nodes,
+			     size_t node_max);
+
+/** @brief Remove all filters from a topic matcher.
+ *
+ * @param matcher Topic matcher instance.
+ */
+void mqtt_topic_matcher_reset(struct mqtt_topic_matcher *matcher);
+
+/** @brief Add a topic filter to a topic matcher.
+ *
+ * The filter string is referenced, not copied, and must remain valid for
+ * as long as the filter is in use.
+ *
+ * When a topic matches several filters, filters with exact levels take
+ * precedence over '+', which takes precedence over '#'.
+ *
+ * @param matcher Topic matcher instance.
+ * @param filter Topic filter, may contain '+' and '#' wildcards.
+ * @param filter_len Length of the topic filter.
+ * @param id Non-negative identifier returned when a topic matches the
+ *	     filter.
+ *
+ * @retval 0 Filter added.
+ * @retval -EINVAL Invalid filter or identifier.
+ * @retval -EALREADY The filter has already been added.
+ * @retval -ENOMEM The node pool is exhausted.
+ */
+int mqtt_topic_matcher_add(struct mqtt_topic_matcher *matcher,
+			   const char *filter, size_t filter_len, int id);
+
+/** @brief Find the filter that matches a topic.
+ *
+ * The cost of matching is proportional to the topic length when the
+ * filters do not overlap.
+ *
+ * @param matcher Topic matcher instance.
+ * @param topic Topic of a received message, not null-terminated.
+ * @param topic_len Length of the topic.
+ *
+ * @return Identifier of the matching filter, or -ENOENT if no filter
+ *	   matches the topic.
+ */
+int mqtt_topic_matcher_match(const struct mqtt_topic_matcher *matcher,
+			     const char *topic, size_t topic_len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_TOPIC_MATCHER_H__ */
@@ -123,6 +123,16 @@ struct nrf_cloud_evt {
 	uint32_t status;
 	/** Received data. */
 	struct nrf_cloud_data data;
+	/** Offset of the received data in the payload of the message. Only
+	 *  nonzero for fragments of a payload that is larger than
+	 *  @option{CONFIG_NRF_CLOUD_MQTT_PAYLOAD_BUFFER_LEN}, see
+	 *  @option{CONFIG_NRF_CLOUD_MQTT_PAYLOAD_FRAGMENTS}.
+	 */
+	uint32_t data_offset;
+	/** Length of the payload of the message that the received data is
+	 *  part of. The last fragment ends at this length.
+	 */
+	uint32_t data_total_len;
 	/** Topic on which data was received. */
 	struct nrf_cloud_topic topic;
 };
@@ -48,6 +48,37 @@ int nrf_cloud_agps_request_all(void);
  */
 int nrf_cloud_agps_process(const char *buf, size_t buf_len, const int *socket);
 
+/**@brief Starts streamed processing of binary A-GPS data from nRF Cloud.
+ *
+ * The payload can then be passed in chunks of arbitrary size using
+ * @ref nrf_cloud_agps_stream_write. Each A-GPS element is injected into the
+ * GNSS socket as soon as it has been completely received, so the whole
+ * payload does not need to be buffered. Any ongoing stream is discarded.
+ *
+ * @param socket Pointer to GNSS socket to which A-GPS data will be injected.
+ *		 If NULL, the nRF9160 GPS driver is used to inject the data.
+ *
+ * @return 0 if successful, otherwise a (negative) error code.
+ */
+int nrf_cloud_agps_stream_begin(const int *socket);
+
+/**@brief Processes a chunk of binary A-GPS data received from nRF Cloud.
+ *
+ * @param buf Pointer to the next chunk of the A-GPS payload.
+ * @param buf_len Length of the chunk.
+ *
+ * @return 0 if successful, otherwise a (negative) error code.
+ */
+int nrf_cloud_agps_stream_write(const char *buf, size_t buf_len);
+
+/**@brief Ends streamed processing of binary A-GPS data.
+ *
+ * @retval 0 The whole payload was processed.
+ * @retval -ENODATA No data was received.
+ * @retval -EBADMSG The payload was truncated or malformed.
+ */
+int nrf_cloud_agps_stream_end(void);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -361,13 +361,48 @@ int gps_agps_request(struct gps_agps_request request, int socket)
 	return 0;
 }
 
-int gps_process_agps_data(const uint8_t *buf, size_t len)
+#if defined(CONFIG_AGPS_SRC_NRF_CLOUD) && defined(CONFIG_NRF_CLOUD_AGPS)
+/* Offset in the A-GPS payload that the next fragment is expected at */
+static size_t stream_offset;
+static bool stream_active;
+#endif /* CONFIG_AGPS_SRC_NRF_CLOUD && CONFIG_NRF_CLOUD_AGPS */
+
+int gps_process_agps_fragment(const uint8_t *buf, size_t len, size_t offset,
+			      size_t total_len)
 {
 	int err = 0;
 
 #if defined(CONFIG_AGPS_SRC_NRF_CLOUD) && defined(CONFIG_NRF_CLOUD_AGPS)
+	if (offset == 0) {
+		err = nrf_cloud_agps_stream_begin(NULL);
+		if (err) {
+			LOG_ERR("A-GPS failed, error: %d", err);
+			return err;
+		}
+
+		stream_offset = 0;
+		stream_active = true;
+	} else if (!stream_active || (offset != stream_offset)) {
+		LOG_ERR("Unexpected A-GPS fragment at offset %d", offset);
+		stream_active = false;
+		return -EINVAL;
+	}
+
+	err = nrf_cloud_agps_stream_write(buf, len);
+	if (err) {
+		LOG_ERR("A-GPS failed, error: %d", err);
+		stream_active = false;
+		return err;
+	}
+
+	stream_offset += len;
+	if (stream_offset < total_len) {
+		return 0;
+	}
 
-	err = nrf_cloud_agps_process(buf, len, NULL);
+	stream_active = false;
+
+	err = nrf_cloud_agps_stream_end();
 	if (err) {
 		LOG_ERR("A-GPS failed, error: %d", err);
 	} else {
@@ -377,3 +412,8 @@ int gps_process_agps_data(const uint8_t *buf, size_t len)
 
 	return err;
 }
+
+int gps_process_agps_data(const uint8_t *buf, size_t len)
+{
+	return gps_process_agps_fragment(buf, len, 0, len);
+}
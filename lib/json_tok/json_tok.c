@@ -0,0 +1,609 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <json_tok.h>
+
+/* What the tokenizer accepts next */
+enum expect {
+	EXPECT_VALUE,
+	/* After '[' */
+	EXPECT_VALUE_OR_END,
+	/* After ',' in an object */
+	EXPECT_KEY,
+	/* After '{' */
+	EXPECT_KEY_OR_END,
+	EXPECT_COLON,
+	EXPECT_COMMA_OR_END,
+	/* After the root value */
+	EXPECT_NOTHING,
+};
+
+static bool is_digit(char c)
+{
+	return (c >= '0') && (c <= '9');
+}
+
+static int hex_value(char c)
+{
+	if (is_digit(c)) {
+		return c - '0';
+	} else if ((c >= 'a') && (c <= 'f')) {
+		return c - 'a' + 10;
+	} else if ((c >= 'A') && (c <= 'F')) {
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+static bool is_delimiter(char c)
+{
+	switch (c) {
+	case '\0':
+	case ' ':
+	case '\t':
+	case '\n':
+	case '\r':
+	case ',':
+	case ':':
+	case ']':
+	case '}':
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Returns the offset of the closing quote */
+static int string_scan(const char *json, size_t pos, size_t len)
+{
+	for (pos++; pos < len; pos++) {
+		unsigned char c = json[pos];
+
+		if (c == '"') {
+			return pos;
+		} else if (c < ' ') {
+			/* Also stops at a null character */
+			return -EINVAL;
+		} else if (c != '\\') {
+			continue;
+		}
+
+		if (++pos >= len) {
+			return -EINVAL;
+		}
+
+		switch (json[pos]) {
+		case '"':
+		case '\\':
+		case '/':
+		case 'b':
+		case 'f':
+		case 'n':
+		case 'r':
+		case 't':
+			break;
+		case 'u':
+			for (int i = 0; i < 4; i++) {
+				if (++pos >= len || hex_value(json[pos]) < 0) {
+					return -EINVAL;
+				}
+			}
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static bool number_valid(const char *str, size_t len)
+{
+	size_t i = 0;
+
+	if (str[i] == '-') {
+		i++;
+	}
+
+	if (i < len && str[i] == '0') {
+		i++;
+	} else if (i < len && is_digit(str[i])) {
+		while (i < len && is_digit(str[i])) {
+			i++;
+		}
+	} else {
+		return false;
+	}
+
+	if (i < len && str[i] == '.') {
+		if (++i >= len || !is_digit(str[i])) {
+			return false;
+		}
+		while (i < len && is_digit(str[i])) {
+			i++;
+		}
+	}
+
+	if (i < len && (str[i] == 'e' || str[i] == 'E')) {
+		i++;
+		if (i < len && (str[i] == '+' || str[i] == '-')) {
+			i++;
+		}
+		if (i >= len || !is_digit(str[i])) {
+			return false;
+		}
+		while (i < len && is_digit(str[i])) {
+			i++;
+		}
+	}
+
+	return i == len;
+}
+
+static bool primitive_valid(const char *str, size_t len)
+{
+	return ((len == 4) && !memcmp(str, "true", 4)) ||
+	       ((len == 5) && !memcmp(str, "false", 5)) ||
+	       ((len == 4) && !memcmp(str, "null", 4)) ||
+	       number_valid(str, len);
+}
+
+static enum expect after_value(int parent)
+{
+	return (parent < 0) ? EXPECT_NOTHING : EXPECT_COMMA_OR_END;
+}
+
+int json_tok_parse(struct json_tok_doc *doc, const char *json, size_t len,
+		   struct json_tok *toks, size_t toks_max)
+{
+	enum expect expect = EXPECT_VALUE;
+	struct json_tok *tok;
+	int parent = -1;
+	int count = 0;
+	size_t pos;
+	int end;
+
+	if (doc == NULL || json == NULL || toks == NULL) {
+		return -EINVAL;
+	}
+
+	for (pos = 0; pos < len && json[pos] != '\0'; pos++) {
+		char c = json[pos];
+		bool key = false;
+
+		if (pos >= JSON_TOK_DOC_LEN_MAX) {
+			return -E2BIG;
+		}
+
+		switch (c) {
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			continue;
+
+		case ':':
+			if (expect != EXPECT_COLON) {
+				return -EINVAL;
+			}
+			expect = EXPECT_VALUE;
+			continue;
+
+		case ',':
+			if (expect != EXPECT_COMMA_OR_END) {
+				return -EINVAL;
+			}
+			expect = (toks[parent].type == JSON_TOK_OBJECT) ?
+				 EXPECT_KEY : EXPECT_VALUE;
+			continue;
+
+		case '}':
+		case ']':
+			if ((parent < 0) ||
+			    (toks[parent].type !=
+			     ((c == '}') ? JSON_TOK_OBJECT : JSON_TOK_ARRAY))) {
+				return -EINVAL;
+			}
+			if ((expect != EXPECT_COMMA_OR_END) &&
+			    (expect != EXPECT_KEY_OR_END) &&
+			    (expect != EXPECT_VALUE_OR_END)) {
+				return -EINVAL;
+			}
+			toks[parent].end = pos + 1;
+			parent = toks[parent].parent;
+			expect = after_value(parent);
+			continue;
+
+		default:
+			break;
+		}
+
+		/* A new token */
+		if ((expect == EXPECT_KEY) || (expect == EXPECT_KEY_OR_END)) {
+			if (c != '"') {
+				return -EINVAL;
+			}
+			key = true;
+		} else if ((expect != EXPECT_VALUE) &&
+			   (expect != EXPECT_VALUE_OR_END)) {
+			return -EINVAL;
+		}
+
+		if (count >= (int)toks_max) {
+			return -ENOMEM;
+		}
+
+		tok = &toks[count];
+		tok->parent = parent;
+		tok->size = 0;
+
+		if (key || (parent >= 0 &&
+			    toks[parent].type == JSON_TOK_ARRAY)) {
+			toks[parent].size++;
+		}
+
+		switch (c) {
+		case '{':
+		case '[':
+			tok->type = (c == '{') ? JSON_TOK_OBJECT :
+						 JSON_TOK_ARRAY;
+			tok->start = pos;
+			tok->end = 0;
+			parent = count;
+			expect = (c == '{') ? EXPECT_KEY_OR_END :
+					      EXPECT_VALUE_OR_END;
+			break;
+
+		case '"':
+			end = string_scan(json, pos, len);
+			if (end < 0) {
+				return end;
+			} else if (end >= JSON_TOK_DOC_LEN_MAX) {
+				return -E2BIG;
+			}
+			tok->type = JSON_TOK_STRING;
+			tok->start = pos + 1;
+			tok->end = end;
+			pos = end;
+			expect = key ? EXPECT_COLON : after_value(parent);
+			break;
+
+		default:
+			end = pos;
+			while (end < len && !is_delimiter(json[end])) {
+				end++;
+			}
+			if (end >= JSON_TOK_DOC_LEN_MAX) {
+				return -E2BIG;
+			} else if (!primitive_valid(&json[pos], end - pos)) {
+				return -EINVAL;
+			}
+			tok->type = JSON_TOK_PRIMITIVE;
+			tok->start = pos;
+			tok->end = end;
+			pos = end - 1;
+			expect = after_value(parent);
+			break;
+		}
+
+		count++;
+	}
+
+	if (expect != EXPECT_NOTHING) {
+		/* Empty or incomplete document */
+		return -EINVAL;
+	}
+
+	doc->json = json;
+	doc->toks = toks;
+	doc->count = count;
+
+	return count;
+}
+
+/* Index of the token that follows the value at index tok */
+static int value_skip(const struct json_tok_doc *doc, int tok)
+{
+	int next = tok + 1;
+
+	while (next < doc->count &&
+	       doc->toks[next].start < doc->toks[tok].end) {
+		next++;
+	}
+
+	return next;
+}
+
+static bool tok_valid(const struct json_tok_doc *doc, int tok)
+{
+	return (doc != NULL) && (tok >= 0) && (tok < doc->count);
+}
+
+static bool key_eq(const struct json_tok_doc *doc, int tok, const char *key,
+		   size_t key_len)
+{
+	const struct json_tok *t = &doc->toks[tok];
+
+	return (t->end - t->start == key_len) &&
+	       !memcmp(&doc->json[t->start], key, key_len);
+}
+
+static int member_get(const struct json_tok_doc *doc, int obj,
+		      const char *key, size_t key_len)
+{
+	int tok = obj + 1;
+
+	for (int i = 0; i < doc->toks[obj].size; i++) {
+		if (key_eq(doc, tok, key, key_len)) {
+			return tok + 1;
+		}
+		tok = value_skip(doc, tok + 1);
+	}
+
+	return -ENOENT;
+}
+
+static int element_get(const struct json_tok_doc *doc, int arr,
+		       const char *index, size_t index_len)
+{
+	int tok = arr + 1;
+	int n = 0;
+
+	if (index_len == 0) {
+		return -ENOENT;
+	}
+
+	for (size_t i = 0; i < index_len; i++) {
+		if (!is_digit(index[i]) || n > (UINT16_MAX / 10)) {
+			return -ENOENT;
+		}
+		n = n * 10 + (index[i] - '0');
+	}
+
+	if (n >= doc->toks[arr].size) {
+		return -ENOENT;
+	}
+
+	while (n--) {
+		tok = value_skip(doc, tok);
+	}
+
+	return tok;
+}
+
+int json_tok_obj_get(const struct json_tok_doc *doc, int obj,
+		     const char *key)
+{
+	if (!json_tok_is(doc, obj, JSON_TOK_OBJECT) || key == NULL) {
+		return -ENOENT;
+	}
+
+	return member_get(doc, obj, key, strlen(key));
+}
+
+int json_tok_path(const struct json_tok_doc *doc, int from, const char *path)
+{
+	int tok = from;
+	const char *elem = path;
+
+	if (!tok_valid(doc, tok) || path == NULL) {
+		return -ENOENT;
+	}
+
+	while (*elem != '\0') {
+		const char *sep = strchr(elem, '.');
+		size_t elem_len = sep ? (sep - elem) : strlen(elem);
+
+		switch (doc->toks[tok].type) {
+		case JSON_TOK_OBJECT:
+			tok = member_get(doc, tok, elem, elem_len);
+			break;
+		case JSON_TOK_ARRAY:
+			tok = element_get(doc, tok, elem, elem_len);
+			break;
+		default:
+			return -ENOENT;
+		}
+
+		if (tok < 0 || sep == NULL) {
+			break;
+		}
+
+		elem = sep + 1;
+	}
+
+	return tok;
+}
+
+bool json_tok_is(const struct json_tok_doc *doc, int tok,
+		 enum json_tok_type type)
+{
+	return tok_valid(doc, tok) && (doc->toks[tok].type == type);
+}
+
+bool json_tok_str_eq(const struct json_tok_doc *doc, int tok,
+		     const char *str)
+{
+	return json_tok_is(doc, tok, JSON_TOK_STRING) && (str != NULL) &&
+	       key_eq(doc, tok, str, strlen(str));
+}
+
+static void out_put(char *buf, size_t size, size_t *len, char c)
+{
+	if (*len + 1 < size) {
+		buf[*len] = c;
+	}
+	(*len)++;
+}
+
+/* Encode a code point as UTF-8 */
+static void utf8_put(char *buf, size_t size, size_t *len, uint32_t cp)
+{
+	if (cp < 0x80) {
+		out_put(buf, size, len, cp);
+	} else if (cp < 0x800) {
+		out_put(buf, size, len, 0xC0 | (cp >> 6));
+		out_put(buf, size, len, 0x80 | (cp & 0x3F));
+	} else if (cp < 0x10000) {
+		out_put(buf, size, len, 0xE0 | (cp >> 12));
+		out_put(buf, size, len, 0x80 | ((cp >> 6) & 0x3F));
+		out_put(buf, size, len, 0x80 | (cp & 0x3F));
+	} else {
+		out_put(buf, size, len, 0xF0 | (cp >> 18));
+		out_put(buf, size, len, 0x80 | ((cp >> 12) & 0x3F));
+		out_put(buf, size, len, 0x80 | ((cp >> 6) & 0x3F));
+		out_put(buf, size, len, 0x80 | (cp & 0x3F));
+	}
+}
+
+static uint32_t hex4_get(const char *str)
+{
+	uint32_t value = 0;
+
+	for (int i = 0; i < 4; i++) {
+		value = (value << 4) | hex_value(str[i]);
+	}
+
+	return value;
+}
+
+int json_tok_str(const struct json_tok_doc *doc, int tok, char *buf,
+		 size_t size)
+{
+	const char *str;
+	size_t str_len;
+	size_t len = 0;
+
+	if (!json_tok_is(doc, tok, JSON_TOK_STRING) ||
+	    (buf == NULL && size > 0)) {
+		return -EINVAL;
+	}
+
+	str = &doc->json[doc->toks[tok].start];
+	str_len = doc->toks[tok].end - doc->toks[tok].start;
+
+	/* Escapes were validated by the tokenizer */
+	for (size_t i = 0; i < str_len; i++) {
+		uint32_t cp;
+
+		if (str[i] != '\\') {
+			out_put(buf, size, &len, str[i]);
+			continue;
+		}
+
+		switch (str[++i]) {
+		case 'b':
+			out_put(buf, size, &len, '\b');
+			break;
+		case 'f':
+			out_put(buf, size, &len, '\f');
+			break;
+		case 'n':
+			out_put(buf, size, &len, '\n');
+			break;
+		case 'r':
+			out_put(buf, size, &len, '\r');
+			break;
+		case 't':
+			out_put(buf, size, &len, '\t');
+			break;
+		case 'u':
+			cp = hex4_get(&str[i + 1]);
+			i += 4;
+			/* Surrogate pair */
+			if ((cp >= 0xD800) && (cp <= 0xDBFF) &&
+			    (i + 6 < str_len) && (str[i + 1] == '\\') &&
+			    (str[i + 2] == 'u')) {
+				uint32_t low = hex4_get(&str[i + 3]);
+
+				if ((low >= 0xDC00) && (low <= 0xDFFF)) {
+					cp = 0x10000 + ((cp - 0xD800) << 10) +
+					     (low - 0xDC00);
+					i += 6;
+				}
+			}
+			utf8_put(buf, size, &len, cp);
+			break;
+		default:
+			/* '"', '\\' and '/' */
+			out_put(buf, size, &len, str[i]);
+			break;
+		}
+	}
+
+	if (size > 0) {
+		buf[MIN(len, size - 1)] = '\0';
+	}
+
+	return len;
+}
+
+int json_tok_int(const struct json_tok_doc *doc, int tok, int *value)
+{
+	const struct json_tok *t;
+	long long result = 0;
+	bool negative;
+	size_t i;
+
+	if (!json_tok_is(doc, tok, JSON_TOK_PRIMITIVE) || value == NULL) {
+		return -EINVAL;
+	}
+
+	t = &doc->toks[tok];
+	i = t->start;
+	negative = (doc->json[i] == '-');
+	if (negative) {
+		i++;
+	}
+
+	if (i >= t->end || !is_digit(doc->json[i])) {
+		return -EINVAL;
+	}
+
+	for (; i < t->end; i++) {
+		if (!is_digit(doc->json[i])) {
+			/* Fraction or exponent */
+			return -EINVAL;
+		}
+		result = result * 10 + (doc->json[i] - '0');
+		if (result > (long long)INT_MAX + 1) {
+			return -EINVAL;
+		}
+	}
+
+	if (negative) {
+		result = -result;
+	} else if (result > INT_MAX) {
+		return -EINVAL;
+	}
+
+	*value = result;
+
+	return 0;
+}
+
+int json_tok_bool(const struct json_tok_doc *doc, int tok, bool *value)
+{
+	if (!json_tok_is(doc, tok, JSON_TOK_PRIMITIVE) || value == NULL) {
+		return -EINVAL;
+	}
+
+	switch (doc->json[doc->toks[tok].start]) {
+	case 't':
+		*value = true;
+		return 0;
+	case 'f':
+		*value = false;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
@@ -97,6 +97,17 @@ static int parse_psm_cfg(struct at_param_list *at_params,
 static lte_lc_evt_handler_t evt_handler;
 static bool is_initialized;
 
+/* Fields of the link state that are updated from notifications. */
+#define STATE_NOTIF_FIELDS (LTE_LC_STATE_NW_REG_STATUS |	\
+			    LTE_LC_STATE_RRC_MODE |		\
+			    LTE_LC_STATE_CELL |			\
+			    LTE_LC_STATE_PSM_CFG |		\
+			    LTE_LC_STATE_EDRX_CFG)
+
+static struct lte_lc_state link_state;
+static sys_slist_t state_handlers;
+static K_MUTEX_DEFINE(state_mutex);
+
 #if defined(CONFIG_BSD_LIBRARY_TRACE_ENABLED)
 /* Enable modem trace */
 static const char mdm_trace[] = "AT%XMODEMTRACE=1,2";
@@ -317,6 +328,103 @@ clean_exit:
 	return err;
 }
 
+static uint32_t state_field_update(uint32_t field, uint32_t fields, void *dst,
+				   const void *src, size_t len)
+{
+	if (!(fields & field)) {
+		return 0;
+	}
+
+	if ((link_state.valid & field) && (memcmp(dst, src, len) == 0)) {
+		return 0;
+	}
+
+	memcpy(dst, src, len);
+
+	return field;
+}
+
+#define STATE_FIELD_UPDATE(_field, _member)				\
+	state_field_update(_field, fields, &link_state._member,		\
+			   &update->_member, sizeof(link_state._member))
+
+/* Updates the given fields of the link state and calls the handlers
+ * registered for the fields that changed.
+ */
+static void state_update(const struct lte_lc_state *update, uint32_t fields)
+{
+	struct lte_lc_state_handler *handler, *tmp;
+	struct lte_lc_state state;
+	uint32_t changed = 0;
+
+	/* Notifications are only received while the library is initialized,
+	 * outside of that the values would go stale.
+	 */
+	if (!is_initialized) {
+		fields &= ~STATE_NOTIF_FIELDS;
+	}
+
+	k_mutex_lock(&state_mutex, K_FOREVER);
+
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_NW_REG_STATUS,
+				      nw_reg_status);
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_RRC_MODE, rrc_mode);
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_CELL, cell);
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_PSM_CFG, psm_cfg);
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_EDRX_CFG, edrx_cfg);
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_SYSTEM_MODE, system_mode);
+	changed |= STATE_FIELD_UPDATE(LTE_LC_STATE_FUNC_MODE, func_mode);
+
+	link_state.valid |= fields;
+	state = link_state;
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&state_handlers, handler, tmp, node) {
+		if (handler->fields & changed) {
+			handler->cb(&state, handler->fields & changed);
+		}
+	}
+
+	k_mutex_unlock(&state_mutex);
+}
+
+/* Copies the link state, and returns true if all the given fields are known
+ * and the cached values can be used instead of querying the modem.
+ */
+static bool state_cache_get(uint32_t fields, struct lte_lc_state *state)
+{
+	bool known;
+
+	if (!IS_ENABLED(CONFIG_LTE_LC_STATE_CACHE)) {
+		return false;
+	}
+
+	k_mutex_lock(&state_mutex, K_FOREVER);
+	known = ((link_state.valid & fields) == fields);
+	*state = link_state;
+	k_mutex_unlock(&state_mutex);
+
+	return known;
+}
+
+/* Marks the given fields of the link state as unknown, so that the getters
+ * query the modem again.
+ */
+static void state_invalidate(uint32_t fields)
+{
+	k_mutex_lock(&state_mutex, K_FOREVER);
+	link_state.valid &= ~fields;
+	k_mutex_unlock(&state_mutex);
+}
+
+static void func_mode_update(enum lte_lc_func_mode mode)
+{
+	struct lte_lc_state update = {
+		.func_mode = mode,
+	};
+
+	state_update(&update, LTE_LC_STATE_FUNC_MODE);
+}
+
 static void at_handler(void *context, const char *response)
 {
 	ARG_UNUSED(context);
@@ -325,6 +433,7 @@ static void at_handler(void *context, const char *response)
 	bool notify = false;
 	enum lte_lc_notif_type notif_type;
 	struct lte_lc_evt evt;
+	struct lte_lc_state update;
 
 	if (response == NULL) {
 		LOG_ERR("Response buffer is NULL-pointer");
@@ -360,6 +469,13 @@ static void at_handler(void *context, const char *response)
 			k_sem_give(&link);
 		}
 
+		update.nw_reg_status = reg_status;
+		update.cell = cell;
+		update.psm_cfg = psm_cfg;
+		state_update(&update, LTE_LC_STATE_NW_REG_STATUS |
+				      LTE_LC_STATE_CELL |
+				      LTE_LC_STATE_PSM_CFG);
+
 		if (!evt_handler) {
 			return;
 		}
@@ -407,6 +523,9 @@ static void at_handler(void *context, const char *response)
 			return;
 		}
 
+		update.rrc_mode = evt.rrc_mode;
+		state_update(&update, LTE_LC_STATE_RRC_MODE);
+
 		evt.type = LTE_LC_EVT_RRC_UPDATE;
 		notify = true;
 
@@ -420,6 +539,9 @@ static void at_handler(void *context, const char *response)
 			return;
 		}
 
+		update.edrx_cfg = evt.edrx_cfg;
+		state_update(&update, LTE_LC_STATE_EDRX_CFG);
+
 		evt.type = LTE_LC_EVT_EDRX_UPDATE;
 		notify = true;
 
@@ -768,18 +890,26 @@ int lte_lc_init_and_connect_async(lte_lc_evt_handler_t handler)
 int lte_lc_offline(void)
 {
 	if (at_cmd_write(offline, NULL, 0, NULL) != 0) {
+		/* The mode the modem is left in is not known */
+		state_invalidate(LTE_LC_STATE_FUNC_MODE);
 		return -EIO;
 	}
 
+	func_mode_update(LTE_LC_FUNC_MODE_OFFLINE);
+
 	return 0;
 }
 
 int lte_lc_power_off(void)
 {
 	if (at_cmd_write(power_off, NULL, 0, NULL) != 0) {
+		/* The mode the modem is left in is not known */
+		state_invalidate(LTE_LC_STATE_FUNC_MODE);
 		return -EIO;
 	}
 
+	func_mode_update(LTE_LC_FUNC_MODE_POWER_OFF);
+
 	return 0;
 }
 
@@ -788,6 +918,9 @@ int lte_lc_deinit(void)
 	if (is_initialized) {
 		is_initialized = false;
 		at_notif_deregister_handler(NULL, at_handler);
+
+		state_invalidate(STATE_NOTIF_FIELDS);
+
 		return lte_lc_power_off();
 	}
 
@@ -797,9 +930,13 @@ int lte_lc_deinit(void)
 int lte_lc_normal(void)
 {
 	if (at_cmd_write(normal, NULL, 0, NULL) != 0) {
+		/* The mode the modem is left in is not known */
+		state_invalidate(LTE_LC_STATE_FUNC_MODE);
 		return -EIO;
 	}
 
+	func_mode_update(LTE_LC_FUNC_MODE_NORMAL);
+
 	return 0;
 }
 
@@ -843,12 +980,19 @@ int lte_lc_psm_get(int *tau, int *active_time)
 	int err;
 	struct at_param_list at_resp_list = {0};
 	char buf[AT_CEREG_RESPONSE_MAX_LEN] = {0};
-	struct lte_lc_psm_cfg psm_cfg;
+	struct lte_lc_state state;
 
 	if ((tau == NULL) || (active_time == NULL)) {
 		return -EINVAL;
 	}
 
+	if (state_cache_get(LTE_LC_STATE_PSM_CFG, &state)) {
+		*tau = state.psm_cfg.tau;
+		*active_time = state.psm_cfg.active_time;
+
+		return 0;
+	}
+
 	/* Enable network registration status with PSM information */
 	err = at_cmd_write(AT_CEREG_5, NULL, 0, NULL);
 	if (err) {
@@ -878,14 +1022,16 @@ int lte_lc_psm_get(int *tau, int *active_time)
 		goto parse_psm_clean_exit;
 	}
 
-	err = parse_psm_cfg(&at_resp_list, false, &psm_cfg);
+	err = parse_psm_cfg(&at_resp_list, false, &state.psm_cfg);
 	if (err) {
 		LOG_ERR("Could not obtain PSM configuration");
 		goto parse_psm_clean_exit;
 	}
 
-	*tau = psm_cfg.tau;
-	*active_time = psm_cfg.active_time;
+	state_update(&state, LTE_LC_STATE_PSM_CFG);
+
+	*tau = state.psm_cfg.tau;
+	*active_time = state.psm_cfg.active_time;
 
 	LOG_DBG("TAU: %d sec, active time: %d sec\n", *tau, *active_time);
 
@@ -1151,8 +1297,8 @@ static int parse_nw_reg_status(const char *at_response,
 
 	if (!response_is_valid(response_prefix, response_prefix_len,
 			       AT_CEREG_RESPONSE_PREFIX)) {
-		/* The unsolicited response is not a CEREG response, ignore it.
-		 */
+		LOG_ERR("Invalid CEREG response");
+		err = -EIO;
 		goto clean_exit;
 	}
 
@@ -1422,11 +1568,18 @@ int lte_lc_nw_reg_status_get(enum lte_lc_nw_reg_status *status)
 {
 	int err;
 	char buf[AT_CEREG_RESPONSE_MAX_LEN] = {0};
+	struct lte_lc_state state;
 
 	if (status == NULL) {
 		return -EINVAL;
 	}
 
+	if (state_cache_get(LTE_LC_STATE_NW_REG_STATUS, &state)) {
+		*status = state.nw_reg_status;
+
+		return 0;
+	}
+
 	/* Enable network registration status with level 5 */
 	err = at_cmd_write(AT_CEREG_5, NULL, 0, NULL);
 	if (err) {
@@ -1447,6 +1600,9 @@ int lte_lc_nw_reg_status_get(enum lte_lc_nw_reg_status *status)
 		return err;
 	}
 
+	state.nw_reg_status = *status;
+	state_update(&state, LTE_LC_STATE_NW_REG_STATUS);
+
 	return err;
 }
 
@@ -1482,6 +1638,13 @@ int lte_lc_system_mode_set(enum lte_lc_system_mode mode)
 	err = at_cmd_write(cmd, NULL, 0, NULL);
 	if (err) {
 		LOG_ERR("Could not send AT command, error: %d", err);
+		state_invalidate(LTE_LC_STATE_SYSTEM_MODE);
+	} else {
+		struct lte_lc_state update = {
+			.system_mode = mode,
+		};
+
+		state_update(&update, LTE_LC_STATE_SYSTEM_MODE);
 	}
 
 	sys_mode_current = mode;
@@ -1497,11 +1660,18 @@ int lte_lc_system_mode_get(enum lte_lc_system_mode *mode)
 	char response[AT_XSYSTEMMODE_RESPONSE_MAX_LEN] = {0};
 	char response_prefix[sizeof(AT_XSYSTEMMODE_RESPONSE_PREFIX)] = {0};
 	size_t response_prefix_len = sizeof(response_prefix);
+	struct lte_lc_state state;
 
 	if (mode == NULL) {
 		return -EINVAL;
 	}
 
+	if (state_cache_get(LTE_LC_STATE_SYSTEM_MODE, &state)) {
+		*mode = state.system_mode;
+
+		return 0;
+	}
+
 	err = at_cmd_write(AT_XSYSTEMMODE_READ, response, sizeof(response),
 			   NULL);
 	if (err) {
@@ -1590,6 +1760,9 @@ int lte_lc_system_mode_get(enum lte_lc_system_mode *mode)
 		sys_mode_current = *mode;
 	}
 
+	state.system_mode = *mode;
+	state_update(&state, LTE_LC_STATE_SYSTEM_MODE);
+
 clean_exit:
 	at_params_list_free(&resp_list);
 
@@ -1603,11 +1776,18 @@ int lte_lc_func_mode_get(enum lte_lc_func_mode *mode)
 	char response[AT_CFUN_RESPONSE_MAX_LEN] = {0};
 	char response_prefix[sizeof(AT_CFUN_RESPONSE_PREFIX)] = {0};
 	size_t response_prefix_len = sizeof(response_prefix);
+	struct lte_lc_state state;
 
 	if (mode == NULL) {
 		return -EINVAL;
 	}
 
+	if (state_cache_get(LTE_LC_STATE_FUNC_MODE, &state)) {
+		*mode = state.func_mode;
+
+		return 0;
+	}
+
 	err = at_cmd_write(AT_CFUN_READ, response, sizeof(response), NULL);
 	if (err) {
 		LOG_ERR("Could not send AT command");
@@ -1652,12 +1832,53 @@ int lte_lc_func_mode_get(enum lte_lc_func_mode *mode)
 
 	*mode = resp_mode;
 
+	func_mode_update(*mode);
+
 clean_exit:
 	at_params_list_free(&resp_list);
 
 	return err;
 }
 
+int lte_lc_state_get(struct lte_lc_state *state)
+{
+	if (state == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&state_mutex, K_FOREVER);
+	*state = link_state;
+	k_mutex_unlock(&state_mutex);
+
+	return 0;
+}
+
+void lte_lc_state_invalidate(uint32_t fields)
+{
+	state_invalidate(fields);
+}
+
+void lte_lc_state_handler_add(struct lte_lc_state_handler *handler)
+{
+	__ASSERT_NO_MSG(handler != NULL);
+	__ASSERT_NO_MSG(handler->cb != NULL);
+
+	k_mutex_lock(&state_mutex, K_FOREVER);
+	sys_slist_append(&state_handlers, &handler->node);
+	k_mutex_unlock(&state_mutex);
+}
+
+int lte_lc_state_handler_remove(struct lte_lc_state_handler *handler)
+{
+	bool found;
+
+	k_mutex_lock(&state_mutex, K_FOREVER);
+	found = sys_slist_find_and_remove(&state_handlers, &handler->node);
+	k_mutex_unlock(&state_mutex);
+
+	return found ? 0 : -ENOENT;
+}
+
 #if defined(CONFIG_LTE_AUTO_INIT_AND_CONNECT)
 DEVICE_DECLARE(lte_link_control);
 DEVICE_AND_API_INIT(lte_link_control, "LTE_LINK_CONTROL",
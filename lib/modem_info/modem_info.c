@@ -362,25 +362,23 @@ static void flip_iccid_string(char *buf)
 	}
 }
 
-static int modem_info_parse(const struct modem_info_data *modem_data,
-			    const char *buf)
+static int modem_info_parse(const char *buf, uint8_t param_count)
 {
 	int err;
 	uint32_t param_index;
 
 	err = at_parser_max_params_from_str(buf, NULL, &m_param_list,
-					    modem_data->param_count);
+					    param_count);
 
 	if (err == -EAGAIN) {
-		LOG_DBG("More items exist to parse for: %s",
-			modem_data->data_name);
+		LOG_DBG("More items exist to parse");
 		err = 0;
 	} else if (err != 0) {
 		return err;
 	}
 
 	param_index = at_params_valid_count_get(&m_param_list);
-	if (param_index > modem_data->param_count) {
+	if (param_index > param_count) {
 		return -EAGAIN;
 	}
 
@@ -440,7 +438,8 @@ int modem_info_short_get(enum modem_info info, uint16_t *buf)
 		return -EIO;
 	}
 
-	err = modem_info_parse(modem_data[info], &recv_buf[cmd_length]);
+	err = modem_info_parse(&recv_buf[cmd_length],
+			       modem_data[info]->param_count);
 
 	if (err) {
 		return err;
@@ -457,11 +456,13 @@ int modem_info_short_get(enum modem_info info, uint16_t *buf)
 	return sizeof(uint16_t);
 }
 
-int modem_info_string_get(enum modem_info info, char *buf,
-				  const size_t buf_size)
+/* Parses a value from an AT command response. The response buffer is
+ * modified when parsing IP addresses.
+ */
+static int modem_info_string_parse(enum modem_info info, char *recv_buf,
+				   char *buf, const size_t buf_size)
 {
 	int err;
-	char recv_buf[CONFIG_MODEM_INFO_BUFFER_SIZE] = {0};
 	uint16_t param_value;
 	int ip_cnt = 0;
 	char *ip_str_end = recv_buf;
@@ -474,15 +475,6 @@ int modem_info_string_get(enum modem_info info, char *buf,
 	/* return value indicating length of the string written to buf */
 	size_t len = 0;
 
-	if ((buf == NULL) || (buf_size == 0)) {
-		return -EINVAL;
-	}
-
-	err = at_cmd_write(modem_data[info]->cmd,
-			  recv_buf,
-			  CONFIG_MODEM_INFO_BUFFER_SIZE,
-			  NULL);
-
 	/* modem_info does not yet support array objects, so here we handle
 	 * the supported bands independently as a string
 	 */
@@ -500,10 +492,6 @@ int modem_info_string_get(enum modem_info info, char *buf,
 		LOG_DBG("Device contains %d IP addresses", ip_cnt);
 	}
 
-	if (err != 0) {
-		return -EIO;
-	}
-
 parse:
 	if (info == MODEM_INFO_IP_ADDRESS) {
 		/* parse each IP address line separately */
@@ -515,7 +503,8 @@ parse:
 		ip_str_len = ip_str_end - &recv_buf[cmd_rsp_idx];
 		recv_buf[++ip_str_len] = 0;
 	}
-	err = modem_info_parse(modem_data[info], &recv_buf[cmd_rsp_idx]);
+	err = modem_info_parse(&recv_buf[cmd_rsp_idx],
+			       modem_data[info]->param_count);
 
 	if (err) {
 		LOG_ERR("Unable to parse data: %d", err);
@@ -595,6 +584,195 @@ parse:
 	return len <= 0 ? -ENOTSUP : len;
 }
 
+int modem_info_string_get(enum modem_info info, char *buf,
+				  const size_t buf_size)
+{
+	int err;
+	char recv_buf[CONFIG_MODEM_INFO_BUFFER_SIZE] = {0};
+
+	if ((buf == NULL) || (buf_size == 0)) {
+		return -EINVAL;
+	}
+
+	err = at_cmd_write(modem_data[info]->cmd,
+			  recv_buf,
+			  CONFIG_MODEM_INFO_BUFFER_SIZE,
+			  NULL);
+
+	if (err != 0) {
+		return -EIO;
+	}
+
+	return modem_info_string_parse(info, recv_buf, buf, buf_size);
+}
+
+/* Pending values are tracked in a 32-bit mask. */
+BUILD_ASSERT(MODEM_INFO_SNAPSHOT_MAX_PARAMS <= 32);
+
+static bool snapshot_param_fresh(const struct lte_param *param, int64_t now)
+{
+	/* A timestamp ahead of the uptime was not set by an earlier read */
+	if ((CONFIG_MODEM_INFO_SNAPSHOT_MAX_AGE == 0) ||
+	    (param->timestamp <= 0) || (param->timestamp > now)) {
+		return false;
+	}
+
+	return (now - param->timestamp) < CONFIG_MODEM_INFO_SNAPSHOT_MAX_AGE;
+}
+
+/* Values that need more than reading one parameter from the response. */
+static bool snapshot_param_special(enum modem_info info)
+{
+	return (info == MODEM_INFO_SUP_BAND) ||
+	       (info == MODEM_INFO_IP_ADDRESS) ||
+	       (info == MODEM_INFO_ICCID);
+}
+
+/* Reads a value from the parameters of an already parsed response. */
+static int snapshot_param_read(struct lte_param *param)
+{
+	const struct modem_info_data *data = modem_data[param->type];
+	size_t len = sizeof(param->value_string) - 1;
+	int err;
+
+	if (data->data_type == AT_PARAM_TYPE_NUM_SHORT) {
+		return at_params_short_get(&m_param_list, data->param_index,
+					   &param->value);
+	}
+
+	err = at_params_string_get(&m_param_list, data->param_index,
+				   param->value_string, &len);
+	if (err) {
+		return err;
+	}
+
+	param->value_string[len] = '\0';
+
+	return 0;
+}
+
+/* Sends one AT command and reads all values in the group from the
+ * response. The response is parsed once for all values that are read
+ * directly from its parameters.
+ */
+static int snapshot_group_read(struct lte_param *params[], size_t count,
+			       uint32_t group, const char *cmd,
+			       uint8_t param_count)
+{
+	char recv_buf[CONFIG_MODEM_INFO_BUFFER_SIZE] = {0};
+	char rsp_buf[CONFIG_MODEM_INFO_BUFFER_SIZE];
+	bool parsed = false;
+	int64_t now;
+	int ret = 0;
+	int err;
+
+	err = at_cmd_write(cmd, recv_buf, sizeof(recv_buf), NULL);
+	if (err) {
+		LOG_ERR("%s failed: %d", cmd, err);
+		return -EIO;
+	}
+
+	now = k_uptime_get();
+
+	for (size_t i = 0; i < count; i++) {
+		struct lte_param *param = params[i];
+
+		if (!(group & BIT(i))) {
+			continue;
+		}
+
+		if (snapshot_param_special(param->type)) {
+			/* The response buffer may be modified by the parser. */
+			memcpy(rsp_buf, recv_buf, sizeof(rsp_buf));
+			err = modem_info_string_parse(param->type, rsp_buf,
+						      param->value_string,
+						      sizeof(param->value_string));
+			err = (err > 0) ? 0 : err;
+			parsed = false;
+		} else {
+			if (!parsed) {
+				err = modem_info_parse(recv_buf, param_count);
+				if (err) {
+					LOG_ERR("Unable to parse %s response: %d",
+						cmd, err);
+					return err;
+				}
+
+				parsed = true;
+			}
+
+			err = snapshot_param_read(param);
+		}
+
+		if (err) {
+			LOG_ERR("Unable to read %s: %d",
+				modem_data[param->type]->data_name, err);
+			ret = ret ? ret : err;
+			continue;
+		}
+
+		param->timestamp = now;
+	}
+
+	return ret;
+}
+
+int modem_info_snapshot_get(struct lte_param *params[], size_t count)
+{
+	uint32_t pending = 0;
+	int64_t now = k_uptime_get();
+	int ret = 0;
+	int err;
+
+	if ((params == NULL) || (count == 0) ||
+	    (count > MODEM_INFO_SNAPSHOT_MAX_PARAMS)) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if ((params[i] == NULL) || (params[i]->type >= MODEM_INFO_COUNT)) {
+			return -EINVAL;
+		}
+
+		if (!snapshot_param_fresh(params[i], now)) {
+			pending |= BIT(i);
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const char *cmd = modem_data[params[i]->type]->cmd;
+		uint32_t group = 0;
+		uint8_t param_count = 0;
+
+		if (!(pending & BIT(i))) {
+			continue;
+		}
+
+		/* Group all pending values that are read with the same
+		 * AT command.
+		 */
+		for (size_t j = i; j < count; j++) {
+			const struct modem_info_data *data =
+				modem_data[params[j]->type];
+
+			if ((pending & BIT(j)) && (strcmp(data->cmd, cmd) == 0)) {
+				group |= BIT(j);
+				param_count = MAX(param_count, data->param_count);
+			}
+		}
+
+		pending &= ~group;
+
+		err = snapshot_group_read(params, count, group, cmd,
+					  param_count);
+		if (err && !ret) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
 static void modem_info_rsrp_subscribe_handler(void *context, const char *response)
 {
 	ARG_UNUSED(context);
@@ -614,7 +792,7 @@ static void modem_info_rsrp_subscribe_handler(void *context, const char *respons
 		.data_type	= AT_PARAM_TYPE_NUM_SHORT,
 	};
 
-	err = modem_info_parse(&rsrp_notify_data, response);
+	err = modem_info_parse(response, rsrp_notify_data.param_count);
 	if (err != 0) {
 		LOG_ERR("modem_info_parse failed to parse "
 			"CESQ notification, %d", err);
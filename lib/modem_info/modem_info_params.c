@@ -19,6 +19,8 @@ int modem_info_params_init(struct modem_param_info *modem)
 		return -EINVAL;
 	}
 
+	memset(modem, 0, sizeof(*modem));
+
 	modem->network.current_band.type	= MODEM_INFO_CUR_BAND;
 	modem->network.sup_band.type		= MODEM_INFO_SUP_BAND;
 	modem->network.area_code.type		= MODEM_INFO_AREA_CODE;
@@ -98,38 +100,10 @@ static int cellid_to_dec(struct lte_param *cellID, double *cellID_dec)
 	return 0;
 }
 
-static int modem_data_get(struct lte_param *param)
-{
-	enum at_param_type data_type;
-	int ret;
-
-	data_type = modem_info_type_get(param->type);
-
-	if (data_type < 0) {
-		return -EINVAL;
-	}
-
-	if (data_type == AT_PARAM_TYPE_STRING) {
-		ret = modem_info_string_get(param->type,
-				param->value_string,
-				sizeof(param->value_string));
-		if (ret < 0) {
-			LOG_ERR("Link data not obtained: %d %d", param->type, ret);
-			return ret;
-		}
-	} else if (data_type == AT_PARAM_TYPE_NUM_SHORT) {
-		ret = modem_info_short_get(param->type, &param->value);
-		if (ret < 0) {
-			LOG_ERR("Link data not obtained: %d", ret);
-			return ret;
-		}
-	}
-
-	return 0;
-}
-
 int modem_info_params_get(struct modem_param_info *modem)
 {
+	struct lte_param *params[MODEM_INFO_COUNT];
+	size_t count;
 	int ret;
 
 	if (modem == NULL) {
@@ -137,22 +111,24 @@ int modem_info_params_get(struct modem_param_info *modem)
 	}
 
 	if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_NETWORK)) {
-		ret = modem_data_get(&modem->network.current_band);
-		ret += modem_data_get(&modem->network.sup_band);
-		ret += modem_data_get(&modem->network.ip_address);
-		ret += modem_data_get(&modem->network.ue_mode);
-		ret += modem_data_get(&modem->network.current_operator);
-		ret += modem_data_get(&modem->network.cellid_hex);
-		ret += modem_data_get(&modem->network.area_code);
-		ret += modem_data_get(&modem->network.lte_mode);
-		ret += modem_data_get(&modem->network.nbiot_mode);
-		ret += modem_data_get(&modem->network.gps_mode);
-		ret += modem_data_get(&modem->network.apn);
+		count = 0;
+		params[count++] = &modem->network.current_band;
+		params[count++] = &modem->network.sup_band;
+		params[count++] = &modem->network.ip_address;
+		params[count++] = &modem->network.ue_mode;
+		params[count++] = &modem->network.current_operator;
+		params[count++] = &modem->network.cellid_hex;
+		params[count++] = &modem->network.area_code;
+		params[count++] = &modem->network.lte_mode;
+		params[count++] = &modem->network.nbiot_mode;
+		params[count++] = &modem->network.gps_mode;
+		params[count++] = &modem->network.apn;
 
 		if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_DATE_TIME)) {
-			ret += modem_data_get(&modem->network.date_time);
+			params[count++] = &modem->network.date_time;
 		}
 
+		ret = modem_info_snapshot_get(params, count);
 		ret += mcc_mnc_parse(&modem->network.current_operator,
 				&modem->network.mcc,
 				&modem->network.mnc);
@@ -166,13 +142,16 @@ int modem_info_params_get(struct modem_param_info *modem)
 	}
 
 	if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_SIM)) {
-		ret = modem_data_get(&modem->sim.uicc);
+		count = 0;
+		params[count++] = &modem->sim.uicc;
 		if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_SIM_ICCID)) {
-			ret += modem_data_get(&modem->sim.iccid);
+			params[count++] = &modem->sim.iccid;
 		}
 		if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_SIM_IMSI)) {
-			ret += modem_data_get(&modem->sim.imsi);
+			params[count++] = &modem->sim.imsi;
 		}
+
+		ret = modem_info_snapshot_get(params, count);
 		if (ret) {
 			LOG_ERR("Sim data not obtained: %d", ret);
 			return -EAGAIN;
@@ -180,9 +159,12 @@ int modem_info_params_get(struct modem_param_info *modem)
 	}
 
 	if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_DEVICE)) {
-		ret = modem_data_get(&modem->device.modem_fw);
-		ret += modem_data_get(&modem->device.battery);
-		ret += modem_data_get(&modem->device.imei);
+		count = 0;
+		params[count++] = &modem->device.modem_fw;
+		params[count++] = &modem->device.battery;
+		params[count++] = &modem->device.imei;
+
+		ret = modem_info_snapshot_get(params, count);
 		if (ret) {
 			LOG_ERR("Device data not obtained: %d", ret);
 			return -EAGAIN;
@@ -139,7 +139,8 @@ static void cloud_event_handler(const struct cloud_backend *const backend,
 		 * from the cloud. The command can be sent using the terminal
 		 * card on the device page on nrfcloud.com.
 		 */
-		if (evt->data.msg.buf[0] == '{') {
+		if ((evt->data.msg.offset == 0) &&
+		    (evt->data.msg.buf[0] == '{')) {
 			int ret = strncmp(evt->data.msg.buf,
 				      "{\"reboot\":true}",
 				      strlen("{\"reboot\":true}"));
@@ -150,8 +151,11 @@ static void cloud_event_handler(const struct cloud_backend *const backend,
 			break;
 		}
 
-		int err = gps_process_agps_data(evt->data.msg.buf,
-						evt->data.msg.len);
+		/* A-GPS data can be received in several fragments */
+		int err = gps_process_agps_fragment(evt->data.msg.buf,
+						    evt->data.msg.len,
+						    evt->data.msg.offset,
+						    evt->data.msg.total_len);
 		if (err) {
 			LOG_INF("Unable to process agps data, error: %d", err);
 		}
@@ -91,6 +91,46 @@ static void dfu_target_cb(enum dfu_target_evt_id evt)
 	ARG_UNUSED(evt);
 }
 
+/* Bytes of the image the DFU target has. This can be more than has been
+ * received, when the target continues from data stored by an earlier
+ * download.
+ */
+static size_t target_offset;
+
+/* The image is always received from the start, so the data before the
+ * offset of the DFU target is skipped.
+ */
+static int target_write(const uint8_t *data, size_t len, size_t data_offset)
+{
+	size_t skip;
+	int ret;
+
+	if (target_offset < data_offset) {
+		LOG_ERR("DFU target expects data from offset %zu, "
+			"already received", target_offset);
+		return -EIO;
+	}
+
+	skip = MIN(target_offset - data_offset, len);
+	if (skip == len) {
+		return 0;
+	}
+
+	ret = dfu_target_write(&data[skip], len - skip);
+	if (ret == 0) {
+		target_offset = data_offset + len;
+	} else if (ret == -EAGAIN) {
+		ret = dfu_target_offset_get(&target_offset);
+		if (ret == 0) {
+			LOG_INF("DFU target expects data from offset %zu",
+				target_offset);
+			ret = -EAGAIN;
+		}
+	}
+
+	return ret;
+}
+
 static int firmware_block_received_cb(uint16_t obj_inst_id,
 				      uint16_t res_id, uint16_t res_inst_id,
 				      uint8_t *data, uint16_t data_len,
@@ -117,6 +157,18 @@ static int firmware_block_received_cb(uint16_t obj_inst_id,
 			goto cleanup;
 		}
 
+		ret = dfu_target_offset_get(&target_offset);
+		if (ret < 0) {
+			LOG_ERR("Failed to get DFU target offset, err: %d",
+				ret);
+			goto cleanup;
+		}
+
+		if (target_offset > 0) {
+			LOG_INF("Skipping %zu bytes stored by the DFU target",
+				target_offset);
+		}
+
 		LOG_INF("%s firmware download started.",
 			image_type == DFU_TARGET_IMAGE_TYPE_MODEM_DELTA ?
 				"Modem" :
@@ -140,14 +192,19 @@ static int firmware_block_received_cb(uint16_t obj_inst_id,
 		}
 	}
 
-	bytes_downloaded += data_len;
+	ret = target_write(data, data_len, bytes_downloaded);
+	if (ret == -EAGAIN) {
+		/* Write the data from the offset the target expects */
+		ret = target_write(data, data_len, bytes_downloaded);
+	}
 
-	ret = dfu_target_write(data, data_len);
 	if (ret < 0) {
 		LOG_ERR("dfu_target_write error, err %d", ret);
 		goto cleanup;
 	}
 
+	bytes_downloaded += data_len;
+
 	if (!last_block) {
 		/* Keep going */
 		return 0;
@@ -171,6 +228,7 @@ cleanup:
 
 	bytes_downloaded = 0;
 	percent_downloaded = 0;
+	target_offset = 0;
 
 	return ret;
 }
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+
+"""
+Create a delta between two MCUboot images, for the MCUboot delta DFU target
+(CONFIG_DFU_TARGET_MCUBOOT_DELTA). The format is described in
+subsys/dfu/include/dfu_target_mcuboot_delta.h.
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+
+MAGIC = 0x544c4544
+VERSION = 1
+HEADER_FMT = '<IIII32s32s'
+
+OP_COPY = 0
+OP_INSERT = 1
+
+# Shorter matches cost more in instructions than they save
+MIN_MATCH = 12
+KEY_LEN = 8
+
+
+def read_image(path):
+    if path.endswith('.hex'):
+        from intelhex import IntelHex
+        ih = IntelHex(path)
+        ih.padding = 0xff
+        return ih.tobinstr()
+    with open(path, 'rb') as f:
+        return f.read()
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def match_len(source, s, target, t):
+    n = 0
+    limit = min(len(source) - s, len(target) - t)
+    while n < limit and source[s + n] == target[t + n]:
+        n += 1
+    return n
+
+
+def diff(source, target):
+    """Greedy matching against an index of the source. The position that
+    follows the previous copy is tried first, since most of an image is
+    unchanged or moved as a whole.
+    """
+    index = {}
+    for i in range(len(source) - KEY_LEN + 1):
+        index.setdefault(source[i:i + KEY_LEN], []).append(i)
+
+    ops = []
+    source_pos = 0
+    pending = bytearray()
+    t = 0
+
+    def flush_insert():
+        if pending:
+            ops.append(bytes([OP_INSERT]) + varint(len(pending)) +
+                       bytes(pending))
+            pending.clear()
+
+    while t < len(target):
+        best_len = 0
+        best_pos = 0
+
+        if source_pos < len(source):
+            best_len = match_len(source, source_pos, target, t)
+            best_pos = source_pos
+
+        if best_len < MIN_MATCH:
+            for s in index.get(target[t:t + KEY_LEN], [])[:64]:
+                n = match_len(source, s, target, t)
+                if n > best_len:
+                    best_len = n
+                    best_pos = s
+
+        if best_len >= MIN_MATCH:
+            flush_insert()
+            ops.append(bytes([OP_COPY]) +
+                       varint(zigzag(best_pos - source_pos)) +
+                       varint(best_len))
+            source_pos = best_pos + best_len
+            t += best_len
+        else:
+            pending.append(target[t])
+            t += 1
+
+    flush_insert()
+    return b''.join(ops)
+
+
+def apply(source, delta):
+    magic, version, source_size, target_size, source_hash, target_hash = \
+        struct.unpack_from(HEADER_FMT, delta)
+    assert magic == MAGIC and version == VERSION
+    assert hashlib.sha256(source[:source_size]).digest() == source_hash
+
+    def read_varint(i):
+        value = 0
+        shift = 0
+        while True:
+            byte = delta[i]
+            i += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value, i
+
+    out = bytearray()
+    source_pos = 0
+    i = struct.calcsize(HEADER_FMT)
+    while i < len(delta):
+        op = delta[i]
+        i += 1
+        if op == OP_COPY:
+            rel, i = read_varint(i)
+            length, i = read_varint(i)
+            rel = (rel >> 1) ^ -(rel & 1)
+            source_pos += rel
+            out += source[source_pos:source_pos + length]
+            source_pos += length
+        elif op == OP_INSERT:
+            length, i = read_varint(i)
+            out += delta[i:i + length]
+            i += length
+        else:
+            raise ValueError('Unknown instruction {}'.format(op))
+
+    assert len(out) == target_size
+    assert hashlib.sha256(out).digest() == target_hash
+    return bytes(out)
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Create a delta between two MCUboot images.",
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+
+    parser.add_argument("--source", required=True,
+                        help="Image in the primary slot of the device. If a "
+                             "*.hex file is given, it is first converted to "
+                             "binary.")
+    parser.add_argument("--target", required=True,
+                        help="New image, in the same format as --source.")
+    parser.add_argument("--out", required=True,
+                        help="Output file for the delta.")
+    parser.add_argument("--verify", action="store_true",
+                        help="Apply the delta to the source and compare the "
+                             "result with the target.")
+    return parser.parse_args()
+
+
+if __name__ == "__main__":
+    args = parse_args()
+
+    source = read_image(args.source)
+    target = read_image(args.target)
+
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, len(source), len(target),
+                         hashlib.sha256(source).digest(),
+                         hashlib.sha256(target).digest())
+    delta = header + diff(source, target)
+
+    if args.verify and apply(source, delta) != target:
+        sys.exit("Delta verification failed")
+
+    with open(args.out, 'wb') as f:
+        f.write(delta)
+
+    print("{} byte delta for a {} byte image".format(len(delta), len(target)))
@@ -15,11 +15,34 @@
 #define DFU_TARGET_MCUBOOT_H__
 
 #include <stddef.h>
+#include <zephyr/types.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** @brief Timing statistics of the MCUboot DFU target. Times are in
+ *	   microseconds.
+ */
+struct dfu_target_mcuboot_stats {
+	/** Number of calls to dfu_target_mcuboot_write(). */
+	uint32_t writes;
+	/** Total time spent in dfu_target_mcuboot_write(). */
+	uint32_t write_time;
+	/** Longest time spent in one call to dfu_target_mcuboot_write(). */
+	uint32_t write_time_max;
+	/** Number of times the write progress was stored. */
+	uint32_t checkpoints;
+	/** Total time spent storing the write progress. */
+	uint32_t checkpoint_time;
+	/** Number of pages erased ahead of the written data. */
+	uint32_t pre_erases;
+	/** Total time spent erasing pages ahead of the written data. */
+	uint32_t pre_erase_time;
+	/** Number of pages erased when data was written to them. */
+	uint32_t inline_erases;
+};
+
 /**
  * @brief Find correct MCUBoot update file path entry in space separated string.
  *
@@ -77,6 +100,25 @@ int dfu_target_mcuboot_offset_get(size_t *offset);
  */
 int dfu_target_mcuboot_write(const void *const buf, size_t len);
 
+/**
+ * @brief Read back data that has been written to the secondary slot.
+ *
+ * @param[in] offset Offset in the image.
+ * @param[out] buf Buffer for the data.
+ * @param[in] len Number of bytes to read. The data must have been written to
+ *		  flash, see dfu_target_mcuboot_offset_get().
+ *
+ * @return 0 on success, negative errno otherwise.
+ */
+int dfu_target_mcuboot_read(size_t offset, void *buf, size_t len);
+
+/**
+ * @brief Write the buffered data to flash, without finalizing the upgrade.
+ *
+ * @return 0 on success, negative errno otherwise.
+ */
+int dfu_target_mcuboot_flush(void);
+
 /**
  * @brief Deinitialize resources and finalize firmware upgrade if successful.
 
@@ -86,6 +128,18 @@ int dfu_target_mcuboot_write(const void *const buf, size_t len);
  */
 int dfu_target_mcuboot_done(bool successful);
 
+/**
+ * @brief Get the timing statistics of the current or last upgrade.
+ *
+ * The statistics are cleared by dfu_target_mcuboot_init().
+ *
+ * @param[out] stats Statistics.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If CONFIG_DFU_TARGET_MCUBOOT_STATS is disabled.
+ */
+int dfu_target_mcuboot_stats_get(struct dfu_target_mcuboot_stats *stats);
+
 #endif /* DFU_TARGET_MCUBOOT_H__ */
 
 /**@} */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/** @file dfu_target_mcuboot_delta.h
+ *
+ * @defgroup dfu_target_mcuboot_delta MCUboot delta DFU Target
+ * @{
+ * @brief DFU Target for MCUboot upgrades given as a delta against the image
+ *	  in the primary slot
+ */
+
+#ifndef DFU_TARGET_MCUBOOT_DELTA_H__
+#define DFU_TARGET_MCUBOOT_DELTA_H__
+
+#include <stddef.h>
+#include <zephyr/types.h>
+#include <toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Magic word that starts a delta, "DELT". */
+#define DFU_DELTA_MAGIC 0x544c4544
+#define DFU_DELTA_VERSION 1
+#define DFU_DELTA_HASH_LEN 32
+
+/** Copy bytes from the primary slot. Arguments: signed offset from the end of
+ *  the previous copy, zigzag encoded, and length.
+ */
+#define DFU_DELTA_OP_COPY 0
+/** Insert the bytes that follow. Argument: length. */
+#define DFU_DELTA_OP_INSERT 1
+
+/** @brief Header of a delta. Fields are little-endian. It is followed by
+ *	   instructions, each an opcode byte followed by its arguments as
+ *	   unsigned LEB128 numbers.
+ */
+struct dfu_delta_header {
+	uint32_t magic;
+	uint32_t version;
+	/** Size of the image in the primary slot the delta applies to. */
+	uint32_t source_size;
+	/** Size of the resulting image. */
+	uint32_t target_size;
+	/** SHA-256 of the image in the primary slot. */
+	uint8_t source_hash[DFU_DELTA_HASH_LEN];
+	/** SHA-256 of the resulting image. */
+	uint8_t target_hash[DFU_DELTA_HASH_LEN];
+} __packed;
+
+/**
+ * @brief See if data in buf indicates a delta upgrade.
+ *
+ * @retval true if data matches, false otherwise.
+ */
+bool dfu_target_mcuboot_delta_identify(const void *const buf);
+
+/**
+ * @brief Initialize dfu target, perform steps necessary to receive a delta.
+ *
+ * @param[in] file_size Size of the delta.
+ * @param[in] cb Callback for signaling events(unused).
+ *
+ * @retval 0 If successful, negative errno otherwise.
+ */
+int dfu_target_mcuboot_delta_init(size_t file_size, dfu_target_callback_t cb);
+
+/**
+ * @brief Get the number of bytes of the delta that have been applied.
+ *
+ * @param[out] offset Returns the offset in the delta.
+ *
+ * @return 0 if success, otherwise negative value if unable to get the offset
+ */
+int dfu_target_mcuboot_delta_offset_get(size_t *offset);
+
+/**
+ * @brief Apply part of the delta. The resulting image is written to the
+ *	  secondary slot.
+ *
+ * @param[in] buf Pointer to the delta data.
+ * @param[in] len Length of the delta data.
+ *
+ * @retval 0 on success.
+ * @retval -ENOEXEC if the delta is not for the image in the primary slot.
+ * @retval -EINVAL if the delta is invalid. Otherwise negative errno.
+ */
+int dfu_target_mcuboot_delta_write(const void *const buf, size_t len);
+
+/**
+ * @brief Deinitialize resources and finalize firmware upgrade if successful.
+ *
+ * The hash of the resulting image is verified in the secondary slot before
+ * the upgrade is requested.
+ *
+ * @param[in] successful Indicate whether the delta was successfully received.
+ *
+ * @return 0 on success, negative errno otherwise.
+ */
+int dfu_target_mcuboot_delta_done(bool successful);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DFU_TARGET_MCUBOOT_DELTA_H__ */
+
+/**@} */
@@ -41,6 +41,10 @@ int dfu_target_modem_init(size_t file_size, dfu_target_callback_t callback);
 /**
  * @brief Get offset of firmware
  *
+ * The offset is the number of bytes the modem has received. After
+ * initialization, it is the offset the modem has stored from an earlier
+ * download, if any.
+ *
  * @param[out] offset Returns the offset of the firmware upgrade.
  *
  * @return 0 if success, otherwise negative value if unable to get the offset
@@ -50,9 +54,16 @@ int dfu_target_modem_offset_get(size_t *offset);
 /**
  * @brief Write firmware data.
  *
+ * The data is copied, and sent to the modem from a separate thread while the
+ * next data is downloaded. The function only blocks when the modem has not
+ * received the data of the previous calls yet. An error of an earlier write is
+ * returned by the next call, or by dfu_target_modem_done().
+ *
  * @param[in] buf Pointer to data that should be written.
  * @param[in] len Length of data to write.
  *
+ * @retval -EAGAIN if the modem expects data from another offset. Continue
+ *		   from the offset given by dfu_target_modem_offset_get().
  * @return 0 on success, negative errno otherwise.
  */
 int dfu_target_modem_write(const void *const buf, size_t len);
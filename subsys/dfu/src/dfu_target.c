@@ -24,6 +24,10 @@ DEF_DFU_TARGET(modem);
 #include "dfu_target_mcuboot.h"
 DEF_DFU_TARGET(mcuboot);
 #endif
+#ifdef CONFIG_DFU_TARGET_MCUBOOT_DELTA
+#include "dfu_target_mcuboot_delta.h"
+DEF_DFU_TARGET(mcuboot_delta);
+#endif
 
 #define MIN_SIZE_IDENTIFY_BUF 32
 
@@ -31,6 +35,155 @@ LOG_MODULE_REGISTER(dfu_target, CONFIG_DFU_TARGET_LOG_LEVEL);
 
 static const struct dfu_target *current_target;
 
+#ifdef CONFIG_DFU_TARGET_HASH_CHECK
+#include <string.h>
+#include <tinycrypt/constants.h>
+#include <tinycrypt/sha256.h>
+
+/* Size of the reads when hashing data written before a resumed download */
+#define HASH_READ_SIZE 64
+
+static struct {
+	struct tc_sha256_state_struct state;
+	uint8_t expected[DFU_TARGET_HASH_LEN];
+	bool enabled;
+} hash;
+
+static void hash_clear(void)
+{
+	hash.enabled = false;
+}
+
+static void hash_update(const void *const buf, size_t len)
+{
+	if (hash.enabled) {
+		(void)tc_sha256_update(&hash.state, buf, len);
+	}
+}
+
+/* Hash the data written before the offset the target continues from */
+static int hash_resume(size_t len)
+{
+#ifdef CONFIG_DFU_TARGET_MCUBOOT
+	if (current_target == &dfu_target_mcuboot) {
+		uint8_t buf[HASH_READ_SIZE];
+		size_t chunk;
+		int err;
+
+		for (size_t off = 0; off < len; off += chunk) {
+			chunk = MIN(len - off, sizeof(buf));
+
+			err = dfu_target_mcuboot_read(off, buf, chunk);
+			if (err != 0) {
+				return err;
+			}
+
+			(void)tc_sha256_update(&hash.state, buf, chunk);
+		}
+
+		return 0;
+	}
+#endif
+	LOG_WRN("The data written before offset %d cannot be hashed", len);
+	return -ENOTSUP;
+}
+
+static int hash_check(void)
+{
+	uint8_t digest[DFU_TARGET_HASH_LEN];
+
+	if (!hash.enabled) {
+		return 0;
+	}
+
+	hash.enabled = false;
+
+	if (tc_sha256_final(digest, &hash.state) != TC_CRYPTO_SUCCESS) {
+		return -EIO;
+	}
+
+	if (memcmp(digest, hash.expected, sizeof(digest)) != 0) {
+		LOG_ERR("Hash of the image does not match the expected hash");
+		return -EBADMSG;
+	}
+
+	LOG_INF("Image hash verified");
+	return 0;
+}
+
+/* Start hashing at the offset the target continues from */
+static int hash_start(void)
+{
+	size_t offset;
+	int err;
+
+	err = current_target->offset_get(&offset);
+	if (err != 0) {
+		return err;
+	}
+
+	if (tc_sha256_init(&hash.state) != TC_CRYPTO_SUCCESS) {
+		return -EIO;
+	}
+
+	if (offset > 0) {
+		return hash_resume(offset);
+	}
+
+	return 0;
+}
+
+/* The target continues from another offset than the one it was given data
+ * for, so the hash must start again.
+ */
+static void hash_rewind(void)
+{
+	if (hash.enabled && hash_start() != 0) {
+		LOG_WRN("Image hash will not be verified");
+		hash.enabled = false;
+	}
+}
+
+int dfu_target_hash_set(const uint8_t *expected)
+{
+	int err;
+
+	if (current_target == NULL) {
+		return -EACCES;
+	}
+
+	hash_clear();
+
+	if (expected == NULL) {
+		return 0;
+	}
+
+	err = hash_start();
+	if (err != 0) {
+		return err;
+	}
+
+	memcpy(hash.expected, expected, sizeof(hash.expected));
+	hash.enabled = true;
+
+	return 0;
+}
+#else
+static inline void hash_clear(void) {}
+static inline void hash_update(const void *const buf, size_t len) {}
+static inline void hash_rewind(void) {}
+static inline int hash_check(void)
+{
+	return 0;
+}
+
+int dfu_target_hash_set(const uint8_t *expected)
+{
+	ARG_UNUSED(expected);
+	return -ENOTSUP;
+}
+#endif /* CONFIG_DFU_TARGET_HASH_CHECK */
+
 int dfu_target_img_type(const void *const buf, size_t len)
 {
 #ifdef CONFIG_DFU_TARGET_MCUBOOT
@@ -38,6 +191,11 @@ int dfu_target_img_type(const void *const buf, size_t len)
 		return DFU_TARGET_IMAGE_TYPE_MCUBOOT;
 	}
 #endif
+#ifdef CONFIG_DFU_TARGET_MCUBOOT_DELTA
+	if (dfu_target_mcuboot_delta_identify(buf)) {
+		return DFU_TARGET_IMAGE_TYPE_MCUBOOT_DELTA;
+	}
+#endif
 #ifdef CONFIG_DFU_TARGET_MODEM
 	if (dfu_target_modem_identify(buf)) {
 		return DFU_TARGET_IMAGE_TYPE_MODEM_DELTA;
@@ -60,6 +218,11 @@ int dfu_target_init(int img_type, size_t file_size, dfu_target_callback_t cb)
 		new_target = &dfu_target_mcuboot;
 	}
 #endif
+#ifdef CONFIG_DFU_TARGET_MCUBOOT_DELTA
+	if (img_type == DFU_TARGET_IMAGE_TYPE_MCUBOOT_DELTA) {
+		new_target = &dfu_target_mcuboot_delta;
+	}
+#endif
 #ifdef CONFIG_DFU_TARGET_MODEM
 	if (img_type == DFU_TARGET_IMAGE_TYPE_MODEM_DELTA) {
 		new_target = &dfu_target_modem;
@@ -70,6 +233,8 @@ int dfu_target_init(int img_type, size_t file_size, dfu_target_callback_t cb)
 		return -ENOTSUP;
 	}
 
+	hash_clear();
+
 	/* The user is re-initializing with an previously aborted target.
 	 * Avoid re-initializing generally to ensure that the download can
 	 * continue where it left off. Re-initializing is required for modem
@@ -96,11 +261,23 @@ int dfu_target_offset_get(size_t *offset)
 
 int dfu_target_write(const void *const buf, size_t len)
 {
+	int err;
+
 	if (current_target == NULL || buf == NULL) {
 		return -EACCES;
 	}
 
-	return current_target->write(buf, len);
+	err = current_target->write(buf, len);
+	if (err == -EAGAIN) {
+		hash_rewind();
+	}
+	if (err != 0) {
+		return err;
+	}
+
+	hash_update(buf, len);
+
+	return 0;
 }
 
 int dfu_target_done(bool successful)
@@ -111,6 +288,16 @@ int dfu_target_done(bool successful)
 		return -EACCES;
 	}
 
+	if (successful) {
+		err = hash_check();
+		if (err != 0) {
+			(void)current_target->done(false);
+			return err;
+		}
+	}
+
+	hash_clear();
+
 	err = current_target->done(successful);
 	if (err != 0) {
 		LOG_ERR("Unable to clean up dfu_target");
@@ -126,6 +313,8 @@ int dfu_target_done(bool successful)
 
 int dfu_target_reset(void)
 {
+	hash_clear();
+
 	if (current_target != NULL) {
 		int err = current_target->done(false);
 
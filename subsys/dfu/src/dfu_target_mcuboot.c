@@ -24,14 +24,75 @@
 #include <dfu/dfu_target.h>
 #include <dfu/flash_img.h>
 #include <settings/settings.h>
+#include <storage/flash_map.h>
+
+#include "dfu_target_mcuboot.h"
 
 LOG_MODULE_REGISTER(dfu_target_mcuboot, CONFIG_DFU_TARGET_LOG_LEVEL);
 
 #define MAX_FILE_SEARCH_LEN 500
 #define MCUBOOT_HEADER_MAGIC 0x96f3b83d
 
+#if defined(CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS_INTERVAL)
+#define SAVE_PROGRESS_INTERVAL CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS_INTERVAL
+#else
+#define SAVE_PROGRESS_INTERVAL 0
+#endif
+
+#if defined(CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE_PAGES)
+#define PRE_ERASE_PAGES CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE_PAGES
+#else
+#define PRE_ERASE_PAGES 0
+#endif
+
 static struct flash_img_context flash_img;
 
+/* Write progress when it was last stored */
+static size_t stored_progress;
+
+/* The settings handler is registered on the first init */
+static bool settings_registered;
+
+/* Size of the image given at init */
+static size_t image_size;
+
+/* The flash context was reset when the image was done or aborted. As
+ * dfu_target does not initialize the same target again, the next write
+ * starts the image again.
+ */
+static bool context_reset;
+
+/* Offsets relative to the start of the secondary slot. The pages up to
+ * erased_end are erased, either by the stream when data was written to
+ * them, or ahead of the written data by the pre-erase work.
+ */
+static struct {
+	size_t erased_end;
+	/* No page is erased ahead of the written data beyond this offset */
+	size_t image_end;
+} pre_erase;
+
+static struct dfu_target_mcuboot_stats stats;
+
+/* Protects flash_img, pre_erase and stats, as pages are erased from the
+ * system workqueue.
+ */
+static K_MUTEX_DEFINE(flash_img_lock);
+
+static void pre_erase_work_fn(struct k_work *work);
+static K_WORK_DEFINE(pre_erase_work, pre_erase_work_fn);
+
+static uint32_t time_start(void)
+{
+	return IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_STATS) ?
+	       k_cycle_get_32() : 0;
+}
+
+static uint32_t time_since(uint32_t start)
+{
+	return k_cyc_to_us_floor32(k_cycle_get_32() - start);
+}
+
 int dfu_ctx_mcuboot_set_b1_file(const char *file, bool s0_active,
 				const char **update)
 {
@@ -78,6 +139,7 @@ static int store_flash_img_context(void)
 	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS)) {
 		char key[] = MODULE "/" FILE_FLASH_IMG;
 		size_t bytes_written = flash_img_bytes_written(&flash_img);
+		uint32_t start = time_start();
 		int err = settings_save_one(key, &bytes_written,
 					    sizeof(bytes_written));
 
@@ -85,6 +147,190 @@ static int store_flash_img_context(void)
 			LOG_ERR("Problem storing offset (err %d)", err);
 			return err;
 		}
+
+		stored_progress = bytes_written;
+
+		if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_STATS)) {
+			stats.checkpoints++;
+			stats.checkpoint_time += time_since(start);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Store the write progress if it has advanced by at least
+ *	  CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS_INTERVAL bytes since it was
+ *	  last stored.
+ */
+static int checkpoint(void)
+{
+	size_t progress = flash_img_bytes_written(&flash_img);
+
+	if ((progress == stored_progress) ||
+	    (progress - stored_progress < SAVE_PROGRESS_INTERVAL)) {
+		return 0;
+	}
+
+	return store_flash_img_context();
+}
+
+static int slot_page_get(size_t off, struct flash_pages_info *info)
+{
+	return flash_get_page_info_by_offs(flash_img.stream.fdev,
+					   flash_img.stream.offset + off, info);
+}
+
+static size_t slot_page_end(const struct flash_pages_info *info)
+{
+	return info->start_offset + info->size - flash_img.stream.offset;
+}
+
+/**
+ * @brief Erase the next page ahead of the written data, and resubmit until
+ *	  CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE_PAGES pages are erased ahead.
+ *	  One page is erased per run, so that the writer waits for at most
+ *	  one page erase.
+ */
+static void pre_erase_work_fn(struct k_work *work)
+{
+	const struct device *fdev = flash_img.stream.fdev;
+	struct flash_pages_info info;
+	size_t progress;
+	uint32_t start;
+	int err;
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&flash_img_lock, K_FOREVER);
+
+	if (pre_erase.erased_end >= pre_erase.image_end) {
+		goto out;
+	}
+
+	err = slot_page_get(pre_erase.erased_end, &info);
+	if (err) {
+		goto fail;
+	}
+
+	progress = flash_img_bytes_written(&flash_img);
+	if (pre_erase.erased_end >= progress + PRE_ERASE_PAGES * info.size) {
+		goto out;
+	}
+
+	start = time_start();
+
+	err = flash_write_protection_set(fdev, false);
+	if (err) {
+		goto fail;
+	}
+
+	err = flash_erase(fdev, info.start_offset, info.size);
+	(void)flash_write_protection_set(fdev, true);
+	if (err) {
+		goto fail;
+	}
+
+	pre_erase.erased_end = slot_page_end(&info);
+
+	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_STATS)) {
+		stats.pre_erases++;
+		stats.pre_erase_time += time_since(start);
+	}
+
+	k_mutex_unlock(&flash_img_lock);
+	k_work_submit(&pre_erase_work);
+	return;
+
+fail:
+	/* Pages are then erased when data is written to them */
+	LOG_WRN("Unable to erase ahead of the written data: %d", err);
+	pre_erase.image_end = 0;
+out:
+	k_mutex_unlock(&flash_img_lock);
+}
+
+static void pre_erase_init(size_t file_size)
+{
+	/* The pages before the written data are not written again */
+	pre_erase.erased_end = flash_img_bytes_written(&flash_img);
+	pre_erase.image_end = IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE) ?
+			      file_size : 0;
+
+	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE)) {
+		k_work_submit(&pre_erase_work);
+	}
+}
+
+/**
+ * @brief Move the restored write progress back to the start of the page it
+ *	  ends in. The progress may be stored in the middle of a page, and more
+ *	  data may have been written after it before the reset, so that page
+ *	  is erased and written again.
+ */
+static void progress_align(void)
+{
+	struct flash_pages_info info;
+	size_t progress = flash_img_bytes_written(&flash_img);
+
+	if ((progress > 0) && (slot_page_get(progress, &info) == 0)) {
+		flash_img.stream.bytes_written = info.start_offset -
+						 flash_img.stream.offset;
+	}
+}
+
+/**
+ * @brief Start writing the image from the restored write progress.
+ */
+static void image_start(void)
+{
+	memset(&stats, 0, sizeof(stats));
+
+	progress_align();
+	stored_progress = flash_img_bytes_written(&flash_img);
+	pre_erase_init(image_size);
+
+	context_reset = false;
+}
+
+/**
+ * @brief Write to the flash_img buffer. The data must flush the buffer at
+ *	  most once. If the page that the flush writes to is already erased,
+ *	  the stream is told not to erase it again.
+ */
+static int buffered_write(const uint8_t *data, size_t len, bool flush)
+{
+	struct stream_flash_ctx *stream = &flash_img.stream;
+	struct flash_pages_info info;
+	size_t flush_len = flush ? stream->buf_bytes + len : stream->buf_len;
+	size_t last = stream->bytes_written + flush_len - 1;
+	off_t erased;
+	int err;
+
+	if ((flush_len > 0) && (last < pre_erase.erased_end) &&
+	    (slot_page_get(last, &info) == 0)) {
+		stream->last_erased_page_start_offset = info.start_offset;
+	}
+
+	erased = stream->last_erased_page_start_offset;
+
+	err = flash_img_buffered_write(&flash_img, (uint8_t *)data, len, flush);
+	if (err != 0) {
+		LOG_ERR("flash_img_buffered_write error %d", err);
+		return err;
+	}
+
+	if ((stream->last_erased_page_start_offset != erased) &&
+	    (flash_get_page_info_by_offs(stream->fdev,
+					 stream->last_erased_page_start_offset,
+					 &info) == 0)) {
+		pre_erase.erased_end = MAX(pre_erase.erased_end,
+					   slot_page_end(&info));
+
+		if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_STATS)) {
+			stats.inline_erases++;
+		}
 	}
 
 	return 0;
@@ -120,12 +366,7 @@ bool dfu_target_mcuboot_identify(const void *const buf)
 int dfu_target_mcuboot_init(size_t file_size, dfu_target_callback_t cb)
 {
 	ARG_UNUSED(cb);
-	int err = flash_img_init(&flash_img);
-
-	if (err != 0) {
-		LOG_ERR("flash_img_init error %d", err);
-		return err;
-	}
+	int err;
 
 	if (file_size > PM_MCUBOOT_SECONDARY_SIZE) {
 		LOG_ERR("Requested file too big to fit in flash %zu > 0x%x",
@@ -133,6 +374,14 @@ int dfu_target_mcuboot_init(size_t file_size, dfu_target_callback_t cb)
 		return -EFBIG;
 	}
 
+	k_mutex_lock(&flash_img_lock, K_FOREVER);
+
+	err = flash_img_init(&flash_img);
+	if (err != 0) {
+		LOG_ERR("flash_img_init error %d", err);
+		goto out;
+	}
+
 	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS)) {
 		static struct settings_handler sh = {
 			.name = MODULE,
@@ -143,23 +392,33 @@ int dfu_target_mcuboot_init(size_t file_size, dfu_target_callback_t cb)
 		err = settings_subsys_init();
 		if (err) {
 			LOG_ERR("settings_subsys_init failed (err %d)", err);
-			return err;
+			goto out;
 		}
 
-		err = settings_register(&sh);
-		if (err) {
-			LOG_ERR("Cannot register settings (err %d)", err);
-			return err;
+		if (!settings_registered) {
+			err = settings_register(&sh);
+			if (err) {
+				LOG_ERR("Cannot register settings (err %d)",
+					err);
+				goto out;
+			}
+
+			settings_registered = true;
 		}
 
 		err = settings_load();
 		if (err) {
 			LOG_ERR("Cannot load settings (err %d)", err);
-			return err;
+			goto out;
 		}
 	}
 
-	return 0;
+	image_size = file_size;
+	image_start();
+
+out:
+	k_mutex_unlock(&flash_img_lock);
+	return err;
 }
 
 int dfu_target_mcuboot_offset_get(size_t *out)
@@ -170,29 +429,78 @@ int dfu_target_mcuboot_offset_get(size_t *out)
 
 int dfu_target_mcuboot_write(const void *const buf, size_t len)
 {
-	int err = flash_img_buffered_write(&flash_img, (uint8_t *)buf, len, false);
+	const uint8_t *data = buf;
+	uint32_t start = time_start();
+	size_t progress;
+	size_t chunk;
+	int err = 0;
 
-	if (err != 0) {
-		LOG_ERR("flash_img_buffered_write error %d", err);
-		return err;
+	k_mutex_lock(&flash_img_lock, K_FOREVER);
+
+	if (context_reset) {
+		image_start();
 	}
 
-	err = store_flash_img_context();
-	if (err != 0) {
-		/* Failing to store progress is not a critical error you'll just
-		 * be left to download a bit more if you fail and resume.
-		 */
-		LOG_WRN("Unable to store write progress: %d", err);
+	progress = flash_img_bytes_written(&flash_img);
+
+	/* Split the data where it fills the buffer, so that each part
+	 * flushes the buffer at most once.
+	 */
+	while (len > 0) {
+		chunk = MIN(len, flash_img.stream.buf_len -
+				 flash_img.stream.buf_bytes);
+
+		err = buffered_write(data, chunk, false);
+		if (err != 0) {
+			goto out;
+		}
+
+		data += chunk;
+		len -= chunk;
 	}
 
-	return 0;
+	if (flash_img_bytes_written(&flash_img) != progress) {
+		err = checkpoint();
+		if (err != 0) {
+			/* Failing to store progress is not a critical error
+			 * you'll just be left to download a bit more if you
+			 * fail and resume.
+			 */
+			LOG_WRN("Unable to store write progress: %d", err);
+			err = 0;
+		}
+
+		if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE)) {
+			k_work_submit(&pre_erase_work);
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_STATS)) {
+		uint32_t time = time_since(start);
+
+		stats.writes++;
+		stats.write_time += time;
+		stats.write_time_max = MAX(stats.write_time_max, time);
+	}
+
+out:
+	k_mutex_unlock(&flash_img_lock);
+	return err;
 }
 
 static void reset_flash_context(void)
 {
-	/* Need to set bytes_written to 0 */
-	int err = flash_img_init(&flash_img);
+	int err;
+
+	k_mutex_lock(&flash_img_lock, K_FOREVER);
 
+	/* Stop erasing ahead of the written data until the next write */
+	pre_erase.erased_end = 0;
+	pre_erase.image_end = 0;
+	context_reset = true;
+
+	/* Need to set bytes_written to 0 */
+	err = flash_img_init(&flash_img);
 	if (err) {
 		LOG_ERR("Unable to re-initialize flash_img");
 	}
@@ -200,6 +508,39 @@ static void reset_flash_context(void)
 	if (err != 0) {
 		LOG_ERR("Unable to reset write progress: %d", err);
 	}
+
+	k_mutex_unlock(&flash_img_lock);
+}
+
+int dfu_target_mcuboot_read(size_t offset, void *buf, size_t len)
+{
+	const struct flash_area *fa;
+	int err;
+
+	if (offset + len > flash_img_bytes_written(&flash_img)) {
+		return -EINVAL;
+	}
+
+	err = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	if (err != 0) {
+		return err;
+	}
+
+	err = flash_area_read(fa, offset, buf, len);
+	flash_area_close(fa);
+
+	return err;
+}
+
+int dfu_target_mcuboot_flush(void)
+{
+	int err;
+
+	k_mutex_lock(&flash_img_lock, K_FOREVER);
+	err = buffered_write(NULL, 0, true);
+	k_mutex_unlock(&flash_img_lock);
+
+	return err;
 }
 
 int dfu_target_mcuboot_done(bool successful)
@@ -207,9 +548,8 @@ int dfu_target_mcuboot_done(bool successful)
 	int err = 0;
 
 	if (successful) {
-		err = flash_img_buffered_write(&flash_img, NULL, 0, true);
+		err = dfu_target_mcuboot_flush();
 		if (err != 0) {
-			LOG_ERR("flash_img_buffered_write error %d", err);
 			reset_flash_context();
 			return err;
 		}
@@ -230,3 +570,16 @@ int dfu_target_mcuboot_done(bool successful)
 	reset_flash_context();
 	return err;
 }
+
+int dfu_target_mcuboot_stats_get(struct dfu_target_mcuboot_stats *out)
+{
+	if (!IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_STATS)) {
+		return -ENOTSUP;
+	}
+
+	k_mutex_lock(&flash_img_lock, K_FOREVER);
+	*out = stats;
+	k_mutex_unlock(&flash_img_lock);
+
+	return 0;
+}
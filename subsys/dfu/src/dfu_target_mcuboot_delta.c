@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <pm_config.h>
+#include <logging/log.h>
+#include <sys/byteorder.h>
+#include <storage/flash_map.h>
+#include <dfu/dfu_target.h>
+
+#include "dfu_target_mcuboot.h"
+#include "dfu_target_mcuboot_delta.h"
+
+LOG_MODULE_REGISTER(dfu_target_mcuboot_delta, CONFIG_DFU_TARGET_LOG_LEVEL);
+
+/* An unsigned LEB128 number of up to 32 bits takes at most 5 bytes */
+#define VARINT_SHIFT_MAX 28
+#define ARGS_MAX 2
+
+enum delta_state {
+	STATE_HEADER,
+	STATE_OPCODE,
+	STATE_ARGS,
+	STATE_INSERT,
+	/* The delta was invalid, everything is rejected until done */
+	STATE_ERROR,
+};
+
+static struct {
+	enum delta_state state;
+	/* Bytes of the delta that have been applied */
+	size_t offset;
+	union {
+		struct dfu_delta_header header;
+		uint8_t header_buf[sizeof(struct dfu_delta_header)];
+	};
+	size_t header_len;
+	uint32_t source_size;
+	uint32_t target_size;
+	/* Image in the primary slot */
+	const struct flash_area *source;
+	bool mcuboot_started;
+	/* Current instruction */
+	uint8_t opcode;
+	uint8_t arg_count;
+	uint8_t arg_index;
+	uint8_t arg_shift;
+	uint32_t args[ARGS_MAX];
+	/* Bytes left to insert */
+	uint32_t remaining;
+	/* End of the previous copy in the source image */
+	uint32_t source_pos;
+	/* Bytes of the resulting image written to the secondary slot */
+	uint32_t written;
+} delta;
+
+/* Used to copy from the primary slot and to read the slots for hashing */
+static uint8_t copy_buf[CONFIG_DFU_TARGET_MCUBOOT_DELTA_BUF_SIZE];
+
+static void delta_reset(void)
+{
+	if (delta.source != NULL) {
+		flash_area_close(delta.source);
+	}
+
+	memset(&delta, 0, sizeof(delta));
+	delta.state = STATE_HEADER;
+}
+
+static int slot_hash_check(const struct flash_area *fa, const uint8_t *hash,
+			   size_t len)
+{
+	struct flash_area_check fac = {
+		.match = hash,
+		.clen = len,
+		.off = 0,
+		.rbuf = copy_buf,
+		.rblen = sizeof(copy_buf),
+	};
+
+	return flash_area_check_int_sha256(fa, &fac);
+}
+
+/* Start the MCUboot target that writes the resulting image. A delta is not
+ * resumed after a reset, so progress stored by an earlier download is
+ * discarded.
+ */
+static int mcuboot_start(void)
+{
+	size_t offset;
+	int err;
+
+	err = dfu_target_mcuboot_init(delta.target_size, NULL);
+	if (err) {
+		return err;
+	}
+
+	delta.mcuboot_started = true;
+
+	err = dfu_target_mcuboot_offset_get(&offset);
+	if (err || offset == 0) {
+		return err;
+	}
+
+	LOG_INF("Discarding stored progress of an earlier upgrade");
+
+	err = dfu_target_mcuboot_done(false);
+	if (err) {
+		return err;
+	}
+
+	return dfu_target_mcuboot_init(delta.target_size, NULL);
+}
+
+static int header_process(void)
+{
+	const struct dfu_delta_header *header = &delta.header;
+	int err;
+
+	if (sys_le32_to_cpu(header->magic) != DFU_DELTA_MAGIC) {
+		LOG_ERR("Not a delta");
+		return -EINVAL;
+	}
+
+	if (sys_le32_to_cpu(header->version) != DFU_DELTA_VERSION) {
+		LOG_ERR("Unsupported delta version %d",
+			sys_le32_to_cpu(header->version));
+		return -EINVAL;
+	}
+
+	delta.source_size = sys_le32_to_cpu(header->source_size);
+	delta.target_size = sys_le32_to_cpu(header->target_size);
+
+	if ((delta.target_size == 0) ||
+	    (delta.target_size > PM_MCUBOOT_SECONDARY_SIZE)) {
+		LOG_ERR("Invalid image size %d", delta.target_size);
+		return -EFBIG;
+	}
+
+	err = flash_area_open(FLASH_AREA_ID(image_0), &delta.source);
+	if (err) {
+		LOG_ERR("Cannot open the primary slot (err %d)", err);
+		delta.source = NULL;
+		return err;
+	}
+
+	if ((delta.source_size > delta.source->fa_size) ||
+	    (slot_hash_check(delta.source, header->source_hash,
+			     delta.source_size) != 0)) {
+		LOG_ERR("The delta is not for the image in the primary slot");
+		return -ENOEXEC;
+	}
+
+	LOG_INF("Applying delta, %d byte image from %d byte image",
+		delta.target_size, delta.source_size);
+
+	return mcuboot_start();
+}
+
+static int image_write(const uint8_t *buf, size_t len)
+{
+	int err;
+
+	if (len > delta.target_size - delta.written) {
+		LOG_ERR("Delta writes beyond the end of the image");
+		return -EINVAL;
+	}
+
+	err = dfu_target_mcuboot_write(buf, len);
+	if (err) {
+		return err;
+	}
+
+	delta.written += len;
+
+	return 0;
+}
+
+static int copy_run(void)
+{
+	/* Zigzag decoding of the offset from the end of the previous copy */
+	int32_t rel = (int32_t)(delta.args[0] >> 1) ^ -(int32_t)(delta.args[0] & 1);
+	uint32_t pos = delta.source_pos + rel;
+	uint32_t len = delta.args[1];
+	size_t chunk;
+	int err;
+
+	if ((pos > delta.source_size) || (len > delta.source_size - pos)) {
+		LOG_ERR("Copy outside of the source image");
+		return -EINVAL;
+	}
+
+	delta.source_pos = pos + len;
+
+	while (len > 0) {
+		chunk = MIN(len, sizeof(copy_buf));
+
+		err = flash_area_read(delta.source, pos, copy_buf, chunk);
+		if (err) {
+			LOG_ERR("Cannot read the primary slot (err %d)", err);
+			return err;
+		}
+
+		err = image_write(copy_buf, chunk);
+		if (err) {
+			return err;
+		}
+
+		pos += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+static int opcode_process(uint8_t opcode)
+{
+	switch (opcode) {
+	case DFU_DELTA_OP_COPY:
+		delta.arg_count = 2;
+		break;
+	case DFU_DELTA_OP_INSERT:
+		delta.arg_count = 1;
+		break;
+	default:
+		LOG_ERR("Unknown delta instruction 0x%02x", opcode);
+		return -EINVAL;
+	}
+
+	delta.opcode = opcode;
+	delta.arg_index = 0;
+	delta.arg_shift = 0;
+	delta.args[0] = 0;
+	delta.state = STATE_ARGS;
+
+	return 0;
+}
+
+static int arg_process(uint8_t byte)
+{
+	if ((delta.arg_shift > VARINT_SHIFT_MAX) ||
+	    ((delta.arg_shift == VARINT_SHIFT_MAX) && ((byte & 0x7f) > 0x0f))) {
+		LOG_ERR("Delta argument too large");
+		return -EINVAL;
+	}
+
+	delta.args[delta.arg_index] |= (uint32_t)(byte & 0x7f) <<
+				       delta.arg_shift;
+	delta.arg_shift += 7;
+
+	if (byte & 0x80) {
+		return 0;
+	}
+
+	if (++delta.arg_index < delta.arg_count) {
+		delta.args[delta.arg_index] = 0;
+		delta.arg_shift = 0;
+		return 0;
+	}
+
+	if (delta.opcode == DFU_DELTA_OP_COPY) {
+		delta.state = STATE_OPCODE;
+		return copy_run();
+	}
+
+	delta.remaining = delta.args[0];
+	delta.state = delta.remaining ? STATE_INSERT : STATE_OPCODE;
+
+	return 0;
+}
+
+bool dfu_target_mcuboot_delta_identify(const void *const buf)
+{
+	return sys_get_le32(buf) == DFU_DELTA_MAGIC;
+}
+
+int dfu_target_mcuboot_delta_init(size_t file_size, dfu_target_callback_t cb)
+{
+	ARG_UNUSED(cb);
+
+	if (file_size < sizeof(struct dfu_delta_header)) {
+		LOG_ERR("Delta too small");
+		return -EINVAL;
+	}
+
+	delta_reset();
+
+	return 0;
+}
+
+int dfu_target_mcuboot_delta_offset_get(size_t *offset)
+{
+	*offset = delta.offset;
+	return 0;
+}
+
+int dfu_target_mcuboot_delta_write(const void *const buf, size_t len)
+{
+	const uint8_t *data = buf;
+	size_t i = 0;
+	size_t n;
+	int err = 0;
+
+	while ((i < len) && (err == 0)) {
+		switch (delta.state) {
+		case STATE_HEADER:
+			n = MIN(len - i, sizeof(delta.header) - delta.header_len);
+			memcpy(&delta.header_buf[delta.header_len], &data[i], n);
+			delta.header_len += n;
+			i += n;
+
+			if (delta.header_len == sizeof(delta.header)) {
+				err = header_process();
+				delta.state = STATE_OPCODE;
+			}
+			break;
+		case STATE_OPCODE:
+			err = opcode_process(data[i++]);
+			break;
+		case STATE_ARGS:
+			err = arg_process(data[i++]);
+			break;
+		case STATE_INSERT:
+			/* Written directly from the download buffer */
+			n = MIN(len - i, delta.remaining);
+			err = image_write(&data[i], n);
+			delta.remaining -= n;
+			i += n;
+
+			if (delta.remaining == 0) {
+				delta.state = STATE_OPCODE;
+			}
+			break;
+		case STATE_ERROR:
+			return -EINVAL;
+		}
+	}
+
+	if (err) {
+		delta.state = STATE_ERROR;
+		return err;
+	}
+
+	delta.offset += len;
+
+	return 0;
+}
+
+int dfu_target_mcuboot_delta_done(bool successful)
+{
+	const struct flash_area *fa;
+	int err;
+
+	if (!successful) {
+		err = delta.mcuboot_started ? dfu_target_mcuboot_done(false) : 0;
+		delta_reset();
+		LOG_INF("Delta upgrade aborted.");
+		return err;
+	}
+
+	if ((delta.state != STATE_OPCODE) ||
+	    (delta.written != delta.target_size)) {
+		LOG_ERR("Incomplete delta, %d of %d bytes written",
+			delta.written, delta.target_size);
+		err = -EINVAL;
+		goto fail;
+	}
+
+	err = dfu_target_mcuboot_flush();
+	if (err) {
+		goto fail;
+	}
+
+	err = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	if (err) {
+		goto fail;
+	}
+
+	err = slot_hash_check(fa, delta.header.target_hash, delta.target_size);
+	flash_area_close(fa);
+	if (err) {
+		LOG_ERR("Hash mismatch of the resulting image");
+		err = -EINVAL;
+		goto fail;
+	}
+
+	err = dfu_target_mcuboot_done(true);
+	delta_reset();
+	return err;
+
+fail:
+	if (delta.mcuboot_started) {
+		(void)dfu_target_mcuboot_done(false);
+	}
+	delta_reset();
+	return err;
+}
@@ -1,5 +1,7 @@
 #include <zephyr.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/atomic.h>
 #include <drivers/flash.h>
 #include <net/socket.h>
 #include <nrf_socket.h>
@@ -11,16 +13,37 @@ LOG_MODULE_REGISTER(dfu_target_modem, CONFIG_DFU_TARGET_LOG_LEVEL);
 #define DIRTY_IMAGE 0x280000
 #define MODEM_MAGIC 0x7544656d
 
+/* Data is sent to the modem from a separate thread, so that the download
+ * can continue while the modem writes the previous fragment to flash.
+ */
+#define WRITE_BUF_COUNT 2
+#define WRITE_PRIORITY K_LOWEST_APPLICATION_THREAD_PRIO
+
 struct modem_delta_header {
 	uint16_t pad1;
 	uint16_t pad2;
 	uint32_t magic;
 };
 
+struct write_buf {
+	struct k_work work;
+	size_t len;
+	uint8_t data[CONFIG_DFU_TARGET_MODEM_WRITE_BUF_SIZE];
+};
+
 static int  fd;
-static int  offset;
+/* Bytes the modem has received */
+static atomic_t offset;
+/* First error of a background write, rejects the following data */
+static atomic_t write_err;
 static dfu_target_callback_t callback;
 
+static struct write_buf write_bufs[WRITE_BUF_COUNT];
+static size_t write_buf_next;
+static K_SEM_DEFINE(write_bufs_free, WRITE_BUF_COUNT, WRITE_BUF_COUNT);
+static K_THREAD_STACK_DEFINE(write_stack, CONFIG_DFU_TARGET_MODEM_WRITE_STACK_SIZE);
+static struct k_work_q write_work_q;
+
 static int get_modem_error(void)
 {
 	int rc;
@@ -57,7 +80,8 @@ static int apply_modem_upgrade(void)
 static int delete_banked_modem_fw(void)
 {
 	int err;
-	socklen_t len = sizeof(offset);
+	uint32_t modem_offset;
+	socklen_t len = sizeof(modem_offset);
 	int timeout = CONFIG_DFU_TARGET_MODEM_TIMEOUT;
 
 	LOG_INF("Deleting firmware image, this can take several minutes");
@@ -67,10 +91,13 @@ static int delete_banked_modem_fw(void)
 		return -EFAULT;
 	}
 	while (true) {
-		err = getsockopt(fd, SOL_DFU, SO_DFU_OFFSET, &offset, &len);
+		err = getsockopt(fd, SOL_DFU, SO_DFU_OFFSET, &modem_offset,
+				 &len);
 		if (err < 0) {
 			if (timeout < 0) {
-				callback(DFU_TARGET_EVT_TIMEOUT);
+				if (callback) {
+					callback(DFU_TARGET_EVT_TIMEOUT);
+				}
 				timeout = CONFIG_DFU_TARGET_MODEM_TIMEOUT;
 			}
 			if (errno == ENOEXEC) {
@@ -78,19 +105,154 @@ static int delete_banked_modem_fw(void)
 				if (err != DFU_ERASE_PENDING) {
 					LOG_ERR("DFU error: %d", err);
 				}
-				k_sleep(K_SECONDS(SLEEP_TIME));
 			}
+			k_sleep(K_SECONDS(SLEEP_TIME));
 			timeout -= SLEEP_TIME;
 		} else {
-			callback(DFU_TARGET_EVT_ERASE_DONE);
+			if (callback) {
+				callback(DFU_TARGET_EVT_ERASE_DONE);
+			}
 			LOG_INF("Modem FW delete complete");
 			break;
 		}
 	}
 
+	atomic_set(&offset, modem_offset);
+
 	return 0;
 }
 
+/* Get the offset stored by the modem, and erase the stored data if the
+ * modem cannot continue from it.
+ */
+static int modem_offset_sync(void)
+{
+	int err;
+	uint32_t modem_offset = 0;
+	socklen_t len = sizeof(modem_offset);
+
+	err = getsockopt(fd, SOL_DFU, SO_DFU_OFFSET, &modem_offset, &len);
+	if (err < 0) {
+		if (errno == ENOEXEC) {
+			LOG_ERR("Modem error: %d", get_modem_error());
+		} else {
+			LOG_ERR("getsockopt(OFFSET) errno: %d", errno);
+		}
+		return -EFAULT;
+	}
+
+	if (modem_offset == DIRTY_IMAGE) {
+		return delete_banked_modem_fw();
+	}
+
+	atomic_set(&offset, modem_offset);
+
+	if (modem_offset != 0) {
+		LOG_INF("Continuing from offset 0x%x", modem_offset);
+		err = setsockopt(fd, SOL_DFU, SO_DFU_OFFSET, &modem_offset,
+				 sizeof(modem_offset));
+		if (err < 0) {
+			LOG_ERR("Error while setting offset, errno %d", errno);
+			return -EFAULT;
+		}
+	}
+
+	return 0;
+}
+
+static int modem_send(const uint8_t *buf, size_t len)
+{
+	ssize_t sent;
+	int modem_error;
+
+	while (len > 0) {
+		sent = send(fd, buf, len, 0);
+		if (sent < 0) {
+			break;
+		}
+
+		buf += sent;
+		len -= sent;
+	}
+
+	if (len == 0) {
+		return 0;
+	}
+
+	if (errno != ENOEXEC) {
+		LOG_ERR("send failed, errno %d", errno);
+		return -EFAULT;
+	}
+
+	modem_error = get_modem_error();
+	LOG_ERR("send failed, modem errno %d, dfu err %d", errno, modem_error);
+	switch (modem_error) {
+	case DFU_INVALID_UUID:
+		return -EINVAL;
+	case DFU_INVALID_FILE_OFFSET:
+		/* Continue from the offset the modem expects, erasing the
+		 * stored data first if needed, instead of rewriting it.
+		 */
+		if (modem_offset_sync() != 0) {
+			return -EFAULT;
+		}
+		LOG_INF("Modem expects data from offset 0x%x",
+			(uint32_t)atomic_get(&offset));
+		return -EAGAIN;
+	case DFU_AREA_NOT_BLANK:
+		/* The modem cannot write over the stored data, even if its
+		 * offset is valid. Delete it and start again.
+		 */
+		if (delete_banked_modem_fw() != 0) {
+			return -EFAULT;
+		}
+		return -EAGAIN;
+	default:
+		return -EFAULT;
+	}
+}
+
+static void write_work_fn(struct k_work *work)
+{
+	struct write_buf *buf = CONTAINER_OF(work, struct write_buf, work);
+	int err;
+
+	if (atomic_get(&write_err) == 0) {
+		err = modem_send(buf->data, buf->len);
+		if (err == 0) {
+			atomic_add(&offset, buf->len);
+		} else {
+			(void)atomic_cas(&write_err, 0, err);
+		}
+	}
+
+	k_sem_give(&write_bufs_free);
+}
+
+/* Wait until all data given to the modem has been sent, or dropped after an
+ * error.
+ */
+static void sends_wait(void)
+{
+	for (int i = 0; i < WRITE_BUF_COUNT; i++) {
+		k_sem_take(&write_bufs_free, K_FOREVER);
+	}
+
+	for (int i = 0; i < WRITE_BUF_COUNT; i++) {
+		k_sem_give(&write_bufs_free);
+	}
+}
+
+/* Wait until all data given to the modem has been sent, and return the first
+ * error of the sends, if any.
+ */
+static int writes_wait(void)
+{
+	sends_wait();
+
+	return atomic_set(&write_err, 0);
+}
+
 /**@brief Initialize DFU socket. */
 static int modem_dfu_socket_init(void)
 {
@@ -132,12 +294,32 @@ bool dfu_target_modem_identify(const void *const buf)
 
 int dfu_target_modem_init(size_t file_size, dfu_target_callback_t cb)
 {
+	static bool write_work_q_started;
 	int err;
-	size_t scratch_space;
-	socklen_t len = sizeof(offset);
+	uint32_t scratch_space = 0;
+	socklen_t len = sizeof(scratch_space);
 
 	callback = cb;
 
+	if (!write_work_q_started) {
+		k_work_q_start(&write_work_q, write_stack,
+			       K_THREAD_STACK_SIZEOF(write_stack),
+			       WRITE_PRIORITY);
+		for (int i = 0; i < WRITE_BUF_COUNT; i++) {
+			k_work_init(&write_bufs[i].work, write_work_fn);
+		}
+		write_work_q_started = true;
+	}
+
+	/* Drop the data of an earlier download that has not been sent yet,
+	 * and let a send in progress finish before the state is reset.
+	 */
+	(void)atomic_cas(&write_err, 0, -ECANCELED);
+	(void)writes_wait();
+
+	atomic_set(&offset, 0);
+	atomic_set(&write_err, 0);
+
 	err = modem_dfu_socket_init();
 	if (err < 0) {
 		return err;
@@ -148,35 +330,20 @@ int dfu_target_modem_init(size_t file_size, dfu_target_callback_t cb)
 		if (errno == ENOEXEC) {
 			LOG_ERR("Modem error: %d", get_modem_error());
 		} else {
-			LOG_ERR("getsockopt(OFFSET) errno: %d", errno);
+			LOG_ERR("getsockopt(RESOURCES) errno: %d", errno);
 		}
-	}
-
-	if (file_size > scratch_space) {
+	} else if (file_size > scratch_space) {
 		LOG_ERR("Requested file too big to fit in flash %d > %d",
 			file_size, scratch_space);
+		(void)close(fd);
 		return -EFBIG;
 	}
 
-	/* Check offset, store to local variable */
-	err = getsockopt(fd, SOL_DFU, SO_DFU_OFFSET, &offset, &len);
-	if (err < 0) {
-		if (errno == ENOEXEC) {
-			LOG_ERR("Modem error: %d", get_modem_error());
-		} else {
-			LOG_ERR("getsockopt(OFFSET) errno: %d", errno);
-		}
-	}
-
-	if (offset == DIRTY_IMAGE) {
-		delete_banked_modem_fw();
-	} else if (offset != 0) {
-		LOG_INF("Setting offset to 0x%x", offset);
-		len = sizeof(offset);
-		err = setsockopt(fd, SOL_DFU, SO_DFU_OFFSET, &offset, len);
-		if (err != 0) {
-			LOG_INF("Error while setting offset: %d", offset);
-		}
+	/* Resume from the data the modem has stored */
+	err = modem_offset_sync();
+	if (err) {
+		(void)close(fd);
+		return err;
 	}
 
 	return 0;
@@ -184,63 +351,62 @@ int dfu_target_modem_init(size_t file_size, dfu_target_callback_t cb)
 
 int dfu_target_modem_offset_get(size_t *out)
 {
-	*out = offset;
+	/* Include the data that is still being sent. An error of the sends
+	 * is kept for the next write.
+	 */
+	sends_wait();
+
+	*out = atomic_get(&offset);
 	return 0;
 }
 
 int dfu_target_modem_write(const void *const buf, size_t len)
 {
-	int err = 0;
-	int sent = 0;
-	int modem_error = 0;
-	int send_result = 0;
-
-	while (send_result >= 0) {
-		send_result = send(fd, (((uint8_t *)buf) + sent),
-				   (len - sent), 0);
-		if (send_result > 0) {
-			sent += send_result;
-			if (sent >= len) {
-				offset += len;
-				return 0;
-			}
+	const uint8_t *data = buf;
+	struct write_buf *write_buf;
+
+	while (len > 0) {
+		/* Waits while the modem writes both buffers */
+		k_sem_take(&write_bufs_free, K_FOREVER);
+
+		if (atomic_get(&write_err) != 0) {
+			k_sem_give(&write_bufs_free);
+			/* On -EAGAIN, the download continues from the
+			 * offset the modem expects.
+			 */
+			return writes_wait();
 		}
-	}
 
-	if (errno != ENOEXEC) {
-		return -EFAULT;
-	}
+		write_buf = &write_bufs[write_buf_next];
+		write_buf_next = (write_buf_next + 1) % WRITE_BUF_COUNT;
 
-	modem_error = get_modem_error();
-	LOG_ERR("send failed, modem errno %d, dfu err %d", errno, modem_error);
-	switch (modem_error) {
-	case DFU_INVALID_UUID:
-		return -EINVAL;
-	case DFU_INVALID_FILE_OFFSET:
-		delete_banked_modem_fw();
-		err = dfu_target_modem_write(buf, len);
-		if (err < 0) {
-			return -EINVAL;
-		} else {
-			return 0;
-		}
-	case DFU_AREA_NOT_BLANK:
-		delete_banked_modem_fw();
-		err = dfu_target_modem_write(buf, len);
-		if (err < 0) {
-			return -EINVAL;
-		} else {
-			return 0;
-		}
-	default:
-		return -EFAULT;
+		write_buf->len = MIN(len, sizeof(write_buf->data));
+		memcpy(write_buf->data, data, write_buf->len);
+		k_work_submit_to_queue(&write_work_q, &write_buf->work);
+
+		data += write_buf->len;
+		len -= write_buf->len;
 	}
+
+	return 0;
 }
 
 int dfu_target_modem_done(bool successful)
 {
 	int err = 0;
 
+	if (!successful) {
+		/* Skip the data that has not been sent yet */
+		(void)atomic_cas(&write_err, 0, -ECANCELED);
+	}
+
+	err = writes_wait();
+	if (successful && err != 0) {
+		LOG_ERR("Failed to send firmware to the modem: %d", err);
+		(void)close(fd);
+		return err;
+	}
+
 	if (successful) {
 		err = apply_modem_upgrade();
 		if (err < 0) {
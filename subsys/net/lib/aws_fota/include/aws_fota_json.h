@@ -27,6 +27,11 @@ extern "C" {
  */
 #define STATUS_MAX_LEN (12)
 
+/** @brief Length of the SHA-256 digest in the "fwSha256" field of a job
+ * document.
+ */
+#define FW_HASH_LEN (32)
+
 /**
  * @brief The bit set when the status field in a job execution object is
  * decoded.
@@ -51,6 +56,10 @@ extern "C" {
  * @param[out] file_path_buf  Output buffer for the "file" field from the Job
  *			      Document
  * @param[out] version_number  Version number from the Job Execution data type.
+ * @param[out] hash_buf  Output buffer of FW_HASH_LEN bytes for the optional
+ *			 "fwSha256" field from the Job Document.
+ * @param[out] has_hash  Set to true if the Job Document has a "fwSha256"
+ *			 field.
  *
  * @return 0 if the Job Execution object is empty, 1 if Job Execution object was
  *	     correctly decoded, otherwise a negative error code is returned
@@ -61,7 +70,9 @@ int aws_fota_parse_DescribeJobExecution_rsp(const char *job_document,
 					    char *job_id_buf,
 					    char *hostname_buf,
 					    char *file_path_buf,
-					    int *version_number);
+					    int *version_number,
+					    uint8_t *hash_buf,
+					    bool *has_hash);
 
 /**
  * @brief Parse a Job Execution accepted response object. Returned by a call to
@@ -53,6 +53,8 @@ static uint8_t payload_buf[CONFIG_AWS_FOTA_PAYLOAD_SIZE];
 static uint8_t hostname[CONFIG_AWS_FOTA_HOSTNAME_MAX_LEN];
 static uint8_t file_path[CONFIG_AWS_FOTA_FILE_PATH_MAX_LEN];
 static uint8_t job_id[AWS_JOBS_JOB_ID_MAX_LEN];
+static uint8_t hash[FW_HASH_LEN];
+static bool has_hash;
 static aws_fota_callback_t callback;
 
 /**
@@ -170,7 +172,8 @@ static int get_job_execution(struct mqtt_client *const client,
 	err = aws_fota_parse_DescribeJobExecution_rsp(payload_buf, payload_len,
 						      job_id, hostname,
 						      file_path,
-						     &execution_version_number);
+						     &execution_version_number,
+						      hash, &has_hash);
 
 	if (err < 0) {
 		LOG_ERR("Error when parsing the json: %d", err);
@@ -186,6 +189,11 @@ static int get_job_execution(struct mqtt_client *const client,
 	LOG_DBG("file_path %s", log_strdup(file_path));
 	LOG_DBG("execution_version_number: %d ", execution_version_number);
 
+	if (has_hash && !IS_ENABLED(CONFIG_DFU_TARGET_HASH_CHECK)) {
+		LOG_WRN("fwSha256 ignored, hash check is not enabled");
+		has_hash = false;
+	}
+
 	/* Subscribe to update topic to receive feedback on whether an
 	 * update is accepted or not.
 	 */
@@ -250,7 +258,9 @@ static int job_update_accepted(struct mqtt_client *const client,
 		sec_tag = CONFIG_AWS_FOTA_DOWNLOAD_SECURITY_TAG;
 #endif
 
-		err = fota_download_start(hostname, file_path, sec_tag, apn, 0);
+		err = fota_download_start_with_hash(hostname, file_path,
+						    sec_tag, apn, 0,
+						    has_hash ? hash : NULL);
 		if (err) {
 			LOG_ERR("Error (%d) when trying to start firmware "
 				"download", err);
@@ -6,53 +6,81 @@
 
 #include <zephyr.h>
 #include <string.h>
-#include <cJSON.h>
+#include <json_tok.h>
 #include <sys/util.h>
 #include <net/aws_jobs.h>
 
 #include "aws_fota_json.h"
 
-/**@brief Copy max maxlen bytes from src to dst. Insert null-terminator.
+/* Responses are parsed from the MQTT event handler only */
+static struct json_tok toks[CONFIG_AWS_FOTA_JSON_TOKENS_MAX];
+
+/* Every token but the root follows one of '{', '[', ',' or ':', so this is
+ * an upper bound of the number of tokens in the document.
  */
-static void strncpy_nullterm(char *dst, const char *src, size_t maxlen)
+static size_t toks_bound(const char *json, size_t len)
 {
-	size_t len = strlen(src) + 1;
+	size_t count = 1;
 
-	memcpy(dst, src, MIN(len, maxlen));
-	if (len > maxlen) {
-		dst[maxlen - 1] = '\0';
+	for (size_t i = 0; i < len && json[i] != '\0'; i++) {
+		if (strchr("{[,:", json[i]) != NULL) {
+			count++;
+		}
 	}
+
+	return count;
+}
+
+/* Tokenize a document with the static tokens, or with tokens allocated on
+ * the heap if it has more than CONFIG_AWS_FOTA_JSON_TOKENS_MAX tokens.
+ * The allocated tokens are returned in heap_toks and must be freed by the
+ * caller.
+ */
+static int doc_parse(struct json_tok_doc *doc, const char *json, size_t len,
+		     struct json_tok **heap_toks)
+{
+	size_t count;
+	int ret;
+
+	*heap_toks = NULL;
+
+	ret = json_tok_parse(doc, json, len, toks, ARRAY_SIZE(toks));
+	if (ret != -ENOMEM) {
+		return ret;
+	}
+
+	count = toks_bound(json, len);
+	*heap_toks = k_calloc(count, sizeof(struct json_tok));
+	if (*heap_toks == NULL) {
+		return -ENOMEM;
+	}
+
+	return json_tok_parse(doc, json, len, *heap_toks, count);
 }
 
 int aws_fota_parse_UpdateJobExecution_rsp(const char *update_rsp_document,
 					  size_t payload_len, char *status_buf)
 {
+	struct json_tok_doc doc;
+	struct json_tok *heap_toks;
+	int ret;
+
 	if (update_rsp_document == NULL || status_buf == NULL) {
 		return -EINVAL;
 	}
 
-	int ret;
-
-	cJSON *update_response = cJSON_Parse(update_rsp_document);
-
-	if (update_response == NULL) {
+	ret = doc_parse(&doc, update_rsp_document, payload_len, &heap_toks);
+	if (ret < 0) {
 		ret = -ENODATA;
 		goto cleanup;
 	}
 
-	cJSON *status = cJSON_GetObjectItemCaseSensitive(update_response,
-							  "status");
-	if (cJSON_IsString(status) && status->valuestring != NULL) {
-		strncpy_nullterm(status_buf, status->valuestring,
-				 STATUS_MAX_LEN);
-	} else {
-		ret = -ENODATA;
-		goto cleanup;
-	}
+	ret = json_tok_str(&doc, json_tok_obj_get(&doc, 0, "status"),
+			   status_buf, STATUS_MAX_LEN);
+	ret = (ret < 0) ? -ENODATA : 0;
 
-	ret = 0;
 cleanup:
-	cJSON_Delete(update_response);
+	k_free(heap_toks);
 	return ret;
 }
 
@@ -61,84 +89,89 @@ int aws_fota_parse_DescribeJobExecution_rsp(const char *job_document,
 					   char *job_id_buf,
 					   char *hostname_buf,
 					   char *file_path_buf,
-					   int *execution_version_number)
+					   int *execution_version_number,
+					   uint8_t *hash_buf,
+					   bool *has_hash)
 {
+	struct json_tok_doc doc;
+	struct json_tok *heap_toks;
+	char hash_str[2 * FW_HASH_LEN + 1];
+	int execution;
+	int location;
+	int host;
+	int path;
+	int hash;
+	int ret;
+
 	if (job_document == NULL
 	    || job_id_buf == NULL
 	    || hostname_buf == NULL
 	    || file_path_buf == NULL
-	    || execution_version_number == NULL) {
+	    || execution_version_number == NULL
+	    || hash_buf == NULL
+	    || has_hash == NULL) {
 		return -EINVAL;
 	}
 
-	int ret;
-
-	cJSON *json_data = cJSON_Parse(job_document);
+	*has_hash = false;
 
-	if (json_data == NULL) {
+	ret = doc_parse(&doc, job_document, payload_len, &heap_toks);
+	if (ret < 0) {
 		ret = -ENODATA;
 		goto cleanup;
 	}
 
-	cJSON *execution = cJSON_GetObjectItemCaseSensitive(json_data,
-							    "execution");
-	if (execution == NULL) {
+	execution = json_tok_obj_get(&doc, 0, "execution");
+	if (execution < 0) {
 		ret = 0;
 		goto cleanup;
 	}
 
-	cJSON *job_id = cJSON_GetObjectItemCaseSensitive(execution, "jobId");
-
-	if (cJSON_GetStringValue(job_id) != NULL) {
-		strncpy_nullterm(job_id_buf, job_id->valuestring,
-				AWS_JOBS_JOB_ID_MAX_LEN);
-	} else {
+	ret = json_tok_str(&doc, json_tok_obj_get(&doc, execution, "jobId"),
+			   job_id_buf, AWS_JOBS_JOB_ID_MAX_LEN);
+	if (ret < 0) {
 		ret = -ENODATA;
 		goto cleanup;
 	}
 
-	cJSON *job_data = cJSON_GetObjectItemCaseSensitive(execution,
-							   "jobDocument");
-
-	if (!cJSON_IsObject(job_data)) {
+	location = json_tok_path(&doc, execution, "jobDocument.location");
+	if (!json_tok_is(&doc, location, JSON_TOK_OBJECT)) {
 		ret = -ENODATA;
 		goto cleanup;
 	}
 
-	cJSON *location = cJSON_GetObjectItemCaseSensitive(job_data,
-							    "location");
-
-	if (!cJSON_IsObject(location)) {
+	host = json_tok_obj_get(&doc, location, "host");
+	path = json_tok_obj_get(&doc, location, "path");
+	if (!json_tok_is(&doc, host, JSON_TOK_STRING) ||
+	    !json_tok_is(&doc, path, JSON_TOK_STRING)) {
 		ret = -ENODATA;
 		goto cleanup;
 	}
 
-	cJSON *hostname = cJSON_GetObjectItemCaseSensitive(location, "host");
-	cJSON *path = cJSON_GetObjectItemCaseSensitive(location, "path");
-
-	if ((cJSON_GetStringValue(hostname) != NULL)
-	   && (cJSON_GetStringValue(path) != NULL)) {
-		strncpy_nullterm(hostname_buf, hostname->valuestring,
-				CONFIG_AWS_FOTA_HOSTNAME_MAX_LEN);
-		strncpy_nullterm(file_path_buf, path->valuestring,
-				CONFIG_AWS_FOTA_FILE_PATH_MAX_LEN);
-	} else {
-		ret = -ENODATA;
-		goto cleanup;
+	/* Optional SHA-256 digest of the file, as a hex string */
+	hash = json_tok_path(&doc, execution, "jobDocument.fwSha256");
+	if (hash >= 0) {
+		ret = json_tok_str(&doc, hash, hash_str, sizeof(hash_str));
+		if (ret != 2 * FW_HASH_LEN ||
+		    hex2bin(hash_str, ret, hash_buf, FW_HASH_LEN) !=
+		    FW_HASH_LEN) {
+			ret = -ENODATA;
+			goto cleanup;
+		}
+		*has_hash = true;
 	}
 
-	cJSON *version_number = cJSON_GetObjectItemCaseSensitive(
-					execution, "versionNumber");
+	json_tok_str(&doc, host, hostname_buf,
+		     CONFIG_AWS_FOTA_HOSTNAME_MAX_LEN);
+	json_tok_str(&doc, path, file_path_buf,
+		     CONFIG_AWS_FOTA_FILE_PATH_MAX_LEN);
 
-	if (cJSON_IsNumber(version_number)) {
-		*execution_version_number = version_number->valueint;
-	} else {
-		ret = -ENODATA;
-		goto cleanup;
-	}
+	ret = json_tok_int(&doc,
+			   json_tok_obj_get(&doc, execution, "versionNumber"),
+			   execution_version_number);
+	ret = (ret < 0) ? -ENODATA : 1;
 
-	ret = 1;
 cleanup:
-	cJSON_Delete(json_data);
+	k_free(heap_toks);
 	return ret;
 }
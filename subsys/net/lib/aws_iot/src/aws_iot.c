@@ -6,6 +6,7 @@
 
 #include <net/aws_iot.h>
 #include <net/mqtt.h>
+#include <net/mqtt_topic_matcher.h>
 #include <net/socket.h>
 #include <net/cloud.h>
 #include <stdio.h>
@@ -93,6 +94,43 @@ static char delete_accepted_topic[DELETE_ACCEPTED_TOPIC_LEN + 1];
 static char delete_rejected_topic[DELETE_REJECTED_TOPIC_LEN + 1];
 #endif
 
+/* Shadow topics subscribed to, and the type reported for messages received
+ * on them.
+ */
+static const struct {
+	const char *topic;
+	enum aws_iot_topic_type type;
+} shadow_rx_topics[] = {
+#if defined(CONFIG_AWS_IOT_TOPIC_GET_ACCEPTED_SUBSCRIBE)
+	{ get_accepted_topic, AWS_IOT_SHADOW_TOPIC_GET_ACCEPTED },
+#endif
+#if defined(CONFIG_AWS_IOT_TOPIC_GET_REJECTED_SUBSCRIBE)
+	{ get_rejected_topic, AWS_IOT_SHADOW_TOPIC_GET_REJECTED },
+#endif
+#if defined(CONFIG_AWS_IOT_TOPIC_UPDATE_ACCEPTED_SUBSCRIBE)
+	{ update_accepted_topic, AWS_IOT_SHADOW_TOPIC_UPDATE_ACCEPTED },
+#endif
+#if defined(CONFIG_AWS_IOT_TOPIC_UPDATE_REJECTED_SUBSCRIBE)
+	{ update_rejected_topic, AWS_IOT_SHADOW_TOPIC_UPDATE_REJECTED },
+#endif
+#if defined(CONFIG_AWS_IOT_TOPIC_UPDATE_DELTA_SUBSCRIBE)
+	{ update_delta_topic, AWS_IOT_SHADOW_TOPIC_UPDATE_DELTA },
+#endif
+#if defined(CONFIG_AWS_IOT_TOPIC_DELETE_ACCEPTED_SUBSCRIBE)
+	{ delete_accepted_topic, AWS_IOT_SHADOW_TOPIC_DELETE_ACCEPTED },
+#endif
+#if defined(CONFIG_AWS_IOT_TOPIC_DELETE_REJECTED_SUBSCRIBE)
+	{ delete_rejected_topic, AWS_IOT_SHADOW_TOPIC_DELETE_REJECTED },
+#endif
+};
+
+/* "$aws", "things", client ID and "shadow" levels are shared, each topic
+ * adds at most two levels.
+ */
+#define TOPIC_MATCHER_NODES (4 + 2 * ARRAY_SIZE(shadow_rx_topics))
+
+MQTT_TOPIC_MATCHER_DEFINE(topic_matcher, MAX(TOPIC_MATCHER_NODES, 1));
+
 #if defined(CONFIG_CLOUD_API)
 static struct cloud_backend *aws_iot_backend;
 #endif
@@ -236,6 +274,7 @@ static void aws_iot_notify_event(const struct aws_iot_evt *aws_iot_evt)
 		cloud_evt.type = CLOUD_EVT_DATA_RECEIVED;
 		cloud_evt.data.msg.buf = aws_iot_evt->data.msg.ptr;
 		cloud_evt.data.msg.len = aws_iot_evt->data.msg.len;
+		cloud_evt.data.msg.total_len = aws_iot_evt->data.msg.len;
 		cloud_evt.data.msg.endpoint.type = CLOUD_EP_TOPIC_MSG;
 		cloud_evt.data.msg.endpoint.str =
 				(char *)aws_iot_evt->data.msg.topic.str;
@@ -414,6 +453,35 @@ static int aws_iot_topics_populate(char *const id, size_t id_len)
 	return 0;
 }
 
+static int topic_matcher_populate(void)
+{
+	int err;
+
+	mqtt_topic_matcher_reset(&topic_matcher);
+
+	for (size_t i = 0; i < ARRAY_SIZE(shadow_rx_topics); i++) {
+		err = mqtt_topic_matcher_add(&topic_matcher,
+					     shadow_rx_topics[i].topic,
+					     strlen(shadow_rx_topics[i].topic),
+					     shadow_rx_topics[i].type);
+		if (err) {
+			LOG_ERR("Failed to add shadow topic, error: %d", err);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static enum aws_iot_topic_type topic_type_get(const struct mqtt_topic *topic)
+{
+	int type = mqtt_topic_matcher_match(&topic_matcher,
+					    (const char *)topic->topic.utf8,
+					    topic->topic.size);
+
+	return (type < 0) ? AWS_IOT_SHADOW_TOPIC_UNKNOWN : type;
+}
+
 /** Returns the number of topics subscribed to (0 or greater),
   * or a negative error code. */
 static int topic_subscribe(void)
@@ -633,7 +701,8 @@ static void mqtt_evt_handler(struct mqtt_client *const c,
 		aws_iot_evt.type = AWS_IOT_EVT_DATA_RECEIVED;
 		aws_iot_evt.data.msg.ptr = payload_buf;
 		aws_iot_evt.data.msg.len = p->message.payload.len;
-		aws_iot_evt.data.msg.topic.type = AWS_IOT_SHADOW_TOPIC_UNKNOWN;
+		aws_iot_evt.data.msg.topic.type =
+				topic_type_get(&p->message.topic);
 		aws_iot_evt.data.msg.topic.str = p->message.topic.topic.utf8;
 		aws_iot_evt.data.msg.topic.len = p->message.topic.topic.size;
 
@@ -1014,6 +1083,11 @@ int aws_iot_init(const struct aws_iot_config *const config,
 		return err;
 	}
 
+	err = topic_matcher_populate();
+	if (err) {
+		return err;
+	}
+
 #if defined(CONFIG_AWS_FOTA)
 	err = aws_fota_init(&client, aws_fota_cb_handler);
 	if (err) {
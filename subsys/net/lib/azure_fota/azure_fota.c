@@ -11,6 +11,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/util.h>
+#include <dfu/dfu_target.h>
 #include <net/fota_download.h>
 #include <net/azure_iot_hub.h>
 #include <net/azure_fota.h>
@@ -54,6 +56,8 @@ struct fota_object {
 	char path[CONFIG_AZURE_FOTA_FILE_PATH_MAX_LEN];
 	char version[CONFIG_AZURE_FOTA_VERSION_MAX_LEN];
 	size_t fragment_size;
+	uint8_t hash[DFU_TARGET_HASH_LEN];
+	bool has_hash;
 };
 
 /* Static variables */
@@ -313,7 +317,7 @@ static int extract_fw_details(const char *msg)
 	int err = -ENOMEM;
 	struct cJSON *root_obj, *desired_obj, *fw_obj, *fw_version_obj,
 		*fw_location_obj, *fw_hostname_obj, *fw_path_obj,
-		*fw_fragment_obj;
+		*fw_fragment_obj, *fw_hash_obj;
 
 	/* The properties.desired.firmware object has the excpected structure:
 	 *	properties.desired.firmware : {
@@ -322,7 +326,8 @@ static int extract_fw_details(const char *msg)
 	 *			host : <hostname>,
 	 *			path : <file path>
 	 *		},
-	 *		fwFragmentSize : <value>
+	 *		fwFragmentSize : <value>,
+	 *		fwSha256 : <hex string, optional>
 	 *	}
 	 */
 
@@ -439,6 +444,28 @@ static int extract_fw_details(const char *msg)
 
 	fota_object.fragment_size = fw_fragment_obj->valueint;
 
+	/* Expected SHA-256 digest of the firmware image, if given */
+	fota_object.has_hash = false;
+	fw_hash_obj = cJSON_GetObjectItemCaseSensitive(fw_obj, "fwSha256");
+	if (fw_hash_obj != NULL) {
+		if (!cJSON_IsString(fw_hash_obj) ||
+		    (strlen(fw_hash_obj->valuestring) !=
+		     2 * sizeof(fota_object.hash)) ||
+		    (hex2bin(fw_hash_obj->valuestring,
+			     strlen(fw_hash_obj->valuestring),
+			     fota_object.hash, sizeof(fota_object.hash)) !=
+		     sizeof(fota_object.hash))) {
+			LOG_ERR("Invalid fwSha256 received");
+			goto clean_exit;
+		}
+
+		if (IS_ENABLED(CONFIG_DFU_TARGET_HASH_CHECK)) {
+			fota_object.has_hash = true;
+		} else {
+			LOG_WRN("fwSha256 ignored, hash check is not enabled");
+		}
+	}
+
 	err = 0;
 
 clean_exit:
@@ -523,9 +550,11 @@ int azure_fota_msg_process(const char *const buf, size_t size)
 		log_strdup(fota_object.host),
 		log_strdup(fota_object.path));
 
-	err = fota_download_start(fota_object.host, fota_object.path,
-				  CONFIG_AZURE_FOTA_SEC_TAG,
-				  NULL, fota_object.fragment_size);
+	err = fota_download_start_with_hash(fota_object.host, fota_object.path,
+					    CONFIG_AZURE_FOTA_SEC_TAG, NULL,
+					    fota_object.fragment_size,
+					    fota_object.has_hash ?
+					    fota_object.hash : NULL);
 	if (err) {
 		LOG_ERR("Error (%d) when trying to start firmware download",
 			err);
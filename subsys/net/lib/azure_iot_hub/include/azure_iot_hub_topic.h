@@ -18,6 +18,10 @@ extern "C" {
 #define TOPIC_PROP_BAG_FIELD_MAX_LEN CONFIG_AZURE_IOT_HUB_TOPIC_ELEMENT_MAX_LEN
 #define TOPIC_PROP_BAG_COUNT	     CONFIG_AZURE_IOT_HUB_PROPERTY_BAG_MAX_COUNT
 
+/* Buffer size for the strings of all property bags of a topic. */
+#define TOPIC_PROP_BAG_BUF_SIZE \
+	(TOPIC_PROP_BAG_COUNT * 2 * (TOPIC_PROP_BAG_FIELD_MAX_LEN + 1))
+
 #define TOPIC_PREFIX_DEVICEBOUND	"devices/"
 #define TOPIC_PREFIX_TWIN_DESIRED	"$iothub/twin/PATCH/properties/desired/"
 #define TOPIC_PREFIX_TWIN_RES		"$iothub/twin/res/"
@@ -36,11 +40,15 @@ enum topic_type {
 	TOPIC_TYPE_EMPTY,
 };
 
+/* Property bag element. The key and value point into the topic buffer, they
+ * are not null-terminated and are still URL-encoded.
+ */
 struct topic_parser_prop_bag {
-	/* Null-terminated key string. */
-	char key[TOPIC_PROP_BAG_FIELD_MAX_LEN + 1];
-	/* Null-terminated value string. */
-	char value[TOPIC_PROP_BAG_FIELD_MAX_LEN + 1];
+	const char *key;
+	size_t key_len;
+	/* Empty if the element has no value. */
+	const char *value;
+	size_t value_len;
 };
 
 /* Topic parser data. Used for both input and output. It's the caller's
@@ -65,7 +73,9 @@ struct topic_parser_data {
 		 */
 		uint32_t status;
 	};
-	/* Array of property bag elements. */
+	/* Array of property bag elements, valid as long as the topic
+	 * buffer is.
+	 */
 	struct topic_parser_prop_bag prop_bag[TOPIC_PROP_BAG_COUNT];
 	/* Number of property bag elements in the above array. */
 	size_t prop_bag_count;
@@ -89,7 +99,9 @@ static inline void azure_iot_hub_prop_bag_free(char *buf)
  */
 enum topic_type topic_type_get(const char *buf, const size_t len);
 
-/* @brief Parse topic.
+/* @brief Parse topic. The topic type, dynamic value and property bags are
+ *	  found in a single pass over the topic buffer, and the property bags
+ *	  are not copied.
  *
  * @param data Pointer to topic data structure. The structure must
  *	       be initialized with a topic buffer pointer and topic
@@ -101,6 +113,67 @@ enum topic_type topic_type_get(const char *buf, const size_t len);
  */
 int azure_iot_hub_topic_parse(struct topic_parser_data *const data);
 
+/* @brief Compare the key of a property bag element with a string.
+ *
+ * @param bag Property bag element.
+ * @param key Null-terminated string, compared with the URL-encoded key.
+ *
+ * @return true if the key is equal to the string.
+ */
+bool topic_prop_bag_key_eq(const struct topic_parser_prop_bag *bag,
+			   const char *key);
+
+/* @brief Compare the value of a property bag element with a string.
+ *
+ * @param bag Property bag element.
+ * @param value Null-terminated string, compared with the URL-encoded value.
+ *
+ * @return true if the value is equal to the string.
+ */
+bool topic_prop_bag_value_eq(const struct topic_parser_prop_bag *bag,
+			     const char *value);
+
+/* @brief Get the value of a property bag element as a decimal number.
+ *
+ * @param bag Property bag element.
+ * @param val Pointer to the parsed value.
+ *
+ * @return 0 on success, -EINVAL if the value is not a number or -ERANGE if
+ *	   it is too large.
+ */
+int topic_prop_bag_uint_get(const struct topic_parser_prop_bag *bag,
+			    uint32_t *val);
+
+/* @brief URL-decode a key or value into a null-terminated string.
+ *
+ * @param src Key or value to decode.
+ * @param src_len Length of the key or value.
+ * @param buf Output buffer.
+ * @param size Size of the output buffer.
+ *
+ * @return Length of the decoded string on success, -EINVAL if the input
+ *	   has an invalid percent-encoding or -ENOMEM if the output buffer is
+ *	   too small.
+ */
+int topic_url_decode(const char *src, size_t src_len, char *buf,
+		     size_t size);
+
+/* @brief Copy the property bags of a parsed topic as URL-decoded,
+ *	  null-terminated strings, for the application.
+ *
+ * @param data Parsed topic.
+ * @param bags Array of at least data->prop_bag_count elements, pointing
+ *	       into buf after the call.
+ * @param buf Buffer for the strings.
+ * @param size Size of the buffer.
+ *
+ * @return 0 on success, -EINVAL if a key or value has an invalid
+ *	   percent-encoding or -ENOMEM if the buffer is too small.
+ */
+int topic_prop_bags_export(const struct topic_parser_data *data,
+			   struct azure_iot_hub_prop_bag *bags,
+			   char *buf, size_t size);
+
 /* @brief Create a string with all property bags as a querystring.
  *	  The caller is responsible for calling k_free() on the returned
  *	  (non-NULL) pointer after use.
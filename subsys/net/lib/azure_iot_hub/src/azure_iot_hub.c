@@ -142,6 +142,47 @@ static int publish_get_payload(struct mqtt_client *const client, size_t length)
 	return mqtt_readall_publish_payload(client, payload_buf, length);
 }
 
+/* Read and drop a payload that is not delivered, so that the MQTT client
+ * can continue with the next packet.
+ */
+static int publish_discard_payload(struct mqtt_client *const client,
+				   size_t length)
+{
+	int err;
+	size_t chunk;
+
+	while (length > 0) {
+		chunk = MIN(length, sizeof(payload_buf));
+
+		err = mqtt_readall_publish_payload(client, payload_buf, chunk);
+		if (err) {
+			return err;
+		}
+
+		length -= chunk;
+	}
+
+	return 0;
+}
+
+static void publish_ack(struct mqtt_client *const client,
+			const struct mqtt_publish_param *p)
+{
+	int err;
+	const struct mqtt_puback_param ack = {
+		.message_id = p->message_id
+	};
+
+	if (p->message.topic.qos != MQTT_QOS_1_AT_LEAST_ONCE) {
+		return;
+	}
+
+	err = mqtt_publish_qos1_ack(client, &ack);
+	if (err) {
+		LOG_WRN("Failed to send MQTT ACK, error: %d", err);
+	}
+}
+
 static int topic_subscribe(void)
 {
 	int err;
@@ -221,7 +262,11 @@ static bool direct_method_process(struct topic_parser_data *topic,
 	}
 
 	/* Get request ID */
-	evt.data.method.rid = atoi(topic->prop_bag[0].value);
+	if (topic_prop_bag_uint_get(&topic->prop_bag[0],
+				    &evt.data.method.rid)) {
+		LOG_WRN("Invalid request ID, cannot process direct method");
+		return false;
+	}
 
 	LOG_DBG("Direct method request ID: %d", evt.data.method.rid);
 
@@ -254,6 +299,7 @@ static void device_twin_result_process(struct topic_parser_data *topic,
 		.topic.len = topic->topic_len,
 		.data.msg.ptr = payload,
 		.data.msg.len = payload_len,
+		.data.msg.total_len = payload_len,
 	};
 
 	/* Status codes
@@ -327,6 +373,92 @@ static bool on_suback(void)
 	return false;
 }
 
+#if IS_ENABLED(CONFIG_AZURE_IOT_HUB_PAYLOAD_FRAGMENTS)
+/* Returns true if messages on the topic can be delivered in fragments, and
+ * the event type to deliver them with.
+ */
+static bool fragment_evt_type_get(const struct topic_parser_data *topic,
+				  enum azure_iot_hub_evt_type *type)
+{
+	switch (topic->type) {
+	case TOPIC_TYPE_DEVICEBOUND:
+		*type = AZURE_IOT_HUB_EVT_DATA_RECEIVED;
+		return true;
+	case TOPIC_TYPE_TWIN_UPDATE_DESIRED:
+		*type = AZURE_IOT_HUB_EVT_TWIN_DESIRED_RECEIVED;
+		return true;
+	case TOPIC_TYPE_TWIN_UPDATE_RESULT:
+		/* Only the full device twin document is large */
+		if (topic->status == 200) {
+			*type = AZURE_IOT_HUB_EVT_TWIN_RECEIVED;
+			return true;
+		}
+		return false;
+	default:
+		return false;
+	}
+}
+
+/* Read a payload that does not fit in the payload buffer and notify it in
+ * buffer-sized fragments, as it arrives.
+ */
+static int payload_fragments_notify(struct mqtt_client *const client,
+				    struct azure_iot_hub_evt *evt)
+{
+	int err;
+	struct azure_iot_hub_data *msg = &evt->data.msg;
+
+	for (msg->offset = 0; msg->offset < msg->total_len;
+	     msg->offset += msg->len) {
+		msg->len = MIN(msg->total_len - msg->offset,
+			       sizeof(payload_buf));
+
+		err = mqtt_readall_publish_payload(client, payload_buf,
+						   msg->len);
+		if (err) {
+			return err;
+		}
+
+		azure_iot_hub_notify_event(evt);
+	}
+
+	return 0;
+}
+#endif /* IS_ENABLED(CONFIG_AZURE_IOT_HUB_PAYLOAD_FRAGMENTS) */
+
+/* Handles a payload that does not fit in the payload buffer. The payload is
+ * delivered in fragments if enabled, otherwise it is dropped.
+ */
+static void on_publish_oversized(struct mqtt_client *const client,
+				 const struct mqtt_publish_param *p,
+				 const struct topic_parser_data *topic_data,
+				 struct azure_iot_hub_evt *evt)
+{
+	int err;
+
+#if IS_ENABLED(CONFIG_AZURE_IOT_HUB_PAYLOAD_FRAGMENTS)
+	if (fragment_evt_type_get(topic_data, &evt->type)) {
+		err = payload_fragments_notify(client, evt);
+		if (err) {
+			LOG_ERR("Failed to read payload fragment, error: %d",
+				err);
+			return;
+		}
+
+		publish_ack(client, p);
+		return;
+	}
+#endif /* IS_ENABLED(CONFIG_AZURE_IOT_HUB_PAYLOAD_FRAGMENTS) */
+
+	LOG_ERR("Incoming MQTT message too large for payload buffer");
+
+	/* The message is not acknowledged, as it has not been handled */
+	err = publish_discard_payload(client, p->message.payload.len);
+	if (err) {
+		LOG_ERR("Failed to discard payload, error: %d", err);
+	}
+}
+
 static void on_publish(struct mqtt_client *const client,
 			   const struct mqtt_evt *mqtt_evt)
 {
@@ -334,10 +466,12 @@ static void on_publish(struct mqtt_client *const client,
 	const struct mqtt_publish_param *p = &mqtt_evt->param.publish;
 	size_t payload_len = p->message.payload.len;
 	struct azure_iot_hub_prop_bag prop_bag[TOPIC_PROP_BAG_COUNT];
+	char prop_bag_buf[TOPIC_PROP_BAG_BUF_SIZE];
 	struct azure_iot_hub_evt evt = {
 		.type = AZURE_IOT_HUB_EVT_DATA_RECEIVED,
 		.data.msg.ptr = payload_buf,
 		.data.msg.len = payload_len,
+		.data.msg.total_len = payload_len,
 		.topic.str = (char *)p->message.topic.topic.utf8,
 		.topic.len = p->message.topic.topic.size,
 		.topic.prop_bag = prop_bag,
@@ -351,40 +485,38 @@ static void on_publish(struct mqtt_client *const client,
 	LOG_DBG("MQTT_EVT_PUBLISH: id = %d, len = %d ",
 		p->message_id, payload_len);
 
-	err = publish_get_payload(client, payload_len);
+	/* The topic is parsed before the payload is read, as it decides how
+	 * a payload larger than the buffer is handled.
+	 */
+	err = azure_iot_hub_topic_parse(&topic_data);
 	if (err) {
-		LOG_ERR("publish_get_payload, error: %d", err);
-		return;
+		LOG_ERR("Failed to parse topic, error: %d", err);
 	}
 
-	if (p->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
-		const struct mqtt_puback_param ack = {
-			.message_id = p->message_id
-		};
+	/* Only the property bags of devicebound messages are passed to the
+	 * application, and are URL-decoded and null-terminated for it.
+	 */
+	if ((topic_data.type == TOPIC_TYPE_DEVICEBOUND) &&
+	    (topic_prop_bags_export(&topic_data, prop_bag, prop_bag_buf,
+				    sizeof(prop_bag_buf)) == 0)) {
+		evt.topic.prop_bag_count = topic_data.prop_bag_count;
+	}
 
-		err = mqtt_publish_qos1_ack(client, &ack);
-		if (err) {
-			LOG_WRN("Failed to send MQTT ACK, error: %d",
-				err);
-		}
+	if (payload_len > sizeof(payload_buf)) {
+		on_publish_oversized(client, p, &topic_data, &evt);
+		return;
 	}
 
-	err = azure_iot_hub_topic_parse(&topic_data);
+	err = publish_get_payload(client, payload_len);
 	if (err) {
-		LOG_ERR("Failed to parse topic, error: %d", err);
+		LOG_ERR("publish_get_payload, error: %d", err);
+		return;
 	}
 
+	publish_ack(client, p);
+
 	switch (topic_data.type) {
 	case TOPIC_TYPE_DEVICEBOUND:
-		evt.topic.prop_bag_count = topic_data.prop_bag_count;
-		if (evt.topic.prop_bag_count == 0) {
-			break;
-		}
-
-		for (size_t i = 0; i < topic_data.prop_bag_count; i++) {
-			prop_bag[i].key = topic_data.prop_bag[i].key;
-			prop_bag[i].value = topic_data.prop_bag[i].value;
-		}
 		break;
 	case TOPIC_TYPE_DIRECT_METHOD:
 		if (direct_method_process(&topic_data, payload_buf,
@@ -50,6 +50,8 @@ static void api_event_handler(struct azure_iot_hub_evt *evt)
 		cloud_evt.type = CLOUD_EVT_DATA_RECEIVED;
 		cloud_evt.data.msg.buf = evt->data.msg.ptr;
 		cloud_evt.data.msg.len = evt->data.msg.len;
+		cloud_evt.data.msg.offset = evt->data.msg.offset;
+		cloud_evt.data.msg.total_len = evt->data.msg.total_len;
 		cloud_evt.data.msg.endpoint.type = CLOUD_EP_TOPIC_MSG;
 		cloud_evt.data.msg.endpoint.str = evt->topic.str;
 		cloud_evt.data.msg.endpoint.len = evt->topic.len;
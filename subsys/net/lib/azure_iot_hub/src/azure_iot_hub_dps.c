@@ -7,8 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <net/azure_iot_hub.h>
-#include <cJSON.h>
-#include <cJSON_os.h>
+#include <json_tok.h>
 #include <settings/settings.h>
 
 #include "azure_iot_hub_dps.h"
@@ -40,6 +39,9 @@ LOG_MODULE_REGISTER(azure_iot_hub_dps, CONFIG_AZURE_IOT_HUB_LOG_LEVEL);
 
 #define DPS_REG_PAYLOAD "{registrationId:\"%s\"}"
 
+/* Enough for a registration response without a custom payload */
+#define DPS_JSON_TOKENS_MAX	48
+
 struct dps_reg_status {
 	enum dps_reg_state state;
 	struct k_delayed_work poll_work;
@@ -55,6 +57,10 @@ struct dps_reg_status {
 
 static dps_handler_t cb_handler;
 static struct dps_reg_status dps_reg_status;
+
+/* Responses are parsed from the MQTT event handler only */
+static struct json_tok dps_toks[DPS_JSON_TOKENS_MAX];
+
 static struct mqtt_client *mqtt_client;
 static char dps_topic_reg_pub[sizeof(DPS_TOPIC_REG_PUB) +
 			      sizeof(dps_reg_status.reg_id)];
@@ -215,108 +221,80 @@ static void dps_reg_status_work_fn(struct k_work *work)
 	}
 }
 
-static int dps_get_operation_id(char *json)
+static int dps_get_operation_id(const char *json, size_t len)
 {
-	cJSON *root_obj, *op_id_obj;
-	char *op_id_str;
-	int err = 0;
+	struct json_tok_doc doc;
+	int err;
 
-	root_obj = cJSON_Parse(json);
-	if (root_obj == NULL) {
+	err = json_tok_parse(&doc, json, len, dps_toks, ARRAY_SIZE(dps_toks));
+	if (err < 0) {
 		LOG_DBG("[%s:%d] Unable to parse input", __func__, __LINE__);
 		return -ENOMEM;
 	}
 
-	op_id_obj = cJSON_GetObjectItem(root_obj, "operationId");
-	if (op_id_obj == NULL) {
-		LOG_ERR("Could not find operationId object");
-		err = -ENOMEM;
-		goto exit;
-	}
-
-	op_id_str = cJSON_GetStringValue(op_id_obj);
-	if (op_id_str == NULL) {
-		LOG_ERR("Failed to get operation ID string");
-		err = -ENOMEM;
-		goto exit;
+	err = json_tok_str(&doc, json_tok_obj_get(&doc, 0, "operationId"),
+			   dps_reg_status.operation_id,
+			   sizeof(dps_reg_status.operation_id));
+	if (err < 0) {
+		LOG_ERR("Could not find operationId string");
+		return -ENOMEM;
 	}
 
-	strncpy(dps_reg_status.operation_id, op_id_str,
-		sizeof(dps_reg_status.operation_id));
-
-exit:
-	cJSON_Delete(root_obj);
-
-	return err;
+	return 0;
 }
 
-static int dps_check_reg_success(char *json)
+static int dps_check_reg_success(const char *json, size_t len)
 {
-	cJSON *root_obj, *reg_status_obj, *status_item, *assigned_hub_item;
-	char *status_str, *assigned_hub_str;
-	int err = 0;
+	struct json_tok_doc doc;
+	char status[sizeof("assigned")];
+	int reg_status;
+	int len_hub;
+	int err;
 
-	root_obj = cJSON_Parse(json);
-	if (root_obj == NULL) {
+	err = json_tok_parse(&doc, json, len, dps_toks, ARRAY_SIZE(dps_toks));
+	if (err < 0) {
 		LOG_DBG("[%s:%d] Unable to parse input", __func__, __LINE__);
 		return -ENOMEM;
 	}
 
-	reg_status_obj =
-		cJSON_GetObjectItem(root_obj, "registrationState");
-	if (reg_status_obj == NULL) {
+	reg_status = json_tok_obj_get(&doc, 0, "registrationState");
+	if (!json_tok_is(&doc, reg_status, JSON_TOK_OBJECT)) {
 		LOG_ERR("Did not find registrationState object");
-		err = -ENOMEM;
-		goto exit;
-	}
-
-	status_item =
-		cJSON_GetObjectItem(reg_status_obj, "status");
-	if (status_item == NULL) {
-		LOG_ERR("Did not find status object");
-		err = -ENOMEM;
-		goto exit;
+		return -ENOMEM;
 	}
 
-	status_str = cJSON_GetStringValue(status_item);
-	if (status_str == NULL) {
+	err = json_tok_str(&doc, json_tok_obj_get(&doc, reg_status, "status"),
+			   status, sizeof(status));
+	if (err < 0) {
 		LOG_ERR("Failed to get status string");
-		err = -ENOMEM;
-		goto exit;
+		return -ENOMEM;
 	}
 
-	if (strcmp("assigned", status_str) != 0) {
+	if ((err >= sizeof(status)) || (strcmp("assigned", status) != 0)) {
 		LOG_ERR("The device was not assigned to hub, status: %s",
-			log_strdup(status_str));
-		goto exit;
+			log_strdup(status));
+		return 0;
 	}
 
-	LOG_DBG("Registration status: %s", log_strdup(status_str));
-
-	assigned_hub_item =
-		cJSON_GetObjectItem(reg_status_obj, "assignedHub");
-	if (assigned_hub_item == NULL) {
-		LOG_ERR("Did not find assignedHub object");
-		err = -ENOMEM;
-		goto exit;
-	}
+	LOG_DBG("Registration status: %s", log_strdup(status));
 
-	assigned_hub_str = cJSON_GetStringValue(assigned_hub_item);
-	if (assigned_hub_str == NULL) {
+	len_hub = json_tok_str(&doc,
+			       json_tok_obj_get(&doc, reg_status,
+						"assignedHub"),
+			       dps_reg_status.assigned_hub,
+			       sizeof(dps_reg_status.assigned_hub));
+	if (len_hub < 0) {
 		LOG_ERR("Failed to get assignedHub string");
-		err = -ENOMEM;
-		goto exit;
+		return -ENOMEM;
+	} else if (len_hub >= sizeof(dps_reg_status.assigned_hub)) {
+		LOG_ERR("assignedHub is too long");
+		return -ENOMEM;
 	}
 
-	strncpy(dps_reg_status.assigned_hub, assigned_hub_str,
-		sizeof(dps_reg_status.assigned_hub));
-
-	err = dps_save_hostname(assigned_hub_str, strlen(assigned_hub_str) + 1);
+	err = dps_save_hostname(dps_reg_status.assigned_hub, len_hub + 1);
 	if (err) {
 		LOG_ERR("Failed to save hostname");
 	}
-exit:
-	cJSON_Delete(root_obj);
 
 	return err;
 }
@@ -325,9 +303,8 @@ static void dps_parse_reg_update(struct topic_parser_data *topic, char *payload,
 				 size_t payload_len)
 {
 	int err;
-	char *reg_id_str = NULL;
-	char *retry_str = NULL;
-	char *end_ptr;
+	const struct topic_parser_prop_bag *reg_id;
+	const struct topic_parser_prop_bag *retry;
 
 	LOG_DBG("DPS registration request response received");
 
@@ -340,7 +317,7 @@ static void dps_parse_reg_update(struct topic_parser_data *topic, char *payload,
 		k_delayed_work_cancel(&dps_reg_status.poll_work);
 
 		/* The assigned IoT hub is stored as JSON in the payload */
-		err = dps_check_reg_success(payload);
+		err = dps_check_reg_success(payload, payload_len);
 		if (err) {
 			LOG_ERR("The registration was not successful");
 
@@ -374,36 +351,20 @@ static void dps_parse_reg_update(struct topic_parser_data *topic, char *payload,
 	}
 
 	/* Usually the registration ID comes first. */
-	if (strcmp("$rid", topic->prop_bag[0].key) == 0) {
-		reg_id_str = topic->prop_bag[0].value;
-	} else if (strcmp("retry-after", topic->prop_bag[0].key) == 0) {
-		retry_str = topic->prop_bag[0].value;
+	if (topic_prop_bag_key_eq(&topic->prop_bag[0], "$rid") &&
+	    topic_prop_bag_key_eq(&topic->prop_bag[1], "retry-after")) {
+		reg_id = &topic->prop_bag[0];
+		retry = &topic->prop_bag[1];
+	} else if (topic_prop_bag_key_eq(&topic->prop_bag[0], "retry-after") &&
+		   topic_prop_bag_key_eq(&topic->prop_bag[1], "$rid")) {
+		retry = &topic->prop_bag[0];
+		reg_id = &topic->prop_bag[1];
 	} else {
-		LOG_WRN("Unexpected property bag keys: \"%s\", \"%s\"",
-			log_strdup(topic->prop_bag[0].key),
-			log_strdup(topic->prop_bag[1].key));
-		return;
-	}
-
-	/* Usually the retry-after property comes second. */
-	if (strcmp("retry-after", topic->prop_bag[1].key) == 0) {
-		retry_str = topic->prop_bag[1].value;
-	} else if (strcmp("$rid", topic->prop_bag[1].key) == 0) {
-		reg_id_str = topic->prop_bag[1].value;
-	} else {
-		LOG_WRN("Unexpected property bag keys: \"%s\", \"%s\"",
-			log_strdup(topic->prop_bag[0].key),
-			log_strdup(topic->prop_bag[1].key));
-		return;
-	}
-
-	if ((reg_id_str == NULL) || (retry_str == NULL)) {
 		LOG_ERR("Retry value or request ID was not be found in topic");
 		return;
 	}
 
-	err = strcmp(dps_reg_status.reg_id, reg_id_str);
-	if (err != 0) {
+	if (!topic_prop_bag_value_eq(reg_id, dps_reg_status.reg_id)) {
 		LOG_ERR("Mismatch in received registration ID");
 		return;
 	}
@@ -411,10 +372,8 @@ static void dps_parse_reg_update(struct topic_parser_data *topic, char *payload,
 	LOG_DBG("Correct registration ID verified");
 
 	/* Convert retry value from string to integer */
-	errno = 0;
-	dps_reg_status.retry = strtoul(retry_str, &end_ptr, 10);
-
-	if ((errno == ERANGE) || (*end_ptr != '\0')) {
+	err = topic_prop_bag_uint_get(retry, &dps_reg_status.retry);
+	if (err) {
 		LOG_WRN("Retry value could not be parsed and applied");
 		return;
 	}
@@ -422,7 +381,7 @@ static void dps_parse_reg_update(struct topic_parser_data *topic, char *payload,
 	LOG_DBG("Received retry value: %d", dps_reg_status.retry);
 
 	/* Get operation ID and store to global status struct */
-	err = dps_get_operation_id(payload);
+	err = dps_get_operation_id(payload, payload_len);
 	if (err) {
 		dps_reg_status.state = DPS_STATE_FAILED;
 		LOG_ERR("Failed to get operation ID, error: %d", err);
@@ -479,7 +438,6 @@ int dps_init(struct dps_config *cfg)
 
 	k_delayed_work_init(&dps_reg_status.poll_work, dps_reg_status_work_fn);
 	k_sem_init(&dps_reg_status.settings_loaded, 0, 1);
-	cJSON_Init();
 
 	return dps_settings_init();
 }
@@ -7,7 +7,6 @@
 #include <zephyr.h>
 #include <stdio.h>
 #include <string.h>
-#include <stdlib.h>
 
 #include "azure_iot_hub_topic.h"
 
@@ -18,261 +17,363 @@ LOG_MODULE_REGISTER(azure_iot_hub_topic, CONFIG_AZURE_IOT_HUB_LOG_LEVEL);
 #define PROP_BAG_STR_EMPTY_VAL	"%s="
 #define PROP_BAG_STR_NO_VAL	"%s"
 
-static char *topic_prefixes[] = {
-	[TOPIC_TYPE_DEVICEBOUND] = TOPIC_PREFIX_DEVICEBOUND,
-	[TOPIC_TYPE_TWIN_UPDATE_DESIRED] = TOPIC_PREFIX_TWIN_DESIRED,
-	[TOPIC_TYPE_TWIN_UPDATE_RESULT] = TOPIC_PREFIX_TWIN_RES,
-	[TOPIC_TYPE_DPS_REG_RESULT] = TOPIC_PREFIX_DPS_REG_RESULT,
-	[TOPIC_TYPE_DIRECT_METHOD] = TOPIC_PREFIX_DIRECT_METHOD,
+/* Layout of a topic type:
+ *	<prefix>[<dynamic value>/[<suffix>]][<property bags>]
+ */
+struct topic_format {
+	const char *prefix;
+	uint8_t prefix_len;
+	/* The topic has a dynamic value after the prefix. */
+	bool has_value;
+	/* Fixed topic levels between the dynamic value and the property bags.
+	 * For devicebound topics, the '?' that should precede the property
+	 * bags is not consistently sent by the cloud side, so the property
+	 * bags can only be found by skipping these levels and the '/' that
+	 * follows them.
+	 */
+	const char *suffix;
+	uint8_t suffix_len;
 };
 
-/* If the topic type is TOPIC_TYPE_DEVICEBOUND, the dynamic value in the
- * topic (the device ID), is placed in the middle of the topic, and
- * the following string needs to be skipped before reaching the property
- * bag part of the topic. This can't be achieved by searching for '?' as
- * the separator indicating start of property bag component, as its not
- * consistently enforced on the cloud side, and the topic may or may not
- * contain '?' as separator.
- */
-#define TOPIC_DEVICE_BOUND_SUFFIX	"messages/devicebound/"
+#define TOPIC_FORMAT(_prefix, _has_value, _suffix)			       \
+	{								       \
+		.prefix = _prefix,					       \
+		.prefix_len = sizeof(_prefix) - 1,			       \
+		.has_value = _has_value,				       \
+		.suffix = _suffix,					       \
+		.suffix_len = sizeof(_suffix) - 1,			       \
+	}
 
-/* Move a pointer forward by the number of bytes corresponding to the
- * prefix length of the relevant topic.
- */
-static inline char *skip_prefix(char *const buf, enum topic_type type)
+static const struct topic_format topic_formats[] = {
+	[TOPIC_TYPE_DEVICEBOUND] =
+		TOPIC_FORMAT(TOPIC_PREFIX_DEVICEBOUND, true,
+			     "messages/devicebound"),
+	[TOPIC_TYPE_TWIN_UPDATE_DESIRED] =
+		TOPIC_FORMAT(TOPIC_PREFIX_TWIN_DESIRED, false, ""),
+	[TOPIC_TYPE_TWIN_UPDATE_RESULT] =
+		TOPIC_FORMAT(TOPIC_PREFIX_TWIN_RES, true, ""),
+	[TOPIC_TYPE_DPS_REG_RESULT] =
+		TOPIC_FORMAT(TOPIC_PREFIX_DPS_REG_RESULT, true, ""),
+	[TOPIC_TYPE_DIRECT_METHOD] =
+		TOPIC_FORMAT(TOPIC_PREFIX_DIRECT_METHOD, true, ""),
+};
+
+static bool starts_with(const char *buf, size_t len, const char *str,
+			size_t str_len)
 {
-	return buf + strlen(topic_prefixes[type]);
+	return (len >= str_len) && (memcmp(buf, str, str_len) == 0);
 }
 
-/* Get the next occurence of a character within a string, where the length
- * of the string to inspect is set by the max argument.
+/* The prefixes differ in their first characters, so only the prefix of
+ * the matching type is compared beyond a character or two.
  */
-static inline char *get_next_occurrence(char *str, char c, size_t max)
+static enum topic_type topic_prefix_match(const char *buf, size_t len)
 {
-	for (size_t i = 0; i < max; i++) {
-		if (str[i] == c) {
-			return &str[i];
+	for (size_t i = 0; i < ARRAY_SIZE(topic_formats); i++) {
+		if (starts_with(buf, len, topic_formats[i].prefix,
+				topic_formats[i].prefix_len)) {
+			return i;
 		}
 	}
 
-	return NULL;
+	return TOPIC_TYPE_UNEXPECTED;
 }
 
-/* Gets the next property bag, on the format "<key>[=[<value>]]", where '=' and
- * value are optional.
- *
- * @retval the length of parsed property bag on success.
- * @retval 0 if there was no property bag the provided buffer.
- * @retval -ENOMEM if the key or value is too long for the buffer set by
- *	   CONFIG_AZURE_IOT_HUB_TOPIC_ELEMENT_MAX_LEN.
- */
-static int get_next_prop_bag(char *buf, size_t buf_len,
-			     struct topic_parser_prop_bag *const bag)
+/* Parse a decimal number that fills the whole buffer. */
+static int uint_parse(const char *buf, size_t len, uint32_t *val)
 {
-	char *start_ptr = buf;
-	const char *max_ptr = buf + buf_len;
-	char *end_ptr;
-	size_t len;
-	size_t parsed_len;
+	uint32_t num = 0;
 
-	if (buf_len == 0) {
-		return 0;
+	if (len == 0) {
+		return -EINVAL;
 	}
 
-	/* Skip forward to next property bag */
-	if ((*start_ptr == '?') || (*start_ptr == '&')) {
-		start_ptr += 1;
-		if (start_ptr >= max_ptr) {
-			return 0;
+	for (size_t i = 0; i < len; i++) {
+		uint32_t digit = buf[i] - '0';
+
+		if (digit > 9) {
+			return -EINVAL;
 		}
-	} else if ((*(start_ptr + 1) == '?') || (*(start_ptr + 1) == '&')) {
-		start_ptr += 2;
-		if (start_ptr >= max_ptr) {
-			return 0;
+
+		if (num > (UINT32_MAX - digit) / 10) {
+			return -ERANGE;
 		}
+
+		num = num * 10 + digit;
 	}
 
-	parsed_len = buf - start_ptr;
+	*val = num;
 
-	/* Pointer is at '/', '?' or '&', move to first character of the key */
+	return 0;
+}
 
-	/* The key has one of three formats:
-	 *	<key>
-	 *	<key>=
-	 *	<key>=<value>
-	 *
-	 * The end of the key can be detected in following ways:
-	 *	<key><end of buffer>
-	 *	<key>&
-	 *	<key>=
-	 */
-	end_ptr = start_ptr;
+/* Tokenize the property bags, on the format "<key>[=[<value>]]", separated
+ * by '&'. A leading '?' or '&' is skipped. Each character is visited once,
+ * and the bags point into the topic buffer.
+ *
+ * @retval 0 on success. Property bags beyond TOPIC_PROP_BAG_COUNT are
+ *	   ignored.
+ * @retval -ENOMEM if a key or value is longer than
+ *	   CONFIG_AZURE_IOT_HUB_TOPIC_ELEMENT_MAX_LEN.
+ */
+static int prop_bags_tokenize(const char *buf, size_t len,
+			      struct topic_parser_data *const data)
+{
+	const char *ptr = buf;
+	const char *end = buf + len;
+	struct topic_parser_prop_bag *bag;
 
-	while ((*end_ptr != '=') &&
-	       (*end_ptr != '&') &&
-	       (end_ptr < max_ptr)) {
-		end_ptr++;
+	if ((ptr < end) && ((*ptr == '?') || (*ptr == '&'))) {
+		ptr++;
 	}
 
-	len = end_ptr - start_ptr;
+	while ((ptr < end) && (data->prop_bag_count < TOPIC_PROP_BAG_COUNT)) {
+		bag = &data->prop_bag[data->prop_bag_count];
+		bag->key = ptr;
 
-	if (len > TOPIC_PROP_BAG_FIELD_MAX_LEN) {
-		LOG_ERR("Property bag element is too long for buffer");
-		return -ENOMEM;
-	}
-
-	memcpy(bag->key, start_ptr, len);
-	bag->key[len] = '\0';
+		while ((ptr < end) && (*ptr != '=') && (*ptr != '&')) {
+			ptr++;
+		}
 
-	LOG_DBG("Key: %s", log_strdup(bag->key));
+		bag->key_len = ptr - bag->key;
 
-	if (end_ptr == max_ptr) {
-		return 0;
-	} else if (*end_ptr == '&') {
-		LOG_DBG("No value in bag");
-		bag->value[0] = '\0';
+		if ((ptr < end) && (*ptr == '=')) {
+			ptr++;
+		}
 
-		return len;
-	} else if (end_ptr + 1 == max_ptr) {
-		LOG_DBG("Value is empty string");
+		bag->value = ptr;
 
-		return len + 1;
-	}
+		while ((ptr < end) && (*ptr != '&')) {
+			ptr++;
+		}
 
-	/* Set start_ptr to first character of value */
-	start_ptr = end_ptr + 1;
-	end_ptr = start_ptr;
+		bag->value_len = ptr - bag->value;
 
-	while ((*end_ptr != '&') && (end_ptr < max_ptr)) {
-		end_ptr++;
-	}
+		if ((bag->key_len > TOPIC_PROP_BAG_FIELD_MAX_LEN) ||
+		    (bag->value_len > TOPIC_PROP_BAG_FIELD_MAX_LEN)) {
+			LOG_ERR("Property bag element is too long");
+			return -ENOMEM;
+		}
 
-	len = end_ptr - start_ptr;
+		data->prop_bag_count++;
 
-	if (len > TOPIC_PROP_BAG_FIELD_MAX_LEN) {
-		LOG_ERR("Property bag element is too long for buffer");
-		return -ENOMEM;
+		/* Skip the '&' */
+		if (ptr < end) {
+			ptr++;
+		}
 	}
 
-	parsed_len = start_ptr - buf + len;
-
-	memcpy(bag->value, start_ptr, len);
-	bag->value[len] = '\0';
-
-	LOG_DBG("Value: %s", log_strdup(bag->value));
-
-	return parsed_len;
+	return 0;
 }
 
 enum topic_type topic_type_get(const char *buf, const size_t len)
 {
-	if (buf == NULL || len == 0) {
-		return TOPIC_TYPE_EMPTY;
-	}
+	struct topic_parser_data data = {
+		.topic = buf,
+		.topic_len = len,
+		.type = TOPIC_TYPE_UNKNOWN,
+	};
 
-	for (size_t i = 0; i < ARRAY_SIZE(topic_prefixes); i++) {
-		if (strncmp(topic_prefixes[i], buf,
-			    MIN(strlen(topic_prefixes[i]), len)) == 0) {
-			return i;
-		}
-	}
+	(void)azure_iot_hub_topic_parse(&data);
 
-	return TOPIC_TYPE_UNEXPECTED;
+	return data.type;
 }
 
 int azure_iot_hub_topic_parse(struct topic_parser_data *const data)
 {
-	char *start_ptr, *stop_ptr;
-	const char *max_ptr = data->topic + data->topic_len;
+	const struct topic_format *format;
+	const char *ptr, *value;
+	const char *end = data->topic + data->topic_len;
 	size_t len;
+	int err;
+
+	data->prop_bag_count = 0;
 
 	if (!data->topic || (data->topic_len == 0)) {
+		data->type = TOPIC_TYPE_EMPTY;
 		return -EINVAL;
 	}
 
 	if (data->type >= TOPIC_TYPE_UNKNOWN) {
-		data->type = topic_type_get(data->topic, data->topic_len);
-
-		if ((data->type == TOPIC_TYPE_EMPTY) ||
-		    (data->type == TOPIC_TYPE_UNEXPECTED)) {
+		data->type = topic_prefix_match(data->topic, data->topic_len);
+		if (data->type == TOPIC_TYPE_UNEXPECTED) {
 			return 0;
 		}
 	}
 
-	start_ptr = skip_prefix((char *)data->topic, data->type);
-
-	/* This is the common format for topics:
-	 *	<prefix>/<dynamic value>/<suffix>/<property bags>
-	 *
-	 * Where <dynamic value> and <suffix> fields are not present for all.
-	 *
-	 * Property bags have the following format:
-	 *	<key 1>=<value 1>&<key 2>=<value 2>&...
-	 *
-	 * Where the value field may be left empty. It's also allowed to leave
-	 * out the '=' sign.
-	 */
+	format = &topic_formats[data->type];
+	ptr = data->topic + format->prefix_len;
 
 	/* Detect if the topic carries more information than just the prefix. */
-	if (start_ptr == max_ptr) {
+	if (ptr >= end) {
 		return 0;
 	}
 
-	/* Get the dynamic value for topics that have one */
-	if (data->type != TOPIC_TYPE_TWIN_UPDATE_DESIRED) {
-		stop_ptr = get_next_occurrence(start_ptr, '/',
-					data->topic_len -
-					(start_ptr - data->topic));
-		len = stop_ptr ? stop_ptr - start_ptr : 0;
+	if (format->has_value) {
+		value = ptr;
+
+		while ((ptr < end) && (*ptr != '/')) {
+			ptr++;
+		}
+
+		len = ptr - value;
 
-		if (len == 0) {
+		if ((ptr == end) || (len == 0)) {
 			return -EFAULT;
-		} else if (len > TOPIC_DYNAMIC_VALUE_MAX_LEN) {
-			return -ENOMEM;
 		}
 
-		memcpy(data->name, start_ptr, len);
-		data->name[len] = '\0';
+		/* Skip the '/' */
+		ptr++;
 
-		LOG_DBG("Dynamic value: %s", log_strdup(data->name));
+		if (!starts_with(ptr, end - ptr, format->suffix,
+				 format->suffix_len)) {
+			if (data->type == TOPIC_TYPE_DEVICEBOUND) {
+				/* Another "devices/+/..." topic */
+				data->type = TOPIC_TYPE_UNEXPECTED;
+				return 0;
+			}
 
-		if ((data->type == TOPIC_TYPE_TWIN_UPDATE_RESULT) ||
-		    (data->type == TOPIC_TYPE_DPS_REG_RESULT)) {
-			char *end_ptr;
+			return -EFAULT;
+		}
 
-			errno = 0;
-			data->status = strtoul(data->name, &end_ptr, 10);
+		ptr += format->suffix_len;
 
-			if ((errno == ERANGE) || (*end_ptr != '\0')) {
+		if (format->suffix_len > 0) {
+			if ((ptr < end) && (*ptr != '/')) {
+				data->type = TOPIC_TYPE_UNEXPECTED;
+				return 0;
+			}
+
+			if (ptr < end) {
+				ptr++;
+			}
+		}
+
+		if ((data->type == TOPIC_TYPE_TWIN_UPDATE_RESULT) ||
+		    (data->type == TOPIC_TYPE_DPS_REG_RESULT)) {
+			err = uint_parse(value, len, &data->status);
+			if (err) {
 				LOG_ERR("Failed to parse string as number");
 				return -EFAULT;
 			}
-		} else if (data->type == TOPIC_TYPE_DEVICEBOUND) {
-			stop_ptr += sizeof(TOPIC_DEVICE_BOUND_SUFFIX) - 1;
+		} else if (data->type == TOPIC_TYPE_DIRECT_METHOD) {
+			if (len > TOPIC_DYNAMIC_VALUE_MAX_LEN) {
+				return -ENOMEM;
+			}
+
+			memcpy(data->name, value, len);
+			data->name[len] = '\0';
+
+			LOG_DBG("Direct method name: %s",
+				log_strdup(data->name));
 		}
+	}
+
+	return prop_bags_tokenize(ptr, end - ptr, data);
+}
+
+bool topic_prop_bag_key_eq(const struct topic_parser_prop_bag *bag,
+			   const char *key)
+{
+	return (strlen(key) == bag->key_len) &&
+	       (memcmp(bag->key, key, bag->key_len) == 0);
+}
+
+bool topic_prop_bag_value_eq(const struct topic_parser_prop_bag *bag,
+			     const char *value)
+{
+	return (strlen(value) == bag->value_len) &&
+	       (memcmp(bag->value, value, bag->value_len) == 0);
+}
+
+int topic_prop_bag_uint_get(const struct topic_parser_prop_bag *bag,
+			    uint32_t *val)
+{
+	return uint_parse(bag->value, bag->value_len, val);
+}
 
-		/* Move the start pointer to the end of the method name plus the
-		 * subsequent '/'. start_ptr will now be at the start of the
-		 * property bags, if there are any.
-		 */
-		start_ptr = stop_ptr + 1;
+static int hex_val(char c)
+{
+	if ((c >= '0') && (c <= '9')) {
+		return c - '0';
+	} else if ((c >= 'a') && (c <= 'f')) {
+		return c - 'a' + 10;
+	} else if ((c >= 'A') && (c <= 'F')) {
+		return c - 'A' + 10;
 	}
 
-	data->prop_bag_count = 0;
+	return -1;
+}
+
+int topic_url_decode(const char *src, size_t src_len, char *buf,
+		     size_t size)
+{
+	size_t len = 0;
+	int hi, lo;
+
+	if (size == 0) {
+		return -ENOMEM;
+	}
+
+	for (size_t i = 0; i < src_len; i++) {
+		char c = src[i];
+
+		if (c == '%') {
+			if (i + 2 >= src_len) {
+				return -EINVAL;
+			}
+
+			hi = hex_val(src[i + 1]);
+			lo = hex_val(src[i + 2]);
+			if ((hi < 0) || (lo < 0)) {
+				return -EINVAL;
+			}
 
-	while ((start_ptr < max_ptr) &&
-	       (data->prop_bag_count < TOPIC_PROP_BAG_COUNT)) {
-		int ret = get_next_prop_bag(start_ptr, max_ptr - start_ptr,
-				&data->prop_bag[data->prop_bag_count]);
+			c = (char)((hi << 4) | lo);
+			i += 2;
+		}
 
-		if (ret <= 0) {
-			return ret;
+		if (len + 1 >= size) {
+			return -ENOMEM;
 		}
 
-		data->prop_bag_count += 1;
-		start_ptr  += ret;
+		buf[len++] = c;
 	}
 
+	buf[len] = '\0';
+
+	return len;
+}
+
+int topic_prop_bags_export(const struct topic_parser_data *data,
+			   struct azure_iot_hub_prop_bag *bags,
+			   char *buf, size_t size)
+{
+	size_t used = 0;
+	const struct topic_parser_prop_bag *bag;
+	int len;
+
+	for (size_t i = 0; i < data->prop_bag_count; i++) {
+		bag = &data->prop_bag[i];
+
+		len = topic_url_decode(bag->key, bag->key_len, &buf[used],
+				       size - used);
+		if (len < 0) {
+			return len;
+		}
+
+		bags[i].key = &buf[used];
+		used += len + 1;
+
+		len = topic_url_decode(bag->value, bag->value_len, &buf[used],
+				       size - used);
+		if (len < 0) {
+			return len;
+		}
+
+		bags[i].value = &buf[used];
+		used += len + 1;
+	}
 
 	return 0;
 }
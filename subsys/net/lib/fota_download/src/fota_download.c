@@ -5,6 +5,7 @@
  */
 
 #include <zephyr.h>
+#include <string.h>
 #include <logging/log.h>
 #include <net/fota_download.h>
 #include <net/download_client.h>
@@ -24,6 +25,9 @@ static fota_download_callback_t callback;
 static struct download_client   dlc;
 static struct k_delayed_work    dlc_with_offset_work;
 static int socket_retries_left;
+static int offset_retries_left;
+static uint8_t expected_hash[DFU_TARGET_HASH_LEN];
+static bool hash_check;
 
 static void send_evt(enum fota_download_evt_id id)
 {
@@ -106,6 +110,20 @@ static int download_client_callback(const struct download_client_evt *event)
 				return err;
 			}
 
+			if (hash_check) {
+				err = dfu_target_hash_set(expected_hash);
+				if (err == -ENOTSUP) {
+					LOG_WRN("Image hash will not be verified");
+				} else if (err != 0) {
+					LOG_ERR("dfu_target_hash_set error %d",
+						err);
+					send_error_evt(FOTA_DOWNLOAD_ERROR_CAUSE_DOWNLOAD_FAILED);
+					(void)dfu_target_done(false);
+					first_fragment = true;
+					return err;
+				}
+			}
+
 			err = dfu_target_offset_get(&offset);
 			if (err != 0) {
 				LOG_DBG("unable to get dfu target offset err: "
@@ -128,7 +146,18 @@ static int download_client_callback(const struct download_client_evt *event)
 
 		err = dfu_target_write(event->fragment.buf,
 				       event->fragment.len);
-		if (err != 0) {
+		if ((err == -EAGAIN) && (offset_retries_left > 0)) {
+			/* The target expects data from another offset,
+			 * continue the download from there.
+			 */
+			offset_retries_left--;
+			(void)download_client_disconnect(&dlc);
+			k_delayed_work_submit(&dlc_with_offset_work,
+					      K_SECONDS(1));
+			LOG_INF("Refuse fragment, restart with offset");
+
+			return -1;
+		} else if (err != 0) {
 			LOG_ERR("dfu_target_write error %d", err);
 			int res = dfu_target_done(false);
 
@@ -137,10 +166,14 @@ static int download_client_callback(const struct download_client_evt *event)
 			}
 			first_fragment = true;
 			(void) download_client_disconnect(&dlc);
-			send_error_evt(FOTA_DOWNLOAD_ERROR_CAUSE_INVALID_UPDATE);
+			send_error_evt(err == -EAGAIN ?
+				FOTA_DOWNLOAD_ERROR_CAUSE_DOWNLOAD_FAILED :
+				FOTA_DOWNLOAD_ERROR_CAUSE_INVALID_UPDATE);
 			return err;
 		}
 
+		offset_retries_left = CONFIG_FOTA_OFFSET_RETRIES;
+
 		if (IS_ENABLED(CONFIG_FOTA_DOWNLOAD_PROGRESS_EVT) &&
 		    !first_fragment) {
 			err = dfu_target_offset_get(&offset);
@@ -165,7 +198,13 @@ static int download_client_callback(const struct download_client_evt *event)
 
 	case DOWNLOAD_CLIENT_EVT_DONE:
 		err = dfu_target_done(true);
-		if (err != 0) {
+		if (err == -EBADMSG) {
+			/* The image is corrupted, do not schedule the upgrade */
+			(void)download_client_disconnect(&dlc);
+			first_fragment = true;
+			send_error_evt(FOTA_DOWNLOAD_ERROR_CAUSE_INVALID_UPDATE);
+			return err;
+		} else if (err != 0) {
 			LOG_ERR("dfu_target_done error: %d", err);
 			send_error_evt(FOTA_DOWNLOAD_ERROR_CAUSE_DOWNLOAD_FAILED);
 			return err;
@@ -242,6 +281,14 @@ static void download_with_offset(struct k_work *unused)
 
 int fota_download_start(const char *host, const char *file, int sec_tag,
 			const char *apn, size_t fragment_size)
+{
+	return fota_download_start_with_hash(host, file, sec_tag, apn,
+					     fragment_size, NULL);
+}
+
+int fota_download_start_with_hash(const char *host, const char *file,
+				  int sec_tag, const char *apn,
+				  size_t fragment_size, const uint8_t *hash)
 {
 	int err = -1;
 
@@ -255,7 +302,17 @@ int fota_download_start(const char *host, const char *file, int sec_tag,
 		return -EINVAL;
 	}
 
+	if (hash != NULL && !IS_ENABLED(CONFIG_DFU_TARGET_HASH_CHECK)) {
+		return -ENOTSUP;
+	}
+
+	hash_check = (hash != NULL);
+	if (hash_check) {
+		memcpy(expected_hash, hash, sizeof(expected_hash));
+	}
+
 	socket_retries_left = CONFIG_FOTA_SOCKET_RETRIES;
+	offset_retries_left = CONFIG_FOTA_OFFSET_RETRIES;
 
 #ifdef PM_S1_ADDRESS
 	/* B1 upgrade is supported, check what B1 slot is active,
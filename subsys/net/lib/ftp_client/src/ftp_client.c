@@ -6,6 +6,7 @@
 #include <logging/log.h>
 #include <zephyr.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <net/socket.h>
 #include <net/tls_credentials.h>
@@ -38,10 +39,9 @@ static struct ftp_client {
 
 static struct k_work_q ftp_work_q;
 static char ctrl_buf[NET_IPV4_MTU];
-static K_SEM_DEFINE(tx_done, 0, 1);
+static uint8_t stream_buf[NET_IPV4_MTU];
 
 enum data_task_type {
-	TASK_SEND,
 	TASK_RECEIVE
 };
 
@@ -49,10 +49,21 @@ static struct data_task {
 	struct k_work work;
 	enum data_task_type task;
 	char *ctrl_msg;		/* PSAV resposne */
-	uint8_t *data;		/* TX data */
-	uint16_t length;	/* TX length */
 } data_task_param;
 
+/* File transfer over a single data connection, see ftp_put_open() and
+ * ftp_get_open().
+ */
+static struct ftp_stream {
+	int sock;		/* Data socket */
+	bool upload;		/* STOR, otherwise RETR */
+	bool ctrl_done;		/* Final reply already received */
+	size_t bytes;		/* Bytes transferred */
+	int64_t start;		/* Uptime at start of transfer */
+} stream = {
+	.sock = INVALID_SOCKET
+};
+
 static int parse_return_code(const uint8_t *message, int success_code)
 {
 	char code_str[6]; /* max 1xxxx*/
@@ -105,7 +116,7 @@ static int establish_data_channel(const char *pasv_msg)
 	}
 	if (data_sock < 0) {
 		LOG_ERR("socket(data) failed: %d", -errno);
-		ret = -errno;
+		return -errno;
 	}
 
 	if (client.sec_tag > 0) {
@@ -156,39 +167,6 @@ static int do_ftp_send_ctrl(const uint8_t *message, int length)
 	return ret;
 }
 
-/**@brief Send FTP data via socket
- */
-static int do_ftp_send_data(const char *pasv_msg, uint8_t *message, uint16_t length)
-{
-	int data_sock;
-	int ret;
-	uint32_t offset = 0;
-
-	/* Establish data channel */
-	ret = establish_data_channel(pasv_msg);
-	if (ret < 0) {
-		return ret;
-	}
-
-	LOG_HEXDUMP_DBG(message, length, "TXD");
-
-	data_sock = ret;
-	while (offset < length) {
-		ret = send(data_sock, message + offset, length - offset, 0);
-		if (ret < 0) {
-			LOG_ERR("send(data) failed: %d", -errno);
-			ret = -errno;
-			break;
-		}
-		offset += ret;
-		ret = 0;
-	}
-
-	LOG_DBG("DATA sent");
-	close(data_sock);
-	return ret;
-}
-
 /**@brief Receive FTP message from socket
  */
 static int do_ftp_recv_ctrl(bool post_result, int success_code)
@@ -280,11 +258,6 @@ static void data_task(struct k_work *item)
 
 	if (task_param->task == TASK_RECEIVE) {
 		do_ftp_recv_data(task_param->ctrl_msg);
-	} else if (task_param->task == TASK_SEND) {
-		do_ftp_send_data(task_param->ctrl_msg,
-				task_param->data,
-				task_param->length);
-		k_sem_give(&tx_done);
 	}
 }
 
@@ -438,6 +411,10 @@ int ftp_close(void)
 		}
 	}
 
+	if (stream.sock != INVALID_SOCKET) {
+		close(stream.sock);
+		stream.sock = INVALID_SOCKET;
+	}
 	close(client.sock);
 	client.connected = false;
 	client.sec_tag = INVALID_SEC_TAG;
@@ -627,10 +604,28 @@ int ftp_delete(const char *file)
 	return ret;
 }
 
-int ftp_get(const char *file)
+static void keepalive_restart(void)
+{
+	int keepalive_time = CONFIG_FTP_CLIENT_KEEPALIVE_TIME;
+
+	if (client.connected && keepalive_time > 0) {
+		k_timer_start(&keepalive_timer, K_SECONDS(keepalive_time),
+			K_SECONDS(keepalive_time));
+	}
+}
+
+/**@brief Open a data connection and start a STOR or RETR transfer
+ */
+static int stream_open(const char *cmd, const char *file, size_t offset,
+		       bool post_result)
 {
 	int ret;
-	char get_cmd[128];
+	char xfer_cmd[128];
+
+	if (stream.sock != INVALID_SOCKET) {
+		LOG_ERR("Transfer already open");
+		return -EBUSY;
+	}
 
 	/* Always set Passive mode to act as TCP client */
 	ret = do_ftp_send_ctrl(CMD_PASV, sizeof(CMD_PASV) - 1);
@@ -641,27 +636,250 @@ int ftp_get(const char *file)
 	if (ret != FTP_CODE_227) {
 		return ret;
 	}
-	data_task_param.ctrl_msg = ctrl_buf;
-	data_task_param.task = TASK_RECEIVE;
 
-	/* Send RETR command in control channel */
-	sprintf(get_cmd, CMD_RETR, file);
-	ret = do_ftp_send_ctrl(get_cmd, strlen(get_cmd));
+	/* Stop keep alive, NOOP replies must not mix with the transfer */
+	k_timer_stop(&keepalive_timer);
+
+	/* Set up data connection once for the whole file */
+	ret = establish_data_channel(ctrl_buf);
+	if (ret < 0) {
+		goto error;
+	}
+	stream.sock = ret;
+
+	/* Restart an interrupted transfer at the given offset */
+	if (offset > 0) {
+		sprintf(xfer_cmd, CMD_REST, (unsigned int)offset);
+		ret = do_ftp_send_ctrl(xfer_cmd, strlen(xfer_cmd));
+		if (ret) {
+			ret = -EIO;
+			goto error;
+		}
+		ret = do_ftp_recv_ctrl(post_result, FTP_CODE_350);
+		if (ret != FTP_CODE_350) {
+			goto error;
+		}
+	}
+
+	/* Send STOR/RETR command in control channel */
+	sprintf(xfer_cmd, cmd, file);
+	ret = do_ftp_send_ctrl(xfer_cmd, strlen(xfer_cmd));
 	if (ret) {
-		return -EIO;
+		ret = -EIO;
+		goto error;
+	}
+	ret = do_ftp_recv_ctrl(post_result, FTP_CODE_150);
+	if (ret != FTP_CODE_150) {
+		ret = parse_return_code(ctrl_buf, FTP_CODE_125);
+		if (ret != FTP_CODE_125) {
+			goto error;
+		}
 	}
+	/* Short transfers may complete in the same reply */
+	stream.ctrl_done = (strstr(ctrl_buf, "226 ") != NULL);
+	stream.bytes = 0;
+	stream.start = k_uptime_get();
 
-	/* Set up data connection */
-	k_work_submit_to_queue(&ftp_work_q, &data_task_param.work);
+	return ret;
+
+error:
+	if (stream.sock != INVALID_SOCKET) {
+		close(stream.sock);
+		stream.sock = INVALID_SOCKET;
+	}
+	keepalive_restart();
+	return ret;
+}
+
+/**@brief Close the data connection and wait for the transfer result
+ */
+static int stream_close(bool post_result, struct ftp_transfer_stats *stats)
+{
+	int ret = FTP_CODE_226;
+	int64_t duration;
+
+	if (stream.sock == INVALID_SOCKET) {
+		return -ENOTCONN;
+	}
+
+	/* Closing the data connection ends an upload */
+	close(stream.sock);
+	stream.sock = INVALID_SOCKET;
+
+	if (!stream.ctrl_done) {
+		do {
+			ret = do_ftp_recv_ctrl(post_result, FTP_CODE_226);
+			if (ret < 0 || ret == FTP_CODE_226) {
+				break;
+			}
+		} while (1);
+	}
+
+	duration = k_uptime_get() - stream.start;
+	LOG_INF("%s %u bytes in %u ms", stream.upload ? "Sent" : "Received",
+		(unsigned int)stream.bytes, (unsigned int)duration);
+	if (stats) {
+		stats->bytes = stream.bytes;
+		stats->duration_ms = (uint32_t)duration;
+		stats->throughput = (duration > 0) ?
+			(uint32_t)(stream.bytes * 1000ULL / duration) : 0;
+	}
+
+	keepalive_restart();
+	return ret;
+}
+
+int ftp_put_open(const char *file, size_t offset)
+{
+	int ret;
+
+	ret = stream_open(CMD_STOR, file, offset, true);
+	if (FTP_PRELIMINARY_POS(ret)) {
+		stream.upload = true;
+	}
+
+	return ret;
+}
+
+int ftp_put_write(const uint8_t *data, size_t length)
+{
+	int ret;
+	size_t offset = 0;
+
+	if (stream.sock == INVALID_SOCKET || !stream.upload) {
+		return -ENOTCONN;
+	}
+
+	LOG_HEXDUMP_DBG(data, length, "TXD");
+
+	while (offset < length) {
+		ret = send(stream.sock, data + offset, length - offset, 0);
+		if (ret < 0) {
+			LOG_ERR("send(data) failed: %d", -errno);
+			return -errno;
+		}
+		offset += ret;
+	}
+	stream.bytes += length;
+
+	return 0;
+}
+
+int ftp_put_close(struct ftp_transfer_stats *stats)
+{
+	if (!stream.upload) {
+		return -ENOTCONN;
+	}
+
+	return stream_close(true, stats);
+}
+
+int ftp_get_open(const char *file, size_t offset)
+{
+	int ret;
+
+	ret = stream_open(CMD_RETR, file, offset, true);
+	if (FTP_PRELIMINARY_POS(ret)) {
+		stream.upload = false;
+	}
+
+	return ret;
+}
+
+int ftp_get_read(uint8_t *buf, size_t size)
+{
+	int ret;
+	struct pollfd fds[1];
+
+	if (stream.sock == INVALID_SOCKET || stream.upload) {
+		return -ENOTCONN;
+	}
+
+	fds[0].fd = stream.sock;
+	fds[0].events = POLLIN;
+	ret = poll(fds, 1, MSEC_PER_SEC * CONFIG_FTP_CLIENT_LISTEN_TIME);
+	if (ret <= 0) {
+		LOG_ERR("poll(data) failed: (%d)", -errno);
+		return -ETIMEDOUT;
+	}
+	if ((fds[0].revents & POLLIN) != POLLIN) {
+		LOG_INF("No more data");
+		return 0;
+	}
+	ret = recv(stream.sock, buf, size, 0);
+	if (ret < 0) {
+		LOG_ERR("recv(data) failed: (%d)", -errno);
+		return -errno;
+	}
+
+	LOG_HEXDUMP_DBG(buf, ret, "RXD");
+	stream.bytes += ret;
+
+	/* 0 when the server has sent the whole file */
+	return ret;
+}
+
+int ftp_get_close(struct ftp_transfer_stats *stats)
+{
+	if (stream.upload) {
+		return -ENOTCONN;
+	}
+
+	return stream_close(true, stats);
+}
+
+int ftp_size(const char *file, size_t *size)
+{
+	int ret;
+	char *reply;
+	char *end;
+
+	if (size == NULL) {
+		return -EINVAL;
+	}
+
+	sprintf(ctrl_buf, CMD_SIZE, file);
+	ret = do_ftp_send_ctrl(ctrl_buf, strlen(ctrl_buf));
+	if (ret == 0) {
+		ret = do_ftp_recv_ctrl(true, FTP_CODE_213);
+	}
+	if (ret == FTP_CODE_213) {
+		/* e.g. "213 1024" */
+		reply = strstr(ctrl_buf, "213 ");
+		if (reply == NULL) {
+			return -EBADMSG;
+		}
+		reply += 4;
+		*size = (size_t)strtoul(reply, &end, 10);
+		if (end == reply) {
+			LOG_ERR("Invalid SIZE reply");
+			return -EBADMSG;
+		}
+	}
+
+	return ret;
+}
+
+int ftp_get(const char *file)
+{
+	int ret;
+
+	ret = stream_open(CMD_RETR, file, 0, false);
+	if (!FTP_PRELIMINARY_POS(ret)) {
+		return ret;
+	}
+	stream.upload = false;
 
-	/* Receive control */
 	do {
-		ret = do_ftp_recv_ctrl(false, FTP_CODE_226);
-		if (ret == -ETIMEDOUT || ret == FTP_CODE_226) {
+		ret = ftp_get_read(stream_buf, sizeof(stream_buf));
+		if (ret <= 0) {
 			break;
 		}
-	} while (1);
+		client.data_callback(stream_buf, ret);
+	} while (true);
 
+	/* Receive control */
+	ret = stream_close(false, NULL);
 	if (ret == FTP_CODE_226) {
 		client.ctrl_callback(ctrl_buf, strlen(ctrl_buf));
 	}
@@ -672,44 +890,20 @@ int ftp_get(const char *file)
 int ftp_put(const char *file, const uint8_t *data, uint16_t length)
 {
 	int ret;
-	char put_cmd[128];
+	int err = 0;
 
-	if (data && length) {
-		/* Always set Passive mode to act as TCP client */
-		ret = do_ftp_send_ctrl(CMD_PASV, sizeof(CMD_PASV) - 1);
-		if (ret) {
-			return -EIO;
-		}
-		ret = do_ftp_recv_ctrl(true, FTP_CODE_227);
-		if (ret != FTP_CODE_227) {
-			return ret;
-		}
-		data_task_param.ctrl_msg = ctrl_buf;
-		data_task_param.task = TASK_SEND;
-		data_task_param.data = (uint8_t *)data;
-		data_task_param.length = length;
+	ret = ftp_put_open(file, 0);
+	if (!FTP_PRELIMINARY_POS(ret)) {
+		return ret;
 	}
 
-	/* Send STOR command in control channel */
-	sprintf(put_cmd, CMD_STOR, file);
-	ret = do_ftp_send_ctrl(put_cmd, strlen(put_cmd));
-
-	/* Now send data */
 	if (data && length) {
-		k_work_submit_to_queue(&ftp_work_q, &data_task_param.work);
-		k_sem_take(&tx_done, K_FOREVER);
+		err = ftp_put_write(data, length);
 	}
 
-	if (ret == 0) {
-		do {
-			ret = do_ftp_recv_ctrl(true, FTP_CODE_226);
-			if (ret == -ETIMEDOUT || ret == FTP_CODE_226) {
-				break;
-			}
-		} while (1);
-	}
+	ret = ftp_put_close(NULL);
 
-	return ret;
+	return err ? err : ret;
 }
 
 int ftp_init(ftp_client_callback_t ctrl_callback,
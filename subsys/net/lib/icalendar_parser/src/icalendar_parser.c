@@ -14,402 +14,344 @@
 
 LOG_MODULE_REGISTER(icalendar_parser, CONFIG_ICAL_PARSER_LOG_LEVEL);
 
-static size_t unfold_contentline(const char *buf, char *prop_buf)
+/* Content line parsing states.
+ * Reference: RFC 5545 3.1 Content Lines
+ */
+enum ical_state {
+	/* Property name, up to ";" or ":" */
+	STATE_NAME,
+	/* Property parameters, up to ":" outside quotes */
+	STATE_PARAM,
+	/* Property value, up to the end of the line */
+	STATE_VALUE,
+};
+
+/* Properties the parser acts on */
+enum ical_prop {
+	PROP_OTHER,
+	PROP_BEGIN,
+	PROP_END,
+	PROP_SUMMARY,
+	PROP_LOCATION,
+	PROP_DESCRIPTION,
+	PROP_DTSTART,
+	PROP_DTEND,
+};
+
+static const struct {
+	const char *name;
+	enum ical_prop prop;
+} ical_props[] = {
+	{ "BEGIN", PROP_BEGIN },
+	{ "END", PROP_END },
+	{ "SUMMARY", PROP_SUMMARY },
+	{ "LOCATION", PROP_LOCATION },
+	{ "DESCRIPTION", PROP_DESCRIPTION },
+	{ "DTSTART", PROP_DTSTART },
+	{ "DTEND", PROP_DTEND },
+};
+
+static const struct {
+	const char *name;
+	enum ical_parser_evt_id id;
+} ical_components[] = {
+	{ "VEVENT", ICAL_EVT_VEVENT },
+	{ "VTODO", ICAL_EVT_VTODO },
+	{ "VJOURNAL", ICAL_EVT_VJOURNAL },
+	{ "VFREEBUSY", ICAL_EVT_VFREEBUSY },
+	{ "VTIMEZONE", ICAL_EVT_VTIMEZONE },
+};
+
+static bool name_is(const struct icalendar_parser *ical, const char *name)
 {
-	size_t unfold_size = 0;
-	const char *sol = buf;
-	char *eol;
-	uint16_t total_line_len = 0, single_line_len = 0;
-
-	while (1) {
-		eol = strstr(sol, "\r\n");
-		if (!eol) {
-			return 0;
-		}
-		single_line_len = eol - sol;
-		if ((total_line_len + single_line_len)
-		    <= CONFIG_ICAL_PARSER_MAX_PROPERTY_SIZE) {
-			memcpy(prop_buf +
-			       total_line_len, sol, single_line_len);
-			total_line_len += single_line_len;
-		} else {
-			LOG_DBG("Property value overflow."
-				"Increase CONFIG_ICAL_PARSER_MAX_PROPERTY_SIZE.");
-			return 0;
-		}
-		if (!strncmp(eol, "\r\n ", strlen("\r\n "))) {
-			/* Long content line is split into multiple lines.
-			 * Copy the folded part to unfolded buffer.
-			 */
-			sol = eol + strlen("\r\n ");
-		} else {
-			/* Content line is delimited. Count parsed bytes */
-			unfold_size = eol - buf;
-			break;
-		}
-	}
-	prop_buf[unfold_size] = '\0';
-
-	return unfold_size;
+	return !ical->name_overflow && (strlen(name) == ical->name_len) &&
+	       !strncasecmp(ical->name, name, ical->name_len);
 }
 
-static bool parse_desc_props(const char *buf,
-			     const char *name,
-			     size_t name_size,
-			     char *value,
-			     size_t max_value_len)
+static void name_put(struct icalendar_parser *ical, char c)
 {
-	bool ret;
-	size_t unfold_size;
-	char ical_prop_buf[CONFIG_ICAL_PARSER_MAX_PROPERTY_SIZE + 1];
-
-	unfold_size = unfold_contentline(buf, ical_prop_buf);
-	if (unfold_size <= 0) {
-		/* Property wrong format - no parameter or value. */
-		LOG_ERR("%s no value/param.", name);
-		return false;
-	}
-
-	if (ical_prop_buf[name_size] == ':') {
-		size_t value_len = unfold_size - name_size - 1;
-
-		if (value_len <= max_value_len) {
-			memcpy(value,
-				ical_prop_buf + name_size + 1,
-				value_len);
-			value[value_len] = '\0';
-			ret = true;
-		} else {
-			/* Property value overflow. */
-			LOG_ERR("%s value overflow.", name);
-			ret = false;
-		}
-	} else if (ical_prop_buf[name_size] == ';') {
-		/* Does not support property parameter. */
-		LOG_ERR("%s param not supported.", name);
-		ret = false;
+	if (ical->name_len < ICAL_PARSER_NAME_SIZE) {
+		ical->name[ical->name_len++] = c;
+		ical->name[ical->name_len] = '\0';
 	} else {
-		/* Property wrong format - no parameter or value. */
-		LOG_ERR("%s wrong format.", name);
-		ret = false;
+		ical->name_overflow = true;
 	}
-
-	return ret;
 }
 
-static bool parse_datetime_props(const char *buf,
-				 const char *name,
-				 size_t name_size,
-				 char *value,
-				 size_t max_value_len)
+static enum ical_prop prop_get(const struct icalendar_parser *ical)
 {
-	bool ret;
-	size_t unfold_size;
-	char ical_prop_buf[CONFIG_ICAL_PARSER_MAX_PROPERTY_SIZE + 1];
-
-	unfold_size = unfold_contentline(buf, ical_prop_buf);
-	if (unfold_size <= 0) {
-		/* Property wrong format - fail to unfold property. */
-		LOG_ERR("%s wrong format. Fail to unfold property", name);
-		return false;
-	}
-
-	if (ical_prop_buf[name_size] == ':') {
-		size_t value_len = unfold_size - name_size - 1;
-
-		if (value_len <= max_value_len) {
-			memcpy(value,
-				ical_prop_buf + name_size + 1,
-				value_len);
-			value[value_len] = '\0';
-			ret = true;
-		} else {
-			/* Property value overflow. */
-			LOG_ERR("%s value overflow.", name);
-			ret = false;
+	for (size_t i = 0; i < ARRAY_SIZE(ical_props); i++) {
+		if (name_is(ical, ical_props[i].name)) {
+			return ical_props[i].prop;
 		}
-	} else if (ical_prop_buf[name_size] == ';') {
-		char *dtvalue;
-
-		dtvalue = strchr(ical_prop_buf, ':');
-		if (dtvalue) {
-			dtvalue = dtvalue + 1;
-			size_t value_len;
-
-			value_len = unfold_size -
-					(dtvalue - ical_prop_buf);
-			if (value_len <= max_value_len) {
-				memcpy(value, dtvalue, value_len);
-				value[value_len] = '\0';
-				ret = true;
-			} else {
-				/* Property value overflow. */
-				LOG_ERR("%s value overflow.", name);
-				ret = false;
-			}
-		} else {
-			/* Property wrong format - no value. */
-			LOG_ERR("%s wrong format - no value.", name);
-			ret = false;
-		}
-	} else {
-		/* Property wrong format - no parameter or value. */
-		LOG_ERR("%s wrong format.", name);
-		ret = false;
 	}
 
-	return ret;
+	return PROP_OTHER;
 }
 
-static size_t parse_calprops(const char *buf)
+/* Selects where the value of the current property is stored. */
+static void value_dest_set(struct icalendar_parser *ical)
 {
-	const char *parsed = buf;
-	char *end = NULL;
-	char prop_value[CONFIG_ICAL_PARSER_MAX_PROPERTY_SIZE + 1];
+	struct ical_component *com = &ical->evt.ical_com;
 
-	parsed = strstr(parsed, "BEGIN:VCALENDAR\r\n");
-	if (parsed == NULL) {
-		return 0;
-	}
-	parsed += strlen("BEGIN:VCALENDAR\r\n");
+	ical->value = NULL;
+	ical->value_len = 0;
+	ical->value_overflow = false;
 
-	end = strstr(parsed, "\r\nBEGIN:");
-	if (end == NULL) {
-		return 0;
+	if (ical->prop == PROP_BEGIN || ical->prop == PROP_END) {
+		/* Component name is stored in place of the property name */
+		ical->name_len = 0;
+		ical->name_overflow = false;
+		return;
 	}
-	end += strlen("\r\n");
-
-	while (parsed < end) {
-		memset(prop_value, 0, sizeof(prop_value));
-		if (!strncmp(parsed, "PRODID", 6)) {
-			if (!parse_desc_props(parsed, "PRODID", 6,
-					prop_value, sizeof(prop_value))) {
-				LOG_ERR("Wrong PRODID");
-			}
-		} else if (!strncmp(parsed, "VERSION", 7)) {
-			if (!parse_desc_props(parsed, "VERSION", 7,
-					prop_value, sizeof(prop_value))) {
-				LOG_ERR("Wrong VERSION");
-			}
-		}
-		parsed = strstr(parsed, "\r\n");
-		parsed += strlen("\r\n");
+
+	/* Only the properties of a VEVENT are stored, not the ones of
+	 * nested components such as VALARM.
+	 */
+	if (!ical->com_report || ical->depth != 1 ||
+	    ical->evt.id != ICAL_EVT_VEVENT ||
+	    ical->evt.error != ICAL_ERROR_NONE) {
+		return;
 	}
 
-	return (parsed - buf);
+	switch (ical->prop) {
+	case PROP_SUMMARY:
+		ical->value = com->summary;
+		ical->value_max = CONFIG_ICAL_PARSER_SUMMARY_SIZE;
+		break;
+	case PROP_LOCATION:
+		ical->value = com->location;
+		ical->value_max = CONFIG_ICAL_PARSER_LOCATION_SIZE;
+		break;
+	case PROP_DESCRIPTION:
+		ical->value = com->description;
+		ical->value_max = CONFIG_ICAL_PARSER_DESCRIPTION_SIZE;
+		break;
+	case PROP_DTSTART:
+		ical->value = com->dtstart;
+		ical->value_max = CONFIG_ICAL_PARSER_DTSTART_SIZE;
+		break;
+	case PROP_DTEND:
+		ical->value = com->dtend;
+		ical->value_max = CONFIG_ICAL_PARSER_DTEND_SIZE;
+		break;
+	default:
+		break;
+	}
 }
 
-static size_t parse_eventprop(const char *buf,
-			      struct ical_parser_evt *evt)
+static void value_put(struct icalendar_parser *ical, const char *data,
+		      size_t len)
 {
-	const char *parsed = buf;
-	char *com_end;
+	size_t space;
 
-	if (strncmp(buf, "BEGIN:VEVENT\r\n", strlen("BEGIN:VEVENT\r\n"))) {
-		return 0;
+	if (ical->prop == PROP_BEGIN || ical->prop == PROP_END) {
+		for (size_t i = 0; i < len; i++) {
+			name_put(ical, data[i]);
+		}
+		return;
 	}
 
-	com_end = strstr(buf, "END:VEVENT\r\n");
-	if (com_end == NULL) {
-		return 0;
+	if (ical->value == NULL) {
+		return;
 	}
 
-	evt->id = ICAL_EVT_VEVENT;
-	evt->error = ICAL_ERROR_NONE;
-	com_end += strlen("END:VEVENT\r\n");
-	while (parsed < com_end) {
-		if (!strncasecmp(parsed, "SUMMARY", 7)) {
-			if (!parse_desc_props(
-				parsed, "SUMMARY", 7,
-				evt->ical_com.summary,
-				CONFIG_ICAL_PARSER_SUMMARY_SIZE)) {
-				evt->error = ICAL_ERROR_SUMMARY;
-				parsed = com_end;
-			}
-		} else if (!strncasecmp(parsed, "LOCATION", 8)) {
-			if (!parse_desc_props(
-				parsed, "LOCATION", 8,
-				evt->ical_com.location,
-				CONFIG_ICAL_PARSER_LOCATION_SIZE)) {
-				evt->error = ICAL_ERROR_LOCATION;
-				parsed = com_end;
-			}
-		} else if (!strncasecmp(parsed, "DESCRIPTION", 11)) {
-			if (!parse_desc_props(
-				parsed, "DESCRIPTION", 11,
-				evt->ical_com.description,
-				CONFIG_ICAL_PARSER_DESCRIPTION_SIZE)) {
-				evt->error = ICAL_ERROR_DESCRIPTION;
-				parsed = com_end;
-			}
-		} else if (!strncasecmp(parsed, "DTSTART", 7)) {
-			if (!parse_datetime_props(
-				parsed, "DTSTART", 7,
-				evt->ical_com.dtstart,
-				CONFIG_ICAL_PARSER_DTSTART_SIZE)) {
-				evt->error = ICAL_ERROR_DTSTART;
-				parsed = com_end;
-			}
-		} else if (!strncasecmp(parsed,
-					"DTEND", 5)) {
-			if (!parse_datetime_props(
-				parsed, "DTEND", 5,
-				evt->ical_com.dtend,
-				CONFIG_ICAL_PARSER_DTEND_SIZE)) {
-				evt->error = ICAL_ERROR_DTEND;
-				parsed = com_end;
-			}
-		}
-
-		/* Move parsed pointer to end of line break */
-		parsed = strstr(parsed, "\r\n") + 2;
+	space = ical->value_max - ical->value_len;
+	if (len > space) {
+		ical->value_overflow = true;
+		len = space;
 	}
-
-	return parsed - buf;
+	memcpy(ical->value + ical->value_len, data, len);
+	ical->value_len += len;
 }
 
-static size_t parse_todoprop(const char *buf,
-				struct ical_parser_evt *evt)
+static void component_begin(struct icalendar_parser *ical)
 {
-	const char *parsed = buf;
-	char *com_end;
+	if (!ical->icalobject_begin) {
+		/* Check begin of iCalendar object delimiter
+		 * Reference: RFC 5545 3.4 iCalendar Object
+		 */
+		if (name_is(ical, "VCALENDAR")) {
+			LOG_DBG("Found a calendar stream");
+			ical->icalobject_begin = true;
+			ical->depth = 0;
+		}
+		return;
+	}
 
-	com_end = strstr(buf, "END:VTODO\r\n");
-	if (com_end) {
-		parsed = com_end + strlen("END:VTODO\r\n");
+	if (ical->depth++ > 0) {
+		/* Nested component, reported as part of its parent */
+		return;
 	}
-	evt->id = ICAL_EVT_VTODO;
-	evt->error = ICAL_ERROR_COM_NOT_SUPPORTED;
 
-	return parsed - buf;
+	ical->com_report = false;
+	for (size_t i = 0; i < ARRAY_SIZE(ical_components); i++) {
+		if (name_is(ical, ical_components[i].name)) {
+			memset(&ical->evt, 0, sizeof(ical->evt));
+			ical->evt.id = ical_components[i].id;
+			ical->evt.error =
+				(ical->evt.id == ICAL_EVT_VEVENT) ?
+				ICAL_ERROR_NONE : ICAL_ERROR_COM_NOT_SUPPORTED;
+			ical->com_report = true;
+			break;
+		}
+	}
 }
 
-static size_t parse_jourprop(const char *buf,
-				struct ical_parser_evt *evt)
+/* Returns the callback return value, or 0 if no event was sent. */
+static int component_end(struct icalendar_parser *ical)
 {
-	const char *parsed = buf;
-	char *com_end;
-
-	com_end = strstr(buf, "END:VJOURNAL\r\n");
-	if (com_end) {
-		parsed = com_end + strlen("END:VJOURNAL\r\n");
+	if (!ical->icalobject_begin) {
+		return 0;
 	}
-	evt->id = ICAL_EVT_VJOURNAL;
-	evt->error = ICAL_ERROR_COM_NOT_SUPPORTED;
 
-	return parsed - buf;
-}
-
-static size_t parse_fbprop(const char *buf, struct ical_parser_evt *evt)
-{
-	const char *parsed = buf;
-	char *com_end;
+	if (ical->depth == 0) {
+		if (name_is(ical, "VCALENDAR")) {
+			ical->icalobject_begin = false;
+		}
+		return 0;
+	}
 
-	com_end = strstr(buf, "END:VFREEBUSY\r\n");
-	if (com_end) {
-		parsed = com_end + strlen("END:VFREEBUSY\r\n");
+	if (--ical->depth > 0 || !ical->com_report) {
+		return 0;
 	}
-	evt->id = ICAL_EVT_VFREEBUSY;
-	evt->error = ICAL_ERROR_COM_NOT_SUPPORTED;
 
-	return parsed - buf;
+	ical->com_report = false;
+
+	return ical->callback(&ical->evt);
 }
 
-static size_t parse_tzprop(const char *buf, struct ical_parser_evt *evt)
+static void prop_end(struct icalendar_parser *ical)
 {
-	const char *parsed = buf;
-	char *com_end;
-
-	com_end = strstr(buf, "END:VTIMEZONE\r\n");
-	if (com_end) {
-		parsed = com_end + strlen("END:VTIMEZONE\r\n");
+	static const enum ical_parser_error_id errors[] = {
+		[PROP_SUMMARY] = ICAL_ERROR_SUMMARY,
+		[PROP_LOCATION] = ICAL_ERROR_LOCATION,
+		[PROP_DESCRIPTION] = ICAL_ERROR_DESCRIPTION,
+		[PROP_DTSTART] = ICAL_ERROR_DTSTART,
+		[PROP_DTEND] = ICAL_ERROR_DTEND,
+	};
+
+	if (ical->value == NULL) {
+		return;
 	}
-	evt->id = ICAL_EVT_VTIMEZONE;
-	evt->error = ICAL_ERROR_COM_NOT_SUPPORTED;
 
-	return parsed - buf;
+	if (ical->value_overflow) {
+		/* Property value overflow. */
+		LOG_ERR("%s value overflow.", log_strdup(ical->name));
+		ical->value[0] = '\0';
+		ical->evt.error = errors[ical->prop];
+	} else {
+		ical->value[ical->value_len] = '\0';
+	}
+	ical->value = NULL;
 }
 
-static size_t parse_component(char *buf, struct ical_parser_evt *evt)
+/* Handles the end of an unfolded content line. Returns the callback
+ * return value, or 0 if no event was sent.
+ */
+static int line_end(struct icalendar_parser *ical)
 {
-	char *com_begin = buf;
-	size_t ret = 0;
-
-	/* Search begin of component */
-	if (!strncmp(com_begin, "BEGIN:VEVENT\r\n", 14)) {
-		ret += parse_eventprop(com_begin, evt);
-	} else if (!strncmp(com_begin, "BEGIN:VTODO\r\n", 13)) {
-		ret += parse_todoprop(com_begin, evt);
-	} else if (!strncmp(com_begin, "BEGIN:VJOURNAL\r\n", 16)) {
-		ret += parse_jourprop(com_begin, evt);
-	} else if (!strncmp(com_begin, "BEGIN:VFREEBUSY\r\n", 17)) {
-		ret += parse_fbprop(com_begin, evt);
-	} else if (!strncmp(com_begin, "BEGIN:VTIMEZONE\r\n", 17)) {
-		ret += parse_tzprop(com_begin, evt);
+	int ret = 0;
+
+	if (ical->state != STATE_VALUE) {
+		/* Property wrong format - no value. */
+		LOG_DBG("Content line without value");
+	} else if (ical->prop == PROP_BEGIN) {
+		component_begin(ical);
+	} else if (ical->prop == PROP_END) {
+		ret = component_end(ical);
+	} else {
+		prop_end(ical);
 	}
 
+	ical->state = STATE_NAME;
+	ical->name_len = 0;
+	ical->name_overflow = false;
+	ical->quoted = false;
+	ical->value = NULL;
+
 	return ret;
 }
 
-static size_t parse_icalbody(char *buf,
-				icalendar_parser_callback_t callback)
+/* Handles the name and parameter delimiters. */
+static void delimiter_handle(struct icalendar_parser *ical, char c)
 {
-	size_t parsed_bytes = 0, parsed_offset = 0;
-
-	do {
-		struct ical_parser_evt evt;
-
-		parsed_bytes = parse_component(buf + parsed_offset, &evt);
-		parsed_offset += parsed_bytes;
-		if (parsed_bytes > 0) {
-			callback(&evt);
+	if (ical->state == STATE_NAME) {
+		if (c != ';' && c != ':') {
+			name_put(ical, c);
+			return;
 		}
-	} while (parsed_bytes > 0);
+		ical->prop = prop_get(ical);
+		value_dest_set(ical);
+		ical->state = (c == ':') ? STATE_VALUE : STATE_PARAM;
+		return;
+	}
 
-	return parsed_offset;
+	/* STATE_PARAM. Parameter values are skipped, a ':' in a quoted
+	 * parameter value does not start the property value.
+	 */
+	if (c == '"') {
+		ical->quoted = !ical->quoted;
+	} else if (c == ':' && !ical->quoted) {
+		ical->state = STATE_VALUE;
+	}
 }
 
 size_t ical_parser_parse(struct icalendar_parser *ical,
 			const char *data, size_t len)
 {
-	size_t parsed_offset = 0;
-
-	if (CONFIG_ICAL_PARSER_BUFFER_SIZE < (ical->offset + len)) {
-		return -ENOBUFS;
-	}
-
-	memcpy(ical->buf + ical->offset, data, len);
-	ical->buf[ical->offset + len] = '\0';
-
-	/* Check begin of iCalendar object delimiter
-	 * Reference: RFC 5545 3.4 iCalendar Object
-	 */
-	if (!ical->icalobject_begin) {
-		/* The body of the iCalendar object consists of
-		 * a sequence of calendar properties and
-		 * one or more calendar components.
-		 *
-		 * Reference: RFC 5545 3.6 Calendar Components
-		 */
-		parsed_offset += parse_calprops(ical->buf);
-		if (parsed_offset > 0) {
-			LOG_DBG("Found a calendar stream");
-			ical->icalobject_begin = true;
+	size_t i = 0;
+	size_t run;
+	char c;
+
+	while (i < len) {
+		c = data[i];
+
+		if (ical->line_end) {
+			ical->line_end = false;
+			if (c == ' ' || c == '\t') {
+				/* Folded line, the line break and the
+				 * whitespace are removed.
+				 * Reference: RFC 5545 3.1 Content Lines
+				 */
+				i++;
+				continue;
+			}
+			if (line_end(ical) != 0) {
+				/* Application stops the parsing */
+				return i;
+			}
 		}
-	}
 
-	/* If we got a calendar property, start parsing calendar body. */
-	if (ical->icalobject_begin) {
-		parsed_offset += parse_icalbody(ical->buf + parsed_offset,
-						ical->callback);
-	}
+		if (c == '\r') {
+			i++;
+			continue;
+		}
+		if (c == '\n') {
+			ical->line_end = true;
+			i++;
+			continue;
+		}
 
-	if (parsed_offset) {
-		ical->offset = ical->offset + len - parsed_offset;
-		memcpy(ical->buf, ical->buf + parsed_offset, ical->offset);
+		switch (ical->state) {
+		case STATE_VALUE:
+			/* Copy the value up to the end of the line at once */
+			for (run = i; run < len; run++) {
+				if (data[run] == '\r' || data[run] == '\n') {
+					break;
+				}
+			}
+			value_put(ical, &data[i], run - i);
+			i = run;
+			break;
+		default:
+			delimiter_handle(ical, c);
+			i++;
+			break;
+		}
 	}
 
-	return parsed_offset;
+	return i;
 }
 
 int ical_parser_init(struct icalendar_parser *ical,
@@ -419,9 +361,9 @@ int ical_parser_init(struct icalendar_parser *ical,
 		return -EINVAL;
 	}
 
+	memset(ical, 0, sizeof(*ical));
 	ical->callback = callback;
-	ical->icalobject_begin = false;
-	ical->offset = 0;
+	ical->state = STATE_NAME;
 
 	return 0;
 }
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <net/mqtt_topic_matcher.h>
+
+#define NODE_NONE MQTT_TOPIC_MATCHER_NONE
+
+static enum mqtt_topic_matcher_level_type level_type_get(const char *level,
+							 size_t len)
+{
+	if ((len == 1) && (level[0] == '+')) {
+		return MQTT_TOPIC_MATCHER_LEVEL_SINGLE;
+	}
+
+	if ((len == 1) && (level[0] == '#')) {
+		return MQTT_TOPIC_MATCHER_LEVEL_MULTI;
+	}
+
+	return MQTT_TOPIC_MATCHER_LEVEL_EXACT;
+}
+
+/* Wildcard characters are only allowed as a complete topic level. */
+static bool level_valid(const char *level, size_t len,
+			enum mqtt_topic_matcher_level_type type)
+{
+	if (type != MQTT_TOPIC_MATCHER_LEVEL_EXACT) {
+		return true;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		if ((level[i] == '+') || (level[i] == '#')) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int16_t node_find(const struct mqtt_topic_matcher *matcher,
+			 int16_t head, const char *level, size_t len,
+			 enum mqtt_topic_matcher_level_type type)
+{
+	for (int16_t i = head; i != NODE_NONE;
+	     i = matcher->nodes[i].sibling) {
+		const struct mqtt_topic_matcher_node *node = &matcher->nodes[i];
+
+		if (node->type != type) {
+			continue;
+		}
+
+		if ((type != MQTT_TOPIC_MATCHER_LEVEL_EXACT) ||
+		    ((node->level_len == len) &&
+		     (memcmp(node->level, level, len) == 0))) {
+			return i;
+		}
+	}
+
+	return NODE_NONE;
+}
+
+/* Exact levels are inserted first in the sibling list and wildcards last,
+ * so that more specific filters are tried first when matching.
+ */
+static int16_t node_insert(struct mqtt_topic_matcher *matcher, int16_t *head,
+			   const char *level, size_t len,
+			   enum mqtt_topic_matcher_level_type type)
+{
+	struct mqtt_topic_matcher_node *node;
+	int16_t index;
+
+	if (matcher->node_count >= matcher->node_max) {
+		return NODE_NONE;
+	}
+
+	index = matcher->node_count++;
+	node = &matcher->nodes[index];
+
+	node->level = level;
+	node->level_len = len;
+	node->type = type;
+	node->child = NODE_NONE;
+	node->sibling = NODE_NONE;
+	node->id = NODE_NONE;
+
+	if (type == MQTT_TOPIC_MATCHER_LEVEL_EXACT) {
+		node->sibling = *head;
+		*head = index;
+		return index;
+	}
+
+	while ((*head != NODE_NONE) &&
+	       (matcher->nodes[*head].type <= type)) {
+		head = &matcher->nodes[*head].sibling;
+	}
+
+	node->sibling = *head;
+	*head = index;
+
+	return index;
+}
+
+/* Returns the ID of a '#' child of the node, which also matches the parent
+ * level, or NODE_NONE.
+ */
+static int multi_child_id_get(const struct mqtt_topic_matcher *matcher,
+			      const struct mqtt_topic_matcher_node *node)
+{
+	for (int16_t i = node->child; i != NODE_NONE;
+	     i = matcher->nodes[i].sibling) {
+		if (matcher->nodes[i].type == MQTT_TOPIC_MATCHER_LEVEL_MULTI) {
+			return matcher->nodes[i].id;
+		}
+	}
+
+	return NODE_NONE;
+}
+
+static int level_match(const struct mqtt_topic_matcher *matcher, int16_t head,
+		       const char *level, const char *end, bool first)
+{
+	const char *sep = memchr(level, '/', end - level);
+	size_t len = (sep ? sep : end) - level;
+	/* Topics starting with '$' are not matched by leading wildcards. */
+	bool wildcard_allowed = !(first && (len > 0) && (level[0] == '$'));
+
+	for (int16_t i = head; i != NODE_NONE;
+	     i = matcher->nodes[i].sibling) {
+		const struct mqtt_topic_matcher_node *node = &matcher->nodes[i];
+		int id;
+
+		switch (node->type) {
+		case MQTT_TOPIC_MATCHER_LEVEL_EXACT:
+			if ((node->level_len != len) ||
+			    (memcmp(node->level, level, len) != 0)) {
+				continue;
+			}
+			break;
+		case MQTT_TOPIC_MATCHER_LEVEL_SINGLE:
+			if (!wildcard_allowed) {
+				continue;
+			}
+			break;
+		case MQTT_TOPIC_MATCHER_LEVEL_MULTI:
+			if (!wildcard_allowed) {
+				continue;
+			}
+			return node->id;
+		default:
+			continue;
+		}
+
+		if (sep == NULL) {
+			id = (node->id != NODE_NONE) ?
+				node->id : multi_child_id_get(matcher, node);
+		} else {
+			id = level_match(matcher, node->child, sep + 1, end,
+					 false);
+		}
+
+		if (id != NODE_NONE) {
+			return id;
+		}
+	}
+
+	return NODE_NONE;
+}
+
+void mqtt_topic_matcher_init(struct mqtt_topic_matcher *matcher,
+			     struct mqtt_topic_matcher_node *nodes,
+			     size_t node_max)
+{
+	__ASSERT_NO_MSG(matcher != NULL);
+	__ASSERT_NO_MSG(node_max <= INT16_MAX);
+
+	matcher->nodes = nodes;
+	matcher->node_max = node_max;
+
+	mqtt_topic_matcher_reset(matcher);
+}
+
+void mqtt_topic_matcher_reset(struct mqtt_topic_matcher *matcher)
+{
+	__ASSERT_NO_MSG(matcher != NULL);
+
+	matcher->node_count = 0;
+	matcher->root = NODE_NONE;
+}
+
+static bool filter_valid(const char *filter, size_t filter_len)
+{
+	const char *level = filter;
+	const char *end = filter + filter_len;
+
+	while (level != NULL) {
+		const char *sep = memchr(level, '/', end - level);
+		size_t len = (sep ? sep : end) - level;
+		enum mqtt_topic_matcher_level_type type =
+			level_type_get(level, len);
+
+		if (!level_valid(level, len, type)) {
+			return false;
+		}
+
+		/* '#' must be the last level of the filter. */
+		if ((type == MQTT_TOPIC_MATCHER_LEVEL_MULTI) && (sep != NULL)) {
+			return false;
+		}
+
+		level = sep ? sep + 1 : NULL;
+	}
+
+	return true;
+}
+
+int mqtt_topic_matcher_add(struct mqtt_topic_matcher *matcher,
+			   const char *filter, size_t filter_len, int id)
+{
+	const char *level = filter;
+	const char *end = filter + filter_len;
+	int16_t *head;
+	int16_t index = NODE_NONE;
+
+	if ((matcher == NULL) || (filter == NULL) || (filter_len == 0) ||
+	    (id < 0) || (id > INT16_MAX)) {
+		return -EINVAL;
+	}
+
+	if (!filter_valid(filter, filter_len)) {
+		return -EINVAL;
+	}
+
+	head = &matcher->root;
+
+	while (level != NULL) {
+		const char *sep = memchr(level, '/', end - level);
+		size_t len = (sep ? sep : end) - level;
+		enum mqtt_topic_matcher_level_type type =
+			level_type_get(level, len);
+
+		index = node_find(matcher, *head, level, len, type);
+		if (index == NODE_NONE) {
+			/* Nodes already added for preceding levels have no
+			 * ID and do not affect matching.
+			 */
+			index = node_insert(matcher, head, level, len, type);
+			if (index == NODE_NONE) {
+				return -ENOMEM;
+			}
+		}
+
+		head = &matcher->nodes[index].child;
+		level = sep ? sep + 1 : NULL;
+	}
+
+	if (matcher->nodes[index].id != NODE_NONE) {
+		return -EALREADY;
+	}
+
+	matcher->nodes[index].id = id;
+
+	return 0;
+}
+
+int mqtt_topic_matcher_match(const struct mqtt_topic_matcher *matcher,
+			     const char *topic, size_t topic_len)
+{
+	int id;
+
+	if ((matcher == NULL) || (topic == NULL) || (topic_len == 0)) {
+		return -ENOENT;
+	}
+
+	id = level_match(matcher, matcher->root, topic, topic + topic_len,
+			 true);
+
+	return (id == NODE_NONE) ? -ENOENT : id;
+}
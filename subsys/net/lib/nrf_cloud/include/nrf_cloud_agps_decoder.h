@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef NRF_CLOUD_AGPS_DECODER_H_
+#define NRF_CLOUD_AGPS_DECODER_H_
+
+#include <zephyr.h>
+
+#include "nrf_cloud_agps_schema_v1.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest element in the binary schema is the ephemeris (62 bytes). */
+#define NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE		(64)
+
+/**@brief Callback invoked for every complete A-GPS element.
+ *
+ * The element data pointers are only valid for the duration of the call.
+ *
+ * @return 0 to continue decoding, or a negative error code that is
+ *	   propagated to the caller of @ref nrf_cloud_agps_decoder_write.
+ */
+typedef int (*nrf_cloud_agps_decoder_cb_t)(
+	const struct nrf_cloud_apgs_element *element, void *user_data);
+
+enum nrf_cloud_agps_decoder_state {
+	NRF_CLOUD_AGPS_DECODER_VERSION,
+	NRF_CLOUD_AGPS_DECODER_HEADER,
+	NRF_CLOUD_AGPS_DECODER_ELEMENT,
+	NRF_CLOUD_AGPS_DECODER_DONE,
+	NRF_CLOUD_AGPS_DECODER_ERROR,
+};
+
+/**@brief Resumable A-GPS binary schema decoder.
+ *
+ * All parsing state is kept in this structure, so several decoders can run
+ * concurrently and input may be split at arbitrary byte boundaries.
+ */
+struct nrf_cloud_agps_decoder {
+	enum nrf_cloud_agps_decoder_state state;
+	enum nrf_cloud_agps_type type;
+	/* Elements left in the current array, including the one in progress. */
+	uint16_t elements_left;
+	/* Size of a single element of the current type. */
+	uint16_t element_size;
+	/* Number of bytes staged in buf. */
+	uint16_t staged;
+	/* Total number of bytes consumed, for diagnostics. */
+	size_t offset;
+	nrf_cloud_agps_decoder_cb_t cb;
+	void *user_data;
+	uint8_t buf[NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE];
+};
+
+/**@brief Initialize a decoder for a new A-GPS payload.
+ *
+ * @param decoder Decoder instance.
+ * @param cb Callback for decoded elements.
+ * @param user_data User data passed to the callback.
+ */
+void nrf_cloud_agps_decoder_init(struct nrf_cloud_agps_decoder *decoder,
+				 nrf_cloud_agps_decoder_cb_t cb,
+				 void *user_data);
+
+/**@brief Feed a chunk of A-GPS payload to the decoder.
+ *
+ * Elements are handed to the callback as soon as they are complete.
+ * Elements contained entirely in @p buf are passed without copying, only
+ * elements split across chunks are staged in the decoder.
+ *
+ * @param decoder Decoder instance.
+ * @param buf Chunk of payload.
+ * @param len Length of the chunk.
+ *
+ * @retval 0 Chunk consumed.
+ * @retval -EBADMSG Unsupported schema version.
+ * @retval -EINVAL Invalid parameters.
+ * @return Otherwise the error returned by the element callback.
+ */
+int nrf_cloud_agps_decoder_write(struct nrf_cloud_agps_decoder *decoder,
+				 const uint8_t *buf, size_t len);
+
+/**@brief Signal that the whole payload has been fed to the decoder.
+ *
+ * @param decoder Decoder instance.
+ *
+ * @retval 0 Payload ended on an element boundary.
+ * @retval -ENODATA No payload was received.
+ * @retval -EBADMSG Payload was truncated or decoding failed earlier.
+ */
+int nrf_cloud_agps_decoder_finish(struct nrf_cloud_agps_decoder *decoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NRF_CLOUD_AGPS_DECODER_H_ */
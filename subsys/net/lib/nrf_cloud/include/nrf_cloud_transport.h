@@ -38,6 +38,10 @@ struct nct_dc_data {
 	struct nrf_cloud_data data;
 	struct nrf_cloud_topic topic;
 	uint32_t id;
+	/* Offset of data in the received payload */
+	uint32_t offset;
+	/* Length of the received payload */
+	uint32_t total_len;
 };
 
 struct nct_cc_data {
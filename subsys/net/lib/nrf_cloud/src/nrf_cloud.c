@@ -308,6 +308,8 @@ static void api_event_handler(const struct nrf_cloud_evt *nrf_cloud_evt)
 		evt.type = CLOUD_EVT_DATA_RECEIVED;
 		evt.data.msg.buf = (char *)nrf_cloud_evt->data.ptr;
 		evt.data.msg.len = nrf_cloud_evt->data.len;
+		evt.data.msg.offset = nrf_cloud_evt->data_offset;
+		evt.data.msg.total_len = nrf_cloud_evt->data_total_len;
 		evt.data.msg.endpoint.type = CLOUD_EP_TOPIC_MSG;
 		evt.data.msg.endpoint.str =
 			(char *)nrf_cloud_evt->topic.ptr;
@@ -19,12 +19,15 @@ LOG_MODULE_REGISTER(nrf_cloud_agps, CONFIG_NRF_CLOUD_AGPS_LOG_LEVEL);
 
 #include "nrf_cloud_transport.h"
 #include "nrf_cloud_agps_schema_v1.h"
+#include "nrf_cloud_agps_decoder.h"
 
 extern void agps_print(enum nrf_cloud_agps_type type, void *data);
 
 static int fd = -1;
 static bool agps_print_enabled;
 static const struct device *gps_dev;
+static struct nrf_cloud_agps_decoder stream_decoder;
+static struct nrf_cloud_agps_system_time stream_sys_time;
 
 static enum gps_agps_type type_lookup_socket2gps[] = {
 	[NRF_GNSS_AGPS_UTC_PARAMETERS]	= GPS_AGPS_UTC_PARAMETERS,
@@ -465,95 +468,50 @@ static int agps_send_to_modem(struct nrf_cloud_apgs_element *agps_data)
 	return 0;
 }
 
-static size_t get_next_agps_element(struct nrf_cloud_apgs_element *element,
-				    const char *buf)
+static int agps_element_handler(const struct nrf_cloud_apgs_element *element,
+				void *user_data)
 {
-	static uint16_t elements_left_to_process;
-	static enum nrf_cloud_agps_type element_type;
-	size_t len = 0;
+	struct nrf_cloud_agps_system_time *sys_time = user_data;
+	struct nrf_cloud_apgs_element out = *element;
+	int err;
 
-	/* Check if there are more elements left in the array to process.
-	 * The element type is only given once before the array, and not for
-	 * each element.
-	 */
-	if (elements_left_to_process == 0) {
-		element->type =
-			(enum nrf_cloud_agps_type)buf[NRF_CLOUD_AGPS_BIN_TYPE_OFFSET];
-		element_type = element->type;
-		elements_left_to_process =
-			*(uint16_t *)&buf[NRF_CLOUD_AGPS_BIN_COUNT_OFFSET] - 1;
-		len += NRF_CLOUD_AGPS_BIN_TYPE_SIZE +
-			NRF_CLOUD_AGPS_BIN_COUNT_SIZE;
-	} else {
-		element->type = element_type;
-		elements_left_to_process -= 1;
-	}
+	if (element->type == NRF_CLOUD_AGPS_GPS_TOWS) {
+		uint8_t sv_id = element->tow->sv_id;
 
-	switch (element->type) {
-	case NRF_CLOUD_AGPS_UTC_PARAMETERS:
-		element->utc = (struct nrf_cloud_agps_utc *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_utc);
-		break;
-	case NRF_CLOUD_AGPS_EPHEMERIDES:
-		element->ephemeris = (struct nrf_cloud_agps_ephemeris *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_ephemeris);
-		break;
-	case NRF_CLOUD_AGPS_ALMANAC:
-		element->almanac = (struct nrf_cloud_agps_almanac *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_almanac);
-		break;
-	case NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION:
-		element->ion_correction.klobuchar =
-			(struct nrf_cloud_agps_klobuchar *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_klobuchar);
-		break;
-	case NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK:
-		element->time_and_tow =
-			(struct nrf_cloud_agps_system_time *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_system_time) -
-			sizeof(element->time_and_tow->sv_tow) + 4;
-		break;
-	case NRF_CLOUD_AGPS_GPS_TOWS:
-		element->tow =
-			(struct nrf_cloud_agps_tow_element *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_tow_element);
-		break;
-	case NRF_CLOUD_AGPS_LOCATION:
-		element->location = (struct nrf_cloud_agps_location *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_location);
-		break;
-	case NRF_CLOUD_AGPS_INTEGRITY:
-		element->integrity =
-			(struct nrf_cloud_agps_integrity *)(buf + len);
-		len += sizeof(struct nrf_cloud_agps_integrity);
-		break;
-	default:
-		LOG_DBG("Unhandled A-GPS data type: %d", element->type);
-		return 0;
-	}
+		if ((sv_id == 0) || (sv_id > NRF_CLOUD_AGPS_MAX_SV_TOW)) {
+			LOG_WRN("Invalid TOW SV ID: %d", sv_id);
+			return 0;
+		}
 
-	return len;
-}
+		memcpy(&sys_time->sv_tow[sv_id - 1], element->tow,
+		       sizeof(sys_time->sv_tow[0]));
 
-int nrf_cloud_agps_process(const char *buf, size_t buf_len, const int *socket)
-{
-	int err;
-	struct nrf_cloud_apgs_element element = {};
-	struct nrf_cloud_agps_system_time sys_time;
-	size_t parsed_len = 0;
-	uint8_t version;
+		LOG_DBG("TOW %d copied", sv_id - 1);
+
+		return 0;
+	} else if (element->type == NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK) {
+		/* The TOWs have been collected from the preceding elements,
+		 * only the header is taken from the system clock element.
+		 */
+		memcpy(sys_time, element->time_and_tow,
+		       sizeof(*sys_time) - sizeof(sys_time->sv_tow));
+		out.time_and_tow = sys_time;
 
-	version = buf[NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION_INDEX];
-	parsed_len += NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION_SIZE;
+		LOG_DBG("TOWs copied, bitmask: 0x%08x", sys_time->sv_mask);
+	}
 
-	__ASSERT(version == NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION,
-		 "Cannot parse schema version: %d", version);
+	err = agps_send_to_modem(&out);
+	if (err) {
+		LOG_ERR("Failed to send data to modem, error: %d", err);
+	}
 
-	LOG_DBG("Receievd AGPS data. Schema version: %d, length: %d",
-		version, buf_len);
+	return err;
+}
 
+int nrf_cloud_agps_stream_begin(const int *socket)
+{
 	if (socket) {
-		LOG_DBG("Using user-provided socket, fd %d", fd);
+		LOG_DBG("Using user-provided socket, fd %d", *socket);
 
 		gps_dev = NULL;
 		fd = *socket;
@@ -565,41 +523,44 @@ int nrf_cloud_agps_process(const char *buf, size_t buf_len, const int *socket)
 		}
 	}
 
-	while (parsed_len < buf_len) {
-		size_t element_size =
-			get_next_agps_element(&element, &buf[parsed_len]);
+	memset(&stream_sys_time, 0, sizeof(stream_sys_time));
+	nrf_cloud_agps_decoder_init(&stream_decoder, agps_element_handler,
+				    &stream_sys_time);
 
-		if (element_size == 0) {
-			LOG_DBG("Parsing finished\n");
-			break;
-		}
+	return 0;
+}
 
-		parsed_len += element_size;
+int nrf_cloud_agps_stream_write(const char *buf, size_t buf_len)
+{
+	return nrf_cloud_agps_decoder_write(&stream_decoder,
+					    (const uint8_t *)buf, buf_len);
+}
 
-		LOG_DBG("Parsed_len: %d\n", parsed_len);
+int nrf_cloud_agps_stream_end(void)
+{
+	int err = nrf_cloud_agps_decoder_finish(&stream_decoder);
 
-		if (element.type == NRF_CLOUD_AGPS_GPS_TOWS) {
-			memcpy(&sys_time.sv_tow[element.tow->sv_id - 1],
-				element.tow,
-				sizeof(sys_time.sv_tow[0]));
+	LOG_DBG("A-GPS stream ended, %d bytes processed, err: %d",
+		stream_decoder.offset, err);
 
-			LOG_DBG("TOW %d copied", element.tow->sv_id - 1);
+	return err;
+}
 
-			continue;
-		} else if (element.type == NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK) {
-			memcpy(&sys_time, element.time_and_tow,
-				sizeof(sys_time) - sizeof(sys_time.sv_tow));
+int nrf_cloud_agps_process(const char *buf, size_t buf_len, const int *socket)
+{
+	int err;
 
-			LOG_DBG("TOWs copied, bitmask: 0x%08x",
-				element.time_and_tow->sv_mask);
-		}
+	LOG_DBG("Received AGPS data, length: %d", buf_len);
 
-		err = agps_send_to_modem(&element);
-		if (err) {
-			LOG_ERR("Failed to send data to modem, error: %d", err);
-			return err;
-		}
+	err = nrf_cloud_agps_stream_begin(socket);
+	if (err) {
+		return err;
 	}
 
-	return 0;
+	err = nrf_cloud_agps_stream_write(buf, buf_len);
+	if (err) {
+		return err;
+	}
+
+	return nrf_cloud_agps_stream_end();
 }
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <sys/byteorder.h>
+#include <logging/log.h>
+
+#include "nrf_cloud_agps_decoder.h"
+
+LOG_MODULE_REGISTER(nrf_cloud_agps_decoder, CONFIG_NRF_CLOUD_AGPS_LOG_LEVEL);
+
+#define ARRAY_HEADER_SIZE (NRF_CLOUD_AGPS_BIN_TYPE_SIZE + \
+			   NRF_CLOUD_AGPS_BIN_COUNT_SIZE)
+
+/* The system clock element is followed by 4 bytes that are not part of the
+ * nrf_cloud_agps_system_time header, the TOW array is sent as separate
+ * NRF_CLOUD_AGPS_GPS_TOWS elements.
+ */
+#define SYSTEM_CLOCK_ELEMENT_SIZE					\
+	(sizeof(struct nrf_cloud_agps_system_time) -			\
+	 sizeof(((struct nrf_cloud_agps_system_time *)0)->sv_tow) + 4)
+
+BUILD_ASSERT(ARRAY_HEADER_SIZE <= NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE);
+BUILD_ASSERT(sizeof(struct nrf_cloud_agps_ephemeris) <=
+	     NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE);
+BUILD_ASSERT(sizeof(struct nrf_cloud_agps_almanac) <=
+	     NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE);
+BUILD_ASSERT(SYSTEM_CLOCK_ELEMENT_SIZE <=
+	     NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE);
+
+/* Returns the size of one element of the given type, or 0 if the type
+ * is not supported.
+ */
+static size_t element_size_get(enum nrf_cloud_agps_type type)
+{
+	switch (type) {
+	case NRF_CLOUD_AGPS_UTC_PARAMETERS:
+		return sizeof(struct nrf_cloud_agps_utc);
+	case NRF_CLOUD_AGPS_EPHEMERIDES:
+		return sizeof(struct nrf_cloud_agps_ephemeris);
+	case NRF_CLOUD_AGPS_ALMANAC:
+		return sizeof(struct nrf_cloud_agps_almanac);
+	case NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION:
+		return sizeof(struct nrf_cloud_agps_klobuchar);
+	case NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK:
+		return SYSTEM_CLOCK_ELEMENT_SIZE;
+	case NRF_CLOUD_AGPS_GPS_TOWS:
+		return sizeof(struct nrf_cloud_agps_tow_element);
+	case NRF_CLOUD_AGPS_LOCATION:
+		return sizeof(struct nrf_cloud_agps_location);
+	case NRF_CLOUD_AGPS_INTEGRITY:
+		return sizeof(struct nrf_cloud_agps_integrity);
+	default:
+		return 0;
+	}
+}
+
+/* Number of bytes needed to complete the current state. */
+static size_t state_size_get(const struct nrf_cloud_agps_decoder *decoder)
+{
+	switch (decoder->state) {
+	case NRF_CLOUD_AGPS_DECODER_VERSION:
+		return NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION_SIZE;
+	case NRF_CLOUD_AGPS_DECODER_HEADER:
+		return ARRAY_HEADER_SIZE;
+	case NRF_CLOUD_AGPS_DECODER_ELEMENT:
+		return decoder->element_size;
+	default:
+		return 0;
+	}
+}
+
+static int version_process(struct nrf_cloud_agps_decoder *decoder,
+			   const uint8_t *data)
+{
+	uint8_t version = data[NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION_INDEX];
+
+	if (version != NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION) {
+		LOG_ERR("Cannot parse schema version: %d", version);
+		return -EBADMSG;
+	}
+
+	LOG_DBG("A-GPS schema version: %d", version);
+
+	decoder->state = NRF_CLOUD_AGPS_DECODER_HEADER;
+
+	return 0;
+}
+
+static void header_process(struct nrf_cloud_agps_decoder *decoder,
+			   const uint8_t *data)
+{
+	decoder->type =
+		(enum nrf_cloud_agps_type)data[NRF_CLOUD_AGPS_BIN_TYPE_OFFSET];
+	decoder->elements_left =
+		sys_get_le16(&data[NRF_CLOUD_AGPS_BIN_COUNT_OFFSET]);
+	decoder->element_size = element_size_get(decoder->type);
+
+	if (decoder->element_size == 0) {
+		/* The size of unknown elements can not be determined, so the
+		 * rest of the payload is ignored.
+		 */
+		LOG_DBG("Unhandled A-GPS data type: %d, parsing finished",
+			decoder->type);
+		decoder->state = NRF_CLOUD_AGPS_DECODER_DONE;
+		return;
+	}
+
+	LOG_DBG("A-GPS type: %d, count: %d", decoder->type,
+		decoder->elements_left);
+
+	if (decoder->elements_left > 0) {
+		decoder->state = NRF_CLOUD_AGPS_DECODER_ELEMENT;
+	}
+}
+
+static int element_process(struct nrf_cloud_agps_decoder *decoder,
+			   const uint8_t *data)
+{
+	struct nrf_cloud_apgs_element element = {
+		.type = decoder->type,
+	};
+
+	/* All members of the union are pointers to the element data. */
+	switch (decoder->type) {
+	case NRF_CLOUD_AGPS_UTC_PARAMETERS:
+		element.utc = (struct nrf_cloud_agps_utc *)data;
+		break;
+	case NRF_CLOUD_AGPS_EPHEMERIDES:
+		element.ephemeris = (struct nrf_cloud_agps_ephemeris *)data;
+		break;
+	case NRF_CLOUD_AGPS_ALMANAC:
+		element.almanac = (struct nrf_cloud_agps_almanac *)data;
+		break;
+	case NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION:
+		element.ion_correction.klobuchar =
+			(struct nrf_cloud_agps_klobuchar *)data;
+		break;
+	case NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK:
+		element.time_and_tow =
+			(struct nrf_cloud_agps_system_time *)data;
+		break;
+	case NRF_CLOUD_AGPS_GPS_TOWS:
+		element.tow = (struct nrf_cloud_agps_tow_element *)data;
+		break;
+	case NRF_CLOUD_AGPS_LOCATION:
+		element.location = (struct nrf_cloud_agps_location *)data;
+		break;
+	case NRF_CLOUD_AGPS_INTEGRITY:
+		element.integrity = (struct nrf_cloud_agps_integrity *)data;
+		break;
+	default:
+		return -EBADMSG;
+	}
+
+	decoder->elements_left--;
+	if (decoder->elements_left == 0) {
+		decoder->state = NRF_CLOUD_AGPS_DECODER_HEADER;
+	}
+
+	return decoder->cb(&element, decoder->user_data);
+}
+
+static int state_process(struct nrf_cloud_agps_decoder *decoder,
+			 const uint8_t *data)
+{
+	switch (decoder->state) {
+	case NRF_CLOUD_AGPS_DECODER_VERSION:
+		return version_process(decoder, data);
+	case NRF_CLOUD_AGPS_DECODER_HEADER:
+		header_process(decoder, data);
+		return 0;
+	case NRF_CLOUD_AGPS_DECODER_ELEMENT:
+		return element_process(decoder, data);
+	default:
+		return 0;
+	}
+}
+
+void nrf_cloud_agps_decoder_init(struct nrf_cloud_agps_decoder *decoder,
+				 nrf_cloud_agps_decoder_cb_t cb,
+				 void *user_data)
+{
+	__ASSERT_NO_MSG(decoder != NULL);
+	__ASSERT_NO_MSG(cb != NULL);
+
+	memset(decoder, 0, sizeof(*decoder));
+
+	decoder->state = NRF_CLOUD_AGPS_DECODER_VERSION;
+	decoder->cb = cb;
+	decoder->user_data = user_data;
+}
+
+int nrf_cloud_agps_decoder_write(struct nrf_cloud_agps_decoder *decoder,
+				 const uint8_t *buf, size_t len)
+{
+	int err;
+
+	if ((decoder == NULL) || ((buf == NULL) && (len > 0))) {
+		return -EINVAL;
+	}
+
+	if (decoder->state == NRF_CLOUD_AGPS_DECODER_ERROR) {
+		return -EBADMSG;
+	}
+
+	while ((len > 0) && (decoder->state != NRF_CLOUD_AGPS_DECODER_DONE)) {
+		size_t needed = state_size_get(decoder);
+		const uint8_t *data;
+
+		if ((decoder->staged == 0) && (len >= needed)) {
+			/* The whole unit is available in the input buffer,
+			 * process it in place.
+			 */
+			data = buf;
+			buf += needed;
+			len -= needed;
+		} else {
+			size_t copy = MIN(needed - decoder->staged, len);
+
+			memcpy(&decoder->buf[decoder->staged], buf, copy);
+			decoder->staged += copy;
+			buf += copy;
+			len -= copy;
+
+			if (decoder->staged < needed) {
+				decoder->offset += copy;
+				break;
+			}
+
+			data = decoder->buf;
+			decoder->staged = 0;
+			needed = copy;
+		}
+
+		decoder->offset += needed;
+
+		err = state_process(decoder, data);
+		if (err) {
+			LOG_ERR("A-GPS decoding failed at offset %zu, "
+				"error: %d", decoder->offset, err);
+			decoder->state = NRF_CLOUD_AGPS_DECODER_ERROR;
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+int nrf_cloud_agps_decoder_finish(struct nrf_cloud_agps_decoder *decoder)
+{
+	if (decoder == NULL) {
+		return -EINVAL;
+	}
+
+	switch (decoder->state) {
+	case NRF_CLOUD_AGPS_DECODER_VERSION:
+		return -ENODATA;
+	case NRF_CLOUD_AGPS_DECODER_ERROR:
+		return -EBADMSG;
+	case NRF_CLOUD_AGPS_DECODER_DONE:
+		return 0;
+	default:
+		break;
+	}
+
+	/* Payload must end between element arrays. */
+	if ((decoder->state != NRF_CLOUD_AGPS_DECODER_HEADER) ||
+	    (decoder->staged > 0)) {
+		LOG_ERR("A-GPS payload truncated at offset %zu",
+			decoder->offset);
+		return -EBADMSG;
+	}
+
+	return 0;
+}
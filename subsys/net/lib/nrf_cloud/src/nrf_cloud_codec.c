@@ -13,6 +13,7 @@
 #include <logging/log.h>
 #include "cJSON.h"
 #include "cJSON_os.h"
+#include <json_tok.h>
 
 LOG_MODULE_REGISTER(nrf_cloud_codec, CONFIG_NRF_CLOUD_LOG_LEVEL);
 
@@ -197,19 +198,46 @@ int nrf_cloud_encode_sensor_data(const struct nrf_cloud_sensor_data *sensor,
 	return 0;
 }
 
-int nrf_cloud_decode_requested_state(const struct nrf_cloud_data *input,
-				     enum nfsm_state *requested_state)
+static int requested_state_get(bool has_topic_prefix,
+			       const char *pairing_state, bool has_config,
+			       enum nfsm_state *requested_state)
 {
-	__ASSERT_NO_MSG(requested_state != NULL);
-	__ASSERT_NO_MSG(input != NULL);
-	__ASSERT_NO_MSG(input->ptr != NULL);
-	__ASSERT_NO_MSG(input->len != 0);
+	if (has_topic_prefix) {
+		(*requested_state) = STATE_UA_PIN_COMPLETE;
+		return 0;
+	}
 
+	if (pairing_state == NULL) {
+		if (!has_config) {
+			LOG_WRN("Unhandled data received from nRF Cloud.");
+			LOG_INF("Ensure device firmware is up to date.");
+			LOG_INF("Delete and re-add device to nRF Cloud if problem persists.");
+		}
+		return -ENOENT;
+	}
+
+	if (compare(pairing_state, DUA_PIN_STR)) {
+		(*requested_state) = STATE_UA_PIN_WAIT;
+	} else {
+		LOG_ERR("Deprecated state. Delete device from nRF Cloud and update device with JITP certificates.");
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/* Shadow updates are decoded from the MQTT event handler only */
+static struct json_tok toks[CONFIG_NRF_CLOUD_JSON_TOKENS_MAX];
+
+/* For documents with more tokens than CONFIG_NRF_CLOUD_JSON_TOKENS_MAX */
+static int requested_state_cjson_decode(const struct nrf_cloud_data *input,
+					enum nfsm_state *requested_state)
+{
 	cJSON *root_obj;
 	cJSON *desired_obj;
 	cJSON *pairing_obj;
 	cJSON *pairing_state_obj;
-	cJSON *topic_prefix_obj;
+	int err;
 
 	root_obj = cJSON_Parse(input->ptr);
 	if (root_obj == NULL) {
@@ -220,40 +248,68 @@ int nrf_cloud_decode_requested_state(const struct nrf_cloud_data *input,
 
 	nrf_cloud_decode_desired_obj(root_obj, &desired_obj);
 
-	topic_prefix_obj =
-		json_object_decode(desired_obj, "nrfcloud_mqtt_topic_prefix");
-	if (topic_prefix_obj != NULL) {
-		(*requested_state) = STATE_UA_PIN_COMPLETE;
-		cJSON_Delete(root_obj);
-		return 0;
-	}
-
 	pairing_obj = json_object_decode(desired_obj, "pairing");
 	pairing_state_obj = json_object_decode(pairing_obj, "state");
 
-	if (!pairing_state_obj || pairing_state_obj->type != cJSON_String) {
-		if (cJSON_HasObjectItem(desired_obj, "config") == false) {
-			LOG_WRN("Unhandled data received from nRF Cloud.");
-			LOG_INF("Ensure device firmware is up to date.");
-			LOG_INF("Delete and re-add device to nRF Cloud if problem persists.");
-		}
-		cJSON_Delete(root_obj);
+	err = requested_state_get(
+		json_object_decode(desired_obj,
+				   "nrfcloud_mqtt_topic_prefix") != NULL,
+		cJSON_IsString(pairing_state_obj) ?
+			pairing_state_obj->valuestring : NULL,
+		cJSON_HasObjectItem(desired_obj, "config"),
+		requested_state);
+
+	cJSON_Delete(root_obj);
+
+	return err;
+}
+
+int nrf_cloud_decode_requested_state(const struct nrf_cloud_data *input,
+				     enum nfsm_state *requested_state)
+{
+	__ASSERT_NO_MSG(requested_state != NULL);
+	__ASSERT_NO_MSG(input != NULL);
+	__ASSERT_NO_MSG(input->ptr != NULL);
+	__ASSERT_NO_MSG(input->len != 0);
+
+	struct json_tok_doc doc;
+	char pairing_state[sizeof(DUA_PIN_STR)];
+	int desired;
+	int err;
+
+	err = json_tok_parse(&doc, input->ptr, input->len, toks,
+			     ARRAY_SIZE(toks));
+	if (err == -ENOMEM) {
+		LOG_DBG("Too many JSON tokens, using cJSON");
+		/* The whole document is released before returning */
+		cJSON_ArenaBegin();
+		err = requested_state_cjson_decode(input, requested_state);
+		cJSON_ArenaEnd();
+		return err;
+	} else if (err < 0) {
+		LOG_ERR("JSON parsing failed (%d): %s", err,
+			log_strdup((char *)input->ptr));
 		return -ENOENT;
 	}
 
-	const char *state_str = pairing_state_obj->valuestring;
-
-	if (compare(state_str, DUA_PIN_STR)) {
-		(*requested_state) = STATE_UA_PIN_WAIT;
-	} else {
-		LOG_ERR("Deprecated state. Delete device from nRF Cloud and update device with JITP certificates.");
-		cJSON_Delete(root_obj);
-		return -ENOTSUP;
+	/* On initial pairing, a shadow delta event is sent */
+	/* which does not include the "desired" JSON key, */
+	/* "state" is used instead */
+	desired = json_tok_obj_get(&doc, 0, "state");
+	if (desired < 0) {
+		desired = json_tok_obj_get(&doc, 0, "desired");
 	}
 
-	cJSON_Delete(root_obj);
+	/* Only the beginning is compared */
+	err = json_tok_str(&doc, json_tok_path(&doc, desired, "pairing.state"),
+			   pairing_state, sizeof(pairing_state));
 
-	return 0;
+	return requested_state_get(
+		json_tok_obj_get(&doc, desired,
+				 "nrfcloud_mqtt_topic_prefix") >= 0,
+		(err < 0) ? NULL : pairing_state,
+		json_tok_obj_get(&doc, desired, "config") >= 0,
+		requested_state);
 }
 
 int nrf_cloud_encode_config_response(struct nrf_cloud_data const *const input,
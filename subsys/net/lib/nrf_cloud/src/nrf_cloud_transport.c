@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <fcntl.h>
 #include <net/mqtt.h>
+#include <net/mqtt_topic_matcher.h>
 #include <net/socket.h>
 #include <net/cloud.h>
 #include <logging/log.h>
@@ -108,8 +109,10 @@ static bool persistent_session;
 #define NCT_CC_SUBSCRIBE_ID 1234
 #define NCT_DC_SUBSCRIBE_ID 8765
 
-#define NCT_RX_LIST 0
-#define NCT_TX_LIST 1
+/* Topic levels of the control channel topics and the data channel RX
+ * endpoint, the latter is provided by the cloud and typically has six levels.
+ */
+#define NCT_TOPIC_MATCHER_NODES 24
 
 static int nct_settings_set(const char *key, size_t len_rd,
 			    settings_read_cb read_cb, void *cb_arg);
@@ -189,6 +192,45 @@ static uint32_t const nct_cc_rx_opcode_map[] = {
 	NCT_CC_OPCODE_UPDATE_ACCEPT_RSP
 };
 
+/* Topic matcher IDs 0 to ARRAY_SIZE(nct_cc_rx_list) - 1 are the indexes of
+ * the control channel topics.
+ */
+#define NCT_TOPIC_ID_DC_RX ARRAY_SIZE(nct_cc_rx_list)
+
+MQTT_TOPIC_MATCHER_DEFINE(nct_topic_matcher, NCT_TOPIC_MATCHER_NODES);
+
+/* Rebuild the topic matcher from the control channel topics and the current
+ * data channel RX endpoint.
+ */
+static void nct_topic_matcher_populate(void)
+{
+	int err;
+
+	mqtt_topic_matcher_reset(&nct_topic_matcher);
+
+	for (size_t i = 0; i < ARRAY_SIZE(nct_cc_rx_list); i++) {
+		err = mqtt_topic_matcher_add(&nct_topic_matcher,
+				(const char *)nct_cc_rx_list[i].topic.utf8,
+					     nct_cc_rx_list[i].topic.size, i);
+		if (err) {
+			LOG_ERR("Failed to add control channel topic: %d",
+				err);
+		}
+	}
+
+	if (nct.dc_rx_endp.utf8 == NULL) {
+		return;
+	}
+
+	err = mqtt_topic_matcher_add(&nct_topic_matcher,
+				     (const char *)nct.dc_rx_endp.utf8,
+				     nct.dc_rx_endp.size, NCT_TOPIC_ID_DC_RX);
+	if (err) {
+		/* Unmatched topics are still handled as data channel. */
+		LOG_WRN("Failed to add data channel topic: %d", err);
+	}
+}
+
 /* Internal routine to reset data endpoint information. */
 static void dc_endpoint_reset(void)
 {
@@ -242,6 +284,7 @@ static void dc_endpoint_free(void)
 		nrf_cloud_free((void *)nct.job_status_endp.utf8);
 	}
 	dc_endpoint_reset();
+	nct_topic_matcher_populate();
 }
 
 static uint32_t dc_send(const struct nct_dc_data *dc_data, uint8_t qos)
@@ -271,39 +314,21 @@ static uint32_t dc_send(const struct nct_dc_data *dc_data, uint8_t qos)
 	return mqtt_publish(&nct.client, &publish);
 }
 
-static bool strings_compare(const char *s1, const char *s2, uint32_t s1_len,
-			    uint32_t s2_len)
-{
-	return (strncmp(s1, s2, MIN(s1_len, s2_len))) ? false : true;
-}
-
 /* Verify if the topic is a control channel topic or not. */
-static bool control_channel_topic_match(uint32_t list_id,
-					const struct mqtt_topic *topic,
+static bool control_channel_topic_match(const struct mqtt_topic *topic,
 					enum nct_cc_opcode *opcode)
 {
-	struct mqtt_topic *topic_list;
-	uint32_t list_size;
-
-	if (list_id == NCT_RX_LIST) {
-		topic_list = (struct mqtt_topic *)nct_cc_rx_list;
-		list_size = ARRAY_SIZE(nct_cc_rx_list);
-	} else if (list_id == NCT_TX_LIST) {
-		topic_list = (struct mqtt_topic *)nct_cc_tx_list;
-		list_size = ARRAY_SIZE(nct_cc_tx_list);
-	} else {
+	int id = mqtt_topic_matcher_match(&nct_topic_matcher,
+					  (const char *)topic->topic.utf8,
+					  topic->topic.size);
+
+	if ((id < 0) || (id >= ARRAY_SIZE(nct_cc_rx_opcode_map))) {
 		return false;
 	}
 
-	for (uint32_t index = 0; index < list_size; index++) {
-		if (strings_compare(
-			    topic->topic.utf8, topic_list[index].topic.utf8,
-			    topic->topic.size, topic_list[index].topic.size)) {
-			*opcode = nct_cc_rx_opcode_map[index];
-			return true;
-		}
-	}
-	return false;
+	*opcode = nct_cc_rx_opcode_map[id];
+
+	return true;
 }
 
 /* Function to get the client id */
@@ -394,6 +419,8 @@ static int nct_topics_populate(void)
 	}
 	LOG_DBG("shadow_get_topic: %s", log_strdup(shadow_get_topic));
 
+	nct_topic_matcher_populate();
+
 	return 0;
 }
 
@@ -770,6 +797,60 @@ static int publish_get_payload(struct mqtt_client *client, size_t length)
 	return mqtt_readall_publish_payload(client, nct.payload_buf, length);
 }
 
+static void publish_ack(struct mqtt_client *client,
+			const struct mqtt_publish_param *p)
+{
+	if (p->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+		const struct mqtt_puback_param ack = {
+			.message_id = p->message_id
+		};
+
+		/* Send acknowledgment. */
+		mqtt_publish_qos1_ack(client, &ack);
+	}
+}
+
+#if defined(CONFIG_NRF_CLOUD_MQTT_PAYLOAD_FRAGMENTS)
+/* Read a data channel payload that does not fit in the payload buffer and
+ * notify it in buffer-sized fragments, as it arrives.
+ */
+static int dc_fragments_notify(struct mqtt_client *client,
+			       const struct mqtt_publish_param *p)
+{
+	int err;
+	struct nct_dc_data dc = {
+		.id = p->message_id,
+		.data.ptr = nct.payload_buf,
+		.topic.len = p->message.topic.topic.size,
+		.topic.ptr = p->message.topic.topic.utf8,
+		.total_len = p->message.payload.len,
+	};
+	struct nct_evt evt = {
+		.type = NCT_EVT_DC_RX_DATA,
+		.param.dc = &dc,
+	};
+
+	for (dc.offset = 0; dc.offset < dc.total_len;
+	     dc.offset += dc.data.len) {
+		dc.data.len = MIN(dc.total_len - dc.offset,
+				  sizeof(nct.payload_buf));
+
+		err = mqtt_readall_publish_payload(client, nct.payload_buf,
+						   dc.data.len);
+		if (err) {
+			return err;
+		}
+
+		err = nct_input(&evt);
+		if (err) {
+			LOG_ERR("nct_input: failed %d", err);
+		}
+	}
+
+	return 0;
+}
+#endif /* defined(CONFIG_NRF_CLOUD_MQTT_PAYLOAD_FRAGMENTS) */
+
 /* Handle MQTT events. */
 static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 				 const struct mqtt_evt *_mqtt_evt)
@@ -816,14 +897,31 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 	}
 	case MQTT_EVT_PUBLISH: {
 		const struct mqtt_publish_param *p = &_mqtt_evt->param.publish;
+		bool cc_topic;
 
 		LOG_DBG("MQTT_EVT_PUBLISH: id = %d len = %d",
 			p->message_id,
 			p->message.payload.len);
 
-		int err = publish_get_payload(mqtt_client,
-					      p->message.payload.len);
+		cc_topic = control_channel_topic_match(&p->message.topic,
+						       &cc.opcode);
+
+#if defined(CONFIG_NRF_CLOUD_MQTT_PAYLOAD_FRAGMENTS)
+		if (!cc_topic &&
+		    (p->message.payload.len > sizeof(nct.payload_buf))) {
+			err = dc_fragments_notify(mqtt_client, p);
+			if (err < 0) {
+				LOG_ERR("dc_fragments_notify: failed %d", err);
+				mqtt_disconnect(mqtt_client);
+				break;
+			}
+
+			publish_ack(mqtt_client, p);
+			break;
+		}
+#endif
 
+		err = publish_get_payload(mqtt_client, p->message.payload.len);
 		if (err < 0) {
 			LOG_ERR("publish_get_payload: failed %d", err);
 			mqtt_disconnect(mqtt_client);
@@ -834,8 +932,7 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 		/* If the data arrives on one of the subscribed control channel
 		 * topic. Then we notify the same.
 		 */
-		if (control_channel_topic_match(NCT_RX_LIST, &p->message.topic,
-						&cc.opcode)) {
+		if (cc_topic) {
 			cc.id = p->message_id;
 			cc.data.ptr = nct.payload_buf;
 			cc.data.len = p->message.payload.len;
@@ -852,20 +949,15 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 			dc.data.len = p->message.payload.len;
 			dc.topic.len = p->message.topic.topic.size;
 			dc.topic.ptr = p->message.topic.topic.utf8;
+			dc.offset = 0;
+			dc.total_len = dc.data.len;
 
 			evt.type = NCT_EVT_DC_RX_DATA;
 			evt.param.dc = &dc;
 			event_notify = true;
 		}
 
-		if (p->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
-			const struct mqtt_puback_param ack = {
-				.message_id = p->message_id
-			};
-
-			/* Send acknowledgment. */
-			mqtt_publish_qos1_ack(mqtt_client, &ack);
-		}
+		publish_ack(mqtt_client, p);
 		break;
 	}
 	case MQTT_EVT_SUBACK: {
@@ -1125,6 +1217,8 @@ void nct_dc_endpoint_set(const struct nrf_cloud_data *tx_endp,
 	nct.dc_rx_endp.utf8 = (const uint8_t *)rx_endp->ptr;
 	nct.dc_rx_endp.size = rx_endp->len;
 
+	nct_topic_matcher_populate();
+
 	if (m_endp != NULL) {
 		nct.dc_m_endp.utf8 = (const uint8_t *)m_endp->ptr;
 		nct.dc_m_endp.size = m_endp->len;
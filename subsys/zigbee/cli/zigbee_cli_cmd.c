@@ -13,6 +13,7 @@
 #include <zboss_api.h>
 #include <zb_error_handler.h>
 #include <zb_version.h>
+#include <zb_nrf_platform.h>
 #include "zigbee_cli.h"
 
 #define DEBUG_HELP \
@@ -119,8 +120,49 @@ static int cmd_debug_off(const struct shell *shell, size_t argc, char **argv)
 	return 0;
 }
 
+/**@brief Print statistics of the frames received by the radio.
+ *
+ * @code
+ * radio rx_stats
+ * @endcode
+ *
+ * @code
+ * > radio rx_stats
+ * Received: 1024
+ * Dropped: 0
+ * Queued: 0
+ * Max queued: 2
+ * Done
+ * @endcode
+ */
+static int cmd_radio_rx_stats(const struct shell *shell, size_t argc,
+			      char **argv)
+{
+	struct zigbee_rx_stats stats;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	zigbee_rx_stats_get(&stats);
+
+	shell_print(shell, "Received: %u", stats.received);
+	shell_print(shell, "Dropped: %u", stats.dropped);
+	shell_print(shell, "Queued: %u", stats.queued);
+	shell_print(shell, "Max queued: %u", stats.queued_max);
+
+	zb_cli_print_done(shell, false);
+	return 0;
+}
+
 SHELL_CMD_REGISTER(version, NULL, "Print firmware version", cmd_version);
 
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_radio,
+	SHELL_CMD_ARG(rx_stats, NULL, "Print statistics of received frames",
+		      cmd_radio_rx_stats, 1, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(radio, &sub_radio, "Radio statistics", NULL);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_debug,
 	SHELL_COND_CMD(CONFIG_ZIGBEE_SHELL_DEBUG_CMD, off, NULL,
 		       DEBUG_OFF_HELP, cmd_debug_off),
@@ -47,14 +47,56 @@ static int cmd_zb_resume(const struct shell *shell, size_t argc, char **argv)
 
 	return 0;
 }
+#endif /* CONFIG_ZIGBEE_SHELL_DEBUG_CMD */
+
+/**@brief Print statistics of the callbacks scheduled from other threads
+ *        and ISRs
+ *
+ * @code
+ * zscheduler stats
+ * @endcode
+ *
+ * @code
+ * > zscheduler stats
+ * Callbacks: 2048
+ * Wakeups: 312
+ * Max callbacks per wakeup: 14
+ * Overflows: 0
+ * Average latency: 85 us
+ * Max latency: 1024 us
+ * Done
+ * @endcode
+ */
+static int cmd_zb_stats(const struct shell *shell, size_t argc, char **argv)
+{
+	struct zigbee_app_cb_stats stats;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	zigbee_app_cb_stats_get(&stats);
+
+	shell_print(shell, "Callbacks: %u", stats.count);
+	shell_print(shell, "Wakeups: %u", stats.batches);
+	shell_print(shell, "Max callbacks per wakeup: %u", stats.batch_max);
+	shell_print(shell, "Overflows: %u", stats.overflows);
+	shell_print(shell, "Average latency: %u us", stats.latency_avg_us);
+	shell_print(shell, "Max latency: %u us", stats.latency_max_us);
+	zb_cli_print_done(shell, ZB_FALSE);
+
+	return 0;
+}
 
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_zigbee,
-	SHELL_CMD_ARG(resume, NULL, "Suspend Zigbee scheduler processing",
-		      cmd_zb_resume, 1, 0),
-	SHELL_CMD_ARG(suspend, NULL, "Suspend Zigbee scheduler processing",
-		      cmd_zb_suspend, 1, 0),
+	SHELL_COND_CMD_ARG(CONFIG_ZIGBEE_SHELL_DEBUG_CMD, resume, NULL,
+			   "Suspend Zigbee scheduler processing",
+			   cmd_zb_resume, 1, 0),
+	SHELL_CMD_ARG(stats, NULL, "Print statistics of scheduled callbacks",
+		      cmd_zb_stats, 1, 0),
+	SHELL_COND_CMD_ARG(CONFIG_ZIGBEE_SHELL_DEBUG_CMD, suspend, NULL,
+			   "Suspend Zigbee scheduler processing",
+			   cmd_zb_suspend, 1, 0),
 	SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(zscheduler, &sub_zigbee, "Zigbee scheduler manipulation",
 		   NULL);
-#endif
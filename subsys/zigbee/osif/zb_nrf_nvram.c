@@ -3,11 +3,14 @@
  *
  * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
  */
+#include <kernel.h>
+#include <string.h>
 #include <pm_config.h>
 #include <storage/flash_map.h>
 #include <logging/log.h>
 
 #include <zboss_api.h>
+#include "zb_nrf_platform.h"
 
 #ifdef ZB_USE_NVRAM
 
@@ -26,12 +29,234 @@ LOG_MODULE_DECLARE(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
  */
 void zb_nvram_erase_finished(zb_uint8_t page);
 
+/* Write stored in the write-behind buffer, followed by its data. */
+struct nvram_write {
+	uint32_t pos;
+	uint16_t len;
+	uint8_t page;
+	uint8_t reserved;
+};
+
+BUILD_ASSERT((sizeof(struct nvram_write) % sizeof(uint32_t)) == 0,
+	     "Write data must stay word aligned in the buffer.");
+
 static const struct flash_area *fa; /* ZBOSS nvram */
 
 #ifdef ZB_PRODUCTION_CONFIG
 static const struct flash_area *fa_pc; /* production config */
 #endif
 
+/* Flash operations are done by a separate thread, so that the ZBOSS thread
+ * is not stalled while a page is erased. Writes are stored in the
+ * write-behind buffer until the thread writes them to flash.
+ * Erases and writes are done in the order they are requested, so that
+ * ZBOSS can rely on data being in flash before it erases the page it was
+ * copied from. Erasing a page drops the writes to the page that are still
+ * buffered.
+ */
+static K_THREAD_STACK_DEFINE(nvram_stack_area,
+			     CONFIG_ZIGBEE_NVRAM_THREAD_STACK_SIZE);
+static struct k_work_q nvram_work_q;
+static struct k_work nvram_work;
+static bool work_q_started;
+
+/* Protects the state below and the flash, except when a page is erased */
+static K_MUTEX_DEFINE(nvram_lock);
+static K_SEM_DEFINE(nvram_idle_sem, 0, K_SEM_MAX_LIMIT);
+static uint8_t wb_buf[CONFIG_ZIGBEE_NVRAM_WRITE_BUF_SIZE] __aligned(4);
+static size_t wb_used;
+/* Last write in the buffer, can be extended with a contiguous write */
+static struct nvram_write *wb_last;
+/* Bitmasks of pages waiting to be erased and being erased */
+static uint32_t erase_pending;
+static uint32_t erasing;
+/* Pending erases in the order they were requested, with the offset in the
+ * buffer of the first write requested after each of them. The writes
+ * before that offset are done before the page is erased.
+ */
+static struct {
+	size_t pos;
+	zb_uint8_t page;
+} erase_queue[ZBOSS_NVRAM_PAGE_COUNT];
+static size_t erase_queued;
+/* Bitmask of erased pages that ZBOSS was not notified about */
+static uint32_t erase_unnotified;
+/* Number of threads waiting for the flash operations to finish */
+static uint32_t idle_waiters;
+
+zb_uint32_t zb_get_nvram_page_length(void)
+{
+	return ZBOSS_NVRAM_PAGE_SIZE;
+}
+
+zb_uint8_t zb_get_nvram_page_count(void)
+{
+	return ZBOSS_NVRAM_PAGE_COUNT;
+}
+
+static zb_uint32_t get_page_base_offset(int page_num)
+{
+	return (page_num * zb_get_nvram_page_length());
+}
+
+static bool nvram_busy(void)
+{
+	return erase_pending || erasing || wb_used;
+}
+
+static zb_uint8_t *write_data(struct nvram_write *write)
+{
+	return (zb_uint8_t *)(write + 1);
+}
+
+static struct nvram_write *write_next(struct nvram_write *write)
+{
+	return (struct nvram_write *)(write_data(write) +
+				      ROUND_UP(write->len, sizeof(uint32_t)));
+}
+
+static struct nvram_write *wb_end(void)
+{
+	return (struct nvram_write *)&wb_buf[wb_used];
+}
+
+/* Wait until all erases and writes are in flash. */
+static void nvram_wait_idle(void)
+{
+	k_mutex_lock(&nvram_lock, K_FOREVER);
+	while (nvram_busy()) {
+		idle_waiters++;
+		k_work_submit_to_queue(&nvram_work_q, &nvram_work);
+		k_mutex_unlock(&nvram_lock);
+
+		k_sem_take(&nvram_idle_sem, K_FOREVER);
+
+		k_mutex_lock(&nvram_lock, K_FOREVER);
+	}
+	k_mutex_unlock(&nvram_lock);
+}
+
+/* Called with nvram_lock held. */
+static void wb_drop_page(zb_uint8_t page)
+{
+	struct nvram_write *write = (struct nvram_write *)wb_buf;
+	struct nvram_write *next;
+	size_t kept = 0;
+
+	while (write < wb_end()) {
+		size_t size;
+
+		next = write_next(write);
+		size = (uint8_t *)next - (uint8_t *)write;
+
+		if (write->page != page) {
+			memmove(&wb_buf[kept], write, size);
+			kept += size;
+		} else {
+			/* Pending erases after the write move with the
+			 * writes that follow it.
+			 */
+			for (size_t i = 0; i < erase_queued; i++) {
+				if (erase_queue[i].pos > kept) {
+					erase_queue[i].pos -= size;
+				}
+			}
+		}
+		write = next;
+	}
+
+	wb_used = kept;
+	wb_last = NULL;
+}
+
+/* Called with nvram_lock held. Writes the buffered writes before offset end
+ * to flash and removes them from the buffer.
+ */
+static void wb_drain(size_t end)
+{
+	struct nvram_write *write;
+	int err;
+
+	if (end == 0) {
+		return;
+	}
+
+	for (write = (struct nvram_write *)wb_buf;
+	     (uint8_t *)write < &wb_buf[end]; write = write_next(write)) {
+		err = flash_area_write(fa, get_page_base_offset(write->page) +
+					   write->pos,
+				       write_data(write), write->len);
+		if (err) {
+			LOG_ERR("Write error: %d", err);
+		}
+	}
+
+	memmove(wb_buf, &wb_buf[end], wb_used - end);
+	wb_used -= end;
+	wb_last = NULL;
+
+	for (size_t i = 0; i < erase_queued; i++) {
+		erase_queue[i].pos -= end;
+	}
+}
+
+/* Called with nvram_lock held. */
+static void erase_dequeue(size_t index)
+{
+	erase_pending &= ~BIT(erase_queue[index].page);
+	erase_queued--;
+	memmove(&erase_queue[index], &erase_queue[index + 1],
+		(erase_queued - index) * sizeof(erase_queue[0]));
+}
+
+static void nvram_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&nvram_lock, K_FOREVER);
+
+	while (erase_queued) {
+		zb_uint8_t page = erase_queue[0].page;
+
+		/* Writes requested before the erase go to flash first */
+		wb_drain(erase_queue[0].pos);
+
+		erase_dequeue(0);
+		erasing = BIT(page);
+		k_mutex_unlock(&nvram_lock);
+
+		/* Reads of other pages and writes to the buffer can
+		 * continue during the erase.
+		 */
+		int err = flash_area_erase(fa, get_page_base_offset(page),
+					   zb_get_nvram_page_length());
+		if (err) {
+			LOG_ERR("Erase error: %d", err);
+		}
+
+		/* Notify ZBOSS from its own thread. If the callback queue is
+		 * full, ZBOSS is notified when it waits for the erase.
+		 */
+		zb_ret_t ret = zigbee_schedule_callback(zb_nvram_erase_finished,
+							page);
+
+		k_mutex_lock(&nvram_lock, K_FOREVER);
+		erasing = 0;
+		if (ret != RET_OK) {
+			erase_unnotified |= BIT(page);
+		}
+	}
+
+	wb_drain(wb_used);
+
+	while (idle_waiters) {
+		idle_waiters--;
+		k_sem_give(&nvram_idle_sem);
+	}
+
+	k_mutex_unlock(&nvram_lock);
+}
+
 void zb_osif_nvram_init(const zb_char_t *name)
 {
 	ARG_UNUSED(name);
@@ -48,21 +273,17 @@ void zb_osif_nvram_init(const zb_char_t *name)
 		LOG_ERR("Can't open product config flash area");
 	}
 #endif
-}
 
-zb_uint32_t zb_get_nvram_page_length(void)
-{
-	return ZBOSS_NVRAM_PAGE_SIZE;
-}
-
-zb_uint8_t zb_get_nvram_page_count(void)
-{
-	return ZBOSS_NVRAM_PAGE_COUNT;
-}
+	if (work_q_started) {
+		return;
+	}
 
-static zb_uint32_t get_page_base_offset(int page_num)
-{
-	return (page_num * zb_get_nvram_page_length());
+	k_work_init(&nvram_work, nvram_work_handler);
+	k_work_q_start(&nvram_work_q, nvram_stack_area,
+		       K_THREAD_STACK_SIZEOF(nvram_stack_area),
+		       CONFIG_ZIGBEE_NVRAM_THREAD_PRIORITY);
+	k_thread_name_set(&nvram_work_q.thread, "zboss_nvram");
+	work_q_started = true;
 }
 
 zb_ret_t zb_osif_nvram_read(zb_uint8_t page, zb_uint32_t pos, zb_uint8_t *buf,
@@ -86,21 +307,47 @@ zb_ret_t zb_osif_nvram_read(zb_uint8_t page, zb_uint32_t pos, zb_uint8_t *buf,
 	LOG_DBG("Function: %s, page: %d, pos: %d, len: %d",
 		__func__, page, pos, len);
 
+	k_mutex_lock(&nvram_lock, K_FOREVER);
+	if ((erase_pending | erasing) & BIT(page)) {
+		k_mutex_unlock(&nvram_lock);
+		nvram_wait_idle();
+		k_mutex_lock(&nvram_lock, K_FOREVER);
+	}
+
 	uint32_t flash_addr = get_page_base_offset(page) + pos;
 
 	int err = flash_area_read(fa, flash_addr, buf, len);
 
 	if (err) {
+		k_mutex_unlock(&nvram_lock);
 		LOG_ERR("Read error: %d", err);
 		return RET_ERROR;
 	}
+
+	/* Apply the buffered writes like flash does, by clearing bits. */
+	for (struct nvram_write *write = (struct nvram_write *)wb_buf;
+	     write < wb_end(); write = write_next(write)) {
+		uint32_t start = MAX(pos, write->pos);
+		uint32_t end = MIN(pos + len, write->pos + write->len);
+
+		if (write->page != page) {
+			continue;
+		}
+
+		for (uint32_t i = start; i < end; i++) {
+			buf[i - pos] &= write_data(write)[i - write->pos];
+		}
+	}
+	k_mutex_unlock(&nvram_lock);
+
 	return RET_OK;
 }
 
 zb_ret_t zb_osif_nvram_write(zb_uint8_t page, zb_uint32_t pos, void *buf,
 			     zb_uint16_t len)
 {
-	uint32_t flash_addr = get_page_base_offset(page) + pos;
+	size_t size = sizeof(struct nvram_write) +
+		      ROUND_UP(len, sizeof(uint32_t));
 
 	if (page >= zb_get_nvram_page_count()) {
 		return RET_PAGE_NOT_FOUND;
@@ -121,40 +368,108 @@ zb_ret_t zb_osif_nvram_write(zb_uint8_t page, zb_uint32_t pos, void *buf,
 	LOG_DBG("Function: %s, page: %d, pos: %d, len: %d",
 		__func__, page, pos, len);
 
-	int err = flash_area_write(fa, flash_addr, buf, len);
+	k_mutex_lock(&nvram_lock, K_FOREVER);
+
+	/* Extend the last write if this one follows it in flash. */
+	if (wb_last && wb_last->page == page &&
+	    wb_last->pos + wb_last->len == pos &&
+	    (wb_last->len % sizeof(uint32_t)) == 0 &&
+	    wb_last->len + len <= UINT16_MAX &&
+	    wb_used + ROUND_UP(len, sizeof(uint32_t)) <= sizeof(wb_buf)) {
+		memcpy(write_data(wb_last) + wb_last->len, buf, len);
+		wb_used += ROUND_UP(len, sizeof(uint32_t));
+		wb_last->len += len;
+		k_mutex_unlock(&nvram_lock);
+		return RET_OK;
+	}
+
+	if (wb_used + size > sizeof(wb_buf)) {
+		k_mutex_unlock(&nvram_lock);
+		nvram_wait_idle();
+		k_mutex_lock(&nvram_lock, K_FOREVER);
+	}
 
-	if (err) {
-		LOG_ERR("Write error: %d", err);
-		return RET_ERROR;
+	if (size > sizeof(wb_buf)) {
+		/* The buffer is empty, and there are no pending erases. */
+		int err = flash_area_write(fa, get_page_base_offset(page) + pos,
+					   buf, len);
+
+		k_mutex_unlock(&nvram_lock);
+		if (err) {
+			LOG_ERR("Write error: %d", err);
+			return RET_ERROR;
+		}
+		return RET_OK;
 	}
 
+	wb_last = wb_end();
+	wb_last->page = page;
+	wb_last->pos = pos;
+	wb_last->len = len;
+	memcpy(write_data(wb_last), buf, len);
+	wb_used += size;
+
+	k_work_submit_to_queue(&nvram_work_q, &nvram_work);
+	k_mutex_unlock(&nvram_lock);
+
 	return RET_OK;
 }
 
 zb_ret_t zb_osif_nvram_erase_async(zb_uint8_t page)
 {
-	zb_ret_t ret = RET_OK;
+	if (page >= zb_get_nvram_page_count()) {
+		zb_nvram_erase_finished(page);
+		return RET_OK;
+	}
 
-	if (page < zb_get_nvram_page_count()) {
-		int err = flash_area_erase(fa, get_page_base_offset(page),
-					   zb_get_nvram_page_length());
-		if (err) {
-			LOG_ERR("Erase error: %d", err);
-			ret = RET_ERROR;
+	k_mutex_lock(&nvram_lock, K_FOREVER);
+	/* The erase supersedes the writes to the page that are not done */
+	wb_drop_page(page);
+	/* A page that is erased again is erased after the last request */
+	for (size_t i = 0; i < erase_queued; i++) {
+		if (erase_queue[i].page == page) {
+			erase_dequeue(i);
+			break;
 		}
 	}
-	zb_nvram_erase_finished(page);
-	return ret;
+	erase_queue[erase_queued].page = page;
+	erase_queue[erase_queued].pos = wb_used;
+	erase_queued++;
+	erase_pending |= BIT(page);
+	k_work_submit_to_queue(&nvram_work_q, &nvram_work);
+	k_mutex_unlock(&nvram_lock);
+
+	return RET_OK;
+}
+
+/* Called from the ZBOSS thread, after the flash operations are done. */
+static void erase_unnotified_flush(void)
+{
+	uint32_t pages;
+
+	k_mutex_lock(&nvram_lock, K_FOREVER);
+	pages = erase_unnotified;
+	erase_unnotified = 0;
+	k_mutex_unlock(&nvram_lock);
+
+	while (pages) {
+		zb_uint8_t page = find_lsb_set(pages) - 1;
+
+		pages &= ~BIT(page);
+		zb_nvram_erase_finished(page);
+	}
 }
 
 void zb_osif_nvram_wait_for_last_op(void)
 {
-	/* empty for synchronous erase and write */
+	nvram_wait_idle();
+	erase_unnotified_flush();
 }
 
 void zb_osif_nvram_flush(void)
 {
-	/* empty for synchronous erase and write */
+	nvram_wait_idle();
+	erase_unnotified_flush();
 }
 
 
@@ -43,8 +43,19 @@ typedef struct {
 	zb_uint16_t param;
 	zb_uint16_t user_param;
 	int64_t alarm_timestamp;
+	uint32_t enqueue_cycles;
 } zb_app_cb_t;
 
+/**
+ * Type definition of element of the application callback ring buffer.
+ * The sequence number tells if the element is free for the producer that
+ * reserved its position, or filled for the consumer.
+ */
+typedef struct {
+	atomic_t seq;
+	zb_app_cb_t cb;
+} zb_app_cb_slot_t;
+
 
 LOG_MODULE_REGISTER(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
 
@@ -58,24 +69,39 @@ static struct k_poll_signal zigbee_sig = K_POLL_SIGNAL_INITIALIZER(zigbee_sig);
  */
 static K_MUTEX_DEFINE(zigbee_mutex);
 
+#define ZB_APP_CB_QUEUE_LENGTH CONFIG_ZIGBEE_APP_CB_QUEUE_LENGTH
+BUILD_ASSERT((ZB_APP_CB_QUEUE_LENGTH & (ZB_APP_CB_QUEUE_LENGTH - 1)) == 0,
+	     "The callback queue length must be a power of two.");
+
 /**
- * Message queue, that is used to pass ZBOSS callbacks and alarms from
- * ISR and other threads to ZBOSS main loop context.
+ * Lock-free ring buffer, that is used to pass ZBOSS callbacks and alarms from
+ * ISR and other threads to ZBOSS main loop context. Any number of producers
+ * can add elements, only the ZBOSS thread takes them.
  */
-K_MSGQ_DEFINE(zb_app_cb_msgq, sizeof(zb_app_cb_t),
-	      CONFIG_ZIGBEE_APP_CB_QUEUE_LENGTH, 4);
+static zb_app_cb_slot_t zb_app_cb_ring[ZB_APP_CB_QUEUE_LENGTH];
+/* Next position to be reserved by a producer. */
+static atomic_t zb_app_cb_tail;
+/* Next position to be taken by the ZBOSS thread. */
+static uint32_t zb_app_cb_head;
 
 /**
- * Work queue that will schedule processing of callbacks from the message queue.
+ * Work queue that will schedule processing of callbacks from the ring buffer.
  */
 static struct k_work zb_app_cb_work;
 
 /**
  * Atomic flag, indicating that the processing callback is still scheduled for
- * execution,
+ * execution. Only the producer that sets it wakes up the ZBOSS thread, so
+ * there is a single wakeup for a batch of callbacks.
  */
 volatile atomic_t zb_app_cb_process_scheduled = ATOMIC_INIT(0);
 
+/* Callback statistics, updated from the ZBOSS thread. */
+static struct zigbee_app_cb_stats zb_app_cb_stats;
+static atomic_t zb_app_cb_overflows;
+static uint64_t zb_app_cb_latency_total;
+static uint32_t zb_app_cb_latency_max;
+
 K_THREAD_STACK_DEFINE(zboss_stack_area, CONFIG_ZBOSS_DEFAULT_THREAD_STACK_SIZE);
 static struct k_thread zboss_thread_data;
 static k_tid_t zboss_tid;
@@ -120,10 +146,71 @@ bool zigbee_is_stack_started(void)
 	return stack_is_started;
 }
 
+static zb_ret_t zb_app_cb_put(zb_app_cb_t *app_cb)
+{
+	atomic_val_t pos = atomic_get(&zb_app_cb_tail);
+	zb_app_cb_slot_t *slot;
+	int32_t diff;
+
+	app_cb->enqueue_cycles = k_cycle_get_32();
+
+	/* Reserve the position at the tail. */
+	while (1) {
+		slot = &zb_app_cb_ring[pos & (ZB_APP_CB_QUEUE_LENGTH - 1)];
+		diff = (int32_t)((uint32_t)atomic_get(&slot->seq) -
+				 (uint32_t)pos);
+
+		if (diff == 0) {
+			if (atomic_cas(&zb_app_cb_tail, pos, pos + 1)) {
+				break;
+			}
+		} else if (diff < 0) {
+			/* The element was not taken yet, the ring is full. */
+			atomic_inc(&zb_app_cb_overflows);
+			return RET_OVERFLOW;
+		}
+
+		pos = atomic_get(&zb_app_cb_tail);
+	}
+
+	slot->cb = *app_cb;
+	atomic_set(&slot->seq, pos + 1);
+
+	if (atomic_set((atomic_t *)&zb_app_cb_process_scheduled, 1) == 0) {
+		k_work_submit(&zb_app_cb_work);
+	}
+
+	return RET_OK;
+}
+
+static zb_app_cb_t *zb_app_cb_peek(void)
+{
+	zb_app_cb_slot_t *slot = &zb_app_cb_ring[zb_app_cb_head &
+						 (ZB_APP_CB_QUEUE_LENGTH - 1)];
+
+	if ((uint32_t)atomic_get(&slot->seq) != zb_app_cb_head + 1) {
+		return NULL;
+	}
+
+	return &slot->cb;
+}
+
+static void zb_app_cb_release(void)
+{
+	zb_app_cb_slot_t *slot = &zb_app_cb_ring[zb_app_cb_head &
+						 (ZB_APP_CB_QUEUE_LENGTH - 1)];
+
+	/* Free the element for the producer one lap ahead. */
+	atomic_set(&slot->seq, zb_app_cb_head + ZB_APP_CB_QUEUE_LENGTH);
+	zb_app_cb_head++;
+}
+
 static void zb_app_cb_process(zb_bufid_t bufid)
 {
 	zb_ret_t ret_code = RET_OK;
-	zb_app_cb_t new_app_cb;
+	zb_app_cb_t *app_cb;
+	uint32_t batch = 0;
+	uint32_t latency;
 
 	/* Mark te processing callback as non-scheduled. */
 	(void)atomic_set((atomic_t *)&zb_app_cb_process_scheduled, 0);
@@ -133,7 +220,9 @@ static void zb_app_cb_process(zb_bufid_t bufid)
 	 *
 	 * Note: the ZB_SCHEDULE_APP_ALARM is not thread-safe.
 	 */
-	while (!k_msgq_peek(&zb_app_cb_msgq, &new_app_cb)) {
+	while ((app_cb = zb_app_cb_peek()) != NULL) {
+		zb_app_cb_t new_app_cb = *app_cb;
+
 		switch (new_app_cb.type) {
 		case ZB_CALLBACK_TYPE_SINGLE_PARAM:
 			ret_code = zb_schedule_app_callback(
@@ -206,8 +295,20 @@ static void zb_app_cb_process(zb_bufid_t bufid)
 			break;
 		}
 
-		/* Flush the element from the message queue. */
-		k_msgq_get(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT);
+		/* Flush the element from the ring buffer. */
+		zb_app_cb_release();
+
+		latency = k_cycle_get_32() - new_app_cb.enqueue_cycles;
+		zb_app_cb_latency_total += latency;
+		zb_app_cb_latency_max = MAX(zb_app_cb_latency_max, latency);
+		batch++;
+	}
+
+	if (batch) {
+		zb_app_cb_stats.count += batch;
+		zb_app_cb_stats.batches++;
+		zb_app_cb_stats.batch_max =
+			MAX(zb_app_cb_stats.batch_max, batch);
 	}
 
 	/**
@@ -215,23 +316,26 @@ static void zb_app_cb_process(zb_bufid_t bufid)
 	 * to process remaining requests later.
 	 */
 	if (ret_code == RET_OVERFLOW) {
+		(void)atomic_set((atomic_t *)&zb_app_cb_process_scheduled, 1);
 		k_work_submit(&zb_app_cb_work);
 	}
 }
 
-static void zb_app_cb_process_schedule(struct k_work *item)
+void zigbee_app_cb_stats_get(struct zigbee_app_cb_stats *stats)
 {
-	zb_app_cb_t new_app_cb;
-
-	if (k_msgq_peek(&zb_app_cb_msgq, &new_app_cb)) {
-		return;
-	}
-
-	/* Check if processing callback is altready scheduled. */
-	if (atomic_set((atomic_t *)&zb_app_cb_process_scheduled, 1) == 1) {
-		return;
-	}
+	k_sched_lock();
+	*stats = zb_app_cb_stats;
+	stats->latency_max_us = k_cyc_to_us_floor32(zb_app_cb_latency_max);
+	stats->latency_avg_us = stats->count ?
+		k_cyc_to_us_floor32(zb_app_cb_latency_total / stats->count) :
+		0;
+	k_sched_unlock();
+
+	stats->overflows = atomic_get(&zb_app_cb_overflows);
+}
 
+static void zb_app_cb_process_schedule(struct k_work *item)
+{
 	/**
 	 * From working thread, non-ISR context: schedule processing callback.
 	 * Repeat endlessly, because the user was already informed that the
@@ -253,6 +357,11 @@ int zigbee_init(void)
 	/* Initialise work queue for processing app callback and alarms. */
 	k_work_init(&zb_app_cb_work, zb_app_cb_process_schedule);
 
+	/* Mark all elements of the ring buffer as free for the first lap. */
+	for (int i = 0; i < ZB_APP_CB_QUEUE_LENGTH; i++) {
+		atomic_set(&zb_app_cb_ring[i].seq, i);
+	}
+
 #if ZB_TRACE_LEVEL
 	/* Set Zigbee stack logging level and traffic dump subsystem. */
 	ZB_SET_TRACE_LEVEL(CONFIG_ZBOSS_TRACE_LOG_LEVEL);
@@ -329,12 +438,7 @@ zb_ret_t zigbee_schedule_callback(zb_callback_t func, zb_uint8_t param)
 		.param = param,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_schedule_callback2(zb_callback2_t func,
@@ -348,12 +452,7 @@ zb_ret_t zigbee_schedule_callback2(zb_callback2_t func,
 		.user_param = user_param,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_schedule_alarm(zb_callback_t func,
@@ -368,12 +467,7 @@ zb_ret_t zigbee_schedule_alarm(zb_callback_t func,
 				   ZB_TIME_BEACON_INTERVAL_TO_MSEC(run_after),
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_schedule_alarm_cancel(zb_callback_t func, zb_uint8_t param)
@@ -384,12 +478,7 @@ zb_ret_t zigbee_schedule_alarm_cancel(zb_callback_t func, zb_uint8_t param)
 		.param = param,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_get_out_buf_delayed(zb_callback_t func)
@@ -399,12 +488,7 @@ zb_ret_t zigbee_get_out_buf_delayed(zb_callback_t func)
 		.func = func,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_get_in_buf_delayed(zb_callback_t func)
@@ -414,12 +498,7 @@ zb_ret_t zigbee_get_in_buf_delayed(zb_callback_t func)
 		.func = func,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_get_out_buf_delayed_ext(zb_callback2_t func, zb_uint16_t param,
@@ -432,12 +511,7 @@ zb_ret_t zigbee_get_out_buf_delayed_ext(zb_callback2_t func, zb_uint16_t param,
 		.param = max_size,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 zb_ret_t zigbee_get_in_buf_delayed_ext(zb_callback2_t func, zb_uint16_t param,
@@ -450,12 +524,7 @@ zb_ret_t zigbee_get_in_buf_delayed_ext(zb_callback2_t func, zb_uint16_t param,
 		.param = max_size,
 	};
 
-	if (k_msgq_put(&zb_app_cb_msgq, &new_app_cb, K_NO_WAIT)) {
-		return RET_OVERFLOW;
-	}
-
-	k_work_submit(&zb_app_cb_work);
-	return RET_OK;
+	return zb_app_cb_put(&new_app_cb);
 }
 
 /**@brief SoC general initialization. */
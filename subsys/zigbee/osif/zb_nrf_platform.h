@@ -37,6 +37,47 @@ void zigbee_debug_resume_zboss_thread(void);
 bool zigbee_is_zboss_thread_suspended(void);
 #endif /* defined(CONFIG_ZIGBEE_DEBUG_FUNCTIONS) */
 
+/**@brief Statistics of the frames received by the radio. */
+struct zigbee_rx_stats {
+	/* Frames queued for the Zigbee stack. */
+	uint32_t received;
+	/* Frames dropped because the queue was full. */
+	uint32_t dropped;
+	/* Frames waiting for the Zigbee stack. */
+	uint32_t queued;
+	/* Highest number of frames waiting for the Zigbee stack. */
+	uint32_t queued_max;
+};
+
+/**@brief Function for getting the statistics of the received frames.
+ *
+ * @param[out] stats  Statistics of the received frames.
+ */
+void zigbee_rx_stats_get(struct zigbee_rx_stats *stats);
+
+/**@brief Statistics of the callbacks scheduled from other threads and ISRs. */
+struct zigbee_app_cb_stats {
+	/* Callbacks passed to the ZBOSS scheduler. */
+	uint32_t count;
+	/* Wakeups of the ZBOSS thread that passed callbacks. */
+	uint32_t batches;
+	/* Highest number of callbacks passed in one wakeup. */
+	uint32_t batch_max;
+	/* Callbacks rejected because the queue was full. */
+	uint32_t overflows;
+	/* Average and highest time from scheduling a callback until it is
+	 * passed to the ZBOSS scheduler, in microseconds.
+	 */
+	uint32_t latency_avg_us;
+	uint32_t latency_max_us;
+};
+
+/**@brief Function for getting the statistics of the scheduled callbacks.
+ *
+ * @param[out] stats  Statistics of the scheduled callbacks.
+ */
+void zigbee_app_cb_stats_get(struct zigbee_app_cb_stats *stats);
+
 /**@brief Function for Zigbee stack initialization
  *
  * @return    0 if success
@@ -47,6 +47,9 @@ static struct ieee802154_state_cache state_cache = {
 
 /* RX fifo queue. */
 static struct k_fifo rx_fifo;
+/* Number of frames in the RX fifo queue. */
+static atomic_t rx_queued;
+static struct zigbee_rx_stats rx_stats;
 
 static uint8_t ack_frame_buf[ACK_PKT_LENGTH + PHR_LENGTH];
 static uint8_t *ack_frame;
@@ -447,12 +450,15 @@ zb_uint8_t zb_trans_get_next_packet(zb_bufid_t buf)
 		return 0;
 	}
 
+	atomic_dec(&rx_queued);
+
 	length = net_pkt_get_len(pkt);
 	data_ptr = zb_buf_initial_alloc(buf, length);
 
-	/* Copy received data */
-	net_pkt_cursor_init(pkt);
-	net_pkt_read(pkt, data_ptr, length);
+	/* Copy received data directly from the buffer filled by the radio
+	 * driver. This is the only copy of the frame.
+	 */
+	net_buf_linearize(data_ptr, length, pkt->buffer, 0, length);
 
 	/* Put LQI, RSSI */
 	zb_macll_metadata_t *metadata = ZB_MACLL_GET_METADATA(buf);
@@ -546,6 +552,22 @@ static enum net_verdict zigbee_l2_recv(struct net_if *iface,
 {
 	ARG_UNUSED(iface);
 
+	atomic_val_t queued = atomic_inc(&rx_queued) + 1;
+
+	/* Frames are dropped instead of queued without limit, so that the
+	 * radio driver does not run out of packets, for ACK frames too.
+	 */
+	if (queued > CONFIG_ZIGBEE_RX_QUEUE_LENGTH) {
+		atomic_dec(&rx_queued);
+		rx_stats.dropped++;
+		return NET_DROP;
+	}
+
+	rx_stats.received++;
+	if (queued > rx_stats.queued_max) {
+		rx_stats.queued_max = queued;
+	}
+
 	k_fifo_put(&rx_fifo, pkt);
 
 	zb_macll_set_rx_flag();
@@ -557,6 +579,12 @@ static enum net_verdict zigbee_l2_recv(struct net_if *iface,
 	return NET_OK;
 }
 
+void zigbee_rx_stats_get(struct zigbee_rx_stats *stats)
+{
+	*stats = rx_stats;
+	stats->queued = atomic_get(&rx_queued);
+}
+
 static enum net_l2_flags zigbee_l2_flags(struct net_if *iface)
 {
 	ARG_UNUSED(iface);
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <date_time.h>
+#include <tinycbor/cbor.h>
+#include "cloud_codec.h"
+
+/* UNIX time in ms at uptime 0 */
+#define BOOT_TIME_MS 1603094400000LL
+#define SAMPLES_MAX 4
+#define BUF_SIZE 512
+
+#define GPS_DATA "$GPGGA,090044.00,6325.6003,N,01024.5040,E,1,06,1.65," \
+		 "63.4,M,39.5,M,,*6A"
+
+static bool time_valid = true;
+
+/* Stubs for the date_time library */
+int date_time_uptime_to_unix_time_ms(int64_t *uptime)
+{
+	if (!time_valid) {
+		return -ENODATA;
+	}
+
+	*uptime += BOOT_TIME_MS;
+
+	return 0;
+}
+
+int date_time_timestamp_clear(int64_t *unix_timestamp)
+{
+	*unix_timestamp = 0;
+
+	return 0;
+}
+
+struct decoded_sample {
+	char app_id[16];
+	char data[96];
+	int64_t ts_offset;
+};
+
+static const struct cloud_channel_data samples[] = {
+	{
+		.type = CLOUD_CHANNEL_GPS,
+		.data.buf = GPS_DATA,
+		.data.len = sizeof(GPS_DATA) - 1,
+		.ts = 1000,
+	},
+	{
+		.type = CLOUD_CHANNEL_TEMP,
+		.data.buf = "21.5",
+		.data.len = 4,
+		.ts = 1500,
+	},
+	{
+		.type = CLOUD_CHANNEL_HUMID,
+		.data.buf = "44.0",
+		.data.len = 4,
+		.ts = 4250,
+	},
+};
+
+static uint8_t buf[BUF_SIZE];
+
+static void text_decode(CborValue *value, char *dst, size_t size)
+{
+	size_t len = size;
+	CborError err;
+
+	zassert_true(cbor_value_is_text_string(value), "Not a text string");
+	err = cbor_value_copy_text_string(value, dst, &len, value);
+	zassert_equal(err, CborNoError, "Text string decoding failed");
+}
+
+static int64_t int_decode(CborValue *value)
+{
+	int64_t val;
+	CborError err;
+
+	zassert_true(cbor_value_is_integer(value), "Not an integer");
+	err = cbor_value_get_int64(value, &val);
+	zassert_equal(err, CborNoError, "Integer decoding failed");
+	err = cbor_value_advance_fixed(value);
+	zassert_equal(err, CborNoError, NULL);
+
+	return val;
+}
+
+/* Decode [base ts, [appId, data, ts offset], ...] */
+static size_t batch_decode(const uint8_t *data, size_t len, int64_t *base_ts,
+			   struct decoded_sample *out, size_t out_count)
+{
+	CborParser parser;
+	CborValue it;
+	CborValue batch;
+	CborValue sample;
+	CborError err;
+	size_t arr_len;
+	size_t count = 0;
+
+	err = cbor_parser_init(data, len, 0, &parser, &it);
+	zassert_equal(err, CborNoError, "Parser init failed");
+
+	zassert_true(cbor_value_is_array(&it), "Batch is not an array");
+	err = cbor_value_get_array_length(&it, &arr_len);
+	zassert_equal(err, CborNoError, "Batch length not encoded");
+
+	err = cbor_value_enter_container(&it, &batch);
+	zassert_equal(err, CborNoError, NULL);
+
+	*base_ts = int_decode(&batch);
+
+	while (!cbor_value_at_end(&batch)) {
+		zassert_true(count < out_count, "Too many samples");
+		zassert_true(cbor_value_is_array(&batch),
+			     "Sample is not an array");
+		err = cbor_value_get_array_length(&batch, &arr_len);
+		zassert_equal(err, CborNoError, NULL);
+		zassert_equal(arr_len, 3, "Wrong sample length");
+
+		err = cbor_value_enter_container(&batch, &sample);
+		zassert_equal(err, CborNoError, NULL);
+		text_decode(&sample, out[count].app_id,
+			    sizeof(out[count].app_id));
+		text_decode(&sample, out[count].data, sizeof(out[count].data));
+		out[count].ts_offset = int_decode(&sample);
+		err = cbor_value_leave_container(&batch, &sample);
+		zassert_equal(err, CborNoError, NULL);
+
+		count++;
+	}
+
+	err = cbor_value_leave_container(&it, &batch);
+	zassert_equal(err, CborNoError, NULL);
+	zassert_equal(cbor_value_get_next_byte(&it), data + len,
+		      "Trailing data after the batch");
+
+	return count;
+}
+
+static void test_batch_cbor_round_trip(void)
+{
+	struct decoded_sample decoded[SAMPLES_MAX];
+	int64_t base_ts;
+	size_t count;
+	int len;
+
+	time_valid = true;
+
+	len = cloud_encode_batch_to_buf(samples, ARRAY_SIZE(samples),
+					CLOUD_BATCH_FORMAT_CBOR,
+					buf, sizeof(buf));
+	zassert_true(len > 0, "Encoding failed: %d", len);
+
+	count = batch_decode(buf, len, &base_ts, decoded, ARRAY_SIZE(decoded));
+	zassert_equal(count, ARRAY_SIZE(samples), "Wrong number of samples");
+	zassert_equal(base_ts, BOOT_TIME_MS + samples[0].ts,
+		      "Wrong base timestamp");
+
+	zassert_equal(strcmp(decoded[0].app_id, CLOUD_CHANNEL_STR_GPS), 0,
+		      NULL);
+	zassert_equal(strcmp(decoded[1].app_id, CLOUD_CHANNEL_STR_TEMP), 0,
+		      NULL);
+	zassert_equal(strcmp(decoded[2].app_id, CLOUD_CHANNEL_STR_HUMID), 0,
+		      NULL);
+
+	for (size_t i = 0; i < count; i++) {
+		zassert_equal(strcmp(decoded[i].data, samples[i].data.buf), 0,
+			      "Wrong data in sample %zu", i);
+		zassert_equal(base_ts + decoded[i].ts_offset,
+			      BOOT_TIME_MS + samples[i].ts,
+			      "Wrong timestamp in sample %zu", i);
+	}
+}
+
+/* The wire format of a batch of one sample, pinned for the cloud side */
+static void test_batch_cbor_encoding(void)
+{
+	static const uint8_t expected[] = {
+		/* Array of 2, base timestamp 1603094401000 */
+		0x82, 0x1b, 0x00, 0x00, 0x01, 0x75, 0x3f, 0xdf, 0x4f, 0xe8,
+		/* Array of 3, "TEMP", "21.5", offset 0 */
+		0x83, 0x64, 0x54, 0x45, 0x4d, 0x50, 0x64, 0x32, 0x31, 0x2e,
+		0x35, 0x00,
+	};
+	int len;
+
+	time_valid = true;
+
+	len = cloud_encode_batch_to_buf(&samples[1], 1,
+					CLOUD_BATCH_FORMAT_CBOR,
+					buf, sizeof(buf));
+	zassert_equal(len, sizeof(expected), "Wrong length %d", len);
+	zassert_mem_equal(buf, expected, sizeof(expected), "Wrong encoding");
+}
+
+/* Without a valid time the timestamps are cleared, like in the JSON
+ * messages.
+ */
+static void test_batch_cbor_no_time(void)
+{
+	struct decoded_sample decoded[SAMPLES_MAX];
+	int64_t base_ts;
+	size_t count;
+	int len;
+
+	time_valid = false;
+
+	len = cloud_encode_batch_to_buf(samples, ARRAY_SIZE(samples),
+					CLOUD_BATCH_FORMAT_CBOR,
+					buf, sizeof(buf));
+	zassert_true(len > 0, "Encoding failed: %d", len);
+
+	count = batch_decode(buf, len, &base_ts, decoded, ARRAY_SIZE(decoded));
+	zassert_equal(count, ARRAY_SIZE(samples), "Wrong number of samples");
+	zassert_equal(base_ts, 0, "Timestamp not cleared");
+
+	for (size_t i = 0; i < count; i++) {
+		zassert_equal(decoded[i].ts_offset, 0,
+			      "Timestamp not cleared in sample %zu", i);
+	}
+
+	time_valid = true;
+}
+
+static void test_batch_cbor_size(void)
+{
+	int cbor_len;
+	int json_len;
+
+	cbor_len = cloud_encode_batch_to_buf(samples, ARRAY_SIZE(samples),
+					     CLOUD_BATCH_FORMAT_CBOR,
+					     buf, sizeof(buf));
+	zassert_true(cbor_len > 0, "Encoding failed: %d", cbor_len);
+
+	json_len = cloud_encode_batch_to_buf(samples, ARRAY_SIZE(samples),
+					     CLOUD_BATCH_FORMAT_JSON,
+					     buf, sizeof(buf));
+	zassert_true(json_len > 0, "Encoding failed: %d", json_len);
+
+	TC_PRINT("Batch of %zu samples: %d bytes CBOR, %d bytes JSON\n",
+		 ARRAY_SIZE(samples), cbor_len, json_len);
+	zassert_true(cbor_len < json_len, "CBOR batch not smaller than JSON");
+}
+
+static void test_batch_cbor_errors(void)
+{
+	struct cloud_channel_data empty = {
+		.type = CLOUD_CHANNEL_TEMP,
+	};
+	int len;
+
+	len = cloud_encode_batch_to_buf(samples, ARRAY_SIZE(samples),
+					CLOUD_BATCH_FORMAT_CBOR, buf, 16);
+	zassert_equal(len, -ENOMEM, "Buffer too small not detected");
+
+	len = cloud_encode_batch_to_buf(&empty, 1, CLOUD_BATCH_FORMAT_CBOR,
+					buf, sizeof(buf));
+	zassert_equal(len, -EINVAL, "Sample without data encoded");
+
+	len = cloud_encode_batch_to_buf(samples, 0, CLOUD_BATCH_FORMAT_CBOR,
+					buf, sizeof(buf));
+	zassert_equal(len, -EINVAL, "Empty batch encoded");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(cloud_codec_test,
+			 ztest_unit_test(test_batch_cbor_round_trip),
+			 ztest_unit_test(test_batch_cbor_encoding),
+			 ztest_unit_test(test_batch_cbor_no_time),
+			 ztest_unit_test(test_batch_cbor_size),
+			 ztest_unit_test(test_batch_cbor_errors)
+			 );
+
+	ztest_run_test_suite(cloud_codec_test);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include "data_batch.h"
+#include "mock_cloud_codec.h"
+
+#define WORK_Q_STACK_SIZE 2048
+
+static K_THREAD_STACK_DEFINE(work_q_stack, WORK_Q_STACK_SIZE);
+static struct k_work_q work_q;
+
+static struct {
+	/* Return value of the send function */
+	int err;
+	/* Number of calls to the send function */
+	int count;
+	/* Last batch passed to the send function */
+	char buf[CONFIG_DATA_BATCH_BUF_SIZE + 1];
+	size_t len;
+} mock_send;
+
+static int batch_send(const uint8_t *buf, size_t len)
+{
+	mock_send.count++;
+	mock_send.len = len;
+	memcpy(mock_send.buf, buf, len);
+	mock_send.buf[len] = '\0';
+
+	return mock_send.err;
+}
+
+static int sample_add(const char *str)
+{
+	struct cloud_channel_data data = {
+		.type = CLOUD_CHANNEL_TEMP,
+		.data.buf = (char *)str,
+		.data.len = strlen(str),
+	};
+
+	return data_batch_add(&data);
+}
+
+static void setup(void)
+{
+	memset(&mock_send, 0, sizeof(mock_send));
+}
+
+static void teardown(void)
+{
+	mock_send.err = 0;
+	zassert_equal(data_batch_flush(), 0, "Batch not emptied");
+}
+
+static void test_invalid(void)
+{
+	struct cloud_channel_data data = {
+		.type = CLOUD_CHANNEL_TEMP,
+	};
+
+	zassert_equal(data_batch_init(NULL, batch_send), -EINVAL, NULL);
+	zassert_equal(data_batch_init(&work_q, NULL), -EINVAL, NULL);
+
+	zassert_equal(data_batch_add(NULL), -EINVAL, NULL);
+	zassert_equal(data_batch_add(&data), -EINVAL, "No data");
+
+	data.data.buf = "";
+	zassert_equal(data_batch_add(&data), -EINVAL, "Empty data");
+
+	zassert_equal(sample_add("0123456789abcdefg"), -E2BIG,
+		      "Sample longer than CONFIG_DATA_BATCH_SAMPLE_SIZE");
+	zassert_equal(mock_send.count, 0, NULL);
+}
+
+static void test_flush_samples_max(void)
+{
+	struct data_batch_stats before, after;
+
+	data_batch_stats_get(&before);
+
+	zassert_equal(sample_add("1.0"), 0, NULL);
+	zassert_equal(sample_add("2.0"), 0, NULL);
+	zassert_equal(sample_add("3.0"), 0, NULL);
+	zassert_equal(mock_send.count, 0, "Sent before the batch was full");
+
+	zassert_equal(sample_add("4.0"), 0, NULL);
+	zassert_equal(mock_send.count, 1, "Not sent at SAMPLES_MAX");
+	zassert_equal(strcmp(mock_send.buf, "[1.0,2.0,3.0,4.0]"), 0,
+		      "Unexpected batch %s", mock_send.buf);
+
+	data_batch_stats_get(&after);
+	zassert_equal(after.samples - before.samples, 4, NULL);
+	zassert_equal(after.batches - before.batches, 1, NULL);
+	zassert_equal(after.unbatched_bytes - before.unbatched_bytes,
+		      4 * (3 + MOCK_MSG_OVERHEAD), NULL);
+	zassert_equal(after.batched_bytes - before.batched_bytes,
+		      mock_send.len, NULL);
+	zassert_equal(after.dropped, before.dropped, NULL);
+}
+
+static void test_flush_size(void)
+{
+	/* 26 bytes per sample as a separate message, flushed at 64 */
+	zassert_equal(sample_add("0123456789abcdef"), 0, NULL);
+	zassert_equal(sample_add("fedcba9876543210"), 0, NULL);
+	zassert_equal(mock_send.count, 0, "Sent before FLUSH_SIZE");
+
+	zassert_equal(sample_add("0011223344556677"), 0, NULL);
+	zassert_equal(mock_send.count, 1, "Not sent at FLUSH_SIZE");
+	zassert_equal(strcmp(mock_send.buf,
+		"[0123456789abcdef,fedcba9876543210,0011223344556677]"), 0,
+		"Unexpected batch %s", mock_send.buf);
+}
+
+static void test_flush(void)
+{
+	zassert_equal(data_batch_flush(), 0, "Empty batch");
+	zassert_equal(mock_send.count, 0, "Empty batch sent");
+
+	zassert_equal(sample_add("1.0"), 0, NULL);
+	zassert_equal(data_batch_flush(), 0, NULL);
+	zassert_equal(mock_send.count, 1, NULL);
+	zassert_equal(strcmp(mock_send.buf, "[1.0]"), 0, NULL);
+
+	zassert_equal(data_batch_flush(), 0, NULL);
+	zassert_equal(mock_send.count, 1, "Sample sent twice");
+}
+
+static void test_send_error(void)
+{
+	struct data_batch_stats before, after;
+
+	data_batch_stats_get(&before);
+	mock_send.err = -EIO;
+
+	zassert_equal(sample_add("1.0"), 0, NULL);
+	zassert_equal(sample_add("2.0"), 0, NULL);
+	zassert_equal(sample_add("3.0"), 0, NULL);
+	zassert_equal(sample_add("4.0"), 0, NULL);
+	zassert_equal(mock_send.count, 1, NULL);
+	zassert_equal(data_batch_flush(), -EIO, NULL);
+
+	/* The batch is full and cannot be sent, the oldest sample is
+	 * dropped to make room.
+	 */
+	zassert_equal(sample_add("5.0"), 0, NULL);
+
+	data_batch_stats_get(&after);
+	zassert_equal(after.dropped - before.dropped, 1, NULL);
+	zassert_equal(after.batches, before.batches, NULL);
+
+	mock_send.err = 0;
+	zassert_equal(data_batch_flush(), 0, NULL);
+	zassert_equal(strcmp(mock_send.buf, "[2.0,3.0,4.0,5.0]"), 0,
+		      "Unexpected batch %s", mock_send.buf);
+
+	data_batch_stats_get(&after);
+	zassert_equal(after.samples - before.samples, 4, NULL);
+	zassert_equal(after.batches - before.batches, 1, NULL);
+}
+
+static void test_max_age(void)
+{
+	zassert_equal(sample_add("1.0"), 0, NULL);
+	k_sleep(K_MSEC(CONFIG_DATA_BATCH_MAX_AGE * MSEC_PER_SEC / 2));
+	zassert_equal(mock_send.count, 0, "Sent before MAX_AGE");
+
+	k_sleep(K_MSEC(CONFIG_DATA_BATCH_MAX_AGE * MSEC_PER_SEC));
+	zassert_equal(mock_send.count, 1, "Not sent at MAX_AGE");
+	zassert_equal(strcmp(mock_send.buf, "[1.0]"), 0, NULL);
+}
+
+static void test_flush_request(void)
+{
+	zassert_equal(sample_add("1.0"), 0, NULL);
+	data_batch_flush_request();
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(mock_send.count, 1, "Not sent from the work queue");
+	zassert_equal(strcmp(mock_send.buf, "[1.0]"), 0, NULL);
+}
+
+void test_main(void)
+{
+	k_work_q_start(&work_q, work_q_stack,
+		       K_THREAD_STACK_SIZEOF(work_q_stack),
+		       K_LOWEST_APPLICATION_THREAD_PRIO);
+
+	zassert_equal(data_batch_init(&work_q, batch_send), 0, NULL);
+
+	ztest_test_suite(data_batch,
+		ztest_unit_test_setup_teardown(test_invalid,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_flush_samples_max,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_flush_size,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_flush,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_send_error,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_max_age,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_flush_request,
+					       setup, teardown)
+	);
+
+	ztest_run_test_suite(data_batch);
+}
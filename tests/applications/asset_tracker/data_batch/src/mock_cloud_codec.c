@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include "cloud_codec.h"
+#include "mock_cloud_codec.h"
+
+int cloud_encode_data_to_buf(const struct cloud_channel_data *channel,
+			     const enum cloud_cmd_group group,
+			     char *buf, size_t size)
+{
+	ARG_UNUSED(group);
+	ARG_UNUSED(buf);
+	ARG_UNUSED(size);
+
+	return channel->data.len + MOCK_MSG_OVERHEAD;
+}
+
+/* Encodes the batch as the sample data separated by commas, in brackets */
+int cloud_encode_batch_to_buf(const struct cloud_channel_data *samples,
+			      size_t count, enum cloud_batch_format format,
+			      uint8_t *buf, size_t size)
+{
+	size_t len = 0;
+
+	if (format != CLOUD_BATCH_FORMAT_JSON) {
+		return -ENOTSUP;
+	}
+
+	if (size < 3) {
+		return -ENOMEM;
+	}
+
+	buf[len++] = '[';
+
+	for (size_t i = 0; i < count; i++) {
+		if (len + samples[i].data.len + 3 > size) {
+			return -ENOMEM;
+		}
+
+		if (i > 0) {
+			buf[len++] = ',';
+		}
+
+		memcpy(&buf[len], samples[i].data.buf, samples[i].data.len);
+		len += samples[i].data.len;
+	}
+
+	buf[len++] = ']';
+	buf[len] = '\0';
+
+	return len;
+}
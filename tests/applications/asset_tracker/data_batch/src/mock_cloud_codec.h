@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef MOCK_CLOUD_CODEC_H__
+#define MOCK_CLOUD_CODEC_H__
+
+/* Length the mock codec adds to a sample encoded as a separate message */
+#define MOCK_MSG_OVERHEAD 10
+
+#endif /* MOCK_CLOUD_CODEC_H__ */
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <stdlib.h>
+#include <cJSON.h>
+#include <json_writer.h>
+
+#define BENCHMARK_ROUNDS 1000
+
+/* Same shape as the asset tracker sensor data message */
+struct data_msg {
+	const char *app_id;
+	const char *data;
+	const char *msg_type;
+	int64_t ts;
+};
+
+JSON_SCHEMA_DEFINE(data_msg_schema,
+	JSON_FIELD_STR(struct data_msg, app_id, "appId"),
+	JSON_FIELD_STR(struct data_msg, data, "data"),
+	JSON_FIELD_STR(struct data_msg, msg_type, "messageType"),
+	JSON_FIELD_INT64(struct data_msg, ts, "ts")
+);
+
+struct env_msg {
+	double value;
+	bool enable;
+};
+
+JSON_SCHEMA_DEFINE(env_msg_schema,
+	JSON_FIELD_NUMBER(struct env_msg, value, "value"),
+	JSON_FIELD_BOOL(struct env_msg, enable, "enable")
+);
+
+struct nested_msg {
+	const char *name;
+	struct env_msg env;
+};
+
+JSON_SCHEMA_DEFINE(nested_msg_schema,
+	JSON_FIELD_STR(struct nested_msg, name, "name"),
+	JSON_FIELD_OBJ(struct nested_msg, env, "env", env_msg_schema)
+);
+
+static const struct data_msg gps_msg = {
+	.app_id = "GPS",
+	.data = "$GPGGA,090044.00,6325.6003,N,01024.5040,E,1,06,1.65,"
+		"63.4,M,39.5,M,,*6A",
+	.msg_type = "DATA",
+	.ts = 1603094400123LL,
+};
+
+/* Heap usage of cJSON */
+static size_t heap_used;
+static size_t heap_peak;
+
+static void *counting_malloc(size_t size)
+{
+	size_t *p = k_malloc(size + sizeof(size_t));
+
+	if (p == NULL) {
+		return NULL;
+	}
+
+	*p = size;
+	heap_used += size;
+	heap_peak = MAX(heap_peak, heap_used);
+
+	return p + 1;
+}
+
+static void counting_free(void *ptr)
+{
+	size_t *p = ptr;
+
+	if (p == NULL) {
+		return;
+	}
+
+	heap_used -= p[-1];
+	k_free(p - 1);
+}
+
+static char *cjson_data_msg_encode(const struct data_msg *msg)
+{
+	cJSON *root_obj = cJSON_CreateObject();
+	char *buffer;
+
+	cJSON_AddItemToObject(root_obj, "appId",
+			      cJSON_CreateString(msg->app_id));
+	cJSON_AddItemToObject(root_obj, "data", cJSON_CreateString(msg->data));
+	cJSON_AddItemToObject(root_obj, "messageType",
+			      cJSON_CreateString(msg->msg_type));
+	cJSON_AddItemToObject(root_obj, "ts",
+			      cJSON_CreateNumber((double)msg->ts));
+
+	buffer = cJSON_PrintUnformatted(root_obj);
+	cJSON_Delete(root_obj);
+
+	return buffer;
+}
+
+static void setup(void)
+{
+	cJSON_Hooks hooks = {
+		.malloc_fn = counting_malloc,
+		.free_fn = counting_free,
+	};
+
+	cJSON_InitHooks(&hooks);
+	heap_used = 0;
+	heap_peak = 0;
+}
+
+static void teardown(void)
+{
+	zassert_equal(heap_used, 0, "cJSON memory leaked");
+}
+
+static void data_msg_check(const struct data_msg *msg)
+{
+	char buf[256];
+	char *expected;
+	int len;
+
+	expected = cjson_data_msg_encode(msg);
+	zassert_not_null(expected, NULL);
+
+	len = json_schema_encode(&data_msg_schema, msg, buf, sizeof(buf));
+	zassert_equal(len, strlen(expected), NULL);
+	zassert_true(!strcmp(buf, expected), "%s != %s", buf, expected);
+
+	counting_free(expected);
+}
+
+static void test_data_msg(void)
+{
+	struct data_msg msg = gps_msg;
+
+	data_msg_check(&msg);
+
+	/* Cleared and negative timestamps */
+	msg.ts = 0;
+	data_msg_check(&msg);
+	msg.ts = -1;
+	data_msg_check(&msg);
+
+	/* Beyond the exact integer range of cJSON */
+	msg.ts = INT64_MAX;
+	data_msg_check(&msg);
+
+	msg.data = "\"quoted\" \\ back\tslash\r\n\x01\x1f \xc3\xa6";
+	data_msg_check(&msg);
+
+	msg.data = "";
+	data_msg_check(&msg);
+}
+
+static void test_numbers(void)
+{
+	static const double values[] = {
+		0.0, -0.0, 1.0, -1.5, 0.1, 21.3, 1.0 / 3.0, 1e300, -1e-300,
+		1603094400123.0, 123456789012345678.0,
+	};
+	struct env_msg msg = { .enable = true };
+	char buf[64];
+	char *expected;
+	cJSON *root_obj;
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		msg.value = values[i];
+		root_obj = cJSON_CreateObject();
+		cJSON_AddItemToObject(root_obj, "value",
+				      cJSON_CreateNumber(msg.value));
+		cJSON_AddItemToObject(root_obj, "enable",
+				      cJSON_CreateBool(msg.enable));
+		expected = cJSON_PrintUnformatted(root_obj);
+		cJSON_Delete(root_obj);
+
+		zassert_equal(json_schema_encode(&env_msg_schema, &msg, buf,
+						 sizeof(buf)),
+			      strlen(expected), NULL);
+		zassert_true(!strcmp(buf, expected), "%s != %s", buf,
+			     expected);
+		counting_free(expected);
+	}
+}
+
+static void test_nested(void)
+{
+	static const char expected[] =
+		"{\"name\":\"temp\",\"env\":{\"value\":21.5,\"enable\":false}}";
+	struct nested_msg msg = {
+		.name = "temp",
+		.env = { .value = 21.5, .enable = false },
+	};
+	char buf[sizeof(expected)];
+
+	zassert_equal(json_schema_encode(&nested_msg_schema, &msg, buf,
+					 sizeof(buf)),
+		      sizeof(expected) - 1, NULL);
+	zassert_true(!strcmp(buf, expected), NULL);
+}
+
+static void test_buffer_size(void)
+{
+	char buf[32];
+	char large[256];
+	int len;
+
+	/* Length only */
+	len = json_schema_encode(&data_msg_schema, &gps_msg, NULL, 0);
+	zassert_true(len > sizeof(buf), NULL);
+
+	/* Truncated output is still terminated */
+	memset(buf, 'x', sizeof(buf));
+	zassert_equal(json_schema_encode(&data_msg_schema, &gps_msg, buf,
+					 sizeof(buf)),
+		      -ENOMEM, NULL);
+	zassert_equal(buf[sizeof(buf) - 1], '\0', NULL);
+
+	/* No room for the terminating null character */
+	zassert_equal(json_schema_encode(&data_msg_schema, &gps_msg, large,
+					 len), -ENOMEM, NULL);
+	zassert_equal(json_schema_encode(&data_msg_schema, &gps_msg, large,
+					 len + 1), len, NULL);
+}
+
+static void test_benchmark(void)
+{
+	char buf[256];
+	char *out;
+	uint32_t start, cjson_cycles, writer_cycles;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+		out = cjson_data_msg_encode(&gps_msg);
+		zassert_not_null(out, NULL);
+		counting_free(out);
+	}
+	cjson_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+		zassert_true(json_schema_encode(&data_msg_schema, &gps_msg,
+						buf, sizeof(buf)) > 0, NULL);
+	}
+	writer_cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("Encoded %d data messages\n", BENCHMARK_ROUNDS);
+	TC_PRINT("\tcJSON:       %u cycles, peak heap %u bytes\n",
+		 cjson_cycles, (uint32_t)heap_peak);
+	TC_PRINT("\tjson_writer: %u cycles, peak heap 0 bytes\n",
+		 writer_cycles);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(json_writer,
+		ztest_unit_test_setup_teardown(test_data_msg,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_numbers,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_nested,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_buffer_size,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_benchmark,
+					       setup, teardown)
+	);
+
+	ztest_run_test_suite(json_writer);
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <event_manager.h>
+
+#include "hid_event.h"
+#include "motion_event.h"
+#include "usb_event.h"
+
+#include "motion_sim.h"
+
+#define MODULE main
+#include "module_state_event.h"
+
+/* Time between the mouse HID reports, like a BLE connection interval */
+#define REPORT_INTERVAL_MS 8
+#define MOTION_TIME_MS 1000
+/* Wake up the motion thread between the report slots this often */
+#define USB_EVENT_INTERVAL_MS 30
+/* Motion in every sensor sample */
+#define STEP_X 3
+#define STEP_Y -2
+
+/* Collected in the event handler, which runs in the system workqueue like
+ * the report slots.
+ */
+static struct {
+	uint32_t events;
+	uint32_t slots;
+	int32_t dx;
+	int32_t dy;
+	/* Time from a report slot to the motion event */
+	uint32_t latency_sum;
+	uint32_t latency_max;
+	uint32_t latency_count;
+} stats;
+
+static uint32_t slot_time;
+static bool slot_pending;
+static const void *subscriber = &stats;
+
+static K_SEM_DEFINE(motion_ready_sem, 0, 1);
+
+static void report_slot_fn(struct k_work *work)
+{
+	struct hid_report_sent_event *event = new_hid_report_sent_event();
+
+	event->subscriber = subscriber;
+	event->report_id = REPORT_ID_MOUSE;
+	event->error = false;
+
+	slot_time = k_cycle_get_32();
+	slot_pending = true;
+	stats.slots++;
+
+	EVENT_SUBMIT(event);
+}
+
+static K_DELAYED_WORK_DEFINE(report_slot, report_slot_fn);
+
+static void motion_event_handle(const struct motion_event *event)
+{
+	if (slot_pending) {
+		uint32_t latency = k_cyc_to_us_floor32(k_cycle_get_32() -
+						       slot_time);
+
+		stats.latency_sum += latency;
+		stats.latency_max = MAX(stats.latency_max, latency);
+		stats.latency_count++;
+		slot_pending = false;
+	}
+
+	stats.events++;
+	stats.dx += event->dx;
+	stats.dy += event->dy;
+
+	/* The report with the motion is sent in the next slot */
+	k_delayed_work_submit(&report_slot, K_MSEC(REPORT_INTERVAL_MS));
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_motion_event(eh)) {
+		motion_event_handle(cast_motion_event(eh));
+		return false;
+	}
+
+	if (is_module_state_event(eh)) {
+		const struct module_state_event *event =
+			cast_module_state_event(eh);
+
+		if (check_state(event, MODULE_ID(motion), MODULE_STATE_READY)) {
+			k_sem_give(&motion_ready_sem);
+		}
+
+		return false;
+	}
+
+	/* If event is unhandled, unsubscribe. */
+	__ASSERT_NO_MSG(false);
+
+	return false;
+}
+
+EVENT_LISTENER(MODULE, event_handler);
+EVENT_SUBSCRIBE(MODULE, motion_event);
+EVENT_SUBSCRIBE(MODULE, module_state_event);
+
+static void usb_state_set(enum usb_state state)
+{
+	struct usb_state_event *event = new_usb_state_event();
+
+	event->state = state;
+	EVENT_SUBMIT(event);
+}
+
+static void test_init(void)
+{
+	int err;
+
+	err = event_manager_init();
+	zassert_equal(err, 0, "Error when initializing");
+
+	/* The host subscribes to the mouse reports */
+	struct hid_report_subscription_event *event =
+		new_hid_report_subscription_event();
+
+	event->subscriber = subscriber;
+	event->report_id = REPORT_ID_MOUSE;
+	event->enabled = true;
+	EVENT_SUBMIT(event);
+
+	module_set_state(MODULE_STATE_READY);
+
+	err = k_sem_take(&motion_ready_sem, K_SECONDS(1));
+	zassert_equal(err, 0, "Motion module not ready");
+
+	/* Let the module apply the default configuration */
+	k_sleep(K_MSEC(50));
+}
+
+static void test_motion_report_slots(void)
+{
+	struct motion_sim_stats sim_stats;
+	uint32_t events;
+	uint32_t expected;
+
+	motion_sim_stats_reset();
+	memset(&stats, 0, sizeof(stats));
+
+	motion_sim_start(STEP_X, STEP_Y);
+
+	/* Changing the sensor options wakes up the motion thread between
+	 * the report slots.
+	 */
+	for (int t = 0; t < MOTION_TIME_MS; t += USB_EVENT_INTERVAL_MS) {
+		k_sleep(K_MSEC(USB_EVENT_INTERVAL_MS));
+		usb_state_set((t / USB_EVENT_INTERVAL_MS) % 2 ?
+			      USB_STATE_DISCONNECTED : USB_STATE_POWERED);
+	}
+
+	motion_sim_stop();
+	events = stats.events;
+
+	/* The module sends motion events without motion for
+	 * CONFIG_DESKTOP_MOTION_SENSOR_EMPTY_SAMPLES_COUNT report slots, and
+	 * then stops fetching.
+	 */
+	k_sleep(K_MSEC((CONFIG_DESKTOP_MOTION_SENSOR_EMPTY_SAMPLES_COUNT + 10) *
+		       REPORT_INTERVAL_MS));
+
+	motion_sim_stats_get(&sim_stats);
+
+	TC_PRINT("%u sensor samples, %u fetches, %u motion events\n",
+		 sim_stats.samples, sim_stats.fetches, stats.events);
+	TC_PRINT("%u motion events/s, report slot to motion event: "
+		 "%u us average, %u us max\n",
+		 events * 1000 / MOTION_TIME_MS,
+		 stats.latency_sum / MAX(stats.latency_count, 1),
+		 stats.latency_max);
+
+	zassert_equal(stats.dx, sim_stats.dx, "Motion lost");
+	zassert_equal(stats.dy, sim_stats.dy, "Motion lost");
+
+	/* One motion event per report slot, and one sensor read per event,
+	 * apart from the first event on data ready and the last read that
+	 * finds no motion.
+	 */
+	zassert_equal(stats.events, stats.slots, NULL);
+	zassert_equal(sim_stats.fetches, stats.events + 1,
+		      "Sensor read outside of the report slots");
+
+	expected = MOTION_TIME_MS / REPORT_INTERVAL_MS;
+	zassert_true(events >= expected * 9 / 10,
+		     "Expected about %u motion events, got %u", expected,
+		     events);
+	zassert_true(events <= expected + 1,
+		     "Expected about %u motion events, got %u", expected,
+		     events);
+	zassert_true(stats.latency_max < REPORT_INTERVAL_MS * USEC_PER_MSEC,
+		     "Motion event not sent before the next report slot");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf_desktop_motion_sensor_test,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_motion_report_slots)
+			 );
+
+	ztest_run_test_suite(nrf_desktop_motion_sensor_test);
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+#ifndef _MOTION_SENSOR_H_
+#define _MOTION_SENSOR_H_
+
+/* Replaces configuration/common/motion_sensor.h to use the simulated sensor */
+
+#include <drivers/sensor.h>
+
+#include "motion_sim.h"
+
+enum motion_sensor_option {
+	MOTION_SENSOR_OPTION_CPI,
+	MOTION_SENSOR_OPTION_SLEEP_ENABLE,
+	MOTION_SENSOR_OPTION_SLEEP1_TIMEOUT,
+	MOTION_SENSOR_OPTION_SLEEP2_TIMEOUT,
+	MOTION_SENSOR_OPTION_SLEEP3_TIMEOUT,
+	MOTION_SENSOR_OPTION_SLEEP1_SAMPLE_TIME,
+	MOTION_SENSOR_OPTION_SLEEP2_SAMPLE_TIME,
+	MOTION_SENSOR_OPTION_SLEEP3_SAMPLE_TIME,
+
+	MOTION_SENSOR_OPTION_COUNT,
+};
+
+#define MOTION_SENSOR_DEV_NAME MOTION_SIM_DEV_NAME
+
+static const int motion_sensor_option_attr[MOTION_SENSOR_OPTION_COUNT] = {
+	[MOTION_SENSOR_OPTION_CPI] = SENSOR_ATTR_PRIV_START,
+	[MOTION_SENSOR_OPTION_SLEEP_ENABLE] = SENSOR_ATTR_PRIV_START + 1,
+	[MOTION_SENSOR_OPTION_SLEEP1_TIMEOUT] = SENSOR_ATTR_PRIV_START + 2,
+	[MOTION_SENSOR_OPTION_SLEEP2_TIMEOUT] = SENSOR_ATTR_PRIV_START + 3,
+	[MOTION_SENSOR_OPTION_SLEEP3_TIMEOUT] = SENSOR_ATTR_PRIV_START + 4,
+	[MOTION_SENSOR_OPTION_SLEEP1_SAMPLE_TIME] = SENSOR_ATTR_PRIV_START + 5,
+	[MOTION_SENSOR_OPTION_SLEEP2_SAMPLE_TIME] = SENSOR_ATTR_PRIV_START + 6,
+	[MOTION_SENSOR_OPTION_SLEEP3_SAMPLE_TIME] = SENSOR_ATTR_PRIV_START + 7,
+};
+
+#endif /* _MOTION_SENSOR_H_ */
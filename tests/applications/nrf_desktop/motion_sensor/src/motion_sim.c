@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <spinlock.h>
+#include <drivers/sensor.h>
+
+#include "motion_sim.h"
+
+static struct {
+	struct k_spinlock lock;
+	const struct device *dev;
+	sensor_trigger_handler_t handler;
+	/* Delta registers */
+	int16_t acc_x;
+	int16_t acc_y;
+	/* Motion read by the last fetch */
+	int16_t x;
+	int16_t y;
+	int16_t step_x;
+	int16_t step_y;
+	struct motion_sim_stats stats;
+} sim;
+
+static void data_ready_work_fn(struct k_work *work)
+{
+	struct sensor_trigger trig = {
+		.type = SENSOR_TRIG_DATA_READY,
+		.chan = SENSOR_CHAN_ALL,
+	};
+	sensor_trigger_handler_t handler;
+
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	handler = sim.handler;
+	k_spin_unlock(&sim.lock, key);
+
+	/* The trigger can be disabled after the work was submitted */
+	if (handler) {
+		handler(sim.dev, &trig);
+	}
+}
+
+static K_WORK_DEFINE(data_ready_work, data_ready_work_fn);
+
+static void sample_timer_fn(struct k_timer *timer)
+{
+	bool ready;
+
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	sim.acc_x += sim.step_x;
+	sim.acc_y += sim.step_y;
+	sim.stats.samples++;
+	sim.stats.dx += sim.step_x;
+	sim.stats.dy += sim.step_y;
+	ready = (sim.handler != NULL);
+
+	k_spin_unlock(&sim.lock, key);
+
+	if (ready) {
+		k_work_submit(&data_ready_work);
+	}
+}
+
+static K_TIMER_DEFINE(sample_timer, sample_timer_fn, NULL);
+
+void motion_sim_start(int16_t dx, int16_t dy)
+{
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	sim.step_x = dx;
+	sim.step_y = dy;
+	k_spin_unlock(&sim.lock, key);
+
+	k_timer_start(&sample_timer, K_MSEC(MOTION_SIM_SAMPLE_MS),
+		      K_MSEC(MOTION_SIM_SAMPLE_MS));
+}
+
+void motion_sim_stop(void)
+{
+	k_timer_stop(&sample_timer);
+}
+
+void motion_sim_stats_get(struct motion_sim_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	*stats = sim.stats;
+	k_spin_unlock(&sim.lock, key);
+}
+
+void motion_sim_stats_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	memset(&sim.stats, 0, sizeof(sim.stats));
+	k_spin_unlock(&sim.lock, key);
+}
+
+static int motion_sim_sample_fetch(const struct device *dev,
+				   enum sensor_channel chan)
+{
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	/* Reading the delta registers clears them */
+	sim.x = sim.acc_x;
+	sim.y = sim.acc_y;
+	sim.acc_x = 0;
+	sim.acc_y = 0;
+	sim.stats.fetches++;
+
+	k_spin_unlock(&sim.lock, key);
+
+	return 0;
+}
+
+static int motion_sim_channel_get(const struct device *dev,
+				  enum sensor_channel chan,
+				  struct sensor_value *val)
+{
+	switch (chan) {
+	case SENSOR_CHAN_POS_DX:
+		val->val1 = sim.x;
+		val->val2 = 0;
+		break;
+
+	case SENSOR_CHAN_POS_DY:
+		val->val1 = sim.y;
+		val->val2 = 0;
+		break;
+
+	default:
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+static int motion_sim_trigger_set(const struct device *dev,
+				  const struct sensor_trigger *trig,
+				  sensor_trigger_handler_t handler)
+{
+	bool ready;
+
+	if ((trig->type != SENSOR_TRIG_DATA_READY) ||
+	    (trig->chan != SENSOR_CHAN_ALL)) {
+		return -ENOTSUP;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&sim.lock);
+
+	sim.handler = handler;
+	ready = (handler != NULL) && ((sim.acc_x != 0) || (sim.acc_y != 0));
+
+	k_spin_unlock(&sim.lock, key);
+
+	/* Data ready is signaled while there is motion to fetch */
+	if (ready) {
+		k_work_submit(&data_ready_work);
+	}
+
+	return 0;
+}
+
+static int motion_sim_attr_set(const struct device *dev,
+			       enum sensor_channel chan,
+			       enum sensor_attribute attr,
+			       const struct sensor_value *val)
+{
+	return 0;
+}
+
+static int motion_sim_init(const struct device *dev)
+{
+	sim.dev = dev;
+
+	return 0;
+}
+
+static const struct sensor_driver_api motion_sim_driver_api = {
+	.sample_fetch = motion_sim_sample_fetch,
+	.channel_get  = motion_sim_channel_get,
+	.trigger_set  = motion_sim_trigger_set,
+	.attr_set     = motion_sim_attr_set,
+};
+
+DEVICE_AND_API_INIT(motion_sim, MOTION_SIM_DEV_NAME, motion_sim_init,
+		    NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &motion_sim_driver_api);
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef MOTION_SIM_H__
+#define MOTION_SIM_H__
+
+/* Simulated motion sensor. Like an optical sensor, it accumulates the motion
+ * in its delta registers until the motion is fetched, and signals data ready
+ * while there is motion to fetch.
+ */
+
+#include <zephyr.h>
+
+#define MOTION_SIM_DEV_NAME "MOTION_SIM"
+
+/* The sensor samples the motion at this period */
+#define MOTION_SIM_SAMPLE_MS 1
+
+struct motion_sim_stats {
+	/* Sensor samples with motion */
+	uint32_t samples;
+	/* Reads of the delta registers */
+	uint32_t fetches;
+	/* Total motion */
+	int32_t dx;
+	int32_t dy;
+};
+
+/** Move by dx and dy in every sample, until motion_sim_stop() is called. */
+void motion_sim_start(int16_t dx, int16_t dy);
+
+void motion_sim_stop(void);
+
+void motion_sim_stats_get(struct motion_sim_stats *stats);
+
+void motion_sim_stats_reset(void);
+
+#endif /* MOTION_SIM_H__ */
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <drivers/sensor.h>
+#include <drivers/gps.h>
+
+/* Sensor values are converted with a resolution of 1e-6 */
+#define SENSOR_DELTA 0.001
+#define PVT_DELTA 0.001
+/* Tolerance of the replay timing, in milliseconds */
+#define TIME_DELTA 20
+
+#define NMEA_SENTENCE \
+	"$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"
+
+static const struct device *sensor_dev;
+static const struct device *gps_dev;
+
+K_MSGQ_DEFINE(gps_fix_msgq, sizeof(struct gps_event), 8, 4);
+static atomic_t gps_fix_count;
+
+static void gps_handler(const struct device *dev, struct gps_event *evt)
+{
+	ARG_UNUSED(dev);
+
+	if ((evt->type != GPS_EVT_NMEA_FIX) && (evt->type != GPS_EVT_PVT_FIX)) {
+		return;
+	}
+
+	atomic_inc(&gps_fix_count);
+	(void)k_msgq_put(&gps_fix_msgq, evt, K_NO_WAIT);
+}
+
+static void gps_trace_start(void)
+{
+	struct gps_config cfg = {
+		.nav_mode = GPS_NAV_MODE_CONTINUOUS,
+		.interval = 10,
+	};
+
+	k_msgq_purge(&gps_fix_msgq);
+	atomic_set(&gps_fix_count, 0);
+
+	zassert_equal(gps_start(gps_dev, &cfg), 0, "GPS start failed");
+}
+
+static void gps_trace_stop(void)
+{
+	zassert_equal(gps_stop(gps_dev), 0, "GPS stop failed");
+}
+
+static void gps_fix_get(struct gps_event *evt, k_timeout_t timeout)
+{
+	zassert_equal(k_msgq_get(&gps_fix_msgq, evt, timeout), 0,
+		      "No GPS fix");
+}
+
+static void gps_nmea_check(const struct gps_event *evt)
+{
+	zassert_equal(evt->type, GPS_EVT_NMEA_FIX, "Not an NMEA fix");
+	zassert_equal(strcmp(evt->nmea.buf, NMEA_SENTENCE), 0,
+		      "Wrong sentence %s", evt->nmea.buf);
+	zassert_equal(evt->nmea.len, strlen(NMEA_SENTENCE), NULL);
+}
+
+static void gps_pvt_check(const struct gps_event *evt, double latitude,
+			  double longitude, double accuracy)
+{
+	zassert_equal(evt->type, GPS_EVT_PVT_FIX, "Not a PVT fix");
+	zassert_within(evt->pvt.latitude, latitude, PVT_DELTA, NULL);
+	zassert_within(evt->pvt.longitude, longitude, PVT_DELTA, NULL);
+	zassert_within(evt->pvt.accuracy, accuracy, PVT_DELTA, NULL);
+}
+
+static double sensor_fetch_get(enum sensor_channel chan)
+{
+	struct sensor_value val;
+
+	zassert_equal(sensor_sample_fetch_chan(sensor_dev, chan), 0,
+		      "Fetch failed");
+	zassert_equal(sensor_channel_get(sensor_dev, chan, &val), 0,
+		      "Get failed");
+
+	return sensor_value_to_double(&val);
+}
+
+static void sensor_accel_check(double x, double y, double z)
+{
+	struct sensor_value val[3];
+
+	zassert_equal(sensor_sample_fetch_chan(sensor_dev,
+					       SENSOR_CHAN_ACCEL_XYZ), 0,
+		      "Fetch failed");
+	zassert_equal(sensor_channel_get(sensor_dev, SENSOR_CHAN_ACCEL_XYZ,
+					 val), 0, "Get failed");
+
+	zassert_within(sensor_value_to_double(&val[0]), x, SENSOR_DELTA, NULL);
+	zassert_within(sensor_value_to_double(&val[1]), y, SENSOR_DELTA, NULL);
+	zassert_within(sensor_value_to_double(&val[2]), z, SENSOR_DELTA, NULL);
+}
+
+static void sleep_until(int64_t uptime)
+{
+	k_sleep(K_MSEC(MAX(uptime - k_uptime_get(), 0)));
+}
+
+#if defined(CONFIG_TEST_SIM_TRACE_ZERO_TIME)
+static void test_sensor_zero_time(void)
+{
+	/* Every fetch replays a pass of the trace and returns */
+	for (int i = 0; i < 10; i++) {
+		zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP),
+			       20.5, SENSOR_DELTA, NULL);
+		sensor_accel_check(1.0, 2.0, 3.0);
+		k_sleep(K_MSEC(i % 3));
+	}
+}
+
+static void test_gps_zero_time(void)
+{
+	int64_t start = k_uptime_get();
+	struct gps_event evt;
+	atomic_val_t count;
+
+	gps_trace_start();
+
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_pvt_check(&evt, 63.43, 10.39, 4.5);
+
+	/* The fixes are reported at most once per millisecond */
+	k_sleep(K_MSEC(50));
+	gps_trace_stop();
+	count = atomic_get(&gps_fix_count);
+
+	zassert_true(count > 1, "Trace not replayed");
+	zassert_true(count <= k_uptime_get() - start, "%d fixes", count);
+}
+#elif CONFIG_SENSOR_SIM_TRACE_SPEED == 0
+static void test_sensor_step(void)
+{
+	/* Each fetch returns the next record of the channel */
+	sensor_accel_check(1.0, 2.0, 3.0);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 20.5,
+		       SENSOR_DELTA, NULL);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_ACCEL_X), 4.0,
+		       SENSOR_DELTA, NULL);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_HUMIDITY), 40.0,
+		       SENSOR_DELTA, NULL);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_PRESS), 101.5,
+		       SENSOR_DELTA, NULL);
+
+	/* The invalid temperature record is skipped */
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 21.5,
+		       SENSOR_DELTA, NULL);
+
+	/* The trace restarts at the end */
+	sensor_accel_check(1.0, 2.0, 3.0);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 20.5,
+		       SENSOR_DELTA, NULL);
+}
+
+static void test_sensor_unsupported(void)
+{
+	zassert_equal(sensor_sample_fetch_chan(sensor_dev,
+					       SENSOR_CHAN_LIGHT),
+		      -ENOTSUP, NULL);
+}
+
+static void test_gps_step(void)
+{
+	int64_t start = k_uptime_get();
+	struct gps_event evt;
+
+	gps_trace_start();
+
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_nmea_check(&evt);
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_pvt_check(&evt, 63.43, 10.39, 4.5);
+
+	/* The invalid PVT record is skipped */
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_pvt_check(&evt, 63.45, 10.41, 3.5);
+
+	/* The trace restarts at the end */
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_nmea_check(&evt);
+
+	gps_trace_stop();
+
+	/* The fixes do not wait for the record times */
+	zassert_true(k_uptime_get() - start < 100, NULL);
+}
+#else
+static void test_sensor_realtime(void)
+{
+	/* The replay starts when the driver is initialized */
+	zassert_true(k_uptime_get() < 100, "Test started late");
+	sensor_accel_check(1.0, 2.0, 3.0);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 20.5,
+		       SENSOR_DELTA, NULL);
+
+	sleep_until(150);
+	sensor_accel_check(4.0, 5.0, 6.0);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_HUMIDITY), 40.0,
+		       SENSOR_DELTA, NULL);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 20.5,
+		       SENSOR_DELTA, NULL);
+
+	sleep_until(250);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_PRESS), 101.5,
+		       SENSOR_DELTA, NULL);
+
+	sleep_until(350);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 21.5,
+		       SENSOR_DELTA, NULL);
+
+	/* The second pass starts at the time of the last record */
+	sleep_until(450);
+	zassert_within(sensor_fetch_get(SENSOR_CHAN_AMBIENT_TEMP), 20.5,
+		       SENSOR_DELTA, NULL);
+	sensor_accel_check(4.0, 5.0, 6.0);
+}
+
+static void test_gps_realtime(void)
+{
+	struct gps_event evt;
+	int64_t prev;
+	int64_t now;
+
+	gps_trace_start();
+
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_nmea_check(&evt);
+	prev = k_uptime_get();
+
+	gps_fix_get(&evt, K_MSEC(200));
+	gps_pvt_check(&evt, 63.43, 10.39, 4.5);
+	now = k_uptime_get();
+	zassert_within(now - prev, 100, TIME_DELTA, NULL);
+	prev = now;
+
+	gps_fix_get(&evt, K_MSEC(300));
+	gps_pvt_check(&evt, 63.45, 10.41, 3.5);
+	now = k_uptime_get();
+	zassert_within(now - prev, 200, TIME_DELTA, NULL);
+	prev = now;
+
+	/* The next pass starts right after the last record */
+	gps_fix_get(&evt, K_MSEC(100));
+	gps_nmea_check(&evt);
+	zassert_true(k_uptime_get() - prev < TIME_DELTA, NULL);
+
+	gps_trace_stop();
+}
+#endif
+
+void test_main(void)
+{
+	sensor_dev = device_get_binding(CONFIG_SENSOR_SIM_DEV_NAME);
+	zassert_not_null(sensor_dev, "Sensor simulator not found");
+
+	gps_dev = device_get_binding(CONFIG_GPS_SIM_DEV_NAME);
+	zassert_not_null(gps_dev, "GPS simulator not found");
+	zassert_equal(gps_init(gps_dev, gps_handler), 0, "GPS init failed");
+
+#if defined(CONFIG_TEST_SIM_TRACE_ZERO_TIME)
+	ztest_test_suite(sim_trace,
+			 ztest_unit_test(test_sensor_zero_time),
+			 ztest_unit_test(test_gps_zero_time)
+			 );
+#elif CONFIG_SENSOR_SIM_TRACE_SPEED == 0
+	ztest_test_suite(sim_trace,
+			 ztest_unit_test(test_sensor_step),
+			 ztest_unit_test(test_sensor_unsupported),
+			 ztest_unit_test(test_gps_step)
+			 );
+#else
+	ztest_test_suite(sim_trace,
+			 ztest_unit_test(test_sensor_realtime),
+			 ztest_unit_test(test_gps_realtime)
+			 );
+#endif
+
+	ztest_run_test_suite(sim_trace);
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <cJSON.h>
+#include <cJSON_os.h>
+
+#define BENCHMARK_ITERATIONS 1000
+
+static const char document[] =
+	"{\"state\":{\"desired\":{\"pairing\":{\"state\":\"paired\","
+	"\"topics\":{\"d2c\":\"prod/a/m/d/nrf-123/d2c\","
+	"\"c2d\":\"prod/a/m/d/nrf-123/+/r\"}},"
+	"\"config\":{\"GPS\":{\"enable\":true},\"TEMP\":{\"enable\":false},"
+	"\"interval\":60,\"threshold\":[1.5,20,-3]}}},\"version\":42}";
+
+static void test_scope_allocates_from_arena(void)
+{
+	struct cjson_arena_stats before;
+	struct cjson_arena_stats after;
+	cJSON *root;
+	char *str;
+
+	cJSON_ArenaStatsGet(&before);
+
+	cJSON_ArenaBegin();
+	root = cJSON_Parse(document);
+	zassert_not_null(root, "Parsing failed");
+
+	str = cJSON_PrintUnformatted(root);
+	zassert_not_null(str, "Printing failed");
+	zassert_equal(strcmp(str, document), 0, "Output differs from input");
+
+	cJSON_FreeString(str);
+	cJSON_Delete(root);
+	cJSON_ArenaEnd();
+
+	cJSON_ArenaStatsGet(&after);
+	zassert_equal(after.size, CONFIG_CJSON_ARENA_SIZE, "Wrong size");
+	zassert_equal(after.documents, before.documents + 1,
+		      "Scope not counted");
+	zassert_true(after.peak > 0, "Arena not used");
+	zassert_equal(after.fallbacks, before.fallbacks, "Unexpected fallback");
+}
+
+static void test_scope_releases_arena(void)
+{
+	cJSON *first;
+	cJSON *second;
+
+	cJSON_ArenaBegin();
+	first = cJSON_CreateObject();
+	cJSON_ArenaEnd();
+
+	cJSON_ArenaBegin();
+	second = cJSON_CreateObject();
+	cJSON_ArenaEnd();
+
+	zassert_equal(first, second, "Arena not reset at end of scope");
+}
+
+static void test_nested_scope(void)
+{
+	cJSON *outer;
+	cJSON *inner;
+
+	cJSON_ArenaBegin();
+	outer = cJSON_CreateString("outer");
+
+	cJSON_ArenaBegin();
+	inner = cJSON_CreateObject();
+	cJSON_ArenaEnd();
+
+	/* Ending the inner scope must not release the outer document */
+	zassert_not_equal(cJSON_CreateObject(), outer, "Outer item reused");
+	zassert_equal(strcmp(outer->valuestring, "outer"), 0,
+		      "Outer item overwritten");
+	zassert_not_null(inner, "Allocation failed");
+	cJSON_ArenaEnd();
+}
+
+static void test_free_last_allocation(void)
+{
+	void *first;
+	void *second;
+
+	cJSON_ArenaBegin();
+	first = cJSON_malloc(16);
+	cJSON_free(first);
+	second = cJSON_malloc(16);
+	cJSON_ArenaEnd();
+
+	zassert_equal(first, second, "Last allocation not given back");
+}
+
+static void test_fallback_to_heap(void)
+{
+	struct cjson_arena_stats before;
+	struct cjson_arena_stats after;
+	void *ptr;
+
+	cJSON_ArenaStatsGet(&before);
+
+	cJSON_ArenaBegin();
+	ptr = cJSON_malloc(CONFIG_CJSON_ARENA_SIZE + 1);
+	zassert_not_null(ptr, "No heap fallback");
+	memset(ptr, 0, CONFIG_CJSON_ARENA_SIZE + 1);
+	cJSON_free(ptr);
+	cJSON_ArenaEnd();
+
+	cJSON_ArenaStatsGet(&after);
+	zassert_equal(after.fallbacks, before.fallbacks + 1,
+		      "Fallback not counted");
+	zassert_equal(after.fallback_bytes,
+		      before.fallback_bytes + CONFIG_CJSON_ARENA_SIZE + 1,
+		      "Fallback size not counted");
+}
+
+static void test_outside_scope_uses_heap(void)
+{
+	struct cjson_arena_stats before;
+	struct cjson_arena_stats after;
+	cJSON *root;
+
+	cJSON_ArenaStatsGet(&before);
+
+	root = cJSON_Parse(document);
+	zassert_not_null(root, "Parsing failed");
+	cJSON_Delete(root);
+
+	cJSON_ArenaStatsGet(&after);
+	zassert_equal(after.documents, before.documents, "Scope counted");
+	zassert_equal(after.fallbacks, before.fallbacks, "Arena used");
+}
+
+static uint32_t document_cycle(bool arena)
+{
+	uint32_t start = k_cycle_get_32();
+	cJSON *root;
+	char *str;
+
+	for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		if (arena) {
+			cJSON_ArenaBegin();
+		}
+
+		root = cJSON_Parse(document);
+		str = cJSON_PrintUnformatted(root);
+		cJSON_FreeString(str);
+		cJSON_Delete(root);
+
+		if (arena) {
+			cJSON_ArenaEnd();
+		}
+	}
+
+	return k_cycle_get_32() - start;
+}
+
+static void test_benchmark(void)
+{
+	struct cjson_arena_stats stats;
+	uint32_t heap_cycles = document_cycle(false);
+	uint32_t arena_cycles = document_cycle(true);
+
+	cJSON_ArenaStatsGet(&stats);
+
+	TC_PRINT("%d x parse, print and delete of %zu bytes:\n",
+		 BENCHMARK_ITERATIONS, sizeof(document) - 1);
+	TC_PRINT("  heap:  %u cycles\n", heap_cycles);
+	TC_PRINT("  arena: %u cycles\n", arena_cycles);
+	TC_PRINT("  arena peak %zu of %zu bytes, %u heap fallbacks\n",
+		 stats.peak, stats.size, stats.fallbacks);
+}
+
+void test_main(void)
+{
+	cJSON_Init();
+
+	ztest_test_suite(cjson_arena,
+		ztest_unit_test(test_scope_allocates_from_arena),
+		ztest_unit_test(test_scope_releases_arena),
+		ztest_unit_test(test_nested_scope),
+		ztest_unit_test(test_free_last_allocation),
+		ztest_unit_test(test_fallback_to_heap),
+		ztest_unit_test(test_outside_scope_uses_heap),
+		ztest_unit_test(test_benchmark)
+	);
+
+	ztest_run_test_suite(cjson_arena);
+}
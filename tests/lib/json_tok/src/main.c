@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <json_tok.h>
+#include <cJSON.h>
+
+#define TOKS_MAX 64
+#define FUZZ_ITERATIONS 20000
+#define BENCHMARK_ITERATIONS 1000
+
+static struct json_tok toks[TOKS_MAX];
+static struct json_tok_doc doc;
+
+static const char job_execution[] =
+	"{\"timestamp\":1559808907,\"execution\":{\"jobId\":"
+	"\"9b5caac6-3e8a-45dd-9273-c1b995762f4a\",\"status\":\"QUEUED\","
+	"\"queuedAt\":1559808906,\"lastUpdatedAt\":1559808906,"
+	"\"versionNumber\":1,\"executionNumber\":1,\"jobDocument\":"
+	"{\"operation\":\"app_fw_update\",\"fwversion\":\"2\","
+	"\"size\":181124,\"location\":{\"protocol\":\"https:\","
+	"\"host\":\"fota-update-bucket.s3.eu-central-1.amazonaws.com\","
+	"\"path\":\"/update.bin?X-Amz-Algorithm=AWS4-HMAC-SHA256"
+	"&X-Amz-Date=20190606T081505Z&X-Amz-Expires=604800"
+	"&X-Amz-SignedHeaders=host\"}}}}";
+
+static const char shadow_delta[] =
+	"{\"version\":12,\"timestamp\":1594048236,\"state\":{\"pairing\":"
+	"{\"state\":\"paired\",\"topics\":{\"d2c\":"
+	"\"prod/a0b1c2/m/d/nrf-352656100000000/d2c\",\"c2d\":"
+	"\"prod/a0b1c2/m/d/nrf-352656100000000/+/r\"}},"
+	"\"nrfcloud_mqtt_topic_prefix\":\"prod/a0b1c2/\","
+	"\"config\":{\"GPS\":{\"enable\":true},\"TEMP\":{\"enable\":false},"
+	"\"thresholds\":[-10.5,40,1e3]}},\"metadata\":{\"pairing\":"
+	"{\"state\":{\"timestamp\":1594048236}}}}";
+
+static const char dps_registration[] =
+	"{\"operationId\":\"4.d0a671905ea5b2c8.42d78160-4c78-479e-8be7-"
+	"61d5e55dac0d\",\"status\":\"assigned\",\"registrationState\":"
+	"{\"registrationId\":\"my-device\",\"createdDateTimeUtc\":"
+	"\"2020-04-17T09:52:39.2213287Z\",\"assignedHub\":"
+	"\"my-hub.azure-devices.net\",\"deviceId\":\"my-device\","
+	"\"status\":\"assigned\",\"substatus\":\"initialAssignment\","
+	"\"lastUpdatedDateTimeUtc\":\"2020-04-17T09:52:39.4453846Z\","
+	"\"etag\":\"IjRkMDAwN2VlLTAwMDAtMGMwMC0wMDAwLTVlOTk3ZWY3MDAwMCI=\"}}";
+
+static int parse(const char *json)
+{
+	return json_tok_parse(&doc, json, strlen(json), toks, TOKS_MAX);
+}
+
+static void test_parse_tokens(void)
+{
+	static const char json[] = "{\"a\":[1,\"b\",{}],\"c\":null}";
+
+	zassert_equal(parse(json), 8, "Wrong token count");
+
+	zassert_equal(toks[0].type, JSON_TOK_OBJECT, NULL);
+	zassert_equal(toks[0].size, 2, NULL);
+	zassert_equal(toks[0].parent, -1, NULL);
+	zassert_equal(toks[0].end, strlen(json), NULL);
+
+	zassert_equal(toks[1].type, JSON_TOK_STRING, NULL);
+	zassert_equal(toks[1].start, 2, NULL);
+	zassert_equal(toks[1].end, 3, NULL);
+
+	zassert_equal(toks[2].type, JSON_TOK_ARRAY, NULL);
+	zassert_equal(toks[2].size, 3, NULL);
+	zassert_equal(toks[2].parent, 0, NULL);
+
+	zassert_equal(toks[3].type, JSON_TOK_PRIMITIVE, NULL);
+	zassert_equal(toks[3].parent, 2, NULL);
+	zassert_equal(toks[5].type, JSON_TOK_OBJECT, NULL);
+	zassert_equal(toks[5].size, 0, NULL);
+	zassert_equal(toks[7].type, JSON_TOK_PRIMITIVE, NULL);
+	zassert_equal(toks[7].parent, 0, NULL);
+}
+
+static void test_parse_invalid(void)
+{
+	static const char *const invalid[] = {
+		"", " ", "{", "}", "[1,]", "{\"a\":1,}", "{\"a\" 1}", "{\"a\"}",
+		"{1:2}", "[1 2]", "[1}", "{\"a\":1]", "\"abc", "\"a\\x\"",
+		"\"\\u12g4\"", "\"a\nb\"", "01", "1.", "-", "1e", "+1", "tru",
+		"nulll", "[1]]", "[1] 2", "{\"a\":1}{", ",", ":", "[,1]",
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(invalid); i++) {
+		zassert_equal(parse(invalid[i]), -EINVAL, "Accepted: %s",
+			      invalid[i]);
+	}
+}
+
+static void test_parse_valid(void)
+{
+	static const char *const valid[] = {
+		"0", "-0.5e+10", "true", "null", "\"\"", "[]", "{}",
+		" [ 1 , { \"a\" : [ ] } ] ", "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"",
+		"\"\\u00e6\\uD83D\\uDE00\"", "[[[[[[[[[[1]]]]]]]]]]",
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(valid); i++) {
+		zassert_true(parse(valid[i]) > 0, "Rejected: %s", valid[i]);
+	}
+}
+
+static void test_parse_length(void)
+{
+	static const char json[] = "[1,2]xyz";
+
+	/* Stops at the length, and at a null character */
+	zassert_equal(json_tok_parse(&doc, json, 5, toks, TOKS_MAX), 3, NULL);
+	zassert_equal(json_tok_parse(&doc, "[1]\0]", 5, toks, TOKS_MAX), 2,
+		      NULL);
+}
+
+static void test_parse_too_many_tokens(void)
+{
+	zassert_equal(json_tok_parse(&doc, "[1,2,3]", 7, toks, 3), -ENOMEM,
+		      NULL);
+	zassert_equal(json_tok_parse(&doc, "[1,2,3]", 7, toks, 4), 4, NULL);
+}
+
+static void test_path(void)
+{
+	char buf[64];
+	int value;
+
+	zassert_true(parse(job_execution) > 0, NULL);
+
+	zassert_equal(json_tok_str(&doc,
+		json_tok_path(&doc, 0, "execution.jobDocument.location.host"),
+		buf, sizeof(buf)),
+		strlen("fota-update-bucket.s3.eu-central-1.amazonaws.com"),
+		NULL);
+	zassert_equal(strcmp(buf,
+		"fota-update-bucket.s3.eu-central-1.amazonaws.com"), 0, NULL);
+
+	zassert_ok(json_tok_int(&doc,
+		json_tok_path(&doc, 0, "execution.versionNumber"), &value),
+		NULL);
+	zassert_equal(value, 1, NULL);
+
+	zassert_equal(json_tok_path(&doc, 0, "execution.jobDocument.nope"),
+		      -ENOENT, NULL);
+	zassert_equal(json_tok_path(&doc, 0, "timestamp.x"), -ENOENT, NULL);
+	zassert_equal(json_tok_path(&doc, 0, "execution.jobId.x"), -ENOENT,
+		      NULL);
+
+	/* Negative indexes are passed through */
+	zassert_equal(json_tok_obj_get(&doc, -ENOENT, "jobId"), -ENOENT,
+		      NULL);
+	zassert_equal(json_tok_str(&doc, -ENOENT, buf, sizeof(buf)), -EINVAL,
+		      NULL);
+}
+
+static void test_path_array(void)
+{
+	bool value;
+	int tok;
+
+	zassert_true(parse(shadow_delta) > 0, NULL);
+
+	zassert_ok(json_tok_bool(&doc,
+		json_tok_path(&doc, 0, "state.config.GPS.enable"), &value),
+		NULL);
+	zassert_true(value, NULL);
+
+	tok = json_tok_path(&doc, 0, "state.config.thresholds.1");
+	zassert_true(tok > 0, NULL);
+	zassert_equal(strncmp(&shadow_delta[toks[tok].start], "40", 2), 0,
+		      NULL);
+	zassert_equal(json_tok_path(&doc, 0, "state.config.thresholds.3"),
+		      -ENOENT, NULL);
+	zassert_equal(json_tok_path(&doc, 0, "state.config.thresholds.x"),
+		      -ENOENT, NULL);
+
+	/* Members after nested values are found */
+	zassert_true(json_tok_str_eq(&doc,
+		json_tok_path(&doc, 0, "state.nrfcloud_mqtt_topic_prefix"),
+		"prod/a0b1c2/"), NULL);
+	zassert_true(json_tok_path(&doc, 0,
+		"metadata.pairing.state.timestamp") > 0, NULL);
+}
+
+static void test_str_unescape(void)
+{
+	static const char json[] =
+		"[\"a\\\"b\\\\c\\/d\\n\",\"\\u00e6\\u20ac\\uD83D\\uDE00\"]";
+	char buf[16];
+
+	zassert_true(parse(json) > 0, NULL);
+
+	zassert_equal(json_tok_str(&doc, 1, buf, sizeof(buf)), 8, NULL);
+	zassert_equal(strcmp(buf, "a\"b\\c/d\n"), 0, NULL);
+
+	zassert_equal(json_tok_str(&doc, 2, buf, sizeof(buf)), 9, NULL);
+	zassert_equal(strcmp(buf, "\xc3\xa6\xe2\x82\xac\xf0\x9f\x98\x80"), 0,
+		      NULL);
+}
+
+static void test_str_truncate(void)
+{
+	char buf[8];
+
+	memset(buf, 'x', sizeof(buf));
+	zassert_true(parse("\"1234567890\"") > 0, NULL);
+	zassert_equal(json_tok_str(&doc, 0, buf, 4), 10, NULL);
+	zassert_equal(strcmp(buf, "123"), 0, NULL);
+	zassert_equal(buf[4], 'x', "Wrote past the buffer");
+
+	/* Length only */
+	zassert_equal(json_tok_str(&doc, 0, NULL, 0), 10, NULL);
+}
+
+static void test_int(void)
+{
+	int value;
+
+	zassert_true(parse("[2147483647,-2147483648,2147483648,1.5,1e2,"
+			   "\"1\",true]") > 0, NULL);
+	zassert_ok(json_tok_int(&doc, 1, &value), NULL);
+	zassert_equal(value, 2147483647, NULL);
+	zassert_ok(json_tok_int(&doc, 2, &value), NULL);
+	zassert_equal(value, -2147483647 - 1, NULL);
+
+	for (int tok = 3; tok <= 7; tok++) {
+		zassert_equal(json_tok_int(&doc, tok, &value), -EINVAL, NULL);
+	}
+}
+
+/* Tokens must be within the document and nested in their parent */
+static void tokens_check(const char *json, size_t len, int count)
+{
+	zassert_true(count <= TOKS_MAX, NULL);
+
+	for (int i = 0; i < count; i++) {
+		const struct json_tok *t = &toks[i];
+
+		zassert_true(t->start <= t->end, NULL);
+		zassert_true(t->end <= len, NULL);
+		zassert_true(t->parent < i, NULL);
+
+		if (t->parent >= 0) {
+			const struct json_tok *p = &toks[t->parent];
+
+			zassert_true(p->type == JSON_TOK_OBJECT ||
+				     p->type == JSON_TOK_ARRAY, NULL);
+			zassert_true(t->start > p->start, NULL);
+			zassert_true(t->end < p->end, NULL);
+		}
+	}
+}
+
+static uint32_t fuzz_rand(void)
+{
+	static uint32_t state = 0x12345678;
+
+	/* xorshift32, fixed seed for reproducible runs */
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	return state;
+}
+
+static void test_fuzz(void)
+{
+	static const char *const seeds[] = {
+		job_execution, shadow_delta, dps_registration,
+	};
+	static const char chars[] = "{}[]\":,.-+0123456789eEtfnul\\ ab";
+	static char json[sizeof(job_execution) + 1];
+	char str[16];
+	int accepted = 0;
+
+	for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+		const char *seed = seeds[fuzz_rand() % ARRAY_SIZE(seeds)];
+		size_t len = strlen(seed);
+		int mutations = 1 + fuzz_rand() % 4;
+		int count;
+
+		memcpy(json, seed, len + 1);
+
+		for (int m = 0; m < mutations && len > 0; m++) {
+			size_t pos = fuzz_rand() % len;
+
+			switch (fuzz_rand() % 3) {
+			case 0:
+				json[pos] = chars[fuzz_rand() %
+						  (sizeof(chars) - 1)];
+				break;
+			case 1:
+				memmove(&json[pos], &json[pos + 1], len - pos);
+				len--;
+				break;
+			default:
+				len = pos + 1;
+				json[len] = '\0';
+				break;
+			}
+		}
+
+		count = json_tok_parse(&doc, json, len, toks, TOKS_MAX);
+		if (count < 0) {
+			zassert_true(count == -EINVAL || count == -ENOMEM,
+				     NULL);
+			continue;
+		}
+
+		accepted++;
+		tokens_check(json, len, count);
+
+		/* Valid JSON is also accepted by cJSON */
+		cJSON *root = cJSON_ParseWithOpts(json, NULL, true);
+
+		zassert_not_null(root, "Only accepted by json_tok: %s", json);
+		cJSON_Delete(root);
+
+		for (int tok = 0; tok < count; tok++) {
+			memset(str, 'x', sizeof(str));
+			(void)json_tok_str(&doc, tok, str, sizeof(str) - 1);
+			zassert_equal(str[sizeof(str) - 1], 'x',
+				      "Wrote past the buffer");
+		}
+		(void)json_tok_path(&doc, 0, "execution.jobDocument.location");
+		(void)json_tok_path(&doc, 0, "state.config.thresholds.2");
+	}
+
+	TC_PRINT("%d of %d mutated documents were valid\n", accepted,
+		 FUZZ_ITERATIONS);
+}
+
+static void benchmark(const char *name, const char *json, const char *path)
+{
+	char buf[64];
+	uint32_t start;
+	uint32_t cjson_cycles;
+	uint32_t tok_cycles;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		cJSON *item = cJSON_Parse(json);
+		cJSON *root = item;
+		char path_buf[64];
+		char *elem;
+
+		strcpy(path_buf, path);
+		for (elem = strtok(path_buf, "."); elem && item;
+		     elem = strtok(NULL, ".")) {
+			item = cJSON_GetObjectItemCaseSensitive(item, elem);
+		}
+		zassert_not_null(cJSON_GetStringValue(item), NULL);
+		strncpy(buf, item->valuestring, sizeof(buf) - 1);
+		cJSON_Delete(root);
+	}
+	cjson_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		zassert_true(json_tok_parse(&doc, json, strlen(json), toks,
+					    TOKS_MAX) > 0, NULL);
+		zassert_true(json_tok_str(&doc, json_tok_path(&doc, 0, path),
+					  buf, sizeof(buf)) > 0, NULL);
+	}
+	tok_cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("%s (%zu bytes, %d tokens): cJSON %u, json_tok %u cycles\n",
+		 name, strlen(json), doc.count, cjson_cycles, tok_cycles);
+}
+
+static void test_benchmark(void)
+{
+	TC_PRINT("%d x parse and look up one string:\n",
+		 BENCHMARK_ITERATIONS);
+	benchmark("AWS job execution", job_execution,
+		  "execution.jobDocument.location.host");
+	benchmark("nRF Cloud shadow delta", shadow_delta,
+		  "state.pairing.state");
+	benchmark("Azure DPS registration", dps_registration,
+		  "registrationState.assignedHub");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(json_tok,
+		ztest_unit_test(test_parse_tokens),
+		ztest_unit_test(test_parse_invalid),
+		ztest_unit_test(test_parse_valid),
+		ztest_unit_test(test_parse_length),
+		ztest_unit_test(test_parse_too_many_tokens),
+		ztest_unit_test(test_path),
+		ztest_unit_test(test_path_array),
+		ztest_unit_test(test_str_unescape),
+		ztest_unit_test(test_str_truncate),
+		ztest_unit_test(test_int),
+		ztest_unit_test(test_fuzz),
+		ztest_unit_test(test_benchmark)
+	);
+
+	ztest_run_test_suite(json_tok);
+}
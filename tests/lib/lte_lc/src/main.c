@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+#include <string.h>
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <ztest.h>
+#include <modem/lte_lc.h>
+
+#include "mock_at.h"
+
+/* Registered in the home network, active time 60 s and periodic TAU 1800 s */
+#define CEREG_HOME \
+	"+CEREG: 1,\"0A0B\",\"01020304\",7,,,\"00100001\",\"00000011\"\r\n"
+
+static int handler_count;
+static uint32_t handler_changed;
+
+static void state_handler(const struct lte_lc_state *state,
+			  uint32_t has_changed)
+{
+	handler_count++;
+	handler_changed |= has_changed;
+}
+
+static void lte_handler(const struct lte_lc_evt *const evt)
+{
+}
+
+static void setup(void)
+{
+	mock_at_reset();
+	lte_lc_state_invalidate(LTE_LC_STATE_ALL);
+	handler_count = 0;
+	handler_changed = 0;
+}
+
+static void test_lte_lc_func_mode_cache(void)
+{
+	enum lte_lc_func_mode mode;
+	int err;
+
+	setup();
+	mock_at.cfun = "+CFUN: 4\r\n";
+
+	/* Unknown mode is read from the modem */
+	err = lte_lc_func_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_FUNC_MODE_OFFLINE, NULL);
+	zassert_equal(mock_at.cmd_count, 1, NULL);
+
+	err = lte_lc_func_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_FUNC_MODE_OFFLINE, NULL);
+	zassert_equal(mock_at.cmd_count, 1, "Cached mode should be used");
+
+	/* A mode set through the library is cached */
+	err = lte_lc_normal();
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mock_at.cmd_count, 2, NULL);
+
+	err = lte_lc_func_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_FUNC_MODE_NORMAL, NULL);
+	zassert_equal(mock_at.cmd_count, 2, "Cached mode should be used");
+}
+
+static void test_lte_lc_func_mode_invalidate(void)
+{
+	enum lte_lc_func_mode mode;
+	int err;
+
+	setup();
+
+	err = lte_lc_normal();
+	zassert_equal(err, 0, NULL);
+
+	/* The application changes the mode with AT+CFUN directly */
+	mock_at.cfun = "+CFUN: 0\r\n";
+	lte_lc_state_invalidate(LTE_LC_STATE_FUNC_MODE);
+
+	err = lte_lc_func_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_FUNC_MODE_POWER_OFF, NULL);
+	zassert_equal(strcmp(mock_at.last_cmd, "AT+CFUN?"), 0,
+		      "Invalidated mode should be read from the modem");
+
+	/* A failed mode change leaves the mode unknown */
+	mock_at.cfun = "+CFUN: 4\r\n";
+	mock_at.fail_cmd = "AT+CFUN=1";
+
+	err = lte_lc_normal();
+	zassert_equal(err, -EIO, NULL);
+
+	err = lte_lc_func_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_FUNC_MODE_OFFLINE, NULL);
+	zassert_equal(strcmp(mock_at.last_cmd, "AT+CFUN?"), 0, NULL);
+}
+
+static void test_lte_lc_system_mode_cache(void)
+{
+	enum lte_lc_system_mode mode;
+	int cmd_count;
+	int err;
+
+	setup();
+
+	err = lte_lc_system_mode_set(LTE_LC_SYSTEM_MODE_LTEM_GPS);
+	zassert_equal(err, 0, NULL);
+	cmd_count = mock_at.cmd_count;
+
+	err = lte_lc_system_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_SYSTEM_MODE_LTEM_GPS, NULL);
+	zassert_equal(mock_at.cmd_count, cmd_count,
+		      "Cached mode should be used");
+
+	/* Changed with AT%XSYSTEMMODE directly */
+	mock_at.xsystemmode = "%XSYSTEMMODE: 0,1,0,0\r\n";
+	lte_lc_state_invalidate(LTE_LC_STATE_SYSTEM_MODE);
+
+	err = lte_lc_system_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_SYSTEM_MODE_NBIOT, NULL);
+	zassert_equal(mock_at.cmd_count, cmd_count + 1, NULL);
+
+	/* A failed change leaves the mode unknown */
+	mock_at.fail_cmd = "AT%XSYSTEMMODE=0,0,1,0";
+
+	err = lte_lc_system_mode_set(LTE_LC_SYSTEM_MODE_GPS);
+	zassert_not_equal(err, 0, NULL);
+
+	err = lte_lc_system_mode_get(&mode);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mode, LTE_LC_SYSTEM_MODE_NBIOT, NULL);
+	zassert_equal(strcmp(mock_at.last_cmd, "AT%XSYSTEMMODE?"), 0, NULL);
+}
+
+static void test_lte_lc_notification_cache(void)
+{
+	struct lte_lc_state_handler handler = {
+		.cb = state_handler,
+		.fields = LTE_LC_STATE_NW_REG_STATUS | LTE_LC_STATE_PSM_CFG,
+	};
+	enum lte_lc_nw_reg_status status;
+	struct lte_lc_state state;
+	int tau, active_time;
+	int cmd_count;
+	int err;
+
+	setup();
+
+	err = lte_lc_init_and_connect_async(lte_handler);
+	zassert_equal(err, 0, NULL);
+
+	lte_lc_state_handler_add(&handler);
+
+	mock_at_notify(CEREG_HOME);
+	zassert_equal(handler_count, 1, NULL);
+	zassert_equal(handler_changed,
+		      LTE_LC_STATE_NW_REG_STATUS | LTE_LC_STATE_PSM_CFG, NULL);
+
+	/* An unchanged notification does not call the handler */
+	mock_at_notify(CEREG_HOME);
+	zassert_equal(handler_count, 1, NULL);
+
+	cmd_count = mock_at.cmd_count;
+
+	err = lte_lc_nw_reg_status_get(&status);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(status, LTE_LC_NW_REG_REGISTERED_HOME, NULL);
+
+	err = lte_lc_psm_get(&tau, &active_time);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(tau, 1800, NULL);
+	zassert_equal(active_time, 60, NULL);
+
+	zassert_equal(mock_at.cmd_count, cmd_count,
+		      "Cached values should be used");
+
+	err = lte_lc_state_get(&state);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(state.cell.tac, 0x0a0b, NULL);
+	zassert_equal(state.cell.id, 0x01020304, NULL);
+
+	err = lte_lc_state_handler_remove(&handler);
+	zassert_equal(err, 0, NULL);
+
+	/* Notifications are not received after deinit, so the values are
+	 * read from the modem.
+	 */
+	err = lte_lc_deinit();
+	zassert_equal(err, 0, NULL);
+
+	mock_at.cereg = "+CEREG: 5,2,\"0A0B\",\"01020304\",7\r\n";
+	cmd_count = mock_at.cmd_count;
+
+	err = lte_lc_nw_reg_status_get(&status);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(status, LTE_LC_NW_REG_SEARCHING, NULL);
+	zassert_true(mock_at.cmd_count > cmd_count, NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lib_lte_lc_test,
+	     ztest_unit_test(test_lte_lc_func_mode_cache),
+	     ztest_unit_test(test_lte_lc_func_mode_invalidate),
+	     ztest_unit_test(test_lte_lc_system_mode_cache),
+	     ztest_unit_test(test_lte_lc_notification_cache)
+	 );
+
+	ztest_run_test_suite(lib_lte_lc_test);
+}
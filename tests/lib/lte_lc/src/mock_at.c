@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <ztest.h>
+#include <modem/at_cmd.h>
+#include <modem/at_notif.h>
+
+#include "mock_at.h"
+
+struct mock_at mock_at;
+static at_notif_handler_t notif_handler;
+
+void mock_at_reset(void)
+{
+	memset(&mock_at, 0, sizeof(mock_at));
+	mock_at.cfun = "+CFUN: 1\r\n";
+	mock_at.xsystemmode = "%XSYSTEMMODE: 1,0,0,0\r\n";
+	mock_at.cereg = "+CEREG: 5,1,\"0A0B\",\"01020304\",7\r\n";
+}
+
+void mock_at_notify(const char *notif)
+{
+	zassert_not_null(notif_handler, "No notification handler");
+	notif_handler(NULL, notif);
+}
+
+int at_cmd_write(const char *const cmd, char *buf, size_t buf_len,
+		 enum at_cmd_state *state)
+{
+	const char *response = "";
+
+	mock_at.cmd_count++;
+	strncpy(mock_at.last_cmd, cmd, sizeof(mock_at.last_cmd) - 1);
+
+	if (state) {
+		*state = AT_CMD_OK;
+	}
+
+	if (mock_at.fail_cmd && (strcmp(cmd, mock_at.fail_cmd) == 0)) {
+		if (state) {
+			*state = AT_CMD_ERROR;
+		}
+		return -ENOEXEC;
+	}
+
+	if (strcmp(cmd, "AT+CFUN?") == 0) {
+		response = mock_at.cfun;
+	} else if (strcmp(cmd, "AT%XSYSTEMMODE?") == 0) {
+		response = mock_at.xsystemmode;
+	} else if (strcmp(cmd, "AT+CEREG?") == 0) {
+		response = mock_at.cereg;
+	}
+
+	if (buf) {
+		zassert_true(strlen(response) < buf_len, "Response too long");
+		strcpy(buf, response);
+	}
+
+	return 0;
+}
+
+int at_notif_register_handler(void *context, at_notif_handler_t handler)
+{
+	notif_handler = handler;
+	return 0;
+}
+
+int at_notif_deregister_handler(void *context, at_notif_handler_t handler)
+{
+	zassert_equal(notif_handler, handler, NULL);
+	notif_handler = NULL;
+	return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef MOCK_AT_H__
+#define MOCK_AT_H__
+
+#include <zephyr.h>
+
+/* Modem behind the mocked AT command library */
+struct mock_at {
+	/* Responses to the read commands */
+	const char *cfun;
+	const char *xsystemmode;
+	const char *cereg;
+	/* Command that fails, if any */
+	const char *fail_cmd;
+	/* Number of commands sent, and the last one */
+	int cmd_count;
+	char last_cmd[64];
+};
+
+extern struct mock_at mock_at;
+
+void mock_at_reset(void);
+
+/* Sends a notification to the registered notification handler */
+void mock_at_notify(const char *notif);
+
+#endif /* MOCK_AT_H__ */
@@ -8,6 +8,12 @@
 #include <stdbool.h>
 #include <zephyr/types.h>
 #include <dfu/dfu_target.h>
+#include <tinycrypt/constants.h>
+#include <tinycrypt/sha256.h>
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+#include <native_rtc.h>
+#endif
 
 #define FILE_SIZE 0x1000
 
@@ -17,6 +23,7 @@ static int write_retval;
 static int write_param_len;
 static void const *write_param_buf;
 static int done_retval;
+static bool done_param;
 static int init_retval;
 static bool identify_retval;
 
@@ -45,9 +52,20 @@ int dfu_target_mcuboot_write(const void *const buf, size_t len)
 
 int dfu_target_mcuboot_done(bool successful)
 {
+	done_param = successful;
 	return done_retval;
 }
 
+static uint8_t image[FILE_SIZE];
+
+int dfu_target_mcuboot_read(size_t offset, void *buf, size_t len)
+{
+	zassert_true(offset + len <= offset_get_out_param,
+		     "Read beyond the written data");
+	memcpy(buf, &image[offset], len);
+	return 0;
+}
+
 static void init(void)
 {
 	int err;
@@ -179,13 +197,160 @@ static void test_write(void)
 	zassert_true(err < 0, "Did not get error when writing uninitialized");
 }
 
+static void image_hash(uint8_t *hash)
+{
+	struct tc_sha256_state_struct sha;
+
+	for (size_t i = 0; i < sizeof(image); i++) {
+		image[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	zassert_equal(tc_sha256_init(&sha), TC_CRYPTO_SUCCESS, NULL);
+	zassert_equal(tc_sha256_update(&sha, image, sizeof(image)),
+		      TC_CRYPTO_SUCCESS, NULL);
+	zassert_equal(tc_sha256_final(hash, &sha), TC_CRYPTO_SUCCESS, NULL);
+}
+
+static void image_write(size_t start, size_t fragment_size)
+{
+	int err;
+
+	for (size_t off = start; off < sizeof(image); off += fragment_size) {
+		err = dfu_target_write(&image[off],
+				       MIN(fragment_size, sizeof(image) - off));
+		zassert_equal(err, 0, NULL);
+	}
+}
+
+static void test_hash(void)
+{
+	int err;
+	uint8_t hash[DFU_TARGET_HASH_LEN];
+
+	image_hash(hash);
+	init_retval = 0;
+	write_retval = 0;
+	done_retval = 0;
+	offset_get_retval = 0;
+	offset_get_out_param = 0;
+
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, -EACCES, "Should fail when not initialized");
+
+	init();
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, 0, NULL);
+	image_write(0, 100);
+	err = dfu_target_done(true);
+	zassert_equal(err, 0, NULL);
+	zassert_true(done_param, "Target should be finalized");
+
+	/* Corrupted data is rejected and the target aborted */
+	init();
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, 0, NULL);
+	image[FILE_SIZE / 2] ^= 0x01;
+	image_write(0, 100);
+	err = dfu_target_done(true);
+	zassert_equal(err, -EBADMSG, NULL);
+	zassert_false(done_param, "Target should be aborted");
+	done();
+
+	/* Missing data is rejected */
+	init();
+	image_hash(hash);
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, 0, NULL);
+	err = dfu_target_write(image, FILE_SIZE - 1);
+	zassert_equal(err, 0, NULL);
+	err = dfu_target_done(true);
+	zassert_equal(err, -EBADMSG, NULL);
+	done();
+
+	/* The data written before a resumed download is read back */
+	init();
+	offset_get_out_param = 1000;
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, 0, NULL);
+	image_write(offset_get_out_param, 100);
+	err = dfu_target_done(true);
+	zassert_equal(err, 0, NULL);
+	offset_get_out_param = 0;
+
+	/* Without an expected hash nothing is verified */
+	init();
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, 0, NULL);
+	err = dfu_target_hash_set(NULL);
+	zassert_equal(err, 0, NULL);
+	image[0] ^= 0x01;
+	image_write(0, 100);
+	err = dfu_target_done(true);
+	zassert_equal(err, 0, NULL);
+}
+
+#define BENCHMARK_SIZE (256 * 1024)
+#define BENCHMARK_FRAGMENT_SIZE 1024
+
+static uint32_t time_us(void)
+{
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+	/* Simulated time does not advance while code runs */
+	return (uint32_t)native_rtc_gettime_us(RTC_CLOCK_REALTIME);
+#else
+	return k_cyc_to_us_floor32(k_cycle_get_32());
+#endif
+}
+
+static uint32_t benchmark_write(const uint8_t *hash)
+{
+	uint32_t start;
+	int err;
+
+	init();
+	err = dfu_target_hash_set(hash);
+	zassert_equal(err, 0, NULL);
+
+	start = time_us();
+	for (size_t n = 0; n < BENCHMARK_SIZE; n += BENCHMARK_FRAGMENT_SIZE) {
+		(void)dfu_target_write(image, BENCHMARK_FRAGMENT_SIZE);
+	}
+
+	return MAX(time_us() - start, 1);
+}
+
+static void test_hash_benchmark(void)
+{
+	uint8_t hash[DFU_TARGET_HASH_LEN] = {0};
+	uint32_t plain_us;
+	uint32_t hash_us;
+
+	init_retval = 0;
+	write_retval = 0;
+	offset_get_out_param = 0;
+
+	plain_us = benchmark_write(NULL);
+	done();
+	hash_us = benchmark_write(hash);
+	(void)dfu_target_done(false);
+	done();
+
+	TC_PRINT("Writing %d KiB in %d byte fragments:\n",
+		 BENCHMARK_SIZE / 1024, BENCHMARK_FRAGMENT_SIZE);
+	TC_PRINT("\twithout hash: %u us\n", plain_us);
+	TC_PRINT("\twith hash:    %u us, %u KiB/s\n", hash_us,
+		 (uint32_t)((BENCHMARK_SIZE / 1024) * 1000000ULL / hash_us));
+}
+
 void test_main(void)
 {
 	ztest_test_suite(dfu_target_test,
 			 ztest_unit_test(test_write),
 			 ztest_unit_test(test_offset_get),
 			 ztest_unit_test(test_done),
-			 ztest_unit_test(test_init)
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_hash),
+			 ztest_unit_test(test_hash_benchmark)
 			 );
 
 	ztest_run_test_suite(dfu_target_test);
@@ -7,6 +7,7 @@
 #include <zephyr/types.h>
 #include <stdbool.h>
 #include <ztest.h>
+#include <storage/flash_map.h>
 #include <dfu_target.h>
 #include <dfu_target_mcuboot.h>
 
@@ -89,6 +90,277 @@ static void test_dfu_ctx_mcuboot_set_b1_file__empty(void)
 	zassert_true(update == NULL, "update should not be set");
 }
 
+#if defined(CONFIG_FLASH_SIMULATOR)
+#define PAGE_SIZE 4096
+#define IMAGE_PAGES 16
+#define IMAGE_SIZE (IMAGE_PAGES * PAGE_SIZE)
+#define FRAGMENT_SIZE 1024
+#define FILL 0x5a
+
+static uint8_t fragment[FRAGMENT_SIZE];
+
+static uint8_t image_byte(size_t off)
+{
+	return (uint8_t)(off * 7 + 3);
+}
+
+static const struct flash_area *slot_open(void)
+{
+	const struct flash_area *fa;
+
+	zassert_equal(flash_area_open(FLASH_AREA_ID(image_1), &fa), 0, NULL);
+
+	return fa;
+}
+
+/* Fill the page after the image, which must not be erased. */
+static void slot_prepare(void)
+{
+	const struct flash_area *fa = slot_open();
+
+	memset(fragment, FILL, sizeof(fragment));
+	zassert_equal(flash_area_erase(fa, 0, IMAGE_SIZE + PAGE_SIZE), 0, NULL);
+	zassert_equal(flash_area_write(fa, IMAGE_SIZE, fragment,
+				       sizeof(fragment)), 0, NULL);
+	flash_area_close(fa);
+}
+
+static void slot_verify(void)
+{
+	const struct flash_area *fa = slot_open();
+
+	for (size_t off = 0; off < IMAGE_SIZE; off += sizeof(fragment)) {
+		zassert_equal(flash_area_read(fa, off, fragment,
+					      sizeof(fragment)), 0, NULL);
+
+		for (size_t i = 0; i < sizeof(fragment); i++) {
+			zassert_equal(fragment[i], image_byte(off + i),
+				      "Incorrect data at %d", off + i);
+		}
+	}
+
+	zassert_equal(flash_area_read(fa, IMAGE_SIZE, fragment,
+				      sizeof(fragment)), 0, NULL);
+	for (size_t i = 0; i < sizeof(fragment); i++) {
+		zassert_equal(fragment[i], FILL,
+			      "Page after the image was erased");
+	}
+
+	flash_area_close(fa);
+}
+
+static void image_write(size_t start, size_t end, k_timeout_t gap)
+{
+	int err;
+
+	for (size_t off = start; off < end; off += sizeof(fragment)) {
+		for (size_t i = 0; i < sizeof(fragment); i++) {
+			fragment[i] = image_byte(off + i);
+		}
+
+		err = dfu_target_mcuboot_write(fragment, sizeof(fragment));
+		zassert_equal(err, 0, NULL);
+
+		/* Time the download waits for the next fragment */
+		k_sleep(gap);
+	}
+}
+
+static void test_dfu_target_mcuboot_write(void)
+{
+	int err;
+	size_t offset;
+	struct dfu_target_mcuboot_stats stats;
+
+	slot_prepare();
+
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+	err = dfu_target_mcuboot_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, 0, NULL);
+
+	image_write(0, IMAGE_SIZE, K_MSEC(10));
+
+	err = dfu_target_mcuboot_stats_get(&stats);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(stats.writes, IMAGE_SIZE / FRAGMENT_SIZE, NULL);
+	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE)) {
+		zassert_equal(stats.pre_erases, IMAGE_PAGES,
+			      "All pages should be erased ahead of the data");
+		zassert_equal(stats.inline_erases, 0,
+			      "No page should be erased when writing");
+	} else {
+		zassert_equal(stats.pre_erases, 0, NULL);
+		zassert_equal(stats.inline_erases, IMAGE_PAGES, NULL);
+	}
+	zassert_equal(stats.checkpoints,
+		      IMAGE_SIZE / CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS_INTERVAL,
+		      "Incorrect number of checkpoints");
+
+	TC_PRINT("%d writes: %u us average, %u us max\n", stats.writes,
+		 stats.write_time / stats.writes, stats.write_time_max);
+	TC_PRINT("%d checkpoints: %u us, %d pages erased ahead: %u us\n",
+		 stats.checkpoints, stats.checkpoint_time,
+		 stats.pre_erases, stats.pre_erase_time);
+
+	slot_verify();
+
+	err = dfu_target_mcuboot_done(false);
+	zassert_equal(err, 0, NULL);
+}
+
+static void test_dfu_target_mcuboot_write_no_gap(void)
+{
+	int err;
+	struct dfu_target_mcuboot_stats stats;
+
+	slot_prepare();
+
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+
+	/* Data that arrives without waiting is written correctly, and every
+	 * page is erased exactly once.
+	 */
+	image_write(0, IMAGE_SIZE, K_NO_WAIT);
+
+	err = dfu_target_mcuboot_stats_get(&stats);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(stats.pre_erases + stats.inline_erases, IMAGE_PAGES,
+		      "Every page should be erased once");
+
+	TC_PRINT("%d writes: %u us average, %u us max, %d inline erases\n",
+		 stats.writes, stats.write_time / stats.writes,
+		 stats.write_time_max, stats.inline_erases);
+
+	slot_verify();
+
+	err = dfu_target_mcuboot_done(false);
+	zassert_equal(err, 0, NULL);
+}
+
+static void test_dfu_target_mcuboot_resume(void)
+{
+	int err;
+	size_t offset;
+
+	slot_prepare();
+
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+
+	image_write(0, IMAGE_SIZE / 2, K_MSEC(10));
+
+	/* The progress is restored from the last checkpoint */
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+	err = dfu_target_mcuboot_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, IMAGE_SIZE / 2, NULL);
+
+	image_write(offset, IMAGE_SIZE, K_MSEC(10));
+
+	slot_verify();
+
+	err = dfu_target_mcuboot_done(false);
+	zassert_equal(err, 0, NULL);
+}
+
+static void test_dfu_target_mcuboot_resume_mid_page(void)
+{
+	int err;
+	size_t offset;
+	size_t checkpoint;
+
+	slot_prepare();
+
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+
+	/* Flushing the buffer moves the following buffers out of alignment
+	 * with the pages, so the next checkpoint is in the middle of a page.
+	 */
+	image_write(0, FRAGMENT_SIZE, K_NO_WAIT);
+	err = dfu_target_mcuboot_flush();
+	zassert_equal(err, 0, NULL);
+
+	checkpoint = FRAGMENT_SIZE +
+		     ROUND_UP(CONFIG_DFU_TARGET_MCUBOOT_SAVE_PROGRESS_INTERVAL,
+			      PAGE_SIZE);
+	image_write(FRAGMENT_SIZE, checkpoint, K_NO_WAIT);
+
+	/* Data written after the checkpoint, before a reset */
+	image_write(checkpoint, checkpoint + FRAGMENT_SIZE, K_NO_WAIT);
+	err = dfu_target_mcuboot_flush();
+	zassert_equal(err, 0, NULL);
+
+	/* The download resumes from the start of the page that holds the
+	 * checkpoint, which is erased and written again.
+	 */
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+	err = dfu_target_mcuboot_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, ROUND_DOWN(checkpoint, PAGE_SIZE), NULL);
+
+	image_write(offset, IMAGE_SIZE, K_MSEC(10));
+
+	slot_verify();
+
+	err = dfu_target_mcuboot_done(false);
+	zassert_equal(err, 0, NULL);
+}
+
+static void test_dfu_target_mcuboot_restart(void)
+{
+	int err;
+	struct dfu_target_mcuboot_stats stats;
+
+	slot_prepare();
+
+	err = dfu_target_mcuboot_init(IMAGE_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+
+	image_write(0, IMAGE_SIZE / 2, K_MSEC(10));
+
+	err = dfu_target_mcuboot_done(false);
+	zassert_equal(err, 0, NULL);
+
+	/* dfu_target writes an aborted image again without initializing the
+	 * target, and the pages are still erased ahead of the data.
+	 */
+	image_write(0, IMAGE_SIZE, K_MSEC(10));
+
+	err = dfu_target_mcuboot_stats_get(&stats);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(stats.writes, IMAGE_SIZE / FRAGMENT_SIZE,
+		      "Statistics should start again with the image");
+	if (IS_ENABLED(CONFIG_DFU_TARGET_MCUBOOT_PRE_ERASE)) {
+		zassert_equal(stats.pre_erases, IMAGE_PAGES, NULL);
+		zassert_equal(stats.inline_erases, 0, NULL);
+	}
+
+	slot_verify();
+
+	err = dfu_target_mcuboot_done(false);
+	zassert_equal(err, 0, NULL);
+}
+
+static void flash_test_run(void)
+{
+	ztest_test_suite(lib_dfu_target_mcuboot_flash_test,
+	     ztest_unit_test(test_dfu_target_mcuboot_write),
+	     ztest_unit_test(test_dfu_target_mcuboot_write_no_gap),
+	     ztest_unit_test(test_dfu_target_mcuboot_resume),
+	     ztest_unit_test(test_dfu_target_mcuboot_resume_mid_page),
+	     ztest_unit_test(test_dfu_target_mcuboot_restart)
+	 );
+
+	ztest_run_test_suite(lib_dfu_target_mcuboot_flash_test);
+}
+#endif /* CONFIG_FLASH_SIMULATOR */
+
 void test_main(void)
 {
 	ztest_test_suite(lib_dfu_target_mcuboot_test,
@@ -100,4 +372,8 @@ void test_main(void)
 	 );
 
 	ztest_run_test_suite(lib_dfu_target_mcuboot_test);
+
+#if defined(CONFIG_FLASH_SIMULATOR)
+	flash_test_run();
+#endif
 }
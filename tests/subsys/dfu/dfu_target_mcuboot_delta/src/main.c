@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+#include <string.h>
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <ztest.h>
+#include <sys/byteorder.h>
+#include <storage/flash_map.h>
+#include <tinycrypt/sha256.h>
+#include <dfu_target.h>
+#include <dfu_target_mcuboot.h>
+#include <dfu_target_mcuboot_delta.h>
+
+#define SOURCE_SIZE 8192
+#define INSERT_SIZE 100
+/* Sum of the copies and the insert in delta_create() */
+#define TARGET_SIZE (3000 + INSERT_SIZE + 2000 + 3192)
+#define DELTA_SIZE_MAX (sizeof(struct dfu_delta_header) + INSERT_SIZE + 64)
+
+static uint8_t source[SOURCE_SIZE];
+static uint8_t target[TARGET_SIZE];
+static uint8_t delta[DELTA_SIZE_MAX];
+static size_t delta_len;
+static uint8_t buf[1024];
+
+static uint8_t source_byte(size_t off)
+{
+	return (uint8_t)(off * 13 + off / 256 + 1);
+}
+
+static void sha256(const uint8_t *data, size_t len, uint8_t *hash)
+{
+	struct tc_sha256_state_struct sha;
+
+	zassert_equal(tc_sha256_init(&sha), TC_CRYPTO_SUCCESS, NULL);
+	zassert_equal(tc_sha256_update(&sha, data, len), TC_CRYPTO_SUCCESS,
+		      NULL);
+	zassert_equal(tc_sha256_final(hash, &sha), TC_CRYPTO_SUCCESS, NULL);
+}
+
+static void varint_put(uint32_t value)
+{
+	while (value >= 0x80) {
+		delta[delta_len++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	delta[delta_len++] = value;
+}
+
+/* Append a copy to both the delta and the expected image */
+static void copy_put(size_t *source_pos, size_t *target_pos,
+		     int32_t rel, uint32_t len)
+{
+	uint32_t zigzag = (rel >= 0) ? ((uint32_t)rel << 1) :
+				       (((uint32_t)-rel << 1) - 1);
+
+	delta[delta_len++] = DFU_DELTA_OP_COPY;
+	varint_put(zigzag);
+	varint_put(len);
+
+	*source_pos += rel;
+	memcpy(&target[*target_pos], &source[*source_pos], len);
+	*source_pos += len;
+	*target_pos += len;
+}
+
+static void delta_create(void)
+{
+	struct dfu_delta_header *header = (struct dfu_delta_header *)delta;
+	size_t source_pos = 0;
+	size_t target_pos = 0;
+
+	for (size_t i = 0; i < SOURCE_SIZE; i++) {
+		source[i] = source_byte(i);
+	}
+
+	delta_len = sizeof(*header);
+
+	copy_put(&source_pos, &target_pos, 0, 3000);
+
+	delta[delta_len++] = DFU_DELTA_OP_INSERT;
+	varint_put(INSERT_SIZE);
+	for (size_t i = 0; i < INSERT_SIZE; i++) {
+		target[target_pos++] = delta[delta_len++] = 0xa5 ^ i;
+	}
+
+	/* A part moved backwards, then one moved forwards */
+	copy_put(&source_pos, &target_pos, -1000, 2000);
+	copy_put(&source_pos, &target_pos, 1000, 3192);
+
+	zassert_equal(target_pos, TARGET_SIZE, NULL);
+	zassert_true(delta_len <= sizeof(delta), NULL);
+
+	header->magic = sys_cpu_to_le32(DFU_DELTA_MAGIC);
+	header->version = sys_cpu_to_le32(DFU_DELTA_VERSION);
+	header->source_size = sys_cpu_to_le32(SOURCE_SIZE);
+	header->target_size = sys_cpu_to_le32(TARGET_SIZE);
+	sha256(source, SOURCE_SIZE, header->source_hash);
+	sha256(target, TARGET_SIZE, header->target_hash);
+}
+
+static void slot_erase(int id)
+{
+	const struct flash_area *fa;
+
+	zassert_equal(flash_area_open(id, &fa), 0, NULL);
+	zassert_equal(flash_area_erase(fa, 0, fa->fa_size), 0, NULL);
+	flash_area_close(fa);
+}
+
+static void slots_prepare(void)
+{
+	const struct flash_area *fa;
+
+	delta_create();
+
+	slot_erase(FLASH_AREA_ID(image_0));
+	slot_erase(FLASH_AREA_ID(image_1));
+
+	zassert_equal(flash_area_open(FLASH_AREA_ID(image_0), &fa), 0, NULL);
+	zassert_equal(flash_area_write(fa, 0, source, sizeof(source)), 0,
+		      NULL);
+	flash_area_close(fa);
+}
+
+static void slot_verify(void)
+{
+	const struct flash_area *fa;
+
+	zassert_equal(flash_area_open(FLASH_AREA_ID(image_1), &fa), 0, NULL);
+
+	for (size_t off = 0; off < TARGET_SIZE; off += sizeof(buf)) {
+		size_t len = MIN(sizeof(buf), TARGET_SIZE - off);
+
+		zassert_equal(flash_area_read(fa, off, buf, len), 0, NULL);
+		zassert_mem_equal(buf, &target[off], len,
+				  "Incorrect data at %d", off);
+	}
+
+	flash_area_close(fa);
+}
+
+static int delta_write(size_t start, size_t end, size_t fragment_size)
+{
+	size_t len;
+	int err;
+
+	for (size_t off = start; off < end; off += len) {
+		len = MIN(fragment_size, end - off);
+
+		err = dfu_target_mcuboot_delta_write(&delta[off], len);
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static void delta_apply(size_t fragment_size)
+{
+	int err;
+	size_t offset;
+
+	slots_prepare();
+
+	zassert_true(dfu_target_mcuboot_delta_identify(delta), NULL);
+
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = delta_write(0, delta_len, fragment_size);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, delta_len, NULL);
+
+	err = dfu_target_mcuboot_delta_done(true);
+	zassert_equal(err, 0, NULL);
+
+	slot_verify();
+}
+
+static void test_dfu_target_mcuboot_delta_apply(void)
+{
+	uint32_t start = k_cycle_get_32();
+
+	/* The whole delta in one write */
+	delta_apply(DELTA_SIZE_MAX);
+
+	TC_PRINT("%d byte image from %d byte delta in %u us\n", TARGET_SIZE,
+		 delta_len, k_cyc_to_us_floor32(k_cycle_get_32() - start));
+}
+
+static void test_dfu_target_mcuboot_delta_apply_fragmented(void)
+{
+	delta_apply(1);
+	delta_apply(7);
+	delta_apply(sizeof(struct dfu_delta_header) + 3);
+}
+
+static void test_dfu_target_mcuboot_delta_resume(void)
+{
+	int err;
+	size_t offset;
+
+	slots_prepare();
+
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = delta_write(0, delta_len / 2, 16);
+	zassert_equal(err, 0, NULL);
+
+	/* The download continues from the offset during the same boot */
+	err = dfu_target_mcuboot_delta_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, delta_len / 2, NULL);
+
+	err = delta_write(offset, delta_len, 16);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_done(true);
+	zassert_equal(err, 0, NULL);
+
+	slot_verify();
+}
+
+static void test_dfu_target_mcuboot_delta_stale_progress(void)
+{
+	int err;
+	size_t offset;
+
+	/* An interrupted upgrade with a full image leaves stored progress */
+	err = dfu_target_mcuboot_init(TARGET_SIZE, NULL);
+	zassert_equal(err, 0, NULL);
+
+	memset(buf, 0, sizeof(buf));
+	for (size_t off = 0; off < TARGET_SIZE / 2; off += sizeof(buf)) {
+		err = dfu_target_mcuboot_write(buf, sizeof(buf));
+		zassert_equal(err, 0, NULL);
+	}
+
+	err = dfu_target_mcuboot_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_true(offset > 0, "No progress stored");
+
+	/* The delta discards it and writes the image from the start */
+	delta_apply(DELTA_SIZE_MAX);
+}
+
+static void test_dfu_target_mcuboot_delta_wrong_source(void)
+{
+	int err;
+
+	slots_prepare();
+
+	/* A different image in the primary slot */
+	slot_erase(FLASH_AREA_ID(image_0));
+
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_write(delta, delta_len);
+	zassert_equal(err, -ENOEXEC, NULL);
+
+	err = dfu_target_mcuboot_delta_write(delta, delta_len);
+	zassert_equal(err, -EINVAL, "Writes after an error should fail");
+
+	err = dfu_target_mcuboot_delta_done(false);
+	zassert_equal(err, 0, NULL);
+}
+
+static void test_dfu_target_mcuboot_delta_corrupted(void)
+{
+	int err;
+
+	slots_prepare();
+
+	/* Last byte of the insert, which follows a 4 byte copy instruction
+	 * and a 2 byte insert instruction.
+	 */
+	delta[sizeof(struct dfu_delta_header) + 4 + 2 + INSERT_SIZE - 1] ^= 0xff;
+
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_write(delta, delta_len);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_done(true);
+	zassert_equal(err, -EINVAL, "Hash of the image should not match");
+}
+
+static void test_dfu_target_mcuboot_delta_invalid(void)
+{
+	int err;
+
+	slots_prepare();
+
+	/* Copy beyond the end of the source image */
+	delta_len = sizeof(struct dfu_delta_header);
+	delta[delta_len++] = DFU_DELTA_OP_COPY;
+	varint_put(0);
+	varint_put(SOURCE_SIZE + 1);
+
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_write(delta, delta_len);
+	zassert_equal(err, -EINVAL, NULL);
+
+	err = dfu_target_mcuboot_delta_done(false);
+	zassert_equal(err, 0, NULL);
+
+	/* Unknown instruction */
+	delta_len = sizeof(struct dfu_delta_header);
+	delta[delta_len++] = 0x7f;
+
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_write(delta, delta_len);
+	zassert_equal(err, -EINVAL, NULL);
+
+	err = dfu_target_mcuboot_delta_done(false);
+	zassert_equal(err, 0, NULL);
+
+	/* Incomplete image */
+	delta_create();
+	err = dfu_target_mcuboot_delta_init(delta_len, NULL);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_write(delta, delta_len - 1);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_mcuboot_delta_done(true);
+	zassert_equal(err, -EINVAL, NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lib_dfu_target_mcuboot_delta_test,
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_apply),
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_apply_fragmented),
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_resume),
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_stale_progress),
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_wrong_source),
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_corrupted),
+	     ztest_unit_test(test_dfu_target_mcuboot_delta_invalid)
+	 );
+
+	ztest_run_test_suite(lib_dfu_target_mcuboot_delta_test);
+}
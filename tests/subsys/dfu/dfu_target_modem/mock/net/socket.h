@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Socket API of the mock DFU socket, see src/mock_dfu_socket.c */
+
+#ifndef MOCK_NET_SOCKET_H__
+#define MOCK_NET_SOCKET_H__
+
+#include <zephyr/types.h>
+#include <sys/types.h>
+
+typedef uint32_t socklen_t;
+
+#define socket mock_dfu_socket
+#define close mock_dfu_close
+#define send mock_dfu_send
+#define getsockopt mock_dfu_getsockopt
+#define setsockopt mock_dfu_setsockopt
+
+int mock_dfu_socket(int family, int type, int proto);
+int mock_dfu_close(int fd);
+ssize_t mock_dfu_send(int fd, const void *buf, size_t len, int flags);
+int mock_dfu_getsockopt(int fd, int level, int optname, void *optval,
+			socklen_t *optlen);
+int mock_dfu_setsockopt(int fd, int level, int optname, const void *optval,
+			socklen_t optlen);
+
+#endif /* MOCK_NET_SOCKET_H__ */
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* DFU socket definitions of the modem library, for the mock DFU socket */
+
+#ifndef MOCK_NRF_SOCKET_H__
+#define MOCK_NRF_SOCKET_H__
+
+#define AF_LOCAL 1
+#define SOCK_STREAM 1
+#define NPROTO_DFU 515
+
+#define SOL_DFU 515
+#define SO_DFU_FW_VERSION 1
+#define SO_DFU_RESOURCES 2
+#define SO_DFU_TIMEO 3
+#define SO_DFU_APPLY 4
+#define SO_DFU_REVERT 5
+#define SO_DFU_BACKUP_DELETE 6
+#define SO_DFU_OFFSET 7
+#define SO_DFU_ERROR 20
+
+#define DFU_NO_ERROR 0
+#define DFU_RECEIVER_OUT_OF_MEMORY -1
+#define DFU_RECEIVER_BLOCK_TOO_LARGE -2
+#define DFU_INVALID_HEADER_DATA -3
+#define DFU_ZONE_NOT_SUPPORTED -4
+#define DFU_ZONE_SEQUENCE_VIOLATION -5
+#define DFU_INVALID_UUID -6
+#define DFU_BLOCK_OUT_OF_ORDER -7
+#define DFU_INVALID_FILE_OFFSET -8
+#define DFU_AREA_NOT_BLANK -9
+#define DFU_ERASE_PENDING -17
+
+#endif /* MOCK_NRF_SOCKET_H__ */
@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+#include <string.h>
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <ztest.h>
+#include <dfu_target.h>
+#include <dfu_target_modem.h>
+
+#include "mock_dfu_socket.h"
+
+#define IMAGE_SIZE (16 * 1024)
+#define FRAGMENT_SIZE 1024
+/* Time to download a fragment, and time for the modem to write it */
+#define NET_MS 20
+#define WRITE_MS_PER_KB 20
+
+static uint8_t image[IMAGE_SIZE];
+static int erase_done_count;
+
+static void callback(enum dfu_target_evt_id evt_id)
+{
+	if (evt_id == DFU_TARGET_EVT_ERASE_DONE) {
+		erase_done_count++;
+	}
+}
+
+static void setup(void)
+{
+	mock_dfu_reset();
+	erase_done_count = 0;
+
+	for (size_t i = 0; i < sizeof(image); i++) {
+		image[i] = (uint8_t)(i * 7 + i / 251);
+	}
+}
+
+static int image_write(size_t start, size_t end, uint32_t net_ms)
+{
+	size_t len;
+	int err;
+
+	for (size_t off = start; off < end; off += len) {
+		len = MIN(FRAGMENT_SIZE, end - off);
+
+		if (net_ms) {
+			k_sleep(K_MSEC(net_ms));
+		}
+
+		err = dfu_target_modem_write(&image[off], len);
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static void image_verify(void)
+{
+	zassert_mem_equal(mock_dfu_modem.image, image, IMAGE_SIZE,
+			  "Incorrect image in the modem");
+	zassert_equal(mock_dfu_modem.offset, IMAGE_SIZE, NULL);
+}
+
+static void test_dfu_target_modem_write(void)
+{
+	int err;
+	size_t offset;
+
+	setup();
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, 0, NULL);
+
+	/* Fragments larger than the write buffers are split */
+	err = dfu_target_modem_write(image, IMAGE_SIZE / 2 + 1);
+	zassert_equal(err, 0, NULL);
+
+	err = image_write(IMAGE_SIZE / 2 + 1, IMAGE_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	image_verify();
+	zassert_true(mock_dfu_modem.applied, NULL);
+	zassert_equal(mock_dfu_modem.sockets_open, 0, NULL);
+	zassert_equal(mock_dfu_modem.deletes, 0, NULL);
+}
+
+static void test_dfu_target_modem_resume(void)
+{
+	int err;
+	size_t offset;
+
+	setup();
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+
+	err = image_write(0, IMAGE_SIZE / 2, 0);
+	zassert_equal(err, 0, NULL);
+
+	/* The download is aborted, and started again after a reset */
+	err = dfu_target_modem_done(false);
+	zassert_equal(err, 0, NULL);
+	zassert_false(mock_dfu_modem.applied, NULL);
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+
+	/* Data that was not sent to the modem before the abort is dropped */
+	err = dfu_target_modem_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, mock_dfu_modem.offset, NULL);
+	zassert_true(offset > 0,
+		     "The stored data should not be written again");
+
+	err = image_write(offset, IMAGE_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	image_verify();
+	zassert_true(mock_dfu_modem.applied, NULL);
+	zassert_equal(mock_dfu_modem.deletes, 0, NULL);
+}
+
+static void test_dfu_target_modem_dirty(void)
+{
+	int err;
+	size_t offset;
+
+	setup();
+
+	/* The modem has data it cannot continue from */
+	mock_dfu_modem.dirty = true;
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mock_dfu_modem.deletes, 1, NULL);
+	zassert_equal(erase_done_count, 1, NULL);
+
+	err = dfu_target_modem_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, 0, NULL);
+
+	err = image_write(0, IMAGE_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	image_verify();
+}
+
+static void test_dfu_target_modem_invalid_offset(void)
+{
+	int err;
+	size_t offset;
+
+	setup();
+
+	/* The modem loses the last fragment it received */
+	mock_dfu_modem.fail_offset = 4 * FRAGMENT_SIZE;
+	mock_dfu_modem.rewind_offset = 3 * FRAGMENT_SIZE;
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+
+	err = image_write(0, IMAGE_SIZE, 0);
+	zassert_equal(err, -EAGAIN, NULL);
+
+	err = dfu_target_modem_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, 3 * FRAGMENT_SIZE, NULL);
+
+	/* The download continues from the offset the modem expects */
+	err = image_write(offset, IMAGE_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	image_verify();
+	zassert_equal(mock_dfu_modem.deletes, 0, NULL);
+}
+
+static void test_dfu_target_modem_not_blank(void)
+{
+	int err;
+	size_t offset;
+
+	setup();
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(mock_dfu_modem.deletes, 0, NULL);
+
+	/* The modem cannot write the data, although its offset is valid */
+	mock_dfu_modem.not_blank = true;
+
+	err = image_write(0, IMAGE_SIZE, 0);
+	zassert_equal(err, -EAGAIN, NULL);
+	zassert_equal(mock_dfu_modem.deletes, 1,
+		      "The stored data should be deleted");
+	zassert_equal(erase_done_count, 1, NULL);
+
+	err = dfu_target_modem_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, 0, NULL);
+
+	err = image_write(offset, IMAGE_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	image_verify();
+	zassert_equal(mock_dfu_modem.deletes, 1, NULL);
+}
+
+static void test_dfu_target_modem_offset_pending(void)
+{
+	int err;
+	size_t offset;
+
+	setup();
+	mock_dfu_modem.write_ms_per_kb = WRITE_MS_PER_KB;
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+
+	err = image_write(0, 2 * FRAGMENT_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	/* The offset includes the data that is still being sent, so that
+	 * a download restarted from it does not send that data again.
+	 */
+	err = dfu_target_modem_offset_get(&offset);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(offset, 2 * FRAGMENT_SIZE, NULL);
+	zassert_equal(mock_dfu_modem.offset, offset, NULL);
+
+	err = image_write(offset, IMAGE_SIZE, 0);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	image_verify();
+}
+
+static void test_dfu_target_modem_pipelined(void)
+{
+	uint32_t fragments = IMAGE_SIZE / FRAGMENT_SIZE;
+	uint32_t serial_ms = fragments *
+			     (NET_MS + WRITE_MS_PER_KB * FRAGMENT_SIZE / 1024);
+	int64_t start;
+	int64_t elapsed;
+	int err;
+
+	setup();
+	mock_dfu_modem.write_ms_per_kb = WRITE_MS_PER_KB;
+
+	err = dfu_target_modem_init(IMAGE_SIZE, callback);
+	zassert_equal(err, 0, NULL);
+
+	start = k_uptime_get();
+
+	err = image_write(0, IMAGE_SIZE, NET_MS);
+	zassert_equal(err, 0, NULL);
+
+	err = dfu_target_modem_done(true);
+	zassert_equal(err, 0, NULL);
+
+	elapsed = k_uptime_get() - start;
+
+	TC_PRINT("%d byte image in %d ms, %d ms without pipelining\n",
+		 IMAGE_SIZE, (int)elapsed, serial_ms);
+
+	/* The modem writes a fragment while the next one is downloaded */
+	zassert_true(elapsed < serial_ms * 3 / 4,
+		     "Download and modem writes should overlap");
+
+	image_verify();
+}
+
+static void test_dfu_target_modem_too_big(void)
+{
+	int err;
+
+	setup();
+
+	err = dfu_target_modem_init(MOCK_DFU_SCRATCH_SIZE + 1, callback);
+	zassert_equal(err, -EFBIG, NULL);
+	zassert_equal(mock_dfu_modem.sockets_open, 0,
+		      "The socket should be closed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lib_dfu_target_modem_test,
+	     ztest_unit_test(test_dfu_target_modem_write),
+	     ztest_unit_test(test_dfu_target_modem_resume),
+	     ztest_unit_test(test_dfu_target_modem_dirty),
+	     ztest_unit_test(test_dfu_target_modem_invalid_offset),
+	     ztest_unit_test(test_dfu_target_modem_not_blank),
+	     ztest_unit_test(test_dfu_target_modem_offset_pending),
+	     ztest_unit_test(test_dfu_target_modem_pipelined),
+	     ztest_unit_test(test_dfu_target_modem_too_big)
+	 );
+
+	ztest_run_test_suite(lib_dfu_target_modem_test);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Mock of the modem DFU socket, to test the modem DFU target without a
+ * modem.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <errno.h>
+#include <ztest.h>
+#include <net/socket.h>
+#include <nrf_socket.h>
+
+#include "mock_dfu_socket.h"
+
+#define MOCK_DFU_FD 3
+#define DIRTY_IMAGE 0x280000
+#define NO_FAIL_OFFSET UINT32_MAX
+
+struct mock_dfu_modem mock_dfu_modem;
+static int modem_error;
+
+void mock_dfu_reset(void)
+{
+	memset(&mock_dfu_modem, 0, sizeof(mock_dfu_modem));
+	mock_dfu_modem.fail_offset = NO_FAIL_OFFSET;
+	modem_error = DFU_NO_ERROR;
+}
+
+static int modem_fail(int err)
+{
+	modem_error = err;
+	errno = ENOEXEC;
+	return -1;
+}
+
+int mock_dfu_socket(int family, int type, int proto)
+{
+	zassert_equal(family, AF_LOCAL, NULL);
+	zassert_equal(proto, NPROTO_DFU, NULL);
+	zassert_equal(mock_dfu_modem.sockets_open, 0,
+		      "Only one DFU socket can be open");
+
+	mock_dfu_modem.sockets_open++;
+	return MOCK_DFU_FD;
+}
+
+int mock_dfu_close(int fd)
+{
+	zassert_equal(fd, MOCK_DFU_FD, NULL);
+	zassert_equal(mock_dfu_modem.sockets_open, 1, "Socket not open");
+
+	mock_dfu_modem.sockets_open--;
+	return 0;
+}
+
+ssize_t mock_dfu_send(int fd, const void *buf, size_t len, int flags)
+{
+	struct mock_dfu_modem *modem = &mock_dfu_modem;
+
+	zassert_equal(fd, MOCK_DFU_FD, NULL);
+	zassert_equal(modem->sockets_open, 1, "Socket not open");
+
+	if (modem->offset == modem->fail_offset) {
+		modem->fail_offset = NO_FAIL_OFFSET;
+		modem->offset = modem->rewind_offset;
+		return modem_fail(DFU_INVALID_FILE_OFFSET);
+	}
+
+	if (modem->dirty || modem->not_blank) {
+		return modem_fail(DFU_AREA_NOT_BLANK);
+	}
+
+	if (modem->offset + len > sizeof(modem->image)) {
+		return modem_fail(DFU_RECEIVER_OUT_OF_MEMORY);
+	}
+
+	/* The modem writes the data to flash before send() returns */
+	k_sleep(K_MSEC(modem->write_ms_per_kb * len / 1024));
+
+	memcpy(&modem->image[modem->offset], buf, len);
+	modem->offset += len;
+
+	return len;
+}
+
+int mock_dfu_getsockopt(int fd, int level, int optname, void *optval,
+			socklen_t *optlen)
+{
+	struct mock_dfu_modem *modem = &mock_dfu_modem;
+	static const char version[36] = "mfw_nrf9160_1.2.2";
+
+	zassert_equal(fd, MOCK_DFU_FD, NULL);
+	zassert_equal(level, SOL_DFU, NULL);
+
+	switch (optname) {
+	case SO_DFU_FW_VERSION:
+		zassert_true(*optlen >= sizeof(version), NULL);
+		memcpy(optval, version, sizeof(version));
+		return 0;
+	case SO_DFU_RESOURCES:
+		zassert_equal(*optlen, sizeof(uint32_t), NULL);
+		*(uint32_t *)optval = sizeof(modem->image);
+		return 0;
+	case SO_DFU_OFFSET:
+		zassert_equal(*optlen, sizeof(uint32_t), NULL);
+		if (modem->erase_polls > 0) {
+			modem->erase_polls--;
+			return modem_fail(DFU_ERASE_PENDING);
+		}
+		*(uint32_t *)optval = modem->dirty ? DIRTY_IMAGE :
+						     modem->offset;
+		return 0;
+	case SO_DFU_ERROR:
+		zassert_equal(*optlen, sizeof(int), NULL);
+		*(int *)optval = modem_error;
+		return 0;
+	default:
+		zassert_unreachable("Unexpected option %d", optname);
+		return -1;
+	}
+}
+
+int mock_dfu_setsockopt(int fd, int level, int optname, const void *optval,
+			socklen_t optlen)
+{
+	struct mock_dfu_modem *modem = &mock_dfu_modem;
+	uint32_t offset;
+
+	zassert_equal(fd, MOCK_DFU_FD, NULL);
+	zassert_equal(level, SOL_DFU, NULL);
+
+	switch (optname) {
+	case SO_DFU_OFFSET:
+		zassert_equal(optlen, sizeof(uint32_t), NULL);
+		offset = *(const uint32_t *)optval;
+		if (offset > modem->offset) {
+			return modem_fail(DFU_INVALID_FILE_OFFSET);
+		}
+		modem->offset = offset;
+		return 0;
+	case SO_DFU_BACKUP_DELETE:
+		memset(modem->image, 0xff, sizeof(modem->image));
+		modem->offset = 0;
+		modem->dirty = false;
+		modem->not_blank = false;
+		modem->erase_polls = 2;
+		modem->deletes++;
+		return 0;
+	case SO_DFU_APPLY:
+		modem->applied = true;
+		return 0;
+	default:
+		zassert_unreachable("Unexpected option %d", optname);
+		return -1;
+	}
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef MOCK_DFU_SOCKET_H__
+#define MOCK_DFU_SOCKET_H__
+
+#include <zephyr.h>
+
+#define MOCK_DFU_SCRATCH_SIZE 0x8000
+
+/* State of the modem behind the mock DFU socket. The stored data and
+ * offset persist across sockets, like they do across resets.
+ */
+struct mock_dfu_modem {
+	uint8_t image[MOCK_DFU_SCRATCH_SIZE];
+	uint32_t offset;
+	/* The stored data must be deleted before a new upgrade */
+	bool dirty;
+	/* The area after the offset is not blank, while the offset is read
+	 * as valid.
+	 */
+	bool not_blank;
+	/* Offset reads that report DFU_ERASE_PENDING after a delete */
+	int erase_polls;
+	/* Time the modem takes to write a kilobyte to flash */
+	uint32_t write_ms_per_kb;
+	/* Fail the send at this offset with DFU_INVALID_FILE_OFFSET, and
+	 * continue from rewind_offset.
+	 */
+	uint32_t fail_offset;
+	uint32_t rewind_offset;
+	bool applied;
+	int deletes;
+	int sockets_open;
+};
+
+extern struct mock_dfu_modem mock_dfu_modem;
+
+/** Reset the modem to a state without stored data. */
+void mock_dfu_reset(void);
+
+#endif /* MOCK_DFU_SOCKET_H__ */
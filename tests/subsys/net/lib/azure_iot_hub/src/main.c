@@ -10,6 +10,11 @@
 
 #include "azure_iot_hub_topic.h"
 
+#define assert_prop_bag(_bag, _key, _value)				       \
+	zassert_true(topic_prop_bag_key_eq(_bag, _key) &&		       \
+		     topic_prop_bag_value_eq(_bag, _value),		       \
+		     "Incorrect property bag")
+
 static void test_topic_parse_devicebound(void)
 {
 	int err;
@@ -44,8 +49,7 @@ static void test_topic_parse_twin_update_desired(void)
 		      "Incorrect topic type");
 	zassert_equal(topic_data.prop_bag_count, 1,
 		      "Incorrect property bag count");
-	zassert_true(strcmp(topic_data.prop_bag[0].key, "$version") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[0].value, "9") == 0, NULL);
+	assert_prop_bag(&topic_data.prop_bag[0], "$version", "9");
 }
 
 static void test_topic_parse_twin_update_result(void)
@@ -65,10 +69,8 @@ static void test_topic_parse_twin_update_result(void)
 	zassert_equal(topic_data.status, 200, NULL);
 	zassert_equal(topic_data.prop_bag_count, 2,
 		      "Incorrect property bag count");
-	zassert_true(strcmp(topic_data.prop_bag[0].key, "$rid") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[0].value, "738") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].key, "$version") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].value, "135") == 0, NULL);
+	assert_prop_bag(&topic_data.prop_bag[0], "$rid", "738");
+	assert_prop_bag(&topic_data.prop_bag[1], "$version", "135");
 }
 
 static void test_topic_parse_direct_method(void)
@@ -88,8 +90,7 @@ static void test_topic_parse_direct_method(void)
 	zassert_true(strcmp(topic_data.name, "my_method") == 0, NULL);
 	zassert_equal(topic_data.prop_bag_count, 1,
 		      "Incorrect property bag count");
-	zassert_true(strcmp(topic_data.prop_bag[0].key, "$rid") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[0].value, "387") == 0, NULL);
+	assert_prop_bag(&topic_data.prop_bag[0], "$rid", "387");
 }
 
 static void test_topic_parse_dps_reg_result(void)
@@ -110,11 +111,8 @@ static void test_topic_parse_dps_reg_result(void)
 	zassert_equal(topic_data.status, 204, NULL);
 	zassert_equal(topic_data.prop_bag_count, 2,
 		      "Incorrect property bag count");
-	zassert_true(strcmp(topic_data.prop_bag[0].key, "$rid") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[0].value, "59765") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].key, "retry-after") == 0,
-			    NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].value, "3") == 0, NULL);
+	assert_prop_bag(&topic_data.prop_bag[0], "$rid", "59765");
+	assert_prop_bag(&topic_data.prop_bag[1], "retry-after", "3");
 }
 
 static void test_topic_parse_prop_bag_overload(void)
@@ -136,11 +134,8 @@ static void test_topic_parse_prop_bag_overload(void)
 	zassert_equal(topic_data.status, 204, NULL);
 	zassert_equal(topic_data.prop_bag_count, 5,
 		      "Incorrect property bag count");
-	zassert_true(strcmp(topic_data.prop_bag[0].key, "$rid") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[0].value, "59765") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].key, "retry-after") == 0,
-			    NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].value, "3") == 0, NULL);
+	assert_prop_bag(&topic_data.prop_bag[0], "$rid", "59765");
+	assert_prop_bag(&topic_data.prop_bag[1], "retry-after", "3");
 }
 
 static void test_topic_parse_unknown_topic(void)
@@ -162,6 +157,22 @@ static void test_topic_parse_unknown_topic(void)
 		      "Incorrect property bag count");
 }
 
+static void test_topic_parse_devices_not_devicebound(void)
+{
+	int err;
+	const char *topic = "devices/my-device/messages/events/?key=value";
+	struct topic_parser_data topic_data = {
+		.topic = topic,
+		.topic_len = strlen(topic),
+		.type = TOPIC_TYPE_UNKNOWN,
+	};
+
+	err = azure_iot_hub_topic_parse(&topic_data);
+	zassert_equal(err, 0, NULL);
+	zassert_equal(topic_data.type, TOPIC_TYPE_UNEXPECTED,
+		      "Incorrect topic type");
+}
+
 static void test_topic_add_prop_bags(void)
 {
 	char *key1 = "key1";
@@ -242,20 +253,13 @@ static void test_topic_parse_long(void)
 		      "Incorrect topic type");
 	zassert_equal(topic_data.prop_bag_count, 5,
 		      "Incorrect property bag count");
-	zassert_true(strcmp(topic_data.prop_bag[0].key, "%24.mid") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[0].value,
-			    "456132-235-a2fd-8458-56432854d") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].key, "%24.to") == 0,
-			    NULL);
-	zassert_true(strcmp(topic_data.prop_bag[1].value,
-		     "%2Fdevices%2Fmy-device%2Fmessages%2Fdevicebound") == 0,
-		     NULL);
-	zassert_true(strcmp(topic_data.prop_bag[2].key, "key1") == 0, NULL);
-	zassert_equal(strlen(topic_data.prop_bag[2].value), 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[3].key, "key2") == 0, NULL);
-	zassert_equal(strlen(topic_data.prop_bag[3].value), 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[4].key, "key3") == 0, NULL);
-	zassert_true(strcmp(topic_data.prop_bag[4].value, "value3") == 0, NULL);
+	assert_prop_bag(&topic_data.prop_bag[0], "%24.mid",
+			"456132-235-a2fd-8458-56432854d");
+	assert_prop_bag(&topic_data.prop_bag[1], "%24.to",
+			"%2Fdevices%2Fmy-device%2Fmessages%2Fdevicebound");
+	assert_prop_bag(&topic_data.prop_bag[2], "key1", "");
+	assert_prop_bag(&topic_data.prop_bag[3], "key2", "");
+	assert_prop_bag(&topic_data.prop_bag[4], "key3", "value3");
 }
 
 static void test_topic_prop_bag_too_long(void)
@@ -278,6 +282,204 @@ static void test_topic_prop_bag_too_long(void)
 		      "Incorrect property bag count");
 }
 
+static void test_topic_url_decode(void)
+{
+	int len;
+	char buf[48];
+	const char *topic =
+		"devices/my-device/messages/devicebound/"
+		"%24.to=%2Fdevices%2Fmy-device%2Fmessages%2Fdevicebound";
+	struct topic_parser_data topic_data = {
+		.topic = topic,
+		.topic_len = strlen(topic),
+		.type = TOPIC_TYPE_UNKNOWN,
+	};
+
+	zassert_equal(azure_iot_hub_topic_parse(&topic_data), 0, NULL);
+	zassert_equal(topic_data.prop_bag_count, 1,
+		      "Incorrect property bag count");
+
+	len = topic_url_decode(topic_data.prop_bag[0].key,
+			       topic_data.prop_bag[0].key_len,
+			       buf, sizeof(buf));
+	zassert_equal(len, strlen("$.to"), NULL);
+	zassert_equal(strcmp(buf, "$.to"), 0, NULL);
+
+	len = topic_url_decode(topic_data.prop_bag[0].value,
+			       topic_data.prop_bag[0].value_len,
+			       buf, sizeof(buf));
+	zassert_equal(len, strlen("/devices/my-device/messages/devicebound"),
+		      NULL);
+	zassert_equal(strcmp(buf, "/devices/my-device/messages/devicebound"),
+		      0, NULL);
+
+	len = topic_url_decode(topic_data.prop_bag[0].value,
+			       topic_data.prop_bag[0].value_len, buf, 8);
+	zassert_equal(len, -ENOMEM, NULL);
+
+	len = topic_url_decode("bad%2", strlen("bad%2"), buf, sizeof(buf));
+	zassert_equal(len, -EINVAL, NULL);
+
+	len = topic_url_decode("bad%zz", strlen("bad%zz"), buf, sizeof(buf));
+	zassert_equal(len, -EINVAL, NULL);
+}
+
+static void test_topic_prop_bags_export(void)
+{
+	int err;
+	char buf[TOPIC_PROP_BAG_BUF_SIZE];
+	struct azure_iot_hub_prop_bag bags[TOPIC_PROP_BAG_COUNT];
+	const char *topic = "devices/my-device/messages/devicebound/"
+			    "?key1=value1&key2=&key3";
+	struct topic_parser_data topic_data = {
+		.topic = topic,
+		.topic_len = strlen(topic),
+		.type = TOPIC_TYPE_UNKNOWN,
+	};
+
+	zassert_equal(azure_iot_hub_topic_parse(&topic_data), 0, NULL);
+	zassert_equal(topic_data.prop_bag_count, 3,
+		      "Incorrect property bag count");
+
+	err = topic_prop_bags_export(&topic_data, bags, buf, sizeof(buf));
+	zassert_equal(err, 0, NULL);
+	zassert_equal(strcmp(bags[0].key, "key1"), 0, NULL);
+	zassert_equal(strcmp(bags[0].value, "value1"), 0, NULL);
+	zassert_equal(strcmp(bags[1].key, "key2"), 0, NULL);
+	zassert_equal(strcmp(bags[1].value, ""), 0, NULL);
+	zassert_equal(strcmp(bags[2].key, "key3"), 0, NULL);
+	zassert_equal(strcmp(bags[2].value, ""), 0, NULL);
+
+	err = topic_prop_bags_export(&topic_data, bags, buf, 10);
+	zassert_equal(err, -ENOMEM, NULL);
+}
+
+static void test_topic_prop_bags_export_decoded(void)
+{
+	int err;
+	char buf[TOPIC_PROP_BAG_BUF_SIZE];
+	struct azure_iot_hub_prop_bag bags[TOPIC_PROP_BAG_COUNT];
+	const char *topic = "devices/my-device/messages/devicebound/"
+			    "?%24.to=%2Fdevices%2Fmy-device&key%20a=b%26c";
+	const char *bad_topic = "devices/my-device/messages/devicebound/"
+				"?key=bad%2";
+	struct topic_parser_data topic_data = {
+		.topic = topic,
+		.topic_len = strlen(topic),
+		.type = TOPIC_TYPE_UNKNOWN,
+	};
+
+	zassert_equal(azure_iot_hub_topic_parse(&topic_data), 0, NULL);
+	zassert_equal(topic_data.prop_bag_count, 2,
+		      "Incorrect property bag count");
+
+	err = topic_prop_bags_export(&topic_data, bags, buf, sizeof(buf));
+	zassert_equal(err, 0, NULL);
+	zassert_equal(strcmp(bags[0].key, "$.to"), 0, NULL);
+	zassert_equal(strcmp(bags[0].value, "/devices/my-device"), 0, NULL);
+	zassert_equal(strcmp(bags[1].key, "key a"), 0, NULL);
+	zassert_equal(strcmp(bags[1].value, "b&c"), 0, NULL);
+
+	topic_data.topic = bad_topic;
+	topic_data.topic_len = strlen(bad_topic);
+	topic_data.type = TOPIC_TYPE_UNKNOWN;
+
+	zassert_equal(azure_iot_hub_topic_parse(&topic_data), 0, NULL);
+
+	err = topic_prop_bags_export(&topic_data, bags, buf, sizeof(buf));
+	zassert_equal(err, -EINVAL, NULL);
+}
+
+static void test_topic_prop_bag_uint_get(void)
+{
+	uint32_t val;
+	const char *topic = "$iothub/methods/POST/reboot/"
+			    "?$rid=42&big=4294967296&text=4x";
+	struct topic_parser_data topic_data = {
+		.topic = topic,
+		.topic_len = strlen(topic),
+		.type = TOPIC_TYPE_UNKNOWN,
+	};
+
+	zassert_equal(azure_iot_hub_topic_parse(&topic_data), 0, NULL);
+	zassert_equal(topic_data.prop_bag_count, 3,
+		      "Incorrect property bag count");
+	zassert_equal(topic_prop_bag_uint_get(&topic_data.prop_bag[0], &val),
+		      0, NULL);
+	zassert_equal(val, 42, NULL);
+	zassert_equal(topic_prop_bag_uint_get(&topic_data.prop_bag[1], &val),
+		      -ERANGE, NULL);
+	zassert_equal(topic_prop_bag_uint_get(&topic_data.prop_bag[2], &val),
+		      -EINVAL, NULL);
+}
+
+#define BENCHMARK_ITERATIONS 10000
+
+/* Topics as received from IoT Hub and DPS. */
+static const char *const benchmark_topics[] = {
+	"devices/my-device/messages/devicebound/"
+	"%24.mid=456132-235-a2fd-8458-56432854d&"
+	"%24.to=%2Fdevices%2Fmy-device%2Fmessages%2Fdevicebound&"
+	"led=on&color=red",
+	"$iothub/twin/PATCH/properties/desired/?$version=9",
+	"$iothub/twin/res/200/?$rid=738",
+	"$iothub/twin/res/204/?$rid=739&$version=135",
+	"$iothub/methods/POST/reboot/?$rid=387",
+	"$dps/registrations/res/202/?$rid=59765&retry-after=3",
+};
+
+static void test_topic_parse_benchmark(void)
+{
+	uint32_t start, parse_cycles, decode_cycles;
+	volatile size_t sink = 0;
+	char buf[TOPIC_PROP_BAG_FIELD_MAX_LEN + 1];
+	struct topic_parser_data topic_data;
+	const struct topic_parser_prop_bag *bag;
+
+	start = k_cycle_get_32();
+	for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+		const char *topic =
+			benchmark_topics[n % ARRAY_SIZE(benchmark_topics)];
+
+		topic_data.topic = topic;
+		topic_data.topic_len = strlen(topic);
+		topic_data.type = TOPIC_TYPE_UNKNOWN;
+
+		zassert_equal(azure_iot_hub_topic_parse(&topic_data), 0, NULL);
+		sink += topic_data.prop_bag_count;
+	}
+	parse_cycles = k_cycle_get_32() - start;
+
+	/* Decoding cost of every property bag value, paid only by the
+	 * property bags that are actually read.
+	 */
+	start = k_cycle_get_32();
+	for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+		const char *topic =
+			benchmark_topics[n % ARRAY_SIZE(benchmark_topics)];
+
+		topic_data.topic = topic;
+		topic_data.topic_len = strlen(topic);
+		topic_data.type = TOPIC_TYPE_UNKNOWN;
+
+		(void)azure_iot_hub_topic_parse(&topic_data);
+
+		for (size_t i = 0; i < topic_data.prop_bag_count; i++) {
+			bag = &topic_data.prop_bag[i];
+			sink += topic_url_decode(bag->value, bag->value_len,
+						 buf, sizeof(buf));
+		}
+	}
+	decode_cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("Topic parsing, %d topics, %d messages:\n",
+		 ARRAY_SIZE(benchmark_topics), BENCHMARK_ITERATIONS);
+	TC_PRINT("\tparse:              %u cycles/message\n",
+		 parse_cycles / BENCHMARK_ITERATIONS);
+	TC_PRINT("\tparse, decode all:  %u cycles/message\n",
+		 decode_cycles / BENCHMARK_ITERATIONS);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(azure_iot_hub_topic,
@@ -288,10 +490,16 @@ void test_main(void)
 			 ztest_unit_test(test_topic_parse_dps_reg_result),
 			 ztest_unit_test(test_topic_parse_prop_bag_overload),
 			 ztest_unit_test(test_topic_parse_unknown_topic),
+			 ztest_unit_test(test_topic_parse_devices_not_devicebound),
 			 ztest_unit_test(test_topic_add_prop_bags),
 			 ztest_unit_test(test_topic_add_prop_bags_reverse),
 			 ztest_unit_test(test_topic_parse_long),
-			 ztest_unit_test(test_topic_prop_bag_too_long)
+			 ztest_unit_test(test_topic_prop_bag_too_long),
+			 ztest_unit_test(test_topic_url_decode),
+			 ztest_unit_test(test_topic_prop_bags_export),
+			 ztest_unit_test(test_topic_prop_bags_export_decoded),
+			 ztest_unit_test(test_topic_prop_bag_uint_get),
+			 ztest_unit_test(test_topic_parse_benchmark)
 			 );
 	ztest_run_test_suite(azure_iot_hub_topic);
 }
@@ -32,6 +32,10 @@ static uint32_t s0_version;
 static uint32_t s1_version;
 const char *download_client_start_file;
 char *dfu_ctx_mcuboot_set_b1_file__update;
+static download_client_callback_t download_client_callback;
+static int dfu_target_write_err;
+static int dfu_target_done_count;
+static struct fota_download_evt last_evt;
 
 int dfu_target_init(int img_type, size_t file_size)
 {
@@ -45,15 +49,22 @@ int dfu_target_img_type(const void *const buf, size_t len)
 
 int dfu_target_offset_get(size_t *offset)
 {
+	*offset = 0;
 	return 0;
 }
 
 int dfu_target_write(const void *const buf, size_t len)
 {
-	return 0;
+	return dfu_target_write_err;
 }
 
 int dfu_target_done(bool successful)
+{
+	dfu_target_done_count++;
+	return 0;
+}
+
+int dfu_target_hash_set(const uint8_t *hash)
 {
 	return 0;
 }
@@ -78,6 +89,7 @@ int download_client_file_size_get(struct download_client *client, size_t *size)
 int download_client_init(struct download_client *client,
 			 download_client_callback_t callback)
 {
+	download_client_callback = callback;
 	return 0;
 }
 
@@ -111,7 +123,10 @@ int dfu_ctx_mcuboot_set_b1_file(char *file, bool s0_active, char **update)
 
 /* END stubs and mocks */
 
-void client_callback(enum fota_download_evt_id evt_id) { }
+void client_callback(const struct fota_download_evt *evt)
+{
+	last_evt = *evt;
+}
 
 static void init(void)
 {
@@ -166,10 +181,72 @@ static void test_fota_download_start(void)
 	zassert_true(strcmp(download_client_start_file, S1) == 0, NULL);
 }
 
+static void test_fota_download_start_with_hash(void)
+{
+	int err;
+	const uint8_t hash[32] = {0};
+
+	init();
+
+	dfu_ctx_mcuboot_set_b1_file__update = NULL;
+	strcpy(buf, S0_S1);
+	err = fota_download_start_with_hash("something.com", buf, NO_TLS,
+					    DEFAULT_APN, 0, NULL);
+	zassert_equal(err, 0, NULL);
+
+	/* Hashing is not enabled in this test */
+	err = fota_download_start_with_hash("something.com", buf, NO_TLS,
+					    DEFAULT_APN, 0, hash);
+	zassert_equal(err, -ENOTSUP, NULL);
+}
+
+static void test_fota_download_offset_retries(void)
+{
+	int err;
+	const struct download_client_evt fragment = {
+		.id = DOWNLOAD_CLIENT_EVT_FRAGMENT,
+		.fragment = {
+			.buf = buf,
+			.len = 32,
+		},
+	};
+
+	init();
+
+	dfu_ctx_mcuboot_set_b1_file__update = NULL;
+	strcpy(buf, S0_S1);
+	err = fota_download_start("something.com", buf, NO_TLS, DEFAULT_APN, 0);
+	zassert_equal(err, 0, NULL);
+
+	dfu_target_done_count = 0;
+	memset(&last_evt, 0, sizeof(last_evt));
+
+	/* The target keeps asking for another offset. The download restarts
+	 * a limited number of times, and then fails.
+	 */
+	dfu_target_write_err = -EAGAIN;
+	for (int i = 0; i < CONFIG_FOTA_OFFSET_RETRIES; i++) {
+		err = download_client_callback(&fragment);
+		zassert_equal(err, -1, "The download should restart");
+		zassert_equal(dfu_target_done_count, 0, NULL);
+	}
+
+	err = download_client_callback(&fragment);
+	zassert_equal(err, -EAGAIN, "The download should stop");
+	zassert_equal(dfu_target_done_count, 1, NULL);
+	zassert_equal(last_evt.id, FOTA_DOWNLOAD_EVT_ERROR, NULL);
+	zassert_equal(last_evt.cause, FOTA_DOWNLOAD_ERROR_CAUSE_DOWNLOAD_FAILED,
+		      NULL);
+
+	dfu_target_write_err = 0;
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_fota_download_test,
-	     ztest_unit_test(test_fota_download_start)
+	     ztest_unit_test(test_fota_download_start),
+	     ztest_unit_test(test_fota_download_start_with_hash),
+	     ztest_unit_test(test_fota_download_offset_retries)
 	 );
 
 	ztest_run_test_suite(lib_fota_download_test);
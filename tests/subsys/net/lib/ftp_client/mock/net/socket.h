@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Replaces the socket API for the FTP client test. The sockets are served
+ * by the simulated FTP server in src/socket_mock.c.
+ */
+
+#ifndef SOCKET_MOCK_NET_SOCKET_H_
+#define SOCKET_MOCK_NET_SOCKET_H_
+
+#include <zephyr/types.h>
+#include <net/net_ip.h>
+#include <net/tls_credentials.h>
+
+#define SOL_TLS 282
+#define TLS_SEC_TAG_LIST 1
+
+#define POLLIN 0x1
+
+struct pollfd {
+	int fd;
+	short events;
+	short revents;
+};
+
+struct addrinfo {
+	struct addrinfo *ai_next;
+	int ai_flags;
+	int ai_family;
+	int ai_socktype;
+	int ai_protocol;
+	socklen_t ai_addrlen;
+	struct sockaddr *ai_addr;
+	char *ai_canonname;
+};
+
+int zsock_socket(int family, int type, int proto);
+int zsock_close(int sock);
+int zsock_connect(int sock, const struct sockaddr *addr, socklen_t addrlen);
+ssize_t zsock_send(int sock, const void *buf, size_t len, int flags);
+ssize_t zsock_recv(int sock, void *buf, size_t max_len, int flags);
+int zsock_poll(struct pollfd *fds, int nfds, int timeout);
+int zsock_setsockopt(int sock, int level, int optname, const void *optval,
+		     socklen_t optlen);
+int zsock_getaddrinfo(const char *host, const char *service,
+		      const struct addrinfo *hints, struct addrinfo **res);
+void zsock_freeaddrinfo(struct addrinfo *ai);
+
+static inline int socket(int family, int type, int proto)
+{
+	return zsock_socket(family, type, proto);
+}
+
+static inline int close(int sock)
+{
+	return zsock_close(sock);
+}
+
+static inline int connect(int sock, const struct sockaddr *addr,
+			  socklen_t addrlen)
+{
+	return zsock_connect(sock, addr, addrlen);
+}
+
+static inline ssize_t send(int sock, const void *buf, size_t len, int flags)
+{
+	return zsock_send(sock, buf, len, flags);
+}
+
+static inline ssize_t recv(int sock, void *buf, size_t max_len, int flags)
+{
+	return zsock_recv(sock, buf, max_len, flags);
+}
+
+static inline int poll(struct pollfd *fds, int nfds, int timeout)
+{
+	return zsock_poll(fds, nfds, timeout);
+}
+
+static inline int setsockopt(int sock, int level, int optname,
+			     const void *optval, socklen_t optlen)
+{
+	return zsock_setsockopt(sock, level, optname, optval, optlen);
+}
+
+static inline int getaddrinfo(const char *host, const char *service,
+			      const struct addrinfo *hints,
+			      struct addrinfo **res)
+{
+	return zsock_getaddrinfo(host, service, hints, res);
+}
+
+static inline void freeaddrinfo(struct addrinfo *ai)
+{
+	zsock_freeaddrinfo(ai);
+}
+
+#endif /* SOCKET_MOCK_NET_SOCKET_H_ */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <net/ftp_client.h>
+
+#include "socket_mock.h"
+
+#define NO_TLS -1
+#define FILE_SIZE 1500
+#define UPLOAD_SIZE 1000
+#define RESUME_OFFSET 400
+
+static uint8_t file[FILE_SIZE];
+static uint8_t buf[FILE_SIZE];
+static uint32_t ctrl_msg_count;
+
+static void ctrl_callback(const uint8_t *msg, uint16_t len)
+{
+	ctrl_msg_count++;
+}
+
+static void data_callback(const uint8_t *msg, uint16_t len)
+{
+}
+
+static void test_ftp_connect(void)
+{
+	int ret;
+
+	for (size_t i = 0; i < sizeof(file); i++) {
+		file[i] = (uint8_t)(i * 7);
+	}
+
+	server_reset();
+	server_file_set(file, sizeof(file));
+
+	ret = ftp_init(ctrl_callback, data_callback);
+	zassert_equal(ret, 0, "ftp_init failed");
+
+	ret = ftp_open("ftp.example.com", 21, NO_TLS);
+	zassert_equal(ret, FTP_CODE_200, "ftp_open failed");
+
+	ret = ftp_login("user", "password");
+	zassert_equal(ret, FTP_CODE_230, "ftp_login failed");
+}
+
+static void test_ftp_put_stream(void)
+{
+	int ret;
+	size_t size;
+	const uint8_t *upload;
+	struct ftp_transfer_stats stats;
+
+	ret = ftp_put_open("upload.bin", 0);
+	zassert_equal(ret, FTP_CODE_150, "ftp_put_open failed");
+	zassert_true(server_data_open(), "No data connection");
+	zassert_equal(server_data_port_get(), SERVER_DATA_PORT,
+		      "Wrong data port");
+	zassert_true(!strcmp(server_commands_get(), "PASV STOR"),
+		     "Unexpected commands: %s", server_commands_get());
+
+	/* Chunks larger than what one send() takes */
+	ret = ftp_put_write(file, 300);
+	zassert_equal(ret, 0, "ftp_put_write failed");
+	ret = ftp_put_write(file + 300, UPLOAD_SIZE - 300);
+	zassert_equal(ret, 0, "ftp_put_write failed");
+
+	ret = ftp_put_close(&stats);
+	zassert_equal(ret, FTP_CODE_226, "ftp_put_close failed");
+	zassert_true(!server_data_open(), "Data connection not closed");
+	zassert_equal(stats.bytes, UPLOAD_SIZE, "Wrong byte count");
+
+	upload = server_upload_get(&size);
+	zassert_equal(size, UPLOAD_SIZE, "Wrong upload size");
+	zassert_mem_equal(upload, file, UPLOAD_SIZE, "Wrong upload data");
+}
+
+static void test_ftp_put_resume(void)
+{
+	int ret;
+	size_t size;
+	const uint8_t *upload;
+	struct ftp_transfer_stats stats;
+
+	ret = ftp_put_open("upload.bin", RESUME_OFFSET);
+	zassert_equal(ret, FTP_CODE_150, "ftp_put_open failed");
+	zassert_true(!strcmp(server_commands_get(), "PASV REST STOR"),
+		     "Unexpected commands: %s", server_commands_get());
+	zassert_equal(server_rest_get(), RESUME_OFFSET, "Wrong REST offset");
+
+	ret = ftp_put_write(file + RESUME_OFFSET, UPLOAD_SIZE - RESUME_OFFSET);
+	zassert_equal(ret, 0, "ftp_put_write failed");
+
+	ret = ftp_put_close(&stats);
+	zassert_equal(ret, FTP_CODE_226, "ftp_put_close failed");
+	zassert_equal(stats.bytes, UPLOAD_SIZE - RESUME_OFFSET,
+		      "Wrong byte count");
+
+	upload = server_upload_get(&size);
+	zassert_equal(size, UPLOAD_SIZE, "Wrong upload size");
+	zassert_mem_equal(upload, file, UPLOAD_SIZE, "Wrong upload data");
+}
+
+static size_t get_all(uint8_t *dst, size_t size)
+{
+	int ret;
+	size_t received = 0;
+
+	do {
+		ret = ftp_get_read(dst + received, size - received);
+		zassert_true(ret >= 0, "ftp_get_read failed: %d", ret);
+		received += ret;
+	} while (ret > 0 && received < size);
+
+	return received;
+}
+
+static void test_ftp_get_stream(void)
+{
+	int ret;
+	size_t received;
+	struct ftp_transfer_stats stats;
+
+	ret = ftp_get_open("download.bin", 0);
+	zassert_equal(ret, FTP_CODE_150, "ftp_get_open failed");
+	zassert_true(!strcmp(server_commands_get(), "PASV RETR"),
+		     "Unexpected commands: %s", server_commands_get());
+
+	memset(buf, 0, sizeof(buf));
+	received = get_all(buf, sizeof(buf));
+	zassert_equal(received, FILE_SIZE, "Wrong download size");
+	zassert_mem_equal(buf, file, FILE_SIZE, "Wrong download data");
+
+	/* End of file */
+	ret = ftp_get_read(buf, sizeof(buf));
+	zassert_equal(ret, 0, "Data after the end of file");
+
+	ret = ftp_get_close(&stats);
+	zassert_equal(ret, FTP_CODE_226, "ftp_get_close failed");
+	zassert_true(!server_data_open(), "Data connection not closed");
+	zassert_equal(stats.bytes, FILE_SIZE, "Wrong byte count");
+}
+
+static void test_ftp_get_resume(void)
+{
+	int ret;
+	size_t received;
+	struct ftp_transfer_stats stats;
+
+	ret = ftp_get_open("download.bin", RESUME_OFFSET);
+	zassert_equal(ret, FTP_CODE_150, "ftp_get_open failed");
+	zassert_true(!strcmp(server_commands_get(), "PASV REST RETR"),
+		     "Unexpected commands: %s", server_commands_get());
+	zassert_equal(server_rest_get(), RESUME_OFFSET, "Wrong REST offset");
+
+	memset(buf, 0, sizeof(buf));
+	received = get_all(buf, sizeof(buf));
+	zassert_equal(received, FILE_SIZE - RESUME_OFFSET,
+		      "Wrong download size");
+	zassert_mem_equal(buf, file + RESUME_OFFSET, FILE_SIZE - RESUME_OFFSET,
+			  "Wrong download data");
+
+	ret = ftp_get_close(&stats);
+	zassert_equal(ret, FTP_CODE_226, "ftp_get_close failed");
+	zassert_equal(stats.bytes, FILE_SIZE - RESUME_OFFSET,
+		      "Wrong byte count");
+}
+
+static void test_ftp_transfer_stats(void)
+{
+	int ret;
+	struct ftp_transfer_stats stats;
+
+	ret = ftp_put_open("upload.bin", 0);
+	zassert_equal(ret, FTP_CODE_150, "ftp_put_open failed");
+
+	ret = ftp_put_write(file, UPLOAD_SIZE);
+	zassert_equal(ret, 0, "ftp_put_write failed");
+
+	k_sleep(K_MSEC(100));
+
+	ret = ftp_put_close(&stats);
+	zassert_equal(ret, FTP_CODE_226, "ftp_put_close failed");
+	zassert_equal(stats.bytes, UPLOAD_SIZE, "Wrong byte count");
+	zassert_true(stats.duration_ms >= 100, "Wrong duration: %u",
+		     stats.duration_ms);
+	zassert_equal(stats.throughput,
+		      UPLOAD_SIZE * 1000 / stats.duration_ms,
+		      "Wrong throughput");
+
+	/* Statistics are optional */
+	ret = ftp_get_open("download.bin", 0);
+	zassert_equal(ret, FTP_CODE_150, "ftp_get_open failed");
+	get_all(buf, sizeof(buf));
+	ret = ftp_get_close(NULL);
+	zassert_equal(ret, FTP_CODE_226, "ftp_get_close failed");
+}
+
+static void test_ftp_stream_state(void)
+{
+	int ret;
+
+	ret = ftp_put_write(file, 1);
+	zassert_equal(ret, -ENOTCONN, "Write without transfer");
+	ret = ftp_get_read(buf, sizeof(buf));
+	zassert_equal(ret, -ENOTCONN, "Read without transfer");
+	ret = ftp_get_close(NULL);
+	zassert_equal(ret, -ENOTCONN, "Close without transfer");
+
+	ret = ftp_put_open("upload.bin", 0);
+	zassert_equal(ret, FTP_CODE_150, "ftp_put_open failed");
+
+	/* One transfer at a time */
+	ret = ftp_get_open("download.bin", 0);
+	zassert_equal(ret, -EBUSY, "Second transfer opened");
+	ret = ftp_get_read(buf, sizeof(buf));
+	zassert_equal(ret, -ENOTCONN, "Read from an upload");
+	ret = ftp_get_close(NULL);
+	zassert_equal(ret, -ENOTCONN, "Upload closed as download");
+
+	ret = ftp_put_close(NULL);
+	zassert_equal(ret, FTP_CODE_226, "ftp_put_close failed");
+}
+
+static void test_ftp_size(void)
+{
+	int ret;
+	size_t size = 0;
+
+	ret = ftp_size("download.bin", &size);
+	zassert_equal(ret, FTP_CODE_213, "ftp_size failed");
+	zassert_equal(size, FILE_SIZE, "Wrong size");
+
+	size = 0;
+	server_size_reply_set("213 \r\n");
+	ret = ftp_size("download.bin", &size);
+	zassert_equal(ret, -EBADMSG, "Reply without size accepted");
+	zassert_equal(size, 0, "Size set from an invalid reply");
+
+	server_size_reply_set("550 No such file\r\n");
+	ret = ftp_size("missing.bin", &size);
+	zassert_not_equal(ret, FTP_CODE_213, "Missing file has a size");
+	zassert_equal(size, 0, "Size set for a missing file");
+
+	server_size_reply_set(NULL);
+	ret = ftp_size("download.bin", NULL);
+	zassert_equal(ret, -EINVAL, "NULL size accepted");
+}
+
+static void test_ftp_close(void)
+{
+	int ret;
+
+	ret = ftp_close();
+	zassert_equal(ret, FTP_CODE_221, "ftp_close failed");
+	zassert_true(ctrl_msg_count > 0, "No control messages");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(ftp_client_test,
+			 ztest_unit_test(test_ftp_connect),
+			 ztest_unit_test(test_ftp_put_stream),
+			 ztest_unit_test(test_ftp_put_resume),
+			 ztest_unit_test(test_ftp_get_stream),
+			 ztest_unit_test(test_ftp_get_resume),
+			 ztest_unit_test(test_ftp_transfer_stats),
+			 ztest_unit_test(test_ftp_stream_state),
+			 ztest_unit_test(test_ftp_size),
+			 ztest_unit_test(test_ftp_close)
+			 );
+
+	ztest_run_test_suite(ftp_client_test);
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <net/socket.h>
+
+#include "socket_mock.h"
+
+#define CTRL_SOCK 1
+#define DATA_SOCK 2
+
+enum transfer {
+	TRANSFER_NONE,
+	TRANSFER_STOR,
+	TRANSFER_RETR
+};
+
+static struct {
+	bool ctrl_open;
+	bool data_open;
+	uint16_t data_port;
+	/* Pending reply on the control connection */
+	char reply[128];
+	enum transfer transfer;
+	size_t rest;
+	const uint8_t *file;
+	size_t file_size;
+	size_t read_pos;
+	const char *size_reply;
+	uint8_t upload[SERVER_UPLOAD_MAX];
+	size_t upload_size;
+	char commands[64];
+} server;
+
+static struct sockaddr_in server_addr = {
+	.sin_family = AF_INET,
+};
+
+static struct addrinfo server_ai = {
+	.ai_family = AF_INET,
+	.ai_addrlen = sizeof(server_addr),
+	.ai_addr = (struct sockaddr *)&server_addr,
+};
+
+void server_reset(void)
+{
+	memset(&server, 0, sizeof(server));
+}
+
+void server_file_set(const uint8_t *data, size_t size)
+{
+	server.file = data;
+	server.file_size = size;
+}
+
+void server_size_reply_set(const char *reply)
+{
+	server.size_reply = reply;
+}
+
+const uint8_t *server_upload_get(size_t *size)
+{
+	*size = server.upload_size;
+	return server.upload;
+}
+
+const char *server_commands_get(void)
+{
+	return server.commands;
+}
+
+size_t server_rest_get(void)
+{
+	return server.rest;
+}
+
+uint16_t server_data_port_get(void)
+{
+	return server.data_port;
+}
+
+bool server_data_open(void)
+{
+	return server.data_open;
+}
+
+static void reply_set(const char *reply)
+{
+	strcpy(server.reply, reply);
+}
+
+static void command_handle(const char *cmd)
+{
+	char name[5] = { 0 };
+
+	memcpy(name, cmd, MIN(strcspn(cmd, " \r"), sizeof(name) - 1));
+
+	if (!strcmp(name, "PASV")) {
+		server.commands[0] = '\0';
+		server.rest = 0;
+	}
+	if (server.commands[0] != '\0') {
+		strcat(server.commands, " ");
+	}
+	strcat(server.commands, name);
+
+	if (!strcmp(name, "USER")) {
+		reply_set("331 Password required\r\n");
+	} else if (!strcmp(name, "PASS")) {
+		reply_set("230 Logged in\r\n");
+	} else if (!strcmp(name, "OPTS") || !strcmp(name, "NOOP")) {
+		reply_set("200 OK\r\n");
+	} else if (!strcmp(name, "PASV")) {
+		reply_set("227 Entering Passive Mode (127,0,0,1,4,1)\r\n");
+	} else if (!strcmp(name, "REST")) {
+		server.rest = strtoul(cmd + 5, NULL, 10);
+		reply_set("350 Restarting\r\n");
+	} else if (!strcmp(name, "STOR")) {
+		server.transfer = TRANSFER_STOR;
+		server.upload_size = server.rest;
+		reply_set("150 Ok to send data\r\n");
+	} else if (!strcmp(name, "RETR")) {
+		server.transfer = TRANSFER_RETR;
+		server.read_pos = server.rest;
+		reply_set("150 Opening data connection\r\n");
+	} else if (!strcmp(name, "SIZE")) {
+		if (server.size_reply) {
+			reply_set(server.size_reply);
+		} else {
+			sprintf(server.reply, "213 %u\r\n",
+				(unsigned int)server.file_size);
+		}
+	} else if (!strcmp(name, "QUIT")) {
+		reply_set("221 Goodbye\r\n");
+	} else {
+		reply_set("502 Not implemented\r\n");
+	}
+}
+
+int zsock_socket(int family, int type, int proto)
+{
+	if (!server.ctrl_open) {
+		server.ctrl_open = true;
+		return CTRL_SOCK;
+	}
+
+	if (!server.data_open) {
+		server.data_open = true;
+		return DATA_SOCK;
+	}
+
+	errno = ENOMEM;
+	return -1;
+}
+
+int zsock_close(int sock)
+{
+	if (sock == CTRL_SOCK) {
+		server.ctrl_open = false;
+		return 0;
+	}
+
+	if (sock == DATA_SOCK && server.data_open) {
+		server.data_open = false;
+		if (server.transfer != TRANSFER_NONE) {
+			server.transfer = TRANSFER_NONE;
+			reply_set("226 Transfer complete\r\n");
+		}
+		return 0;
+	}
+
+	errno = EBADF;
+	return -1;
+}
+
+int zsock_connect(int sock, const struct sockaddr *addr, socklen_t addrlen)
+{
+	if (sock == CTRL_SOCK) {
+		reply_set("220 Welcome\r\n");
+	} else {
+		server.data_port = ntohs(((struct sockaddr_in *)addr)->sin_port);
+	}
+
+	return 0;
+}
+
+ssize_t zsock_send(int sock, const void *buf, size_t len, int flags)
+{
+	if (sock == CTRL_SOCK) {
+		char cmd[64] = { 0 };
+
+		memcpy(cmd, buf, MIN(len, sizeof(cmd) - 1));
+		command_handle(cmd);
+		return len;
+	}
+
+	if (server.transfer != TRANSFER_STOR) {
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	len = MIN(len, SERVER_CHUNK_SIZE);
+	len = MIN(len, sizeof(server.upload) - server.upload_size);
+	memcpy(server.upload + server.upload_size, buf, len);
+	server.upload_size += len;
+
+	return len;
+}
+
+ssize_t zsock_recv(int sock, void *buf, size_t max_len, int flags)
+{
+	if (sock == CTRL_SOCK) {
+		size_t len = MIN(strlen(server.reply), max_len);
+
+		memcpy(buf, server.reply, len);
+		server.reply[0] = '\0';
+		return len;
+	}
+
+	if (server.transfer != TRANSFER_RETR) {
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	/* 0 once the whole file has been sent */
+	max_len = MIN(max_len, SERVER_CHUNK_SIZE);
+	max_len = MIN(max_len, server.file_size - server.read_pos);
+	memcpy(buf, server.file + server.read_pos, max_len);
+	server.read_pos += max_len;
+
+	return max_len;
+}
+
+int zsock_poll(struct pollfd *fds, int nfds, int timeout)
+{
+	int ready = 0;
+
+	for (int i = 0; i < nfds; i++) {
+		fds[i].revents = 0;
+		if ((fds[i].fd == CTRL_SOCK && server.reply[0] != '\0') ||
+		    (fds[i].fd == DATA_SOCK &&
+		     server.transfer == TRANSFER_RETR)) {
+			fds[i].revents = POLLIN;
+			ready++;
+		}
+	}
+
+	/* Nothing will arrive, time out right away */
+	return ready;
+}
+
+int zsock_setsockopt(int sock, int level, int optname, const void *optval,
+		     socklen_t optlen)
+{
+	return 0;
+}
+
+int zsock_getaddrinfo(const char *host, const char *service,
+		      const struct addrinfo *hints, struct addrinfo **res)
+{
+	server_addr.sin_addr.s_addr = htonl(0x7f000001);
+	*res = &server_ai;
+
+	return 0;
+}
+
+void zsock_freeaddrinfo(struct addrinfo *ai)
+{
+}
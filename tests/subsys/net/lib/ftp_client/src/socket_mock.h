@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef SOCKET_MOCK_H_
+#define SOCKET_MOCK_H_
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/* Data port announced in the PASV reply */
+#define SERVER_DATA_PORT 1025
+
+/* Largest chunk sent or received by one socket call, so that the client
+ * has to loop.
+ */
+#define SERVER_CHUNK_SIZE 200
+
+#define SERVER_UPLOAD_MAX 2048
+
+/** Restore the initial state of the simulated server. */
+void server_reset(void);
+
+/** Set the file served by RETR and SIZE. */
+void server_file_set(const uint8_t *data, size_t size);
+
+/** Set the reply to SIZE, NULL for the size of the served file. */
+void server_size_reply_set(const char *reply);
+
+/** Get the data received by STOR. */
+const uint8_t *server_upload_get(size_t *size);
+
+/** Get the commands received since the last PASV, separated by spaces. */
+const char *server_commands_get(void);
+
+/** Get the offset of the last REST command, 0 if none. */
+size_t server_rest_get(void);
+
+/** Get the port the data connection was opened to. */
+uint16_t server_data_port_get(void);
+
+/** Check if the data connection is open. */
+bool server_data_open(void);
+
+#endif /* SOCKET_MOCK_H_ */
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <net/icalendar_parser.h>
+
+#define EVT_MAX 8
+#define BENCHMARK_EVENTS 2000
+#define BENCHMARK_CHUNK 256
+
+static struct icalendar_parser ical;
+static struct ical_parser_evt evts[EVT_MAX];
+static int evt_count;
+static int stop_after;
+
+static const char calendar[] =
+	"BEGIN:VCALENDAR\r\n"
+	"VERSION:2.0\r\n"
+	"PRODID:-//Nordic Semiconductor//Test//EN\r\n"
+	"BEGIN:VTIMEZONE\r\n"
+	"TZID:Europe/Oslo\r\n"
+	"BEGIN:STANDARD\r\n"
+	"DTSTART:19701025T030000\r\n"
+	"END:STANDARD\r\n"
+	"END:VTIMEZONE\r\n"
+	"BEGIN:VEVENT\r\n"
+	"DTSTART;TZID=Europe/Oslo:20201019T090000\r\n"
+	"DTEND;TZID=\"Europe:Oslo\":20201019T100000\r\n"
+	"SUMMARY:Weekly meeting\r\n"
+	"LOCATION:Room 1\r\n"
+	"DESCRIPTION;LANGUAGE=en:Agenda: review the\r\n"
+	"  backlog\r\n"
+	"BEGIN:VALARM\r\n"
+	"DESCRIPTION:Reminder\r\n"
+	"END:VALARM\r\n"
+	"END:VEVENT\r\n"
+	"BEGIN:VTODO\r\n"
+	"SUMMARY:Todo\r\n"
+	"END:VTODO\r\n"
+	"END:VCALENDAR\r\n";
+
+static int ical_callback(const struct ical_parser_evt *evt)
+{
+	if (evt_count < EVT_MAX) {
+		evts[evt_count] = *evt;
+	}
+	evt_count++;
+
+	return (stop_after > 0 && evt_count == stop_after) ? 1 : 0;
+}
+
+static void setup(void)
+{
+	memset(evts, 0, sizeof(evts));
+	evt_count = 0;
+	stop_after = 0;
+	zassert_equal(ical_parser_init(&ical, ical_callback), 0, NULL);
+}
+
+static void parse_chunked(const char *data, size_t len, size_t chunk)
+{
+	size_t offset = 0;
+
+	while (offset < len) {
+		size_t n = MIN(chunk, len - offset);
+
+		zassert_equal(ical_parser_parse(&ical, data + offset, n), n,
+			      NULL);
+		offset += n;
+	}
+}
+
+static void calendar_check(void)
+{
+	zassert_equal(evt_count, 3, "Wrong number of events");
+
+	zassert_equal(evts[0].id, ICAL_EVT_VTIMEZONE, NULL);
+	zassert_equal(evts[0].error, ICAL_ERROR_COM_NOT_SUPPORTED, NULL);
+
+	zassert_equal(evts[1].id, ICAL_EVT_VEVENT, NULL);
+	zassert_equal(evts[1].error, ICAL_ERROR_NONE, NULL);
+	zassert_true(!strcmp(evts[1].ical_com.dtstart, "20201019T090000"),
+		     NULL);
+	zassert_true(!strcmp(evts[1].ical_com.dtend, "20201019T100000"),
+		     NULL);
+	zassert_true(!strcmp(evts[1].ical_com.summary, "Weekly meeting"),
+		     NULL);
+	zassert_true(!strcmp(evts[1].ical_com.location, "Room 1"), NULL);
+	zassert_true(!strcmp(evts[1].ical_com.description,
+			     "Agenda: review the backlog"), NULL);
+
+	zassert_equal(evts[2].id, ICAL_EVT_VTODO, NULL);
+	zassert_equal(evts[2].error, ICAL_ERROR_COM_NOT_SUPPORTED, NULL);
+}
+
+static void test_calendar(void)
+{
+	parse_chunked(calendar, strlen(calendar), strlen(calendar));
+	calendar_check();
+}
+
+static void test_chunk_boundaries(void)
+{
+	/* Every split position, including inside folds and delimiters */
+	parse_chunked(calendar, strlen(calendar), 1);
+	calendar_check();
+
+	setup();
+	parse_chunked(calendar, strlen(calendar), 7);
+	calendar_check();
+}
+
+static void test_no_calendar_object(void)
+{
+	static const char data[] =
+		"BEGIN:VEVENT\r\n"
+		"SUMMARY:Outside calendar\r\n"
+		"END:VEVENT\r\n"
+		"\r\n";
+
+	parse_chunked(data, strlen(data), strlen(data));
+	zassert_equal(evt_count, 0, "Event outside calendar object");
+}
+
+static void test_value_overflow(void)
+{
+	static char data[1024];
+	char summary[CONFIG_ICAL_PARSER_SUMMARY_SIZE + 2];
+
+	memset(summary, 'x', sizeof(summary) - 1);
+	summary[sizeof(summary) - 1] = '\0';
+	snprintf(data, sizeof(data),
+		 "BEGIN:VCALENDAR\r\n"
+		 "BEGIN:VEVENT\r\n"
+		 "X-LONG-PROPERTY-NAME-IS-SKIPPED:%s%s\r\n"
+		 "SUMMARY:%s\r\n"
+		 "LOCATION:Room 2\r\n"
+		 "END:VEVENT\r\n"
+		 "END:VCALENDAR\r\n",
+		 summary, summary, summary);
+
+	parse_chunked(data, strlen(data), 16);
+	zassert_equal(evt_count, 1, NULL);
+	zassert_equal(evts[0].error, ICAL_ERROR_SUMMARY, NULL);
+	zassert_equal(evts[0].ical_com.location[0], '\0',
+		      "Parsing continued after error");
+}
+
+static void test_callback_stop(void)
+{
+	size_t len = strlen(calendar);
+	size_t parsed;
+
+	stop_after = 1;
+	parsed = ical_parser_parse(&ical, calendar, len);
+	zassert_true(parsed < len, "Parsing not stopped");
+	zassert_equal(evt_count, 1, NULL);
+
+	stop_after = 0;
+	parsed += ical_parser_parse(&ical, calendar + parsed, len - parsed);
+	zassert_equal(parsed, len, NULL);
+	calendar_check();
+}
+
+static void test_benchmark(void)
+{
+	static const char header[] =
+		"BEGIN:VCALENDAR\r\n"
+		"VERSION:2.0\r\n"
+		"PRODID:-//Nordic Semiconductor//Test//EN\r\n";
+	static const char event[] =
+		"BEGIN:VEVENT\r\n"
+		"UID:0123456789abcdef0123456789abcdef@example.com\r\n"
+		"DTSTAMP:20201019T080000Z\r\n"
+		"DTSTART;TZID=Europe/Oslo:20201019T090000\r\n"
+		"DTEND;TZID=Europe/Oslo:20201019T100000\r\n"
+		"SUMMARY:Weekly meeting\r\n"
+		"LOCATION:Room 1\r\n"
+		"DESCRIPTION:A description that is long enough to be folded\r\n"
+		" into several content lines\\, like calendar servers do f\r\n"
+		" or longer texts.\r\n"
+		"BEGIN:VALARM\r\n"
+		"ACTION:DISPLAY\r\n"
+		"TRIGGER:-PT15M\r\n"
+		"END:VALARM\r\n"
+		"END:VEVENT\r\n";
+	static const char footer[] = "END:VCALENDAR\r\n";
+	static char stream[BENCHMARK_CHUNK + sizeof(event)];
+	size_t fill = 0;
+	uint32_t total = 0;
+	uint32_t start, cycles;
+	uint64_t ns;
+
+	start = k_cycle_get_32();
+	parse_chunked(header, strlen(header), strlen(header));
+	total += strlen(header);
+	/* Events are fed in fixed size chunks, split at any position */
+	for (int n = 0; n < BENCHMARK_EVENTS; n++) {
+		memcpy(stream + fill, event, strlen(event));
+		fill += strlen(event);
+		while (fill >= BENCHMARK_CHUNK) {
+			parse_chunked(stream, BENCHMARK_CHUNK, BENCHMARK_CHUNK);
+			total += BENCHMARK_CHUNK;
+			fill -= BENCHMARK_CHUNK;
+			memmove(stream, stream + BENCHMARK_CHUNK, fill);
+		}
+	}
+	parse_chunked(stream, fill, fill);
+	total += fill;
+	parse_chunked(footer, strlen(footer), strlen(footer));
+	total += strlen(footer);
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(evt_count, BENCHMARK_EVENTS, NULL);
+	zassert_equal(evts[0].error, ICAL_ERROR_NONE, NULL);
+	zassert_true(!strcmp(evts[0].ical_com.description,
+			     "A description that is long enough to be folded"
+			     "into several content lines\\, like calendar "
+			     "servers do for longer texts."), NULL);
+
+	ns = k_cyc_to_ns_floor64(cycles);
+	TC_PRINT("Parsed %u bytes, %d events in %u cycles\n",
+		 total, BENCHMARK_EVENTS, cycles);
+	if (ns > 0) {
+		TC_PRINT("\tthroughput: %u kB/s\n",
+			 (uint32_t)((uint64_t)total * 1000000ULL / ns));
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(icalendar_parser,
+		ztest_unit_test_setup_teardown(test_calendar,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_chunk_boundaries,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_no_calendar_object,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_value_overflow,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_callback_stop,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_benchmark,
+					       setup, unit_test_noop)
+	);
+
+	ztest_run_test_suite(icalendar_parser);
+}
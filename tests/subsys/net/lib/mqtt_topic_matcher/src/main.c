@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <net/mqtt_topic_matcher.h>
+
+#define NODE_MAX 64
+#define BENCHMARK_ITERATIONS 10000
+
+static struct mqtt_topic_matcher_node nodes[NODE_MAX];
+static struct mqtt_topic_matcher matcher;
+
+static int add(const char *filter, int id)
+{
+	return mqtt_topic_matcher_add(&matcher, filter, strlen(filter), id);
+}
+
+static int match(const char *topic)
+{
+	return mqtt_topic_matcher_match(&matcher, topic, strlen(topic));
+}
+
+static void setup(void)
+{
+	mqtt_topic_matcher_init(&matcher, nodes, ARRAY_SIZE(nodes));
+}
+
+static void test_exact(void)
+{
+	zassert_equal(add("a/b/c", 1), 0, NULL);
+	zassert_equal(add("a/b", 2), 0, NULL);
+	zassert_equal(add("a/b/d", 3), 0, NULL);
+
+	zassert_equal(match("a/b/c"), 1, NULL);
+	zassert_equal(match("a/b"), 2, NULL);
+	zassert_equal(match("a/b/d"), 3, NULL);
+	zassert_equal(match("a"), -ENOENT, NULL);
+	zassert_equal(match("a/b/c/d"), -ENOENT, NULL);
+	zassert_equal(match("a/b/cc"), -ENOENT, NULL);
+	zassert_equal(match("a/b/"), -ENOENT, NULL);
+	zassert_equal(match("A/b/c"), -ENOENT, NULL);
+}
+
+static void test_single_level_wildcard(void)
+{
+	zassert_equal(add("devices/+/messages", 1), 0, NULL);
+	zassert_equal(add("+/+", 2), 0, NULL);
+
+	zassert_equal(match("devices/dev1/messages"), 1, NULL);
+	zassert_equal(match("devices//messages"), 1, NULL);
+	zassert_equal(match("devices/dev1/messages/x"), -ENOENT, NULL);
+	zassert_equal(match("x/y"), 2, NULL);
+	zassert_equal(match("x"), -ENOENT, NULL);
+	zassert_equal(match("x/y/z"), -ENOENT, NULL);
+}
+
+static void test_multi_level_wildcard(void)
+{
+	zassert_equal(add("sport/tennis/#", 1), 0, NULL);
+	zassert_equal(add("#", 2), 0, NULL);
+
+	zassert_equal(match("sport/tennis/player1"), 1, NULL);
+	zassert_equal(match("sport/tennis/player1/ranking"), 1, NULL);
+	zassert_equal(match("sport/tennis"), 1, NULL);
+	zassert_equal(match("sport/tennis/"), 1, NULL);
+	zassert_equal(match("sport"), 2, NULL);
+	zassert_equal(match("anything/at/all"), 2, NULL);
+}
+
+static void test_precedence(void)
+{
+	zassert_equal(add("a/#", 1), 0, NULL);
+	zassert_equal(add("a/+/c", 2), 0, NULL);
+	zassert_equal(add("a/b/c", 3), 0, NULL);
+
+	zassert_equal(match("a/b/c"), 3, NULL);
+	zassert_equal(match("a/x/c"), 2, NULL);
+	zassert_equal(match("a/x/d"), 1, NULL);
+	zassert_equal(match("a/b/c/d"), 1, NULL);
+}
+
+static void test_dollar_topics(void)
+{
+	zassert_equal(add("#", 1), 0, NULL);
+	zassert_equal(add("+/shadow", 2), 0, NULL);
+	zassert_equal(add("$aws/#", 3), 0, NULL);
+
+	zassert_equal(match("$SYS/broker"), -ENOENT, NULL);
+	zassert_equal(match("$x/shadow"), -ENOENT, NULL);
+	zassert_equal(match("x/shadow"), 2, NULL);
+	zassert_equal(match("$aws/things/x"), 3, NULL);
+}
+
+static void test_invalid_filters(void)
+{
+	zassert_equal(add("", 1), -EINVAL, NULL);
+	zassert_equal(add("a/#/b", 1), -EINVAL, NULL);
+	zassert_equal(add("a/b#", 1), -EINVAL, NULL);
+	zassert_equal(add("a/+b", 1), -EINVAL, NULL);
+	zassert_equal(add("a/b", -1), -EINVAL, NULL);
+	zassert_equal(matcher.node_count, 0, "Invalid filter added nodes");
+
+	zassert_equal(add("a/b", 1), 0, NULL);
+	zassert_equal(add("a/b", 2), -EALREADY, NULL);
+	zassert_equal(match("a/b"), 1, NULL);
+}
+
+static void test_node_pool_exhausted(void)
+{
+	struct mqtt_topic_matcher_node small_pool[3];
+
+	mqtt_topic_matcher_init(&matcher, small_pool, ARRAY_SIZE(small_pool));
+
+	zassert_equal(add("a/b/c", 1), 0, NULL);
+	zassert_equal(add("a/b/d/e", 2), -ENOMEM, NULL);
+	zassert_equal(match("a/b/c"), 1, NULL);
+	zassert_equal(match("a/b/d/e"), -ENOENT, NULL);
+
+	mqtt_topic_matcher_reset(&matcher);
+	zassert_equal(match("a/b/c"), -ENOENT, NULL);
+	zassert_equal(add("x/y/z", 1), 0, NULL);
+	zassert_equal(match("x/y/z"), 1, NULL);
+}
+
+/* Topics used by the cloud libraries. */
+static const char *const cloud_topics[] = {
+	"nrf-352656100000000/shadow/get/accepted",
+	"$aws/things/nrf-352656100000000/shadow/get/rejected",
+	"$aws/things/nrf-352656100000000/shadow/update/delta",
+	"$aws/things/nrf-352656100000000/shadow/update/accepted",
+	"$aws/things/nrf-352656100000000/shadow/update/rejected",
+	"$aws/things/nrf-352656100000000/shadow/delete/accepted",
+	"$aws/things/nrf-352656100000000/shadow/delete/rejected",
+	"prod/1a2b3c4d-0000-1111-2222-333344445555/m/d/"
+		"nrf-352656100000000/c2d",
+	"$aws/things/nrf-352656100000000/jobs/notify-next",
+	"$aws/things/nrf-352656100000000/jobs/$next/get/accepted",
+};
+
+static int linear_match(const char *topic, size_t len)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(cloud_topics); i++) {
+		if ((strlen(cloud_topics[i]) == len) &&
+		    (strncmp(cloud_topics[i], topic, len) == 0)) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static void test_benchmark(void)
+{
+	uint32_t start, linear_cycles, matcher_cycles;
+	volatile int sink = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cloud_topics); i++) {
+		zassert_equal(add(cloud_topics[i], i), 0, NULL);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(cloud_topics); i++) {
+		zassert_equal(match(cloud_topics[i]), i, NULL);
+	}
+
+	start = k_cycle_get_32();
+	for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+		const char *topic = cloud_topics[n % ARRAY_SIZE(cloud_topics)];
+
+		sink += linear_match(topic, strlen(topic));
+	}
+	linear_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+		const char *topic = cloud_topics[n % ARRAY_SIZE(cloud_topics)];
+
+		sink += match(topic);
+	}
+	matcher_cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("Routing cost, %d topics, %d messages:\n",
+		 ARRAY_SIZE(cloud_topics), BENCHMARK_ITERATIONS);
+	TC_PRINT("\tlinear:  %u cycles/message\n",
+		 linear_cycles / BENCHMARK_ITERATIONS);
+	TC_PRINT("\tmatcher: %u cycles/message, %d nodes\n",
+		 matcher_cycles / BENCHMARK_ITERATIONS, matcher.node_count);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_topic_matcher,
+		ztest_unit_test_setup_teardown(test_exact,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_single_level_wildcard,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_multi_level_wildcard,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_precedence,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_dollar_topics,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_invalid_filters,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_node_pool_exhausted,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_benchmark,
+					       setup, unit_test_noop)
+	);
+
+	ztest_run_test_suite(mqtt_topic_matcher);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+
+#include "agps_payload.h"
+
+/* A-GPS response in the nRF Cloud binary format (schema version 1), with
+ * the element arrays in the order nRF Cloud sends them. All multi-byte
+ * fields are little-endian.
+ */
+const uint8_t agps_payload[] = {
+	/* Schema version */
+	0x01,
+	/* UTC parameters, count 1 */
+	0x01, 0x01, 0x00,
+	/* a1 0, a0 -4, tot 144, wn_t 62, delta_tls 18, wn_lsf 137,
+	 * dn 7, delta_tlsf 18
+	 */
+	0x00, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0xff, 0x90, 0x3e,
+	0x12, 0x89, 0x07, 0x12,
+	/* Ephemerides, count 2 */
+	0x02, 0x02, 0x00,
+	/* SV 5 */
+	0x05, 0x00, 0x4e, 0x00, 0x80, 0x70, 0x00, 0x2d, 0xfb, 0xb2,
+	0x9e, 0x43, 0xff, 0xf5, 0x00, 0x00, 0x80, 0x70, 0x2e, 0xfd,
+	0x69, 0xb6, 0x39, 0x30, 0xb1, 0x68, 0xde, 0x3a, 0x32, 0xa9,
+	0xff, 0xff, 0x4e, 0x61, 0xbc, 0x00, 0x85, 0xff, 0xcc, 0x9c,
+	0x0c, 0xa1, 0xca, 0x25, 0x00, 0x27, 0x00, 0x36, 0x65, 0xc4,
+	0x2e, 0xfb, 0x0c, 0x00, 0x80, 0x0d, 0xd2, 0x1e, 0xde, 0xff,
+	0xd7, 0xf6,
+	/* SV 12 */
+	0x0c, 0x00, 0x21, 0x00, 0x80, 0x70, 0x00, 0x57, 0x00, 0x47,
+	0x94, 0x03, 0x00, 0xfa, 0x02, 0x00, 0x80, 0x70, 0xeb, 0xbd,
+	0x60, 0x20, 0xf8, 0x2a, 0xeb, 0x32, 0xa4, 0xf8, 0xf8, 0xad,
+	0xff, 0xff, 0x52, 0xb3, 0x45, 0x00, 0x62, 0x00, 0x38, 0x21,
+	0x0c, 0xa1, 0x87, 0xa3, 0x69, 0x27, 0x00, 0xab, 0x90, 0x41,
+	0xdb, 0x03, 0xd3, 0xff, 0x34, 0x08, 0x8f, 0x19, 0x4c, 0x00,
+	0x2e, 0xfb,
+	/* Almanac, count 2 */
+	0x03, 0x02, 0x00,
+	/* SV 5 */
+	0x05, 0x3e, 0x90, 0x00, 0x39, 0x30, 0xe1, 0x10, 0x72, 0xfd,
+	0x00, 0x36, 0x0d, 0xa1, 0x00, 0xeb, 0x40, 0xcb, 0xff, 0x87,
+	0xd6, 0x12, 0x00, 0x4f, 0x34, 0x8b, 0xff, 0xbf, 0xfe, 0xfe,
+	0xff,
+	/* SV 12 */
+	0x0c, 0x3e, 0x90, 0x00, 0x85, 0x1a, 0x2e, 0xfb, 0x76, 0xfd,
+	0x00, 0xf4, 0x0c, 0xa1, 0x00, 0x52, 0xb3, 0x45, 0x00, 0x32,
+	0x35, 0xdc, 0xff, 0x6a, 0xd7, 0x63, 0x00, 0x7b, 0x00, 0x01,
+	0x00,
+	/* Klobuchar correction, count 1 */
+	0x04, 0x01, 0x00,
+	/* alpha 13 0 -8 0, beta 88 0 -2 1 */
+	0x0d, 0x00, 0xf8, 0x00, 0x58, 0x00, 0xfe, 0x01,
+	/* GPS TOWs, count 2 */
+	0x06, 0x02, 0x00,
+	/* SV 5 */
+	0x05, 0x34, 0x12, 0x01,
+	/* SV 12 */
+	0x0c, 0xbc, 0x0a, 0x00,
+	/* GPS system clock, count 1 */
+	0x07, 0x01, 0x00,
+	/* Day 14897, 43200.250 s, SVs 5 and 12, TOWs sent separately */
+	0x31, 0x3a, 0xc0, 0xa8, 0x00, 0x00, 0xfa, 0x00, 0x10, 0x08,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	/* Location, count 1 */
+	0x08, 0x01, 0x00,
+	/* 63.4305 N, 10.3951 E, 50 m */
+	0x57, 0x36, 0x5a, 0x00, 0x5f, 0x64, 0x07, 0x00, 0x32, 0x00,
+	0x14, 0x12, 0x00, 0x28, 0x44,
+	/* Integrity, count 1 */
+	0x09, 0x01, 0x00,
+	/* SV 21 unhealthy */
+	0x00, 0x00, 0x10, 0x00,
+};
+
+const size_t agps_payload_len = sizeof(agps_payload);
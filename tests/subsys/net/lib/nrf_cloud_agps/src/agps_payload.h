@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef AGPS_PAYLOAD_H_
+#define AGPS_PAYLOAD_H_
+
+#include <zephyr/types.h>
+
+/* Number of elements in agps_payload */
+#define AGPS_PAYLOAD_ELEMENTS 11
+
+extern const uint8_t agps_payload[];
+extern const size_t agps_payload_len;
+
+#endif /* AGPS_PAYLOAD_H_ */
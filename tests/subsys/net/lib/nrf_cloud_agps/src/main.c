@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <sys/byteorder.h>
+
+#include "nrf_cloud_agps_decoder.h"
+#include "agps_payload.h"
+
+#define PAYLOAD_MAX_LEN 2048
+#define ELEMENTS_MAX 80
+#define SYSTEM_CLOCK_SIZE 16
+
+struct element_record {
+	enum nrf_cloud_agps_type type;
+	uint8_t data[NRF_CLOUD_AGPS_DECODER_ELEMENT_MAX_SIZE];
+	size_t len;
+};
+
+struct element_log {
+	struct element_record records[ELEMENTS_MAX];
+	size_t count;
+	size_t fail_at;
+};
+
+static uint8_t payload[PAYLOAD_MAX_LEN];
+static size_t payload_len;
+static struct element_log expected;
+static struct element_log actual;
+static uint32_t prng_state;
+
+static size_t element_size(enum nrf_cloud_agps_type type)
+{
+	switch (type) {
+	case NRF_CLOUD_AGPS_UTC_PARAMETERS:
+		return sizeof(struct nrf_cloud_agps_utc);
+	case NRF_CLOUD_AGPS_EPHEMERIDES:
+		return sizeof(struct nrf_cloud_agps_ephemeris);
+	case NRF_CLOUD_AGPS_ALMANAC:
+		return sizeof(struct nrf_cloud_agps_almanac);
+	case NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION:
+		return sizeof(struct nrf_cloud_agps_klobuchar);
+	case NRF_CLOUD_AGPS_GPS_TOWS:
+		return sizeof(struct nrf_cloud_agps_tow_element);
+	case NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK:
+		return SYSTEM_CLOCK_SIZE;
+	case NRF_CLOUD_AGPS_LOCATION:
+		return sizeof(struct nrf_cloud_agps_location);
+	case NRF_CLOUD_AGPS_INTEGRITY:
+		return sizeof(struct nrf_cloud_agps_integrity);
+	default:
+		return 0;
+	}
+}
+
+static uint8_t prng_next(void)
+{
+	prng_state = prng_state * 1103515245 + 12345;
+
+	return (uint8_t)(prng_state >> 16);
+}
+
+static void payload_array_add(enum nrf_cloud_agps_type type, uint16_t count)
+{
+	size_t size = element_size(type);
+
+	payload[payload_len++] = type;
+	sys_put_le16(count, &payload[payload_len]);
+	payload_len += NRF_CLOUD_AGPS_BIN_COUNT_SIZE;
+
+	for (uint16_t i = 0; i < count; i++) {
+		struct element_record *rec =
+			&expected.records[expected.count++];
+
+		zassert_true(payload_len + size <= sizeof(payload), NULL);
+		zassert_true(expected.count <= ELEMENTS_MAX, NULL);
+
+		for (size_t j = 0; j < size; j++) {
+			payload[payload_len + j] = prng_next();
+		}
+
+		rec->type = type;
+		rec->len = size;
+		memcpy(rec->data, &payload[payload_len], size);
+		payload_len += size;
+	}
+}
+
+/* Builds a payload with the same layout as a full A-GPS response from
+ * nRF Cloud.
+ */
+static void payload_build(void)
+{
+	memset(&expected, 0, sizeof(expected));
+	payload_len = 0;
+	prng_state = 0xA6B5;
+
+	payload[payload_len++] = NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION;
+	payload_array_add(NRF_CLOUD_AGPS_UTC_PARAMETERS, 1);
+	payload_array_add(NRF_CLOUD_AGPS_EPHEMERIDES, 12);
+	payload_array_add(NRF_CLOUD_AGPS_ALMANAC, 12);
+	payload_array_add(NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION, 1);
+	payload_array_add(NRF_CLOUD_AGPS_GPS_TOWS, 8);
+	payload_array_add(NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK, 1);
+	payload_array_add(NRF_CLOUD_AGPS_LOCATION, 1);
+	payload_array_add(NRF_CLOUD_AGPS_INTEGRITY, 1);
+}
+
+static int element_cb(const struct nrf_cloud_apgs_element *element,
+		      void *user_data)
+{
+	struct element_log *log = user_data;
+	struct element_record *rec;
+
+	if (log->count >= ELEMENTS_MAX) {
+		return -ENOMEM;
+	}
+
+	if ((log->fail_at > 0) && (log->count + 1 == log->fail_at)) {
+		return -EIO;
+	}
+
+	rec = &log->records[log->count++];
+	rec->type = element->type;
+	rec->len = element_size(element->type);
+	/* All union members point to the element data. */
+	memcpy(rec->data, element->utc, rec->len);
+
+	return 0;
+}
+
+static void log_compare(const struct element_log *a,
+			const struct element_log *b, size_t split)
+{
+	zassert_equal(a->count, b->count,
+		      "Element count mismatch, split at %zu", split);
+
+	for (size_t i = 0; i < a->count; i++) {
+		zassert_equal(a->records[i].type, b->records[i].type,
+			      "Type mismatch, element %zu, split at %zu",
+			      i, split);
+		zassert_equal(a->records[i].len, b->records[i].len, NULL);
+		zassert_mem_equal(a->records[i].data, b->records[i].data,
+				  a->records[i].len,
+				  "Data mismatch, element %zu, split at %zu",
+				  i, split);
+	}
+}
+
+static void decode_chunked(const uint8_t *buf, size_t len, size_t chunk)
+{
+	struct nrf_cloud_agps_decoder decoder;
+	int err;
+
+	memset(&actual, 0, sizeof(actual));
+	nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+
+	for (size_t offset = 0; offset < len; offset += chunk) {
+		err = nrf_cloud_agps_decoder_write(&decoder, &buf[offset],
+						   MIN(chunk, len - offset));
+		zassert_equal(err, 0, "Write failed at offset %zu", offset);
+	}
+
+	err = nrf_cloud_agps_decoder_finish(&decoder);
+	zassert_equal(err, 0, "Finish failed, chunk size %zu", chunk);
+}
+
+static void setup(void)
+{
+	payload_build();
+}
+
+static void test_decode_whole(void)
+{
+	decode_chunked(payload, payload_len, payload_len);
+	log_compare(&expected, &actual, payload_len);
+}
+
+static void test_decode_split_every_boundary(void)
+{
+	struct nrf_cloud_agps_decoder decoder;
+	int err;
+
+	for (size_t split = 0; split <= payload_len; split++) {
+		memset(&actual, 0, sizeof(actual));
+		nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+
+		err = nrf_cloud_agps_decoder_write(&decoder, payload, split);
+		zassert_equal(err, 0, "First write failed, split at %zu",
+			      split);
+
+		err = nrf_cloud_agps_decoder_write(&decoder, &payload[split],
+						   payload_len - split);
+		zassert_equal(err, 0, "Second write failed, split at %zu",
+			      split);
+
+		err = nrf_cloud_agps_decoder_finish(&decoder);
+		zassert_equal(err, 0, "Finish failed, split at %zu", split);
+
+		log_compare(&expected, &actual, split);
+	}
+}
+
+static void test_decode_chunk_sizes(void)
+{
+	for (size_t chunk = 1; chunk <= 128; chunk++) {
+		decode_chunked(payload, payload_len, chunk);
+		log_compare(&expected, &actual, chunk);
+	}
+}
+
+static void test_decode_truncated(void)
+{
+	struct nrf_cloud_agps_decoder decoder;
+	int err;
+
+	/* Only version and UTC array: truncating inside the UTC element or
+	 * the array header must be detected.
+	 */
+	const size_t utc_end = 1 + 3 + sizeof(struct nrf_cloud_agps_utc);
+
+	for (size_t len = 2; len < utc_end; len++) {
+		memset(&actual, 0, sizeof(actual));
+		nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+
+		err = nrf_cloud_agps_decoder_write(&decoder, payload, len);
+		zassert_equal(err, 0, NULL);
+
+		err = nrf_cloud_agps_decoder_finish(&decoder);
+		zassert_equal(err, -EBADMSG, "Truncation at %zu not detected",
+			      len);
+	}
+
+	nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+	zassert_equal(nrf_cloud_agps_decoder_finish(&decoder), -ENODATA,
+		      NULL);
+}
+
+static void test_decode_bad_version(void)
+{
+	struct nrf_cloud_agps_decoder decoder;
+	uint8_t buf[] = { NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION + 1, 0, 0, 0 };
+	int err;
+
+	memset(&actual, 0, sizeof(actual));
+	nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+
+	err = nrf_cloud_agps_decoder_write(&decoder, buf, sizeof(buf));
+	zassert_equal(err, -EBADMSG, NULL);
+
+	err = nrf_cloud_agps_decoder_write(&decoder, payload, payload_len);
+	zassert_equal(err, -EBADMSG, "Decoder must stay in error state");
+	zassert_equal(actual.count, 0, NULL);
+}
+
+static void test_decode_callback_error(void)
+{
+	struct nrf_cloud_agps_decoder decoder;
+	int err;
+
+	memset(&actual, 0, sizeof(actual));
+	actual.fail_at = 5;
+	nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+
+	err = nrf_cloud_agps_decoder_write(&decoder, payload, payload_len);
+	zassert_equal(err, -EIO, NULL);
+	zassert_equal(actual.count, 4, NULL);
+
+	err = nrf_cloud_agps_decoder_finish(&decoder);
+	zassert_equal(err, -EBADMSG, NULL);
+}
+
+static void test_decode_unknown_type(void)
+{
+	struct nrf_cloud_agps_decoder decoder;
+	uint8_t buf[] = {
+		NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION,
+		NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION, 1, 0,
+		1, 2, 3, 4, 5, 6, 7, 8,
+		0x7F, 1, 0,
+		0xAA, 0xBB, 0xCC
+	};
+	int err;
+
+	memset(&actual, 0, sizeof(actual));
+	nrf_cloud_agps_decoder_init(&decoder, element_cb, &actual);
+
+	err = nrf_cloud_agps_decoder_write(&decoder, buf, sizeof(buf));
+	zassert_equal(err, 0, NULL);
+	zassert_equal(actual.count, 1, NULL);
+	zassert_equal(actual.records[0].type,
+		      NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION, NULL);
+	zassert_equal(nrf_cloud_agps_decoder_finish(&decoder), 0, NULL);
+}
+
+static const void *record_get(size_t i, enum nrf_cloud_agps_type type)
+{
+	zassert_true(i < actual.count, "Element %zu missing", i);
+	zassert_equal(actual.records[i].type, type,
+		      "Wrong type of element %zu", i);
+
+	return actual.records[i].data;
+}
+
+/* Checks the elements decoded from agps_payload against the field values
+ * it was encoded from, which checks the layout of the schema structures
+ * against the wire format.
+ */
+static void payload_fixture_check(void)
+{
+	const struct nrf_cloud_agps_utc *utc;
+	const struct nrf_cloud_agps_ephemeris *eph;
+	const struct nrf_cloud_agps_almanac *alm;
+	const struct nrf_cloud_agps_klobuchar *klob;
+	const struct nrf_cloud_agps_tow_element *tow;
+	const struct nrf_cloud_agps_system_time *sys_time;
+	const struct nrf_cloud_agps_location *loc;
+	const struct nrf_cloud_agps_integrity *integrity;
+
+	zassert_equal(actual.count, AGPS_PAYLOAD_ELEMENTS,
+		      "Wrong element count");
+
+	utc = record_get(0, NRF_CLOUD_AGPS_UTC_PARAMETERS);
+	zassert_equal(utc->a1, 0, NULL);
+	zassert_equal(utc->a0, -4, NULL);
+	zassert_equal(utc->wn_t, 62, NULL);
+	zassert_equal(utc->delta_tls, 18, NULL);
+	zassert_equal(utc->wn_lsf, 137, NULL);
+	zassert_equal(utc->delta_tlsf, 18, NULL);
+
+	eph = record_get(1, NRF_CLOUD_AGPS_EPHEMERIDES);
+	zassert_equal(eph->sv_id, 5, NULL);
+	zassert_equal(eph->iodc, 78, NULL);
+	zassert_equal(eph->af1, -1235, NULL);
+	zassert_equal(eph->af0, -12345678, NULL);
+	zassert_equal(eph->toe, 28800, NULL);
+	zassert_equal(eph->w, -1234567890, NULL);
+	zassert_equal(eph->e, 12345678, NULL);
+	zassert_equal(eph->sqrt_a, 2701958348U, NULL);
+	zassert_equal(eph->omega0, -1000000000, NULL);
+	zassert_equal(eph->cuc, -2345, NULL);
+
+	eph = record_get(2, NRF_CLOUD_AGPS_EPHEMERIDES);
+	zassert_equal(eph->sv_id, 12, NULL);
+	zassert_equal(eph->ura, 2, NULL);
+	zassert_equal(eph->m0, -123456789, NULL);
+	zassert_equal(eph->i0, 661234567, NULL);
+	zassert_equal(eph->cuc, -1234, NULL);
+
+	alm = record_get(3, NRF_CLOUD_AGPS_ALMANAC);
+	zassert_equal(alm->sv_id, 5, NULL);
+	zassert_equal(alm->toa, 144, NULL);
+	zassert_equal(alm->e, 12345, NULL);
+	zassert_equal(alm->sqrt_a, 10554678, NULL);
+	zassert_equal(alm->m0, -7654321, NULL);
+	zassert_equal(alm->af1, -2, NULL);
+
+	alm = record_get(4, NRF_CLOUD_AGPS_ALMANAC);
+	zassert_equal(alm->sv_id, 12, NULL);
+	zassert_equal(alm->omega0, 4567890, NULL);
+	zassert_equal(alm->af0, 123, NULL);
+
+	klob = record_get(5, NRF_CLOUD_AGPS_KLOBUCHAR_CORRECTION);
+	zassert_equal(klob->alpha0, 13, NULL);
+	zassert_equal(klob->alpha2, -8, NULL);
+	zassert_equal(klob->beta0, 88, NULL);
+	zassert_equal(klob->beta3, 1, NULL);
+
+	tow = record_get(6, NRF_CLOUD_AGPS_GPS_TOWS);
+	zassert_equal(tow->sv_id, 5, NULL);
+	zassert_equal(tow->tlm, 0x1234, NULL);
+	zassert_equal(tow->flags, 1, NULL);
+
+	tow = record_get(7, NRF_CLOUD_AGPS_GPS_TOWS);
+	zassert_equal(tow->sv_id, 12, NULL);
+	zassert_equal(tow->tlm, 0x0abc, NULL);
+
+	sys_time = record_get(8, NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK);
+	zassert_equal(sys_time->date_day, 14897, NULL);
+	zassert_equal(sys_time->time_full_s, 43200, NULL);
+	zassert_equal(sys_time->time_frac_ms, 250, NULL);
+	zassert_equal(sys_time->sv_mask, BIT(4) | BIT(11), NULL);
+
+	loc = record_get(9, NRF_CLOUD_AGPS_LOCATION);
+	zassert_equal(loc->latitude, 5912151, NULL);
+	zassert_equal(loc->longitude, 484447, NULL);
+	zassert_equal(loc->altitude, 50, NULL);
+	zassert_equal(loc->unc_semimajor, 20, NULL);
+	zassert_equal(loc->confidence, 68, NULL);
+
+	integrity = record_get(10, NRF_CLOUD_AGPS_INTEGRITY);
+	zassert_equal(integrity->integrity_mask, BIT(20), NULL);
+}
+
+static void test_decode_payload_fixture(void)
+{
+	decode_chunked(agps_payload, agps_payload_len, agps_payload_len);
+	payload_fixture_check();
+
+	/* Byte by byte, every element is staged in the decoder */
+	decode_chunked(agps_payload, agps_payload_len, 1);
+	payload_fixture_check();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf_cloud_agps_decoder,
+		ztest_unit_test_setup_teardown(test_decode_whole,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_decode_split_every_boundary,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_decode_chunk_sizes,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_decode_truncated,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_decode_bad_version,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_decode_callback_error,
+					       setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_decode_unknown_type,
+					       setup, unit_test_noop),
+		ztest_unit_test(test_decode_payload_fixture)
+	);
+
+	ztest_run_test_suite(nrf_cloud_agps_decoder);
+}
@@ -97,13 +97,71 @@ static void test_zb_nvram_write(void)
 	}
 }
 
+static void test_zb_nvram_write_behind(void)
+{
+	const int chunk = 16;
+	const int page = 0;
+	int ret;
+
+	ret = zb_osif_nvram_erase_async(page);
+	zassert_true(ret == RET_OK, "Erasing failed");
+
+	/* Contiguous writes, as ZBOSS writes a dataset */
+	for (int offset = 0; offset < PAGE_SIZE; offset += chunk) {
+		memset(zb_nvram_buf, offset / chunk, chunk);
+		ret = zb_osif_nvram_write(page, offset, zb_nvram_buf, chunk);
+		zassert_true(ret == RET_OK, "writing failed");
+	}
+
+	/* Data is read back before and after it is written to flash */
+	for (int pass = 0; pass < 2; pass++) {
+		zb_osif_nvram_read(page, 0, zb_nvram_buf, PAGE_SIZE);
+		for (int i = 0; i < PAGE_SIZE; i++) {
+			zassert_true(zb_nvram_buf[i] == i / chunk,
+				     "reading failed");
+		}
+
+		zb_osif_nvram_flush();
+	}
+}
+
+static void test_zb_nvram_erase_after_write(void)
+{
+	const char MEM_PATTERN = 0x55;
+	const int page = 1;
+	int ret;
+
+	memset(zb_nvram_buf, MEM_PATTERN, sizeof(zb_nvram_buf));
+
+	/* The erase wins over the write that precedes it */
+	ret = zb_osif_nvram_write(page, 0, zb_nvram_buf, PAGE_SIZE);
+	zassert_true(ret == RET_OK, "writing failed");
+	ret = zb_osif_nvram_erase_async(page);
+	zassert_true(ret == RET_OK, "Erasing failed");
+	ret = zb_osif_nvram_write(page, PAGE_SIZE, zb_nvram_buf, PAGE_SIZE);
+	zassert_true(ret == RET_OK, "writing failed");
+
+	zb_osif_nvram_wait_for_last_op();
+
+	zb_osif_nvram_read(page, 0, zb_nvram_buf, PAGE_SIZE);
+	for (int i = 0; i < PAGE_SIZE; i++) {
+		zassert_true(zb_nvram_buf[i] == 0xFF, "Erasing failed");
+	}
+
+	zb_osif_nvram_read(page, PAGE_SIZE, zb_nvram_buf, PAGE_SIZE);
+	for (int i = 0; i < PAGE_SIZE; i++) {
+		zassert_true(zb_nvram_buf[i] == MEM_PATTERN, "writing failed");
+	}
+}
 
 void test_main(void)
 {
 	ztest_test_suite(osif_test,
 			 ztest_unit_test(test_zb_nvram_memory_size),
 			 ztest_unit_test(test_zb_nvram_erase),
-			 ztest_unit_test(test_zb_nvram_write)
+			 ztest_unit_test(test_zb_nvram_write),
+			 ztest_unit_test(test_zb_nvram_write_behind),
+			 ztest_unit_test(test_zb_nvram_erase_after_write)
 			 );
 
 	ztest_run_test_suite(osif_test);
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* The part of the ZBOSS API used by the NVRAM, without the stack. */
+
+#ifndef ZBOSS_API_H__
+#define ZBOSS_API_H__
+
+#include <zephyr/types.h>
+
+#define ZB_USE_NVRAM
+
+enum zb_bool_e {
+	ZB_FALSE = 0,
+	ZB_TRUE = 1
+};
+
+typedef enum zb_bool_e zb_bool_t;
+typedef char zb_char_t;
+typedef unsigned char zb_uint8_t;
+typedef unsigned short zb_uint16_t;
+typedef unsigned int zb_uint32_t;
+typedef zb_uint32_t zb_time_t;
+typedef zb_uint8_t zb_bufid_t;
+typedef int zb_ret_t;
+
+typedef void (*zb_callback_t)(zb_uint8_t param);
+typedef void (*zb_callback2_t)(zb_uint8_t param, zb_uint16_t cb_param);
+
+#define RET_OK 0
+#define RET_ERROR (-1)
+#define RET_INVALID_PARAMETER (-2)
+#define RET_INVALID_PARAMETER_3 (-3)
+#define RET_INVALID_PARAMETER_4 (-4)
+#define RET_OVERFLOW (-5)
+#define RET_PAGE_NOT_FOUND (-6)
+
+zb_uint32_t zb_get_nvram_page_length(void);
+zb_uint8_t zb_get_nvram_page_count(void);
+void zb_osif_nvram_init(const zb_char_t *name);
+zb_ret_t zb_osif_nvram_read(zb_uint8_t page, zb_uint32_t pos, zb_uint8_t *buf,
+			    zb_uint16_t len);
+zb_ret_t zb_osif_nvram_write(zb_uint8_t page, zb_uint32_t pos, void *buf,
+			     zb_uint16_t len);
+zb_ret_t zb_osif_nvram_erase_async(zb_uint8_t page);
+void zb_osif_nvram_wait_for_last_op(void);
+void zb_osif_nvram_flush(void);
+
+#endif /* ZBOSS_API_H__ */
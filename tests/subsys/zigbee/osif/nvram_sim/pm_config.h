@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#ifndef PM_CONFIG_H__
+#define PM_CONFIG_H__
+
+#include <storage/flash_map.h>
+
+/* The ZBOSS NVRAM is placed in the storage partition of the simulated
+ * flash.
+ */
+#define PM_ZBOSS_NVRAM_ID FLASH_AREA_ID(storage)
+#define PM_ZBOSS_NVRAM_SIZE FLASH_AREA_SIZE(storage)
+
+#endif /* PM_CONFIG_H__ */
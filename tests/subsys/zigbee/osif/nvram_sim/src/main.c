@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <pm_config.h>
+#include <storage/flash_map.h>
+#include <logging/log.h>
+
+#include <zboss_api.h>
+#include "zb_nrf_platform.h"
+
+LOG_MODULE_REGISTER(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
+
+#define CHUNK_LEN 16
+#define CHUNK_COUNT 16
+#define DATA_LEN (CHUNK_LEN * CHUNK_COUNT)
+#define OPS_MAX 16
+
+/* Flash operations done by the NVRAM thread, in the order they are done */
+static struct flash_op {
+	bool erase;
+	zb_uint8_t page;
+	zb_uint32_t pos;
+	size_t len;
+} ops[OPS_MAX];
+static size_t op_count;
+
+/* Stops the NVRAM thread in the next erase, see erase_hold_start() */
+static bool erase_hold;
+static K_SEM_DEFINE(erase_started_sem, 0, 1);
+static K_SEM_DEFINE(erase_release_sem, 0, 1);
+
+static zb_ret_t schedule_ret = RET_OK;
+static uint32_t scheduled_pages;
+static uint32_t notified_pages;
+static k_tid_t notify_thread;
+
+static uint8_t data[DATA_LEN];
+static uint8_t buf[DATA_LEN];
+
+static void op_log(bool erase, off_t off, size_t len)
+{
+	if (op_count < OPS_MAX) {
+		ops[op_count].erase = erase;
+		ops[op_count].page = off / zb_get_nvram_page_length();
+		ops[op_count].pos = off % zb_get_nvram_page_length();
+		ops[op_count].len = len;
+	}
+	op_count++;
+}
+
+int test_flash_area_write(const struct flash_area *fa, off_t off,
+			  const void *src, size_t len)
+{
+	int err = flash_area_write(fa, off, src, len);
+
+	op_log(false, off, len);
+	return err;
+}
+
+int test_flash_area_erase(const struct flash_area *fa, off_t off, size_t len)
+{
+	int err;
+
+	if (erase_hold) {
+		erase_hold = false;
+		k_sem_give(&erase_started_sem);
+		k_sem_take(&erase_release_sem, K_FOREVER);
+	}
+
+	err = flash_area_erase(fa, off, len);
+	op_log(true, off, len);
+	return err;
+}
+
+/* Stub for the ZBOSS callout */
+void zb_nvram_erase_finished(zb_uint8_t page)
+{
+	notified_pages |= BIT(page);
+	notify_thread = k_current_get();
+}
+
+/* Stub for the ZBOSS scheduler, the callback is not called */
+zb_ret_t zigbee_schedule_callback(zb_callback_t func, zb_uint8_t param)
+{
+	if (schedule_ret == RET_OK && func == zb_nvram_erase_finished) {
+		scheduled_pages |= BIT(param);
+	}
+
+	return schedule_ret;
+}
+
+static void ops_reset(void)
+{
+	op_count = 0;
+	scheduled_pages = 0;
+	notified_pages = 0;
+}
+
+static void assert_op(size_t i, bool erase, zb_uint8_t page, zb_uint32_t pos,
+		      size_t len)
+{
+	zassert_true(i < op_count, "Missing flash operation %zu", i);
+	zassert_equal(ops[i].erase, erase, "Wrong operation %zu", i);
+	zassert_equal(ops[i].page, page, "Wrong page in operation %zu", i);
+	zassert_equal(ops[i].pos, pos, "Wrong position in operation %zu", i);
+	zassert_equal(ops[i].len, len, "Wrong length in operation %zu", i);
+}
+
+/* Read the flash, without the writes that are buffered */
+static void flash_read(zb_uint8_t page, zb_uint32_t pos, void *dst,
+		       size_t len)
+{
+	const struct flash_area *fa;
+	int err;
+
+	err = flash_area_open(PM_ZBOSS_NVRAM_ID, &fa);
+	zassert_equal(err, 0, "Can't open the flash area");
+	err = flash_area_read(fa, page * zb_get_nvram_page_length() + pos,
+			      dst, len);
+	zassert_equal(err, 0, "Flash read failed");
+	flash_area_close(fa);
+}
+
+static void assert_erased(const uint8_t *mem, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		zassert_equal(mem[i], 0xFF, "Not erased at %zu", i);
+	}
+}
+
+/* Erase a page and keep the NVRAM thread in the erase until
+ * erase_hold_release(), so that the following requests are buffered.
+ */
+static void erase_hold_start(zb_uint8_t page)
+{
+	zb_ret_t ret;
+
+	erase_hold = true;
+	ret = zb_osif_nvram_erase_async(page);
+	zassert_equal(ret, RET_OK, "Erasing failed");
+	k_sem_take(&erase_started_sem, K_FOREVER);
+}
+
+static void erase_hold_release(void)
+{
+	k_sem_give(&erase_release_sem);
+}
+
+static void test_nvram_init(void)
+{
+	zb_ret_t ret;
+
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = i / CHUNK_LEN;
+	}
+
+	zb_osif_nvram_init(NULL);
+
+	for (int page = 0; page < zb_get_nvram_page_count(); page++) {
+		ret = zb_osif_nvram_erase_async(page);
+		zassert_equal(ret, RET_OK, "Erasing failed");
+	}
+	zb_osif_nvram_flush();
+
+	zassert_equal(op_count, 2, "Unexpected flash operations");
+	assert_op(0, true, 0, 0, zb_get_nvram_page_length());
+	assert_op(1, true, 1, 0, zb_get_nvram_page_length());
+	zassert_equal(scheduled_pages, BIT(0) | BIT(1),
+		      "Erases not notified");
+
+	flash_read(0, 0, buf, sizeof(buf));
+	assert_erased(buf, sizeof(buf));
+}
+
+static void test_nvram_write_coalescing(void)
+{
+	zb_ret_t ret;
+
+	ops_reset();
+	erase_hold_start(1);
+
+	/* Contiguous writes, as ZBOSS writes a dataset */
+	for (int i = 0; i < CHUNK_COUNT; i++) {
+		ret = zb_osif_nvram_write(0, i * CHUNK_LEN,
+					  &data[i * CHUNK_LEN], CHUNK_LEN);
+		zassert_equal(ret, RET_OK, "Writing failed");
+	}
+	/* Not contiguous with the previous writes */
+	ret = zb_osif_nvram_write(0, 2 * DATA_LEN, data, CHUNK_LEN);
+	zassert_equal(ret, RET_OK, "Writing failed");
+
+	/* The buffered writes are read back before they are in flash */
+	ret = zb_osif_nvram_read(0, 0, buf, sizeof(buf));
+	zassert_equal(ret, RET_OK, "Reading failed");
+	zassert_mem_equal(buf, data, sizeof(buf), "Wrong data read");
+	flash_read(0, 0, buf, sizeof(buf));
+	assert_erased(buf, sizeof(buf));
+
+	erase_hold_release();
+	zb_osif_nvram_flush();
+
+	/* The contiguous writes are one flash write */
+	zassert_equal(op_count, 3, "Writes not coalesced");
+	assert_op(0, true, 1, 0, zb_get_nvram_page_length());
+	assert_op(1, false, 0, 0, DATA_LEN);
+	assert_op(2, false, 0, 2 * DATA_LEN, CHUNK_LEN);
+
+	flash_read(0, 0, buf, sizeof(buf));
+	zassert_mem_equal(buf, data, sizeof(buf), "Wrong data in flash");
+	flash_read(0, 2 * DATA_LEN, buf, CHUNK_LEN);
+	zassert_mem_equal(buf, data, CHUNK_LEN, "Wrong data in flash");
+}
+
+/* ZBOSS copies the datasets to the other page before it erases the page
+ * they were copied from. The copy must reach the flash before the erase,
+ * or the data is lost on a reset during the erase.
+ */
+static void test_nvram_erase_write_order(void)
+{
+	uint8_t junk[CHUNK_LEN];
+	zb_ret_t ret;
+
+	memset(junk, 0, sizeof(junk));
+
+	ops_reset();
+	erase_hold_start(1);
+
+	/* Copy to page 1 */
+	ret = zb_osif_nvram_write(1, 0, data, DATA_LEN);
+	zassert_equal(ret, RET_OK, "Writing failed");
+
+	/* The erase of page 0 supersedes this write */
+	ret = zb_osif_nvram_write(0, 3 * DATA_LEN, junk, sizeof(junk));
+	zassert_equal(ret, RET_OK, "Writing failed");
+
+	ret = zb_osif_nvram_erase_async(0);
+	zassert_equal(ret, RET_OK, "Erasing failed");
+
+	/* New data on the erased page */
+	ret = zb_osif_nvram_write(0, 0, data, CHUNK_LEN);
+	zassert_equal(ret, RET_OK, "Writing failed");
+
+	erase_hold_release();
+	zb_osif_nvram_wait_for_last_op();
+
+	zassert_equal(op_count, 4, "Unexpected flash operations");
+	assert_op(0, true, 1, 0, zb_get_nvram_page_length());
+	assert_op(1, false, 1, 0, DATA_LEN);
+	assert_op(2, true, 0, 0, zb_get_nvram_page_length());
+	assert_op(3, false, 0, 0, CHUNK_LEN);
+	zassert_equal(scheduled_pages, BIT(0) | BIT(1),
+		      "Erases not notified");
+	zassert_equal(notified_pages, 0, "Erases notified twice");
+
+	flash_read(1, 0, buf, DATA_LEN);
+	zassert_mem_equal(buf, data, DATA_LEN, "Copy lost");
+	flash_read(0, 0, buf, CHUNK_LEN);
+	zassert_mem_equal(buf, data, CHUNK_LEN, "Write after erase lost");
+	flash_read(0, CHUNK_LEN, buf, sizeof(buf));
+	assert_erased(buf, sizeof(buf));
+	flash_read(0, 3 * DATA_LEN, buf, CHUNK_LEN);
+	assert_erased(buf, CHUNK_LEN);
+}
+
+static void test_nvram_wait_for_last_op(void)
+{
+	zb_ret_t ret;
+
+	ops_reset();
+
+	/* The ZBOSS callback queue is full */
+	schedule_ret = RET_OVERFLOW;
+
+	erase_hold_start(1);
+	ret = zb_osif_nvram_write(1, 0, data, CHUNK_LEN);
+	zassert_equal(ret, RET_OK, "Writing failed");
+	erase_hold_release();
+
+	zb_osif_nvram_wait_for_last_op();
+	schedule_ret = RET_OK;
+
+	/* Everything is in flash, and ZBOSS is notified from its thread */
+	zassert_equal(op_count, 2, "Unexpected flash operations");
+	flash_read(1, 0, buf, CHUNK_LEN);
+	zassert_mem_equal(buf, data, CHUNK_LEN, "Write not done");
+	zassert_equal(notified_pages, BIT(1), "Erase not notified");
+	zassert_equal(notify_thread, k_current_get(),
+		      "Erase notified from the NVRAM thread");
+
+	/* Nothing is left to do */
+	notified_pages = 0;
+	zb_osif_nvram_wait_for_last_op();
+	zassert_equal(op_count, 2, "Unexpected flash operations");
+	zassert_equal(notified_pages, 0, "Erase notified twice");
+}
+
+static void test_nvram_flush(void)
+{
+	zb_ret_t ret;
+
+	ops_reset();
+
+	ret = zb_osif_nvram_write(1, DATA_LEN, data, DATA_LEN);
+	zassert_equal(ret, RET_OK, "Writing failed");
+	ret = zb_osif_nvram_write(1, 3 * DATA_LEN, data, CHUNK_LEN);
+	zassert_equal(ret, RET_OK, "Writing failed");
+
+	zb_osif_nvram_flush();
+
+	zassert_equal(op_count, 2, "Unexpected flash operations");
+	assert_op(0, false, 1, DATA_LEN, DATA_LEN);
+	assert_op(1, false, 1, 3 * DATA_LEN, CHUNK_LEN);
+	flash_read(1, DATA_LEN, buf, DATA_LEN);
+	zassert_mem_equal(buf, data, DATA_LEN, "Write not done");
+	flash_read(1, 3 * DATA_LEN, buf, CHUNK_LEN);
+	zassert_mem_equal(buf, data, CHUNK_LEN, "Write not done");
+
+	/* Nothing is left to do */
+	zb_osif_nvram_flush();
+	zassert_equal(op_count, 2, "Unexpected flash operations");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nvram_sim_test,
+			 ztest_unit_test(test_nvram_init),
+			 ztest_unit_test(test_nvram_write_coalescing),
+			 ztest_unit_test(test_nvram_erase_write_order),
+			 ztest_unit_test(test_nvram_wait_for_last_op),
+			 ztest_unit_test(test_nvram_flush)
+			 );
+
+	ztest_run_test_suite(nvram_sim_test);
+}